@@ -0,0 +1,337 @@
+#include <benchmark/benchmark.h>
+
+#include <components/compiler/context.hpp>
+#include <components/compiler/errorhandler.hpp>
+#include <components/compiler/fileparser.hpp>
+#include <components/compiler/scanner.hpp>
+#include <components/interpreter/context.hpp>
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/interpreter.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    // Scripts following the common patterns of the vanilla local and global scripts: do once guards with an early
+    // return, timers, quest stage state machines and loops. Only generic instructions are used, so no engine is
+    // required to run them.
+    const std::vector<std::string> sScripts = {
+        R"mwscript(Begin bench_doonce
+short doOnce
+if ( doOnce == 1 )
+    return
+endif
+set doOnce to 1
+End)mwscript",
+
+        R"mwscript(Begin bench_timer
+short state
+float timer
+if ( state == 0 )
+    set timer to ( timer + bench_seconds )
+    if ( timer > 5 )
+        set state to 1
+        set timer to 0
+    endif
+elseif ( state == 1 )
+    set timer to ( timer + bench_seconds )
+    if ( timer > 2 )
+        set state to 0
+        set timer to 0
+    endif
+endif
+End)mwscript",
+
+        R"mwscript(Begin bench_quest
+short stage
+short lastStage
+if ( bench_stage == lastStage )
+    return
+endif
+set lastStage to bench_stage
+if ( bench_stage == 10 )
+    set stage to 1
+elseif ( bench_stage == 20 )
+    set stage to 2
+elseif ( bench_stage == 30 )
+    set stage to 3
+elseif ( bench_stage == 40 )
+    set stage to 4
+elseif ( bench_stage >= 100 )
+    set stage to 5
+    set bench_stage to 0
+else
+    set stage to 0
+endif
+set bench_stage to ( bench_stage + 10 )
+End)mwscript",
+
+        R"mwscript(Begin bench_loop
+short i
+long sum
+float average
+set i to 0
+set sum to 0
+while ( i < 32 )
+    set sum to ( sum + i * i )
+    set i to ( i + 1 )
+endwhile
+set average to ( sum / 32.0 )
+End)mwscript",
+
+        R"mwscript(Begin bench_math
+float x
+float y
+float distance
+short inRange
+set x to ( x + 1.5 )
+if ( x > 1000 )
+    set x to -1000
+endif
+set y to ( x * 0.5 - 20 )
+set distance to ( x * x + y * y )
+if ( distance < 250000 )
+    set inRange to 1
+else
+    set inRange to 0
+endif
+End)mwscript",
+    };
+
+    class CompilerContext final : public Compiler::Context
+    {
+    public:
+        bool canDeclareLocals() const override { return true; }
+
+        char getGlobalType(const std::string& name) const override
+        {
+            if (name == "bench_seconds")
+                return 'f';
+            if (name == "bench_stage")
+                return 's';
+            return ' ';
+        }
+
+        std::pair<char, bool> getMemberType(const std::string& /*name*/, const ESM::RefId& /*id*/) const override
+        {
+            return { ' ', false };
+        }
+
+        bool isId(const ESM::RefId& /*name*/) const override { return false; }
+    };
+
+    class ErrorHandler final : public Compiler::ErrorHandler
+    {
+        void report(const std::string& message, const Compiler::TokenLoc& /*loc*/, Type type) override
+        {
+            if (type == ErrorMessage)
+                throw std::runtime_error(message);
+        }
+
+        void report(const std::string& message, Type type) override
+        {
+            if (type == ErrorMessage)
+                throw std::runtime_error(message);
+        }
+    };
+
+    struct Globals
+    {
+        std::map<std::string, int, std::less<>> mIntegers{ { "bench_stage", 0 } };
+        std::map<std::string, float, std::less<>> mFloats{ { "bench_seconds", 0.016f } };
+    };
+
+    class InterpreterContext final : public Interpreter::Context
+    {
+        Globals& mGlobals;
+        std::vector<int> mShorts;
+        std::vector<int> mLongs;
+        std::vector<float> mFloats;
+
+    public:
+        explicit InterpreterContext(Globals& globals, const Compiler::Locals& locals)
+            : mGlobals(globals)
+            , mShorts(locals.get('s').size())
+            , mLongs(locals.get('l').size())
+            , mFloats(locals.get('f').size())
+        {
+        }
+
+        ESM::RefId getTarget() const override { return ESM::RefId(); }
+
+        int getLocalShort(int index) const override { return mShorts[index]; }
+
+        int getLocalLong(int index) const override { return mLongs[index]; }
+
+        float getLocalFloat(int index) const override { return mFloats[index]; }
+
+        void setLocalShort(int index, int value) override { mShorts[index] = value; }
+
+        void setLocalLong(int index, int value) override { mLongs[index] = value; }
+
+        void setLocalFloat(int index, float value) override { mFloats[index] = value; }
+
+        void messageBox(std::string_view /*message*/, const std::vector<std::string>& /*buttons*/) override {}
+
+        void report(const std::string& /*message*/) override {}
+
+        int getGlobalShort(std::string_view name) const override { return mGlobals.mIntegers.find(name)->second; }
+
+        int getGlobalLong(std::string_view name) const override { return mGlobals.mIntegers.find(name)->second; }
+
+        float getGlobalFloat(std::string_view name) const override { return mGlobals.mFloats.find(name)->second; }
+
+        void setGlobalShort(std::string_view name, int value) override
+        {
+            mGlobals.mIntegers.find(name)->second = value;
+        }
+
+        void setGlobalLong(std::string_view name, int value) override
+        {
+            mGlobals.mIntegers.find(name)->second = value;
+        }
+
+        void setGlobalFloat(std::string_view name, float value) override
+        {
+            mGlobals.mFloats.find(name)->second = value;
+        }
+
+        std::vector<std::string> getGlobals() const override { return {}; }
+
+        char getGlobalType(std::string_view name) const override
+        {
+            if (mGlobals.mFloats.contains(name))
+                return 'f';
+            if (mGlobals.mIntegers.contains(name))
+                return 's';
+            return ' ';
+        }
+
+        std::string getActionBinding(std::string_view /*action*/) const override { return {}; }
+
+        std::string_view getActorName() const override { return {}; }
+
+        std::string_view getNPCRace() const override { return {}; }
+
+        std::string_view getNPCClass() const override { return {}; }
+
+        std::string_view getNPCFaction() const override { return {}; }
+
+        std::string_view getNPCRank() const override { return {}; }
+
+        std::string_view getPCName() const override { return {}; }
+
+        std::string_view getPCRace() const override { return {}; }
+
+        std::string_view getPCClass() const override { return {}; }
+
+        std::string_view getPCRank() const override { return {}; }
+
+        std::string_view getPCNextRank() const override { return {}; }
+
+        int getPCBounty() const override { return {}; }
+
+        std::string_view getCurrentCellName() const override { return {}; }
+
+        int getMemberShort(ESM::RefId /*id*/, std::string_view /*name*/, bool /*global*/) const override { return {}; }
+
+        int getMemberLong(ESM::RefId /*id*/, std::string_view /*name*/, bool /*global*/) const override { return {}; }
+
+        float getMemberFloat(ESM::RefId /*id*/, std::string_view /*name*/, bool /*global*/) const override
+        {
+            return {};
+        }
+
+        void setMemberShort(ESM::RefId /*id*/, std::string_view /*name*/, int /*value*/, bool /*global*/) override {}
+
+        void setMemberLong(ESM::RefId /*id*/, std::string_view /*name*/, int /*value*/, bool /*global*/) override {}
+
+        void setMemberFloat(ESM::RefId /*id*/, std::string_view /*name*/, float /*value*/, bool /*global*/) override
+        {
+        }
+    };
+
+    struct Script
+    {
+        Interpreter::Program mProgram;
+        Interpreter::DecodedProgram mDecodedProgram;
+        InterpreterContext mContext;
+    };
+
+    struct Corpus
+    {
+        Globals mGlobals;
+        Interpreter::Interpreter mInterpreter;
+        std::vector<std::unique_ptr<Script>> mScripts;
+
+        Corpus()
+        {
+            Interpreter::installOpcodes(mInterpreter);
+
+            ErrorHandler errorHandler;
+            CompilerContext compilerContext;
+            Compiler::FileParser parser(errorHandler, compilerContext);
+
+            for (const std::string& text : sScripts)
+            {
+                parser.reset();
+                std::istringstream input(text);
+                Compiler::Scanner scanner(errorHandler, input, compilerContext.getExtensions());
+                scanner.scan(parser);
+                Interpreter::Program program = parser.getProgram();
+                Interpreter::DecodedProgram decoded = mInterpreter.decode(Interpreter::Program(program));
+                mScripts.push_back(std::make_unique<Script>(Script{ std::move(program), std::move(decoded),
+                    InterpreterContext(mGlobals, parser.getLocals()) }));
+            }
+        }
+    };
+
+    Corpus& getCorpus()
+    {
+        static Corpus corpus;
+        return corpus;
+    }
+
+    // Decodes every instruction when it's executed, as the interpreter did for all the programs before they were
+    // decoded upfront
+    void runProgram(benchmark::State& state)
+    {
+        Corpus& corpus = getCorpus();
+        for (auto _ : state)
+            for (const std::unique_ptr<Script>& script : corpus.mScripts)
+                corpus.mInterpreter.run(script->mProgram, script->mContext);
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(corpus.mScripts.size()));
+    }
+
+    void runDecodedProgram(benchmark::State& state)
+    {
+        Corpus& corpus = getCorpus();
+        for (auto _ : state)
+            for (const std::unique_ptr<Script>& script : corpus.mScripts)
+                corpus.mInterpreter.run(script->mDecodedProgram, script->mContext);
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(corpus.mScripts.size()));
+    }
+
+    void decodeProgram(benchmark::State& state)
+    {
+        Corpus& corpus = getCorpus();
+        for (auto _ : state)
+            for (const std::unique_ptr<Script>& script : corpus.mScripts)
+                benchmark::DoNotOptimize(corpus.mInterpreter.decode(Interpreter::Program(script->mProgram)));
+        state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(corpus.mScripts.size()));
+    }
+}
+
+BENCHMARK(runProgram);
+BENCHMARK(runDecodedProgram);
+BENCHMARK(decodeProgram);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include "components/nifosg/controller.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Close to a vanilla character animation: a track per bone, a key every few frames for a few hundred seconds
+    constexpr std::size_t tracksCount = 60;
+    constexpr std::size_t keysCount = 2000;
+    constexpr float keysInterval = 0.1f;
+    constexpr float frameDuration = 1 / 60.f;
+
+    struct Track
+    {
+        NifOsg::QuaternionInterpolator mRotations;
+        NifOsg::Vec3Interpolator mTranslations;
+    };
+
+    template <class Random>
+    std::vector<Track> generateTracks(Random& random)
+    {
+        std::uniform_real_distribution<float> distribution(-1, 1);
+        std::vector<Track> result;
+        for (std::size_t i = 0; i < tracksCount; ++i)
+        {
+            auto rotations = std::make_shared<Nif::QuaternionKeyMap>();
+            auto translations = std::make_shared<Nif::Vector3KeyMap>();
+            rotations->mInterpolationType = Nif::InterpolationType_Linear;
+            translations->mInterpolationType = Nif::InterpolationType_Linear;
+            for (std::size_t j = 0; j < keysCount; ++j)
+            {
+                Nif::QuaternionKey rotation{};
+                rotation.mValue = osg::Quat(distribution(random), osg::Vec3f(0, 0, 1));
+                rotations->insert(j * keysInterval, rotation);
+                Nif::Vector3Key translation{};
+                translation.mValue = osg::Vec3f(distribution(random), distribution(random), distribution(random));
+                translations->insert(j * keysInterval, translation);
+            }
+            result.push_back(Track{ NifOsg::QuaternionInterpolator(rotations, osg::Quat()),
+                NifOsg::Vec3Interpolator(translations) });
+        }
+        return result;
+    }
+
+    void sample(const std::vector<Track>& tracks, float time)
+    {
+        for (const Track& track : tracks)
+        {
+            benchmark::DoNotOptimize(track.mRotations.interpKey(time));
+            benchmark::DoNotOptimize(track.mTranslations.interpKey(time));
+        }
+    }
+
+    // Time moving forward frame after frame, as when an animation plays
+    void sampleSequentially(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        const std::vector<Track> tracks = generateTracks(random);
+        float time = 0;
+        for (auto _ : state)
+        {
+            sample(tracks, time);
+            time += frameDuration;
+            if (time > keysCount * keysInterval)
+                time = 0;
+        }
+        state.SetItemsProcessed(state.iterations() * tracksCount);
+    }
+
+    // Time jumping around, as when an animation starts from another group
+    void sampleRandomly(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        const std::vector<Track> tracks = generateTracks(random);
+        std::uniform_real_distribution<float> distribution(0, keysCount * keysInterval);
+        for (auto _ : state)
+            sample(tracks, distribution(random));
+        state.SetItemsProcessed(state.iterations() * tracksCount);
+    }
+}
+
+BENCHMARK(sampleSequentially);
+BENCHMARK(sampleRandomly);
+
+BENCHMARK_MAIN();
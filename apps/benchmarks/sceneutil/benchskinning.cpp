@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+
+#include "components/sceneutil/skinning.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // Close to the vanilla NPC body parts: every character uses about 40 bones of its skeleton, its vertices are
+    // influenced by up to 4 bones.
+    constexpr std::size_t bonesCount = 40;
+    constexpr std::size_t verticesCount = 3000;
+    constexpr std::size_t maxInfluences = 4;
+
+    using BoneWeights = std::vector<std::pair<std::size_t, float>>;
+    using VertexList = std::vector<unsigned short>;
+
+    struct Character
+    {
+        std::vector<osg::Matrixf> mBones;
+        std::vector<std::pair<BoneWeights, VertexList>> mInfluences;
+        std::vector<osg::Vec3f> mPositions;
+        std::vector<osg::Vec3f> mNormals;
+        std::vector<osg::Vec3f> mSkinnedPositions;
+        std::vector<osg::Vec3f> mSkinnedNormals;
+        SceneUtil::SkinningPalette mPalette;
+    };
+
+    template <class Random>
+    Character generateCharacter(Random& random)
+    {
+        std::uniform_real_distribution<float> coordinate(-50, 50);
+        std::uniform_real_distribution<float> angle(-3, 3);
+        std::uniform_int_distribution<std::size_t> bone(0, bonesCount - 1);
+        std::uniform_int_distribution<std::size_t> influences(1, maxInfluences);
+
+        Character result;
+        for (std::size_t i = 0; i < bonesCount; ++i)
+            result.mBones.push_back(osg::Matrixf::rotate(angle(random), osg::Vec3f(0, 0, 1))
+                * osg::Matrixf::translate(coordinate(random), coordinate(random), coordinate(random)));
+
+        // Neighbouring vertices share their weights, as RigGeometry groups them
+        std::map<BoneWeights, VertexList> groups;
+        BoneWeights weights;
+        for (std::size_t i = 0; i < verticesCount; ++i)
+        {
+            if (i % 8 == 0)
+            {
+                weights.clear();
+                const std::size_t count = influences(random);
+                for (std::size_t j = 0; j < count; ++j)
+                    weights.emplace_back(bone(random), 1.f / count);
+            }
+            groups[weights].push_back(static_cast<unsigned short>(i));
+            result.mPositions.emplace_back(coordinate(random), coordinate(random), coordinate(random));
+            result.mNormals.emplace_back(0, 0, 1);
+        }
+        result.mInfluences.assign(groups.begin(), groups.end());
+        result.mSkinnedPositions.resize(verticesCount);
+        result.mSkinnedNormals.resize(verticesCount);
+        return result;
+    }
+
+    template <class Random>
+    std::vector<Character> generateCharacters(std::size_t count, Random& random)
+    {
+        std::vector<Character> result;
+        result.reserve(count);
+        std::generate_n(std::back_inserter(result), count, [&] { return generateCharacter(random); });
+        return result;
+    }
+
+    // What RigGeometry did before the SIMD kernel
+    void skinScalar(Character& character)
+    {
+        for (const auto& [influences, vertices] : character.mInfluences)
+        {
+            osg::Matrixf resultMat(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+
+            for (const auto& [index, weight] : influences)
+            {
+                osg::Matrixf boneMat = character.mBones[index];
+                float* boneMatPtr = boneMat.ptr();
+                float* resultMatPtr = resultMat.ptr();
+                for (int i = 0; i < 16; ++i, ++resultMatPtr, ++boneMatPtr)
+                    if (i % 4 != 3)
+                        *resultMatPtr += *boneMatPtr * weight;
+            }
+
+            for (unsigned short vertex : vertices)
+            {
+                character.mSkinnedPositions[vertex] = resultMat.preMult(character.mPositions[vertex]);
+                character.mSkinnedNormals[vertex]
+                    = osg::Matrixf::transform3x3(character.mNormals[vertex], resultMat);
+            }
+        }
+    }
+
+    void skinSimd(Character& character)
+    {
+        character.mPalette.resize(character.mBones.size());
+        for (std::size_t i = 0; i < character.mBones.size(); ++i)
+            character.mPalette.set(i, character.mBones[i]);
+
+        SceneUtil::SkinningArrays arrays;
+        arrays.mPositionSrc = character.mPositions.data();
+        arrays.mPositionDst = character.mSkinnedPositions.data();
+        arrays.mNormalSrc = character.mNormals.data();
+        arrays.mNormalDst = character.mSkinnedNormals.data();
+
+        for (const auto& [influences, vertices] : character.mInfluences)
+            SceneUtil::skinVertices(character.mPalette, influences, nullptr, vertices, arrays);
+    }
+
+    void skinCharactersScalar(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        std::vector<Character> characters = generateCharacters(state.range(0), random);
+        for (auto _ : state)
+        {
+            for (Character& character : characters)
+                skinScalar(character);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+
+    void skinCharactersSimd(benchmark::State& state)
+    {
+        std::minstd_rand random;
+        std::vector<Character> characters = generateCharacters(state.range(0), random);
+        for (auto _ : state)
+        {
+            for (Character& character : characters)
+                skinSimd(character);
+            benchmark::ClobberMemory();
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+BENCHMARK(skinCharactersScalar)->RangeMultiplier(4)->Range(1, 64);
+BENCHMARK(skinCharactersSimd)->RangeMultiplier(4)->Range(1, 64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,114 @@
+#include <components/esm3/compressedstream.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace ESM
+{
+    namespace
+    {
+        using namespace ::testing;
+
+        struct Esm3CompressedStreamTest : Test
+        {
+            std::minstd_rand mRandom;
+
+            std::string generateData(std::size_t size)
+            {
+                // Mix repeating and random bytes, so the data is compressible but not trivially
+                std::uniform_int_distribution<int> distribution('a', 'h');
+                std::string result;
+                result.reserve(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    result.push_back(i % 3 == 0 ? static_cast<char>(distribution(mRandom)) : 'z');
+                return result;
+            }
+
+            std::unique_ptr<std::istream> compress(const std::string& data, std::size_t blockSize)
+            {
+                auto stream = std::make_unique<std::stringstream>();
+                writeCompressedStream(data, *stream, blockSize);
+                return openCompressedStream(std::move(stream));
+            }
+        };
+
+        TEST_F(Esm3CompressedStreamTest, isCompressedStreamShouldDetectHeaderAndKeepPosition)
+        {
+            std::stringstream compressed;
+            writeCompressedStream("data", compressed);
+            EXPECT_TRUE(isCompressedStream(compressed));
+            EXPECT_EQ(compressed.tellg(), 0);
+
+            std::stringstream raw("TES3");
+            EXPECT_FALSE(isCompressedStream(raw));
+            EXPECT_EQ(raw.tellg(), 0);
+
+            std::stringstream empty;
+            EXPECT_FALSE(isCompressedStream(empty));
+        }
+
+        TEST_F(Esm3CompressedStreamTest, shouldReadWrittenData)
+        {
+            const std::string data = generateData(10000);
+            const auto stream = compress(data, 1024);
+
+            std::string result(data.size(), '\0');
+            stream->read(result.data(), static_cast<std::streamsize>(result.size()));
+            EXPECT_EQ(stream->gcount(), static_cast<std::streamsize>(data.size()));
+            EXPECT_EQ(result, data);
+            EXPECT_EQ(stream->peek(), std::char_traits<char>::eof());
+        }
+
+        TEST_F(Esm3CompressedStreamTest, shouldReadEmptyData)
+        {
+            const auto stream = compress(std::string(), 1024);
+            stream->seekg(0, std::ios::end);
+            EXPECT_EQ(stream->tellg(), 0);
+            stream->seekg(0, std::ios::beg);
+            EXPECT_EQ(stream->peek(), std::char_traits<char>::eof());
+        }
+
+        TEST_F(Esm3CompressedStreamTest, seekEndShouldReportUncompressedSize)
+        {
+            const std::string data = generateData(4096);
+            const auto stream = compress(data, 1000);
+            stream->seekg(0, std::ios::end);
+            EXPECT_EQ(stream->tellg(), static_cast<std::streamoff>(data.size()));
+        }
+
+        TEST_F(Esm3CompressedStreamTest, shouldSupportRandomSeeks)
+        {
+            const std::string data = generateData(10000);
+            const auto stream = compress(data, 512);
+
+            for (const std::size_t offset : { 9000, 10, 511, 512, 513, 4000, 0, 9999 })
+            {
+                stream->seekg(static_cast<std::streamoff>(offset));
+                EXPECT_EQ(stream->tellg(), static_cast<std::streamoff>(offset));
+                EXPECT_EQ(stream->get(), data[offset]) << offset;
+            }
+
+            stream->seekg(100, std::ios::beg);
+            stream->seekg(1000, std::ios::cur);
+            EXPECT_EQ(stream->tellg(), 1100);
+            EXPECT_EQ(stream->get(), data[1100]);
+        }
+
+        TEST_F(Esm3CompressedStreamTest, shouldThrowOnTruncatedData)
+        {
+            std::stringstream compressed;
+            writeCompressedStream(generateData(4096), compressed, 1024);
+            std::string truncated = compressed.str();
+            truncated.resize(truncated.size() / 2);
+
+            const auto stream = openCompressedStream(std::make_unique<std::stringstream>(truncated));
+            stream->exceptions(std::ios::badbit);
+            std::string result(4096, '\0');
+            EXPECT_ANY_THROW(stream->read(result.data(), static_cast<std::streamsize>(result.size())));
+        }
+    }
+}
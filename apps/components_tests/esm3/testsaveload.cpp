@@ -757,6 +757,43 @@ namespace ESM
             EXPECT_EQ(result.mLandData->mDataLoaded, record.mLandData->mDataLoaded);
         }
 
+        TEST_P(Esm3SaveLoadRecordTest, remainingRecordDataShouldBeReadableWithOpenRecordData)
+        {
+            CellRef record;
+            record.blank();
+            record.mRefNum.mIndex = 42;
+            record.mRefNum.mContentFile = 13;
+            record.mRefID = generateRandomRefId();
+            record.mScale = 2;
+            generateArray(record.mPos.pos);
+            generateArray(record.mPos.rot);
+
+            ESMReader reader;
+            reader.open(makeEsmStream(record, GetParam()), "stream");
+            ASSERT_TRUE(reader.hasMoreRecs());
+            ASSERT_EQ(reader.getRecName().toInt(), fakeRecordId);
+            reader.getRecHeader();
+            // Leaves the name of the first sub-record cached
+            ASSERT_FALSE(reader.isNextSub("NONE"));
+
+            std::vector<char> data = reader.getRemainingRecordData();
+            EXPECT_FALSE(reader.hasMoreSubs());
+            EXPECT_FALSE(reader.hasMoreRecs());
+
+            ESMReader dataReader;
+            dataReader.openRecordData(
+                std::make_unique<std::stringstream>(std::string(data.begin(), data.end())), "data", GetParam());
+            CellRef result;
+            load(dataReader, result);
+
+            EXPECT_FALSE(dataReader.hasMoreSubs());
+            EXPECT_EQ(record.mRefNum.mIndex, result.mRefNum.mIndex);
+            EXPECT_EQ(record.mRefNum.mContentFile, result.mRefNum.mContentFile);
+            EXPECT_EQ(record.mRefID, result.mRefID);
+            EXPECT_EQ(record.mScale, result.mScale);
+            EXPECT_EQ(record.mPos, result.mPos);
+        }
+
         INSTANTIATE_TEST_SUITE_P(FormatVersions, Esm3SaveLoadRecordTest, ValuesIn(getFormats()));
     }
 }
@@ -0,0 +1,91 @@
+#include <components/nifosg/controller.hpp>
+
+#include <gtest/gtest.h>
+
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    using namespace NifOsg;
+
+    std::shared_ptr<Nif::FloatKeyMap> makeKeys(
+        std::initializer_list<std::pair<float, float>> keys, uint32_t type = Nif::InterpolationType_Linear)
+    {
+        auto result = std::make_shared<Nif::FloatKeyMap>();
+        result->mInterpolationType = type;
+        for (const auto& [time, value] : keys)
+        {
+            Nif::FloatKey key{};
+            key.mValue = value;
+            key.mInTan = value;
+            key.mOutTan = -value;
+            result->insert(time, key);
+        }
+        return result;
+    }
+
+    TEST(NifOsgValueInterpolatorTest, keysShouldBeSortedWithoutDuplicates)
+    {
+        const auto keys = makeKeys({ { 2, 20 }, { 0, 0 }, { 1, 10 }, { 2, 30 } });
+        EXPECT_EQ(keys->mTimes, (std::vector<float>{ 0, 1, 2 }));
+        EXPECT_EQ(keys->mValues, (std::vector<float>{ 0, 10, 30 }));
+        EXPECT_TRUE(keys->mInTans.empty());
+        EXPECT_TRUE(keys->mOutTans.empty());
+    }
+
+    TEST(NifOsgValueInterpolatorTest, quadraticKeysShouldHaveTangents)
+    {
+        const auto keys = makeKeys({ { 1, 10 }, { 0, 5 } }, Nif::InterpolationType_Quadratic);
+        EXPECT_EQ(keys->mInTans, (std::vector<float>{ 5, 10 }));
+        EXPECT_EQ(keys->mOutTans, (std::vector<float>{ -5, -10 }));
+    }
+
+    TEST(NifOsgValueInterpolatorTest, withoutKeysShouldReturnDefaultValue)
+    {
+        const FloatInterpolator interpolator(nullptr, 3.f);
+        EXPECT_TRUE(interpolator.empty());
+        EXPECT_EQ(interpolator.interpKey(1), 3.f);
+    }
+
+    TEST(NifOsgValueInterpolatorTest, timeOutsideOfKeysShouldBeClamped)
+    {
+        const FloatInterpolator interpolator(makeKeys({ { 1, 10 }, { 2, 20 } }));
+        EXPECT_EQ(interpolator.interpKey(0), 10.f);
+        EXPECT_EQ(interpolator.interpKey(3), 20.f);
+    }
+
+    TEST(NifOsgValueInterpolatorTest, linearKeysShouldBeInterpolatedWhateverTheOrderOfTimes)
+    {
+        const FloatInterpolator interpolator(makeKeys({ { 0, 0 }, { 1, 10 }, { 2, 30 }, { 3, 60 }, { 4, 100 } }));
+        const std::vector<std::pair<float, float>> samples{ { 0.5f, 5 }, { 0.75f, 7.5f }, { 1.5f, 20 },
+            { 3.5f, 80 }, { 0.25f, 2.5f }, { 2, 30 }, { 2.5f, 45 }, { 1, 10 }, { 3.75f, 90 } };
+        for (const auto& [time, expected] : samples)
+            EXPECT_FLOAT_EQ(interpolator.interpKey(time), expected) << time;
+    }
+
+    TEST(NifOsgValueInterpolatorTest, constantKeysShouldSwitchHalfway)
+    {
+        const FloatInterpolator interpolator(makeKeys({ { 0, 0 }, { 1, 10 } }, Nif::InterpolationType_Constant));
+        EXPECT_EQ(interpolator.interpKey(0.4f), 0.f);
+        EXPECT_EQ(interpolator.interpKey(0.6f), 10.f);
+    }
+
+    TEST(NifOsgValueInterpolatorTest, quadraticKeysShouldUseTangents)
+    {
+        const FloatInterpolator interpolator(makeKeys({ { 0, 0 }, { 1, 10 } }, Nif::InterpolationType_Quadratic));
+        // b2(0.5) = 0.5, b4(0.5) = -0.125
+        EXPECT_FLOAT_EQ(interpolator.interpKey(0.5f), 10 * 0.5f + 10 * -0.125f);
+    }
+
+    TEST(NifOsgValueInterpolatorTest, copiesShouldSampleIndependently)
+    {
+        const FloatInterpolator interpolator(makeKeys({ { 0, 0 }, { 1, 10 }, { 2, 20 } }));
+        EXPECT_FLOAT_EQ(interpolator.interpKey(1.5f), 15.f);
+        const FloatInterpolator copy = interpolator;
+        EXPECT_FLOAT_EQ(copy.interpKey(0.5f), 5.f);
+        EXPECT_FLOAT_EQ(interpolator.interpKey(1.75f), 17.5f);
+    }
+}
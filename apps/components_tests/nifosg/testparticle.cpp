@@ -0,0 +1,129 @@
+#include <components/nif/data.hpp>
+#include <components/nifosg/particle.hpp>
+
+#include <osgParticle/ParticleSystem>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace
+{
+    using namespace NifOsg;
+
+    constexpr float epsilon = 1e-5f;
+
+    struct NifOsgParticleBatchTest : ::testing::Test
+    {
+        osg::ref_ptr<osgParticle::ParticleSystem> mSystem = new osgParticle::ParticleSystem;
+        osg::ref_ptr<ParticleProgram> mProgram = new ParticleProgram;
+        ParticleBatch mBatch;
+
+        NifOsgParticleBatchTest()
+        {
+            mSystem->getDefaultParticleTemplate().setSizeRange(osgParticle::rangef(2, 2));
+            mProgram->setParticleSystem(mSystem);
+        }
+
+        osgParticle::Particle& addParticle(double age, double lifeTime, const osg::Vec3f& position = osg::Vec3f())
+        {
+            osgParticle::Particle* particle = mSystem->createParticle(nullptr);
+            particle->setLifeTime(lifeTime);
+            particle->setPosition(position);
+            particle->update(age, true);
+            return *particle;
+        }
+    };
+
+    TEST_F(NifOsgParticleBatchTest, gatherShouldSplitParticlesInBatches)
+    {
+        for (std::size_t i = 0; i < ParticleBatch::sMaxSize + 6; ++i)
+            addParticle(0, 1);
+        int index = 0;
+        ASSERT_TRUE(mBatch.gather(*mSystem, index));
+        EXPECT_EQ(mBatch.mSize, ParticleBatch::sMaxSize);
+        ASSERT_TRUE(mBatch.gather(*mSystem, index));
+        EXPECT_EQ(mBatch.mSize, 6);
+        EXPECT_FALSE(mBatch.gather(*mSystem, index));
+    }
+
+    TEST_F(NifOsgParticleBatchTest, growFadeShouldScaleDefaultSizeWithAge)
+    {
+        mBatch.add(addParticle(0.5, 4));
+        mBatch.add(addParticle(2, 4));
+        mBatch.add(addParticle(3.5, 4));
+        osg::ref_ptr<GrowFadeAffector> affector = new GrowFadeAffector(1, 1);
+        affector->beginOperate(mProgram);
+        affector->operateBatch(mBatch, 0.1f);
+        EXPECT_NEAR(mBatch.mParticleSize[0], 1, epsilon);
+        EXPECT_NEAR(mBatch.mParticleSize[1], 2, epsilon);
+        EXPECT_NEAR(mBatch.mParticleSize[2], 1, epsilon);
+    }
+
+    TEST_F(NifOsgParticleBatchTest, windGravityShouldAccelerateAlongDirection)
+    {
+        Nif::NiGravity gravity;
+        gravity.mForce = 2;
+        gravity.mType = Nif::ForceType::Wind;
+        gravity.mDirection = osg::Vec3f(0, 0, -2);
+        mBatch.add(addParticle(0, 1, osg::Vec3f(1, 2, 3)));
+        osg::ref_ptr<GravityAffector> affector = new GravityAffector(&gravity);
+        affector->beginOperate(mProgram);
+        affector->operateBatch(mBatch, 0.5f);
+        EXPECT_NEAR(mBatch.mVelocityX[0], 0, epsilon);
+        EXPECT_NEAR(mBatch.mVelocityY[0], 0, epsilon);
+        EXPECT_NEAR(mBatch.mVelocityZ[0], -1.6f, epsilon);
+    }
+
+    TEST_F(NifOsgParticleBatchTest, pointGravityShouldAccelerateTowardsPosition)
+    {
+        Nif::NiGravity gravity;
+        gravity.mForce = 2;
+        gravity.mType = Nif::ForceType::Point;
+        gravity.mPosition = osg::Vec3f(10, 0, 0);
+        mBatch.add(addParticle(0, 1, osg::Vec3f(0, 0, 0)));
+        mBatch.add(addParticle(0, 1, osg::Vec3f(10, 0, 0)));
+        osg::ref_ptr<GravityAffector> affector = new GravityAffector(&gravity);
+        affector->beginOperate(mProgram);
+        affector->operateBatch(mBatch, 0.5f);
+        EXPECT_NEAR(mBatch.mVelocityX[0], 1.6f, epsilon);
+        EXPECT_NEAR(mBatch.mVelocityY[0], 0, epsilon);
+        EXPECT_NEAR(mBatch.mVelocityZ[0], 0, epsilon);
+        // A particle at the position isn't accelerated
+        EXPECT_EQ(mBatch.getVelocity(1), osg::Vec3f());
+    }
+
+    TEST_F(NifOsgParticleBatchTest, scatterShouldSetColorAndAlpha)
+    {
+        Nif::NiColorData data;
+        data.mKeyMap = std::make_shared<Nif::Vector4KeyMap>();
+        data.mKeyMap->mInterpolationType = Nif::InterpolationType_Linear;
+        Nif::Vector4Key key{};
+        key.mValue = osg::Vec4f(1, 0, 0, 1);
+        data.mKeyMap->insert(0, key);
+        key.mValue = osg::Vec4f(0, 0, 1, 0);
+        data.mKeyMap->insert(1, key);
+
+        osgParticle::Particle& particle = addParticle(1, 2);
+        mBatch.add(particle);
+        osg::ref_ptr<ParticleColorAffector> affector = new ParticleColorAffector(&data);
+        affector->operateBatch(mBatch, 0.1f);
+        mBatch.scatter();
+        EXPECT_EQ(particle.getColorRange().minimum, osg::Vec4f(0.5f, 0, 0.5f, 1));
+        EXPECT_EQ(particle.getAlphaRange().minimum, 0.5f);
+    }
+
+    TEST_F(NifOsgParticleBatchTest, scatterShouldOnlySetWrittenAttributes)
+    {
+        osgParticle::Particle& particle = addParticle(0, 1);
+        particle.setVelocity(osg::Vec3f(1, 2, 3));
+        mBatch.add(particle);
+        mBatch.setVelocity(0, osg::Vec3f(4, 5, 6));
+        mBatch.scatter();
+        EXPECT_EQ(particle.getVelocity(), osg::Vec3f(1, 2, 3));
+        mBatch.mWritten = ParticleBatch::Attribute_Velocity;
+        mBatch.scatter();
+        EXPECT_EQ(particle.getVelocity(), osg::Vec3f(4, 5, 6));
+        EXPECT_EQ(particle.getSizeRange().minimum, 2);
+    }
+}
@@ -3,6 +3,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <osg/Array>
 #include <osg/Object>
 
 namespace Resource
@@ -317,6 +318,95 @@ namespace Resource
             EXPECT_EQ(cache->lowerBound(4), std::nullopt);
         }
 
+        TEST(ResourceGenericObjectCacheTest, getMemoryShouldReturnSumOfItemSizes)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new Object, 0, 10);
+            cache->addEntryToObjectCache(2, new Object, 0, 20);
+            EXPECT_EQ(cache->getMemory(), 30);
+            EXPECT_EQ(cache->getStats().mMemory, 30);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, addEntryToObjectCacheShouldMeasureObjectOnlyWithBudget)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new osg::Vec3Array(10));
+            EXPECT_EQ(cache->getMemory(), 0);
+
+            cache->setMaxMemory(1000);
+            cache->addEntryToObjectCache(2, new osg::Vec3Array(10));
+            const std::size_t memory = cache->getMemory();
+            EXPECT_GT(memory, 0);
+
+            cache->setMaxMemory(0);
+            cache->setMeasureMemory(true);
+            cache->addEntryToObjectCache(3, new osg::Vec3Array(10));
+            EXPECT_EQ(cache->getMemory(), 2 * memory);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, addEntryToObjectCacheShouldReplaceSizeOfExistingItem)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new Object, 0, 10);
+            cache->addEntryToObjectCache(1, new Object, 0, 20);
+            EXPECT_EQ(cache->getMemory(), 20);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, removeFromObjectCacheShouldSubtractItemSize)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new Object, 0, 10);
+            cache->addEntryToObjectCache(2, new Object, 0, 20);
+            cache->removeFromObjectCache(1);
+            EXPECT_EQ(cache->getMemory(), 20);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, updateShouldSubtractExpiredItemSize)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new Object, 1, 10);
+            cache->update(10, 5);
+            EXPECT_EQ(cache->getMemory(), 0);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, updateShouldEvictLeastRecentlyUsedItemsOverMaxMemory)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->setMaxMemory(25);
+            cache->addEntryToObjectCache(1, new Object, 3, 10);
+            cache->addEntryToObjectCache(2, new Object, 1, 10);
+            cache->addEntryToObjectCache(3, new Object, 2, 10);
+            cache->update(4, 10);
+            EXPECT_EQ(cache->getRefFromObjectCacheOrNone(2), std::nullopt);
+            EXPECT_NE(cache->getRefFromObjectCacheOrNone(1), std::nullopt);
+            EXPECT_NE(cache->getRefFromObjectCacheOrNone(3), std::nullopt);
+            EXPECT_EQ(cache->getMemory(), 20);
+            EXPECT_EQ(cache->getStats().mExpired, 1);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, updateShouldNotEvictItemsReferencedElsewhere)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->setMaxMemory(5);
+            osg::ref_ptr<Object> value(new Object);
+            cache->addEntryToObjectCache(1, value, 1, 10);
+            cache->addEntryToObjectCache(2, new Object, 2, 10);
+            cache->update(3, 10);
+            EXPECT_THAT(cache->getRefFromObjectCacheOrNone(1), Optional(value));
+            EXPECT_EQ(cache->getRefFromObjectCacheOrNone(2), std::nullopt);
+            EXPECT_EQ(cache->getMemory(), 10);
+        }
+
+        TEST(ResourceGenericObjectCacheTest, trimShouldEvictLeastRecentlyUsedItems)
+        {
+            osg::ref_ptr<GenericObjectCache<int>> cache(new GenericObjectCache<int>);
+            cache->addEntryToObjectCache(1, new Object, 2, 10);
+            cache->addEntryToObjectCache(2, new Object, 1, 10);
+            cache->trim(10);
+            EXPECT_NE(cache->getRefFromObjectCacheOrNone(1), std::nullopt);
+            EXPECT_EQ(cache->getRefFromObjectCacheOrNone(2), std::nullopt);
+        }
+
         TEST(ResourceGenericObjectCacheTest, addEntryToObjectCacheShouldSupportHeterogeneousLookup)
         {
             osg::ref_ptr<GenericObjectCache<std::string>> cache(new GenericObjectCache<std::string>);
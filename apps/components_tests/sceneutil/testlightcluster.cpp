@@ -0,0 +1,126 @@
+#include <components/sceneutil/lightcluster.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    // Camera at the origin looking along -Z
+    const osg::Matrix projection = osg::Matrix::perspective(90, 1, 1, 10000);
+
+    struct SceneUtilLightClustersTest : ::testing::Test
+    {
+        LightClusters mClusters;
+
+        std::vector<int> getLights(const osg::Vec3f& viewPos) const
+        {
+            const std::uint32_t cluster = mClusters.getClusters()[mClusters.getClusterIndex(viewPos, projection)];
+            const auto begin = mClusters.getIndices().begin() + (cluster & 0xffff);
+            return std::vector<int>(begin, begin + (cluster >> 16));
+        }
+    };
+
+    TEST_F(SceneUtilLightClustersTest, clustersShouldBeEmptyWithoutLights)
+    {
+        mClusters.build(projection, {}, 8);
+        EXPECT_TRUE(mClusters.getIndices().empty());
+        EXPECT_TRUE(getLights(osg::Vec3f(0, 0, -100)).empty());
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightShouldBeInClustersOfPositionsItReaches)
+    {
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100), 3 } }, 8);
+        EXPECT_EQ(getLights(osg::Vec3f(0, 0, -500)), std::vector<int>{ 3 });
+        EXPECT_EQ(getLights(osg::Vec3f(90, 0, -500)), std::vector<int>{ 3 });
+        EXPECT_EQ(getLights(osg::Vec3f(0, 0, -590)), std::vector<int>{ 3 });
+        EXPECT_EQ(getLights(osg::Vec3f(0, -90, -420)), std::vector<int>{ 3 });
+    }
+
+    TEST_F(SceneUtilLightClustersTest, everyPositionReachedByLightShouldHaveIt)
+    {
+        const osg::BoundingSphere bound(osg::Vec3f(130, -70, -300), 250);
+        mClusters.build(projection, { { bound, 3 } }, 8);
+        for (float x = -1; x <= 1; x += 0.125f)
+            for (float y = -1; y <= 1; y += 0.125f)
+                for (float z = -1; z <= 1; z += 0.125f)
+                {
+                    const osg::Vec3f offset(x, y, z);
+                    if (offset.length2() > 1)
+                        continue;
+                    const osg::Vec3f viewPos(bound.center().x() + x * bound.radius(),
+                        bound.center().y() + y * bound.radius(), bound.center().z() + z * bound.radius());
+                    EXPECT_EQ(getLights(viewPos), std::vector<int>{ 3 }) << x << " " << y << " " << z;
+                }
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightShouldNotBeInDistantClusters)
+    {
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100), 3 } }, 8);
+        EXPECT_TRUE(getLights(osg::Vec3f(400, 0, -500)).empty());
+        EXPECT_TRUE(getLights(osg::Vec3f(0, 0, -50)).empty());
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightBehindCameraShouldBeIgnored)
+    {
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(0, 0, 500), 100), 3 } }, 8);
+        EXPECT_TRUE(mClusters.getIndices().empty());
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightAroundCameraShouldReachNearClusters)
+    {
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(0, 0, 0), 100), 3 } }, 8);
+        EXPECT_EQ(getLights(osg::Vec3f(-50, 50, -20)), std::vector<int>{ 3 });
+        EXPECT_EQ(getLights(osg::Vec3f(5, -5, -2)), std::vector<int>{ 3 });
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightOutsideOfScreenShouldReachEdgeClusters)
+    {
+        // Vertices outside of the screen are clamped to the edge tiles and need the lights around them
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(1000, 0, -500), 100), 3 } }, 8);
+        EXPECT_EQ(getLights(osg::Vec3f(1000, 0, -500)), std::vector<int>{ 3 });
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightsShouldKeepTheirOrder)
+    {
+        mClusters.build(projection,
+            { { osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100), 5 },
+                { osg::BoundingSphere(osg::Vec3f(10, 0, -500), 100), 1 },
+                { osg::BoundingSphere(osg::Vec3f(20, 0, -500), 100), 7 } },
+            8);
+        EXPECT_EQ(getLights(osg::Vec3f(10, 0, -500)), (std::vector<int>{ 5, 1, 7 }));
+    }
+
+    TEST_F(SceneUtilLightClustersTest, lightsAboveLimitShouldBeDropped)
+    {
+        mClusters.build(projection,
+            { { osg::BoundingSphere(osg::Vec3f(0, 0, -500), 100), 5 },
+                { osg::BoundingSphere(osg::Vec3f(10, 0, -500), 100), 1 },
+                { osg::BoundingSphere(osg::Vec3f(20, 0, -500), 100), 7 } },
+            2);
+        EXPECT_EQ(getLights(osg::Vec3f(10, 0, -500)), (std::vector<int>{ 5, 1 }));
+    }
+
+    TEST_F(SceneUtilLightClustersTest, indicesShouldNotExceedLimit)
+    {
+        std::vector<LightClusters::Light> lights;
+        for (int i = 0; i < 300; ++i)
+            lights.push_back({ osg::BoundingSphere(osg::Vec3f(0, 0, -1000), 5000), i });
+        mClusters.build(projection, lights, 64);
+        EXPECT_EQ(mClusters.getIndices().size(), static_cast<std::size_t>(LightClusters::sMaxIndices));
+        for (std::uint32_t cluster : mClusters.getClusters())
+            EXPECT_LE((cluster & 0xffff) + (cluster >> 16), static_cast<std::uint32_t>(LightClusters::sMaxIndices));
+        // Near clusters are filled first
+        EXPECT_EQ(getLights(osg::Vec3f(0, 0, -10)).size(), 64);
+    }
+
+    TEST_F(SceneUtilLightClustersTest, clusterIndexShouldCoverWholeGrid)
+    {
+        mClusters.build(projection, { { osg::BoundingSphere(osg::Vec3f(0, 0, -5000), 100), 0 } }, 8);
+        EXPECT_EQ(mClusters.getClusterIndex(osg::Vec3f(-1e5f, -1e5f, -1), projection), 0);
+        EXPECT_EQ(
+            mClusters.getClusterIndex(osg::Vec3f(1e5f, 1e5f, -1e5f), projection), LightClusters::sNumClusters - 1);
+    }
+}
@@ -0,0 +1,127 @@
+#include <components/sceneutil/occlusionculling.hpp>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    // Camera at the origin looking along -Z
+    const osg::Matrix projection = osg::Matrix::perspective(90, 1, 1, 10000);
+
+    OccluderMesh makeQuad(float halfSize, float z)
+    {
+        OccluderMesh mesh;
+        mesh.mVertices = { osg::Vec3f(-halfSize, -halfSize, z), osg::Vec3f(halfSize, -halfSize, z),
+            osg::Vec3f(halfSize, halfSize, z), osg::Vec3f(-halfSize, halfSize, z) };
+        mesh.mIndices = { 0, 1, 2, 0, 2, 3 };
+        for (const osg::Vec3f& vertex : mesh.mVertices)
+            mesh.mBound.expandBy(vertex);
+        return mesh;
+    }
+
+    struct SceneUtilOcclusionBufferTest : ::testing::Test
+    {
+        OcclusionBuffer mBuffer{ 64, 64 };
+    };
+
+    TEST_F(SceneUtilOcclusionBufferTest, emptyBufferShouldNotOccludeAnything)
+    {
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -1000, 1, 1, -900), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, boxBehindOccluderShouldBeOccluded)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_TRUE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -30, 1, 1, -20), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, boxInFrontOfOccluderShouldNotBeOccluded)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -9, 1, 1, -8), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, boxIntersectingOccluderShouldNotBeOccluded)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -20, 1, 1, -9), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, boxVisibleNextToOccluderShouldNotBeOccluded)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -30, 20, 1, -20), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, boxCloseToCameraShouldNotBeOccluded)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -30, 1, 1, 1), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, clearShouldRemoveOccluders)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        mBuffer.clear();
+        mBuffer.buildHierarchy();
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-1, -1, -30, 1, 1, -20), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, depthShouldNotBeCloserThanOccluder)
+    {
+        mBuffer.addOccluder(makeQuad(5, -10), projection);
+        for (int y = 0; y < mBuffer.getHeight(); ++y)
+            for (int x = 0; x < mBuffer.getWidth(); ++x)
+                EXPECT_LE(mBuffer.getDepth(x, y), 0.1f) << x << " " << y;
+        EXPECT_GT(mBuffer.getDepth(32, 32), 0.09f);
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, trianglesSharingEdgesShouldLeaveNoGaps)
+    {
+        // Irregular grid covering the whole screen
+        OccluderMesh grid;
+        const int size = 7;
+        for (int y = 0; y <= size; ++y)
+            for (int x = 0; x <= size; ++x)
+                grid.mVertices.emplace_back(-20 + 40.f * x / size + 0.37f * (y % 3), -20 + 40.f * y / size, -10 - x);
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                const unsigned int i = y * (size + 1) + x;
+                grid.mIndices.insert(grid.mIndices.end(), { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 });
+            }
+        }
+        mBuffer.addOccluder(grid, projection);
+        for (int y = 0; y < mBuffer.getHeight(); ++y)
+            for (int x = 0; x < mBuffer.getWidth(); ++x)
+                EXPECT_GT(mBuffer.getDepth(x, y), 0) << x << " " << y;
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, occluderLargerThanScreenShouldBeClipped)
+    {
+        mBuffer.addOccluder(makeQuad(1e5f, -10), projection);
+        mBuffer.buildHierarchy();
+        EXPECT_TRUE(mBuffer.isOccluded(osg::BoundingBox(-50, -50, -30, 50, 50, -20), projection));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, occluderBehindCameraShouldBeClipped)
+    {
+        // Floor below the camera from behind it to far in front of it
+        OccluderMesh floor;
+        floor.mVertices = { osg::Vec3f(-1000, -1, 100), osg::Vec3f(1000, -1, 100), osg::Vec3f(1000, -1, -1000),
+            osg::Vec3f(-1000, -1, -1000) };
+        floor.mIndices = { 0, 1, 2, 0, 2, 3 };
+        mBuffer.addOccluder(floor, projection);
+        mBuffer.buildHierarchy();
+        EXPECT_TRUE(mBuffer.isOccluded(osg::BoundingBox(-5, -20, -60, 5, -10, -50), projection));
+        EXPECT_FALSE(mBuffer.isOccluded(osg::BoundingBox(-5, 0, -60, 5, 10, -50), projection));
+    }
+}
@@ -0,0 +1,35 @@
+#include <components/sceneutil/skeleton.hpp>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    TEST(SceneUtilSkeletonTest, animationLodIntervalShouldBeOneForLargeSkeleton)
+    {
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(100, 100, 8), 1);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(200, 100, 8), 1);
+    }
+
+    TEST(SceneUtilSkeletonTest, animationLodIntervalShouldDoubleForEveryHalvedSize)
+    {
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(99, 100, 8), 2);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(50, 100, 8), 2);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(49, 100, 8), 4);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(24, 100, 8), 8);
+    }
+
+    TEST(SceneUtilSkeletonTest, animationLodIntervalShouldBeLimitedByMaxInterval)
+    {
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(1, 100, 4), 4);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(1, 100, 1), 1);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(0, 100, 0), 1);
+    }
+
+    TEST(SceneUtilSkeletonTest, animationLodIntervalShouldNotExceedMaxIntervalWhichIsNotPowerOfTwo)
+    {
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(1, 100, 3), 2);
+        EXPECT_EQ(Skeleton::getAnimationLodInterval(1, 100, 7), 4);
+    }
+}
@@ -0,0 +1,162 @@
+#include <components/sceneutil/skinning.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+namespace
+{
+    using namespace SceneUtil;
+
+    constexpr float epsilon = 1e-4f;
+
+    struct SceneUtilSkinningTest : ::testing::Test
+    {
+        SkinningPalette mPalette;
+        std::vector<osg::Matrixf> mMatrices{
+            osg::Matrixf::rotate(0.5f, osg::Vec3f(0, 0, 1)) * osg::Matrixf::translate(1, 2, 3),
+            osg::Matrixf::scale(2, 2, 2) * osg::Matrixf::translate(-4, 0, 1),
+            osg::Matrixf::rotate(-1.2f, osg::Vec3f(1, 0, 0)),
+        };
+        std::vector<osg::Vec3f> mPositions{ osg::Vec3f(1, 0, 0), osg::Vec3f(0, 1, 2), osg::Vec3f(-3, 5, 1) };
+        std::vector<osg::Vec3f> mNormals{ osg::Vec3f(0, 0, 1), osg::Vec3f(0, 1, 0), osg::Vec3f(1, 0, 0) };
+        std::vector<osg::Vec4f> mTangents{ osg::Vec4f(1, 0, 0, 1), osg::Vec4f(0, 0, 1, -1), osg::Vec4f(0, 1, 0, 1) };
+        std::vector<osg::Vec3f> mSkinnedPositions = std::vector<osg::Vec3f>(3);
+        std::vector<osg::Vec3f> mSkinnedNormals = std::vector<osg::Vec3f>(3);
+        std::vector<osg::Vec4f> mSkinnedTangents = std::vector<osg::Vec4f>(3);
+        SkinningArrays mArrays;
+
+        SceneUtilSkinningTest()
+        {
+            mPalette.resize(mMatrices.size());
+            for (std::size_t i = 0; i < mMatrices.size(); ++i)
+                mPalette.set(i, mMatrices[i]);
+            mArrays.mPositionSrc = mPositions.data();
+            mArrays.mPositionDst = mSkinnedPositions.data();
+            mArrays.mNormalSrc = mNormals.data();
+            mArrays.mNormalDst = mSkinnedNormals.data();
+            mArrays.mTangentSrc = mTangents.data();
+            mArrays.mTangentDst = mSkinnedTangents.data();
+        }
+
+        // Same computation as RigGeometry did before the SIMD kernel
+        osg::Matrixf blend(const std::vector<std::pair<std::size_t, float>>& weights) const
+        {
+            osg::Matrixf result(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+            for (const auto& [index, weight] : weights)
+                for (int i = 0; i < 16; ++i)
+                    if (i % 4 != 3)
+                        result.ptr()[i] += mMatrices[index].ptr()[i] * weight;
+            return result;
+        }
+
+        void expectSkinned(const osg::Matrixf& matrix, unsigned short vertex) const
+        {
+            const osg::Vec3f position = matrix.preMult(mPositions[vertex]);
+            const osg::Vec3f normal = osg::Matrixf::transform3x3(mNormals[vertex], matrix);
+            const osg::Vec4f& tangent = mTangents[vertex];
+            const osg::Vec3f skinnedTangent
+                = osg::Matrixf::transform3x3(osg::Vec3f(tangent.x(), tangent.y(), tangent.z()), matrix);
+            for (int i = 0; i < 3; ++i)
+            {
+                EXPECT_NEAR(mSkinnedPositions[vertex][i], position[i], epsilon) << vertex << " " << i;
+                EXPECT_NEAR(mSkinnedNormals[vertex][i], normal[i], epsilon) << vertex << " " << i;
+                EXPECT_NEAR(mSkinnedTangents[vertex][i], skinnedTangent[i], epsilon) << vertex << " " << i;
+            }
+            EXPECT_EQ(mSkinnedTangents[vertex].w(), tangent.w());
+        }
+    };
+
+    TEST_F(SceneUtilSkinningTest, singleBoneShouldTransformVertices)
+    {
+        skinVertices(mPalette, { { 0, 1.f } }, nullptr, { 0, 1, 2 }, mArrays);
+        for (unsigned short vertex = 0; vertex < 3; ++vertex)
+            expectSkinned(mMatrices[0], vertex);
+    }
+
+    TEST_F(SceneUtilSkinningTest, weightsShouldBlendBoneMatrices)
+    {
+        const std::vector<std::pair<std::size_t, float>> weights{ { 0, 0.25f }, { 1, 0.5f }, { 2, 0.25f } };
+        skinVertices(mPalette, weights, nullptr, { 0, 1, 2 }, mArrays);
+        for (unsigned short vertex = 0; vertex < 3; ++vertex)
+            expectSkinned(blend(weights), vertex);
+    }
+
+    TEST_F(SceneUtilSkinningTest, onlyGivenVerticesShouldBeSkinned)
+    {
+        skinVertices(mPalette, { { 1, 1.f } }, nullptr, { 1 }, mArrays);
+        expectSkinned(mMatrices[1], 1);
+        EXPECT_EQ(mSkinnedPositions[0], osg::Vec3f());
+        EXPECT_EQ(mSkinnedPositions[2], osg::Vec3f());
+    }
+
+    TEST_F(SceneUtilSkinningTest, missingBoneShouldBeIgnored)
+    {
+        mPalette.setMissing(1);
+        skinVertices(mPalette, { { 0, 0.5f }, { 1, 0.5f } }, nullptr, { 0, 1, 2 }, mArrays);
+        for (unsigned short vertex = 0; vertex < 3; ++vertex)
+            expectSkinned(blend({ { 0, 0.5f } }), vertex);
+    }
+
+    TEST_F(SceneUtilSkinningTest, geomToSkelMatrixShouldBeAppliedAfterBlending)
+    {
+        // The translation of the matrix is applied once even when the weights don't sum to 1
+        const osg::Matrixf geomToSkel
+            = osg::Matrixf::rotate(0.3f, osg::Vec3f(0, 1, 0)) * osg::Matrixf::translate(7, 8, 9);
+        const std::vector<std::pair<std::size_t, float>> weights{ { 0, 0.4f }, { 2, 0.4f } };
+        skinVertices(mPalette, weights, &geomToSkel, { 0, 1, 2 }, mArrays);
+        for (unsigned short vertex = 0; vertex < 3; ++vertex)
+            expectSkinned(blend(weights) * geomToSkel, vertex);
+    }
+
+    TEST_F(SceneUtilSkinningTest, optionalArraysShouldBeSkipped)
+    {
+        mArrays.mNormalDst = nullptr;
+        mArrays.mTangentDst = nullptr;
+        skinVertices(mPalette, { { 0, 1.f } }, nullptr, { 0 }, mArrays);
+        EXPECT_EQ(mSkinnedNormals[0], osg::Vec3f());
+        EXPECT_EQ(mSkinnedTangents[0], osg::Vec4f());
+    }
+
+    TEST(SceneUtilPackInfluencesTest, upTo4InfluencesShouldBeKeptAsIs)
+    {
+        const PackedInfluences packed = packInfluences({ { 2, 0.5f }, { 0, 0.3f }, { 1, 0.2f } }, 3);
+        EXPECT_EQ(packed.mIndices, osg::Vec4f(2, 0, 1, 0));
+        EXPECT_EQ(packed.mWeights, osg::Vec4f(0.5f, 0.3f, 0.2f, 0));
+    }
+
+    TEST(SceneUtilPackInfluencesTest, only4HeaviestInfluencesShouldBeKeptWithNormalizedWeights)
+    {
+        const PackedInfluences packed
+            = packInfluences({ { 0, 0.1f }, { 1, 0.3f }, { 2, 0.05f }, { 3, 0.25f }, { 4, 0.2f }, { 5, 0.1f } }, 6);
+        EXPECT_EQ(packed.mIndices, osg::Vec4f(1, 3, 4, 0));
+        EXPECT_NEAR(packed.mWeights[0], 0.3f / 0.85f, epsilon);
+        EXPECT_NEAR(packed.mWeights[1], 0.25f / 0.85f, epsilon);
+        EXPECT_NEAR(packed.mWeights[2], 0.2f / 0.85f, epsilon);
+        EXPECT_NEAR(packed.mWeights[3], 0.1f / 0.85f, epsilon);
+        EXPECT_NEAR(packed.mWeights[0] + packed.mWeights[1] + packed.mWeights[2] + packed.mWeights[3], 1, epsilon);
+    }
+
+    TEST(SceneUtilPackInfluencesTest, bonesPastNumBonesShouldBeIgnored)
+    {
+        const PackedInfluences packed = packInfluences({ { 0, 0.5f }, { 3, 0.25f }, { 1, 0.25f } }, 2);
+        EXPECT_EQ(packed.mIndices, osg::Vec4f(0, 1, 0, 0));
+        EXPECT_EQ(packed.mWeights, osg::Vec4f(0.5f, 0.25f, 0, 0));
+    }
+
+    TEST(SceneUtilPackInfluencesTest, vertexWithoutInfluencesShouldHaveNoWeight)
+    {
+        const PackedInfluences packed = packInfluences({}, 2);
+        EXPECT_EQ(packed.mWeights, osg::Vec4f());
+    }
+
+    TEST(SceneUtilSkinningJobTest, finishShouldRunJobOnce)
+    {
+        std::atomic<int> runs{ 0 };
+        osg::ref_ptr<SkinningJob> job = new SkinningJob([&] { ++runs; });
+        job->finish();
+        EXPECT_FALSE(job->tryRun());
+        job->finish();
+        EXPECT_EQ(runs, 1);
+    }
+}
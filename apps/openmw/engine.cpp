@@ -730,6 +730,7 @@ void OMW::Engine::prepareEngine()
 
     mResourceSystem = std::make_unique<Resource::ResourceSystem>(
         mVFS.get(), Settings::cells().mCacheExpiryDelay, &mEncoder.get()->getStatelessEncoder());
+    mResourceSystem->setMaxCacheMemory(static_cast<std::size_t>(Settings::cells().mCacheMaxMemory) << 20);
     mResourceSystem->getSceneManager()->getShaderManager().setMaxTextureUnits(mGlMaxTextureImageUnits);
     mResourceSystem->getSceneManager()->setUnRefImageDataAfterApply(
         false); // keep to Off for now to allow better state sharing
@@ -817,7 +818,8 @@ void OMW::Engine::prepareEngine()
     mEnvironment.setInputManager(*mInputManager);
 
     // Create sound system
-    mSoundManager = std::make_unique<MWSound::SoundManager>(mVFS.get(), mUseSound);
+    mSoundManager = std::make_unique<MWSound::SoundManager>(mVFS.get(), mUseSound,
+        Settings::sound().mStreamCacheSize > 0 ? mCfgMgr.getCachePath() / "sound" : std::filesystem::path());
     mEnvironment.setSoundManager(*mSoundManager);
 
     // Create the world
@@ -885,7 +887,8 @@ void OMW::Engine::prepareEngine()
     mScriptContext->setExtensions(&mExtensions);
 
     mScriptManager = std::make_unique<MWScript::ScriptManager>(mWorld->getStore(), *mScriptContext, mWarningsMode,
-        mScriptBlacklistUse ? mScriptBlacklist : std::vector<ESM::RefId>());
+        mScriptBlacklistUse ? mScriptBlacklist : std::vector<ESM::RefId>(),
+        Settings::general().mCacheCompiledScripts ? mCfgMgr.getUserDataPath() / "scripts.cache" : std::filesystem::path());
     mEnvironment.setScriptManager(*mScriptManager);
 
     // Create game mechanics system
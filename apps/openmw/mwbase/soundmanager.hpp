@@ -1,6 +1,7 @@
 #ifndef GAME_MWBASE_SOUNDMANAGER_H
 #define GAME_MWBASE_SOUNDMANAGER_H
 
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
@@ -148,6 +149,16 @@ namespace MWBase
         /// and get an average loudness value (scale [0,1]) at the current time position.
         /// If the actor is not saying anything, returns 0.
 
+        virtual void preloadVoice(VFS::Path::NormalizedView filename) = 0;
+        ///< Open a voice file in the background for an upcoming say(). Only the last sMaxPreloadedVoices files are
+        /// kept open.
+        /// \param filename name of a sound file in the VFS
+
+        static constexpr std::size_t sMaxPreloadedVoices = 16;
+
+        virtual void preloadSound(const ESM::RefId& soundId) = 0;
+        ///< Decode a sound in the background for an upcoming playSound()
+
         virtual SoundStream* playTrack(const MWSound::DecoderPtr& decoder, Type type) = 0;
         ///< Play a 2D audio track, using a custom decoder. The caller is expected to call
         /// stopTrack with the returned handle when done.
@@ -4,6 +4,8 @@
 #include <list>
 #include <optional>
 #include <sstream>
+#include <string_view>
+#include <vector>
 
 #include <components/debug/debuglog.hpp>
 
@@ -49,6 +51,7 @@
 
 #include "filter.hpp"
 #include "hypertextparser.hpp"
+#include "saidfiles.hpp"
 
 namespace MWDialogue
 {
@@ -182,6 +185,8 @@ namespace MWDialogue
 
                     addTopicsFromText(info->mResponse);
 
+                    preloadVoices(info->mResponse);
+
                     return true;
                 }
             }
@@ -189,6 +194,36 @@ namespace MWDialogue
         return false;
     }
 
+    void DialogueManager::preloadVoices(const std::string& greeting)
+    {
+        // Voiced answers are played by their result scripts, open the files while the player picks a topic. Only a
+        // few files are kept open, so the topics linked by the greeting come first.
+        std::vector<ESM::RefId> topics = parseTopicIdsFromText(greeting);
+        for (const auto& [topicId, topicInfo] : mActorKnownTopics)
+            topics.push_back(topicId);
+
+        std::vector<VFS::Path::Normalized> files;
+        for (const ESM::RefId& topicId : topics)
+        {
+            const auto it = mActorKnownTopics.find(topicId);
+            if (it == mActorKnownTopics.end() || !mKnownTopics.contains(topicId))
+                continue;
+            for (std::string_view file : getSaidFiles(it->second.mInfo->mResultScript))
+            {
+                VFS::Path::Normalized path = Misc::ResourceHelpers::correctSoundPath(VFS::Path::Normalized(file));
+                if (std::find(files.begin(), files.end(), path) == files.end())
+                    files.push_back(std::move(path));
+            }
+            if (files.size() >= MWBase::SoundManager::sMaxPreloadedVoices)
+                break;
+        }
+        files.resize(std::min(files.size(), MWBase::SoundManager::sMaxPreloadedVoices));
+
+        MWBase::SoundManager* sndMgr = MWBase::Environment::get().getSoundManager();
+        for (const VFS::Path::Normalized& file : files)
+            sndMgr->preloadVoice(file);
+    }
+
     std::optional<Interpreter::Program> DialogueManager::compile(const std::string& cmd, const MWWorld::Ptr& actor)
     {
         bool success = true;
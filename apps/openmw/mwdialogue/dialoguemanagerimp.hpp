@@ -62,6 +62,8 @@ namespace MWDialogue
         std::vector<ESM::RefId> parseTopicIdsFromText(const std::string& text);
         void addTopicsFromText(const std::string& text);
 
+        void preloadVoices(const std::string& greeting);
+
         void updateActorKnownTopics();
         void updateGlobals();
 
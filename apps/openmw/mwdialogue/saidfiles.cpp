@@ -0,0 +1,57 @@
+#include "saidfiles.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#include <components/misc/strings/algorithm.hpp>
+
+namespace MWDialogue
+{
+    namespace
+    {
+        bool isSpace(char c)
+        {
+            return std::isspace(static_cast<unsigned char>(c));
+        }
+
+        std::string_view trimLeft(std::string_view value)
+        {
+            while (!value.empty() && isSpace(value.front()))
+                value.remove_prefix(1);
+            return value;
+        }
+    }
+
+    std::vector<std::string_view> getSaidFiles(std::string_view script)
+    {
+        std::vector<std::string_view> files;
+        while (!script.empty())
+        {
+            const std::size_t end = script.find('\n');
+            std::string_view line = script.substr(0, end);
+            script.remove_prefix(end == std::string_view::npos ? script.size() : end + 1);
+
+            // The instruction may be called on another object
+            if (const std::size_t arrow = line.find("->"); arrow != std::string_view::npos)
+                line.remove_prefix(arrow + 2);
+            line = trimLeft(line);
+
+            constexpr std::string_view say = "say";
+            if (!Misc::StringUtils::ciStartsWith(line, say) || line.size() == say.size() || !isSpace(line[say.size()]))
+                continue;
+            line = trimLeft(line.substr(say.size()));
+
+            std::size_t fileEnd;
+            if (!line.empty() && line.front() == '"')
+            {
+                line.remove_prefix(1);
+                fileEnd = line.find('"');
+            }
+            else
+                fileEnd = std::find_if(line.begin(), line.end(), isSpace) - line.begin();
+            if (fileEnd != std::string_view::npos && fileEnd > 0)
+                files.push_back(line.substr(0, fileEnd));
+        }
+        return files;
+    }
+}
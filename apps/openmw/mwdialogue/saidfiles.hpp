@@ -0,0 +1,14 @@
+#ifndef GAME_MWDIALOGUE_SAIDFILES_H
+#define GAME_MWDIALOGUE_SAIDFILES_H
+
+#include <string_view>
+#include <vector>
+
+namespace MWDialogue
+{
+    /// Files played by the Say instructions of a result script, it's how the answers are voiced. The files are
+    /// returned as written in the script, the script is not compiled.
+    std::vector<std::string_view> getSaidFiles(std::string_view script);
+}
+
+#endif
@@ -1707,6 +1707,15 @@ namespace MWMechanics
                 }
             }
         }
+        if (!inCombat)
+        {
+            // Decode the sounds of the fight before the first blows
+            static const ESM::RefId combatSounds[] = { ESM::RefId::stringRefId("Weapon Swish"),
+                ESM::RefId::stringRefId("Health Damage"), ESM::RefId::stringRefId("miss") };
+            for (const ESM::RefId& sound : combatSounds)
+                MWBase::Environment::get().getSoundManager()->preloadSound(sound);
+        }
+
         stats.getAiSequence().stack(MWMechanics::AiCombat(target), ptr);
         if (target == getPlayer())
         {
@@ -502,9 +502,17 @@ namespace MWRender
     {
         osg::ref_ptr<const SceneUtil::KeyframeHolder> mKeyframes;
 
+        // Only used for error messages
+        std::string mFileName;
+        std::string mBaseModel;
+
         typedef std::map<std::string, osg::ref_ptr<SceneUtil::KeyframeController>> ControllerMap;
 
+        // Created by createControllers the first time a group of the source is played. The controllers are shallow
+        // copies sharing their keyframes with the ones of the KeyframeManager, only the source of the time is per
+        // actor.
         ControllerMap mControllerMap[sNumBlendMasks];
+        bool mControllersCreated = false;
 
         const SceneUtil::TextKeyMap& getTextKeys() const;
 
@@ -679,10 +687,18 @@ namespace MWRender
         if (kfname.ends_with(".nif"))
             kfname.replace(kfname.size() - 4, 4, ".kf");
 
+        const std::size_t numAnimSources = mAnimSources.size();
+
         addSingleAnimSource(kfname, baseModel);
 
         if (Settings::game().mUseAdditionalAnimSources)
             loadAllAnimationsInFolder(kfname, baseModel);
+
+        if (mAnimSources.size() != numAnimSources)
+        {
+            SceneUtil::AssignControllerSourcesVisitor assignVisitor(mAnimationTimePtr[0]);
+            mObjectRoot->accept(assignVisitor);
+        }
     }
 
     std::shared_ptr<Animation::AnimSource> Animation::addSingleAnimSource(
@@ -698,39 +714,16 @@ namespace MWRender
             || animsrc->mKeyframes->mKeyframeControllers.empty())
             return nullptr;
 
-        const NodeMap& nodeMap = getNodeMap();
-        const auto& controllerMap = animsrc->mKeyframes->mKeyframeControllers;
-        for (SceneUtil::KeyframeHolder::KeyframeControllerMap::const_iterator it = controllerMap.begin();
-             it != controllerMap.end(); ++it)
-        {
-            std::string bonename = Misc::StringUtils::lowerCase(it->first);
-            NodeMap::const_iterator found = nodeMap.find(bonename);
-            if (found == nodeMap.end())
-            {
-                Log(Debug::Warning) << "Warning: addAnimSource: can't find bone '" + bonename << "' in " << baseModel
-                                    << " (referenced by " << kfname << ")";
-                continue;
-            }
-
-            osg::Node* node = found->second;
-
-            size_t blendMask = detectBlendMask(node, it->second->getName());
-
-            // clone the controller, because each Animation needs its own ControllerSource
-            osg::ref_ptr<SceneUtil::KeyframeController> cloned
-                = osg::clone(it->second.get(), osg::CopyOp::SHALLOW_COPY);
-            cloned->setSource(mAnimationTimePtr[blendMask]);
-
-            animsrc->mControllerMap[blendMask].insert(std::make_pair(bonename, cloned));
-        }
+        animsrc->mFileName = kfname;
+        animsrc->mBaseModel = baseModel;
 
         mAnimSources.push_back(animsrc);
 
         for (const std::string& group : mAnimSources.back()->getTextKeys().getGroups())
             mSupportedAnimations.insert(group);
 
-        SceneUtil::AssignControllerSourcesVisitor assignVisitor(mAnimationTimePtr[0]);
-        mObjectRoot->accept(assignVisitor);
+        const NodeMap& nodeMap = getNodeMap();
+        const auto& controllerMap = animsrc->mKeyframes->mKeyframeControllers;
 
         // Determine the movement accumulation bone if necessary
         if (!mAccumRoot)
@@ -789,6 +782,37 @@ namespace MWRender
         return animsrc;
     }
 
+    void Animation::createControllers(AnimSource& animsrc) const
+    {
+        if (animsrc.mControllersCreated)
+            return;
+        animsrc.mControllersCreated = true;
+
+        const NodeMap& nodeMap = getNodeMap();
+        for (const auto& [name, controller] : animsrc.mKeyframes->mKeyframeControllers)
+        {
+            std::string bonename = Misc::StringUtils::lowerCase(name);
+            NodeMap::const_iterator found = nodeMap.find(bonename);
+            if (found == nodeMap.end())
+            {
+                Log(Debug::Warning) << "Warning: createControllers: can't find bone '" + bonename << "' in "
+                                    << animsrc.mBaseModel << " (referenced by " << animsrc.mFileName << ")";
+                continue;
+            }
+
+            osg::Node* node = found->second;
+
+            size_t blendMask = detectBlendMask(node, controller->getName());
+
+            // clone the controller, because each Animation needs its own ControllerSource
+            osg::ref_ptr<SceneUtil::KeyframeController> cloned
+                = osg::clone(controller.get(), osg::CopyOp::SHALLOW_COPY);
+            cloned->setSource(mAnimationTimePtr[blendMask]);
+
+            animsrc.mControllerMap[blendMask].insert(std::make_pair(std::move(bonename), cloned));
+        }
+    }
+
     void Animation::clearAnimSources()
     {
         mStates.clear();
@@ -1161,14 +1185,15 @@ namespace MWRender
             if (active != mStates.end())
             {
                 std::shared_ptr<AnimSource> animsrc = active->second.mSource;
+                createControllers(*animsrc);
                 const AnimBlendStateData stateData
                     = { .mGroupname = active->second.mGroupname, .mStartKey = active->second.mStartKey };
 
                 for (AnimSource::ControllerMap::iterator it = animsrc->mControllerMap[blendMask].begin();
                      it != animsrc->mControllerMap[blendMask].end(); ++it)
                 {
-                    osg::ref_ptr<osg::Node> node = getNodeMap().at(
-                        it->first); // this should not throw, we already checked for the node existing in addAnimSource
+                    // this should not throw, we already checked for the node existing in createControllers
+                    osg::ref_ptr<osg::Node> node = getNodeMap().at(it->first);
 
                     const bool useSmoothAnims = Settings::game().mSmoothAnimTransitions;
 
@@ -1304,6 +1329,7 @@ namespace MWRender
         float velocity = 0.0f;
         const SceneUtil::TextKeyMap& keys = (*animsrc)->getTextKeys();
 
+        createControllers(**animsrc);
         const AnimSource::ControllerMap& ctrls = (*animsrc)->mControllerMap[0];
         for (AnimSource::ControllerMap::const_iterator it = ctrls.begin(); it != ctrls.end(); ++it)
         {
@@ -1325,6 +1351,7 @@ namespace MWRender
             {
                 const SceneUtil::TextKeyMap& keys2 = (*animiter)->getTextKeys();
 
+                createControllers(**animiter);
                 const AnimSource::ControllerMap& ctrls2 = (*animiter)->mControllerMap[0];
                 for (AnimSource::ControllerMap::const_iterator it = ctrls2.begin(); it != ctrls2.end(); ++it)
                 {
@@ -1654,6 +1681,13 @@ namespace MWRender
         // FIXME: better way to detect osgAnimation here instead of relying on extension?
         mRequiresBoneMap = mSkeleton != nullptr && !Misc::StringUtils::ciEndsWith(model, ".nif");
 
+        if (mSkeleton)
+        {
+            mSkeleton->setAnimationLod(Settings::general().mAnimationLodPixelSize,
+                static_cast<unsigned int>(Settings::general().mAnimationLodMaxInterval));
+            mSkeleton->setMorphDistance(Settings::general().mMorphAnimationDistance);
+        }
+
         if (previousStateset)
             mObjectRoot->setStateSet(previousStateset);
 
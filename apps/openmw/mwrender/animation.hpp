@@ -292,6 +292,9 @@ namespace MWRender
         void addAnimSource(std::string_view model, const std::string& baseModel);
         std::shared_ptr<AnimSource> addSingleAnimSource(const std::string& model, const std::string& baseModel);
 
+        /// Creates the controllers of the animation source for this actor unless they exist already.
+        void createControllers(AnimSource& animsrc) const;
+
         /** Adds an additional light to the given node using the specified ESM record. */
         void addExtraLight(osg::ref_ptr<osg::Group> parent, const SceneUtil::LightCommon& light);
 
@@ -1,9 +1,15 @@
 #include "groundcover.hpp"
 
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <span>
+
 #include <osg/AlphaFunc>
 #include <osg/BlendFunc>
 #include <osg/ComputeBoundsVisitor>
 #include <osg/Geometry>
+#include <osg/LOD>
 #include <osg/Program>
 #include <osg/VertexAttribDivisor>
 #include <osgUtil/CullVisitor>
@@ -46,7 +52,7 @@ namespace MWRender
         class InstancedComputeNearFarCullCallback : public osg::DrawableCullCallback
         {
         public:
-            InstancedComputeNearFarCullCallback(const std::vector<Groundcover::GroundcoverEntry>& instances,
+            InstancedComputeNearFarCullCallback(std::span<const Groundcover::GroundcoverEntry> instances,
                 const osg::Vec3& chunkPosition, const osg::BoundingBox& instanceBounds)
                 : mInstanceMatrices()
                 , mInstanceBounds(instanceBounds)
@@ -188,13 +194,16 @@ namespace MWRender
             osg::BoundingBox mInstanceBounds;
         };
 
-        class InstancingVisitor : public osg::NodeVisitor
+        // Half a cell, the instances of a chunk are split into clusters of this size culled separately
+        constexpr float clusterSize = ESM::Land::REAL_SIZE / 2.f;
+
+        // Makes a copy of a mesh ready to be drawn instanced. Its arrays are shared by the clusters of every chunk
+        // using the mesh, so their buffer objects are created once here.
+        class PrepareInstancingVisitor : public osg::NodeVisitor
         {
         public:
-            InstancingVisitor(std::vector<Groundcover::GroundcoverEntry>& instances, osg::Vec3f& chunkPosition)
+            PrepareInstancingVisitor()
                 : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
-                , mInstances(instances)
-                , mChunkPosition(chunkPosition)
             {
             }
 
@@ -212,20 +221,44 @@ namespace MWRender
 
             void apply(osg::Geometry& geom) override
             {
+                // Display lists do not support instancing in OSG 3.4
+                geom.setUseDisplayList(false);
+                geom.setUseVertexBufferObjects(true);
+            }
+        };
+
+        class InstancingVisitor : public osg::NodeVisitor
+        {
+        public:
+            InstancingVisitor(std::span<const Groundcover::GroundcoverEntry> instances,
+                const osg::Vec3f& chunkPosition, osg::Vec4Array* transforms, osg::Vec3Array* rotations)
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+                , mInstances(instances)
+                , mChunkPosition(chunkPosition)
+                , mTransforms(transforms)
+                , mRotations(rotations)
+            {
+            }
+
+            void apply(osg::Geometry& geom) override
+            {
+                // Only the first instances of the arrays are drawn when the density is reduced. The primitives are
+                // copied without their buffer object, so they need a new one.
+                osg::ref_ptr<osg::ElementBufferObject> elementBuffer = new osg::ElementBufferObject;
                 for (unsigned int i = 0; i < geom.getNumPrimitiveSets(); ++i)
                 {
-                    geom.getPrimitiveSet(i)->setNumInstances(mInstances.size());
+                    osg::PrimitiveSet* primitiveSet = geom.getPrimitiveSet(i);
+                    primitiveSet->setNumInstances(mInstances.size());
+                    if (osg::DrawElements* drawElements = primitiveSet->getDrawElements())
+                        drawElements->setElementBufferObject(elementBuffer);
                 }
 
-                osg::ref_ptr<osg::Vec4Array> transforms = new osg::Vec4Array(mInstances.size());
                 osg::BoundingBox box;
                 osg::BoundingBox originalBox = geom.getBoundingBox();
                 float radius = originalBox.radius();
-                for (unsigned int i = 0; i < transforms->getNumElements(); i++)
+                for (std::size_t i = 0; i < mInstances.size(); i++)
                 {
-                    osg::Vec3f pos(mInstances[i].mPos.asVec3());
-                    osg::Vec3f relativePos = pos - mChunkPosition;
-                    (*transforms)[i] = osg::Vec4f(relativePos, mInstances[i].mScale);
+                    osg::Vec3f relativePos = mInstances[i].mPos.asVec3() - mChunkPosition;
 
                     // Use an additional margin due to groundcover animation
                     float instanceRadius = radius * mInstances[i].mScale * 1.1f;
@@ -235,25 +268,17 @@ namespace MWRender
 
                 geom.setInitialBound(box);
 
-                osg::ref_ptr<osg::Vec3Array> rotations = new osg::Vec3Array(mInstances.size());
-                for (unsigned int i = 0; i < rotations->getNumElements(); i++)
-                {
-                    (*rotations)[i] = mInstances[i].mPos.asRotationVec3();
-                }
-
-                // Display lists do not support instancing in OSG 3.4
-                geom.setUseDisplayList(false);
-                geom.setUseVertexBufferObjects(true);
-
-                geom.setVertexAttribArray(6, transforms.get(), osg::Array::BIND_PER_VERTEX);
-                geom.setVertexAttribArray(7, rotations.get(), osg::Array::BIND_PER_VERTEX);
+                geom.setVertexAttribArray(6, mTransforms, osg::Array::BIND_PER_VERTEX);
+                geom.setVertexAttribArray(7, mRotations, osg::Array::BIND_PER_VERTEX);
 
                 geom.addCullCallback(new InstancedComputeNearFarCullCallback(mInstances, mChunkPosition, originalBox));
             }
 
         private:
-            std::vector<Groundcover::GroundcoverEntry> mInstances;
+            std::span<const Groundcover::GroundcoverEntry> mInstances;
             osg::Vec3f mChunkPosition;
+            osg::ref_ptr<osg::Vec4Array> mTransforms;
+            osg::ref_ptr<osg::Vec3Array> mRotations;
         };
 
         class DensityCalculator
@@ -340,11 +365,12 @@ namespace MWRender
         }
     }
 
-    Groundcover::Groundcover(
-        Resource::SceneManager* sceneManager, float density, float viewDistance, const MWWorld::GroundcoverStore& store)
+    Groundcover::Groundcover(Resource::SceneManager* sceneManager, float density, float viewDistance,
+        float densityLodDistance, const MWWorld::GroundcoverStore& store)
         : GenericResourceManager<GroundcoverChunkId>(nullptr, Settings::cells().mCacheExpiryDelay)
         , mSceneManager(sceneManager)
         , mDensity(density)
+        , mDensityLodDistance(densityLodDistance)
         , mStateset(new osg::StateSet)
         , mGroundcoverStore(store)
     {
@@ -367,6 +393,14 @@ namespace MWRender
 
     Groundcover::~Groundcover() {}
 
+    void Groundcover::clearCache()
+    {
+        GenericResourceManager<GroundcoverChunkId>::clearCache();
+
+        std::lock_guard<std::mutex> lock(mMeshesMutex);
+        mMeshes.clear();
+    }
+
     void Groundcover::collectInstances(InstanceMap& instances, float size, const osg::Vec2f& center)
     {
         if (mDensity <= 0.f)
@@ -428,17 +462,18 @@ namespace MWRender
         osg::Vec3f worldCenter = osg::Vec3f(center.x(), center.y(), 0) * ESM::Land::REAL_SIZE;
         for (auto& pair : instances)
         {
-            const osg::Node* temp = mSceneManager->getTemplate(pair.first);
-            osg::ref_ptr<osg::Node> node = static_cast<osg::Node*>(temp->clone(osg::CopyOp::DEEP_COPY_NODES
-                | osg::CopyOp::DEEP_COPY_DRAWABLES | osg::CopyOp::DEEP_COPY_USERDATA | osg::CopyOp::DEEP_COPY_ARRAYS
-                | osg::CopyOp::DEEP_COPY_PRIMITIVES));
+            const osg::ref_ptr<const osg::Node> mesh = getMesh(pair.first);
 
-            // Keep link to original mesh to keep it in cache
-            group->getOrCreateUserDataContainer()->addUserObject(new Resource::TemplateRef(temp));
+            std::map<std::pair<int, int>, std::vector<GroundcoverEntry>> clusters;
+            for (GroundcoverEntry& entry : pair.second)
+            {
+                const std::pair<int, int> cluster(static_cast<int>(std::floor(entry.mPos.pos[0] / clusterSize)),
+                    static_cast<int>(std::floor(entry.mPos.pos[1] / clusterSize)));
+                clusters[cluster].push_back(entry);
+            }
 
-            InstancingVisitor visitor(pair.second, worldCenter);
-            node->accept(visitor);
-            group->addChild(node);
+            for (auto& cluster : clusters)
+                group->addChild(createCluster(*mesh, cluster.second, worldCenter));
         }
 
         osg::ComputeBoundsVisitor cbv;
@@ -456,6 +491,76 @@ namespace MWRender
         return group;
     }
 
+    osg::ref_ptr<const osg::Node> Groundcover::getMesh(const std::string& model)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMeshesMutex);
+            const auto it = mMeshes.find(model);
+            if (it != mMeshes.end())
+                return it->second;
+        }
+
+        const osg::Node* temp = mSceneManager->getTemplate(model);
+        osg::ref_ptr<osg::Node> mesh = static_cast<osg::Node*>(temp->clone(osg::CopyOp::DEEP_COPY_NODES
+            | osg::CopyOp::DEEP_COPY_DRAWABLES | osg::CopyOp::DEEP_COPY_USERDATA | osg::CopyOp::DEEP_COPY_ARRAYS
+            | osg::CopyOp::DEEP_COPY_PRIMITIVES));
+        PrepareInstancingVisitor visitor;
+        mesh->accept(visitor);
+
+        std::lock_guard<std::mutex> lock(mMeshesMutex);
+        return mMeshes.emplace(model, std::move(mesh)).first->second;
+    }
+
+    osg::ref_ptr<osg::Node> Groundcover::createCluster(
+        const osg::Node& mesh, std::vector<GroundcoverEntry>& instances, const osg::Vec3f& chunkPosition)
+    {
+        // Any number of first instances is spread over the whole cluster, so the density can be reduced by drawing
+        // fewer of them
+        std::shuffle(instances.begin(), instances.end(), std::minstd_rand(static_cast<unsigned>(instances.size())));
+
+        osg::ref_ptr<osg::Vec4Array> transforms = new osg::Vec4Array(instances.size());
+        osg::ref_ptr<osg::Vec3Array> rotations = new osg::Vec3Array(instances.size());
+        for (std::size_t i = 0; i < instances.size(); ++i)
+        {
+            (*transforms)[i] = osg::Vec4f(instances[i].mPos.asVec3() - chunkPosition, instances[i].mScale);
+            (*rotations)[i] = instances[i].mPos.asRotationVec3();
+        }
+
+        // The vertex arrays are shared with the other clusters, so the instance arrays must not be added to their
+        // buffer object
+        osg::ref_ptr<osg::VertexBufferObject> instanceBuffer = new osg::VertexBufferObject;
+        transforms->setVertexBufferObject(instanceBuffer);
+        rotations->setVertexBufferObject(instanceBuffer);
+
+        const auto createLevel = [&](std::size_t numInstances) {
+            osg::ref_ptr<osg::Node> node = static_cast<osg::Node*>(mesh.clone(osg::CopyOp::DEEP_COPY_NODES
+                | osg::CopyOp::DEEP_COPY_DRAWABLES | osg::CopyOp::DEEP_COPY_USERDATA
+                | osg::CopyOp::DEEP_COPY_PRIMITIVES));
+            InstancingVisitor visitor(
+                std::span<const GroundcoverEntry>(instances).first(numInstances), chunkPosition, transforms, rotations);
+            node->accept(visitor);
+            return node;
+        };
+
+        osg::ref_ptr<osg::Node> node;
+        if (mDensityLodDistance > 0.f && instances.size() >= 4)
+        {
+            osg::ref_ptr<osg::LOD> lod = new osg::LOD;
+            lod->addChild(createLevel(instances.size()), 0.f, mDensityLodDistance);
+            lod->addChild(createLevel((instances.size() + 1) / 2), mDensityLodDistance, mDensityLodDistance * 2);
+            lod->addChild(
+                createLevel((instances.size() + 3) / 4), mDensityLodDistance * 2, std::numeric_limits<float>::max());
+            node = lod;
+        }
+        else
+            node = createLevel(instances.size());
+
+        osg::ComputeBoundsVisitor cbv;
+        node->accept(cbv);
+        node->addCullCallback(new ViewDistanceCallback(getViewDistance(), cbv.getBoundingBox()));
+        return node;
+    }
+
     unsigned int Groundcover::getNodeMask()
     {
         return Mask_Groundcover;
@@ -5,6 +5,10 @@
 #include <components/resource/scenemanager.hpp>
 #include <components/terrain/quadtreeworld.hpp>
 
+#include <map>
+#include <mutex>
+#include <string>
+
 namespace MWWorld
 {
     class ESMStore;
@@ -22,7 +26,7 @@ namespace MWRender
                         public Terrain::QuadTreeWorld::ChunkManager
     {
     public:
-        Groundcover(Resource::SceneManager* sceneManager, float density, float viewDistance,
+        Groundcover(Resource::SceneManager* sceneManager, float density, float viewDistance, float densityLodDistance,
             const MWWorld::GroundcoverStore& store);
         ~Groundcover();
 
@@ -31,6 +35,8 @@ namespace MWRender
 
         unsigned int getNodeMask() override;
 
+        void clearCache() override;
+
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
 
         struct GroundcoverEntry
@@ -48,12 +54,18 @@ namespace MWRender
     private:
         Resource::SceneManager* mSceneManager;
         float mDensity;
+        float mDensityLodDistance;
         osg::ref_ptr<osg::StateSet> mStateset;
         osg::ref_ptr<osg::Program> mProgramTemplate;
         const MWWorld::GroundcoverStore& mGroundcoverStore;
+        std::mutex mMeshesMutex;
+        std::map<std::string, osg::ref_ptr<const osg::Node>, std::less<>> mMeshes;
 
         typedef std::map<std::string, std::vector<GroundcoverEntry>> InstanceMap;
+        osg::ref_ptr<const osg::Node> getMesh(const std::string& model);
         osg::ref_ptr<osg::Node> createChunk(InstanceMap& instances, const osg::Vec2f& center);
+        osg::ref_ptr<osg::Node> createCluster(
+            const osg::Node& mesh, std::vector<GroundcoverEntry>& instances, const osg::Vec3f& chunkPosition);
         void collectInstances(InstanceMap& instances, float size, const osg::Vec2f& center);
     };
 }
@@ -8,9 +8,11 @@
 #include <osg/MatrixTransform>
 #include <osg/Sequence>
 #include <osg/Switch>
+#include <osg/VertexAttribDivisor>
 #include <osgAnimation/BasicAnimationManager>
 #include <osgParticle/ParticleProcessor>
 #include <osgParticle/ParticleSystemUpdater>
+#include <osgUtil/CullVisitor>
 #include <osgUtil/IncrementalCompileOperation>
 
 #include <components/esm3/esmreader.hpp>
@@ -25,12 +27,14 @@
 #include <components/resource/scenemanager.hpp>
 #include <components/sceneutil/lightmanager.hpp>
 #include <components/sceneutil/morphgeometry.hpp>
+#include <components/sceneutil/occlusionculling.hpp>
 #include <components/sceneutil/optimizer.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/riggeometryosgaextension.hpp>
 #include <components/sceneutil/util.hpp>
 #include <components/settings/values.hpp>
+#include <components/shader/shadermanager.hpp>
 #include <components/vfs/manager.hpp>
 
 #include "apps/openmw/mwbase/environment.hpp"
@@ -333,6 +337,9 @@ namespace MWRender
             {
                 StateSetCounter mStateSetCounter;
                 unsigned int mNumVerts = 0;
+                // Each instance is positioned by a translation, a rotation and a uniform scale in the shader
+                // so the node must look the same regardless of the view and the placement
+                bool mInstanceable = true;
             };
 
             void apply(osg::Node& node) override
@@ -340,6 +347,12 @@ namespace MWRender
                 if (node.getStateSet())
                     mCurrentStateSet = node.getStateSet();
 
+                if (node.getCullCallback() || node.getUserValue("shaderPrefix", mShaderPrefix))
+                    mResult.mInstanceable = false;
+
+                if (const osg::Transform* transform = node.asTransform(); transform && !isSimilarity(*transform))
+                    mResult.mInstanceable = false;
+
                 if (osg::Switch* sw = node.asSwitch())
                 {
                     for (unsigned int i = 0; i < sw->getNumChildren(); ++i)
@@ -349,6 +362,8 @@ namespace MWRender
                 }
                 if (osg::LOD* lod = dynamic_cast<osg::LOD*>(&node))
                 {
+                    // The selected children depend on the scale of each instance
+                    mResult.mInstanceable = false;
                     for (unsigned int i = 0; i < lod->getNumChildren(); ++i)
                         if (const auto r = intersection(lod->getRangeList()[i], mDistances); !empty(r))
                             traverse(*lod->getChild(i));
@@ -367,6 +382,9 @@ namespace MWRender
                 if (osg::Array* array = geom.getVertexArray())
                     mResult.mNumVerts += array->getNumElements();
 
+                if (geom.getCullCallback() || geom.getUserValue("shaderPrefix", mShaderPrefix))
+                    mResult.mInstanceable = false;
+
                 ++mResult.mStateSetCounter[mCurrentStateSet];
                 ++mGlobalStateSetCounter[mCurrentStateSet];
             }
@@ -399,6 +417,23 @@ namespace MWRender
             osg::StateSet* mCurrentStateSet;
             StateSetCounter mGlobalStateSetCounter;
             LODRange mDistances = { 0.f, 0.f };
+
+        private:
+            std::string mShaderPrefix;
+
+            bool isSimilarity(const osg::Transform& transform)
+            {
+                osg::Matrix matrix;
+                transform.computeLocalToWorldMatrix(matrix, this);
+                osg::Vec3f translation;
+                osg::Quat rotation;
+                osg::Vec3f scale;
+                osg::Quat scaleOrientation;
+                matrix.decompose(translation, rotation, scale, scaleOrientation);
+                constexpr float epsilon = 1e-3f;
+                return scale.x() > 0 && std::abs(scale.y() - scale.x()) <= epsilon * scale.x()
+                    && std::abs(scale.z() - scale.x()) <= epsilon * scale.x();
+            }
         };
 
         class DebugVisitor : public osg::NodeVisitor
@@ -447,6 +482,131 @@ namespace MWRender
                 node.getOrCreateUserDataContainer()->addUserObject(marker);
             }
         };
+
+        // From OSG's CullVisitor.cpp
+        inline osgUtil::CullVisitor::value_type distance(const osg::Vec3& coord, const osg::Matrix& matrix)
+        {
+            using value_type = osgUtil::CullVisitor::value_type;
+            return -((value_type)coord[0] * (value_type)matrix(0, 2) + (value_type)coord[1] * (value_type)matrix(1, 2)
+                + (value_type)coord[2] * (value_type)matrix(2, 2) + matrix(3, 2));
+        }
+
+        // The instances are positioned in the vertex shader, so the near and far planes computed from the primitives
+        // would not cover them. Use the bounding box of all instances instead.
+        class InstancedComputeNearFarCullCallback : public osg::DrawableCullCallback
+        {
+        public:
+            bool cull(osg::NodeVisitor* nv, osg::Drawable* drawable, osg::RenderInfo* /*renderInfo*/) const override
+            {
+                osgUtil::CullVisitor& cullVisitor = *nv->asCullVisitor();
+                const osg::CullSettings::ComputeNearFarMode cnfMode = cullVisitor.getComputeNearFarMode();
+                if (cnfMode != osg::CullSettings::COMPUTE_NEAR_FAR_USING_PRIMITIVES
+                    && cnfMode != osg::CullSettings::COMPUTE_NEAR_USING_PRIMITIVES)
+                    return false;
+
+                const osg::BoundingBox& boundingBox = drawable->getBoundingBox();
+                if (drawable->isCullingActive() && cullVisitor.isCulled(boundingBox))
+                    return true;
+
+                const osg::Matrix& matrix = *cullVisitor.getModelViewMatrix();
+                osgUtil::CullVisitor::value_type dNear = distance(boundingBox.corner(0), matrix);
+                osgUtil::CullVisitor::value_type dFar = dNear;
+                for (unsigned int i = 1; i < 8; ++i)
+                {
+                    const osgUtil::CullVisitor::value_type d = distance(boundingBox.corner(i), matrix);
+                    dNear = std::min(dNear, d);
+                    dFar = std::max(dFar, d);
+                }
+
+                if (dFar < 0)
+                    return true;
+
+                // CullVisitor doesn't look at the primitives when the bounding box is within the computed planes
+                if (dNear < cullVisitor.getCalculatedNearPlane())
+                    cullVisitor.setCalculatedNearPlane(dNear);
+                if (dFar > cullVisitor.getCalculatedFarPlane())
+                    cullVisitor.setCalculatedFarPlane(dFar);
+
+                return false;
+            }
+        };
+
+        class InstancingVisitor : public osg::NodeVisitor
+        {
+        public:
+            explicit InstancingVisitor(const std::vector<osg::Matrix>& instances)
+                : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+                , mInstances(instances)
+                , mMatrices(1, osg::Matrix::identity())
+            {
+            }
+
+            void apply(osg::Transform& transform) override
+            {
+                osg::Matrix matrix = mMatrices.back();
+                transform.computeLocalToWorldMatrix(matrix, this);
+                mMatrices.push_back(matrix);
+                traverse(transform);
+                mMatrices.pop_back();
+                mTransforms.emplace_back(&transform);
+            }
+
+            void apply(osg::Geometry& geom) override
+            {
+                const osg::BoundingBox originalBox = geom.getBoundingBox();
+                osg::ref_ptr<osg::Vec4Array> offsets = new osg::Vec4Array(mInstances.size());
+                osg::ref_ptr<osg::Vec4Array> rotations = new osg::Vec4Array(mInstances.size());
+                osg::BoundingBox box;
+                for (std::size_t i = 0; i < mInstances.size(); ++i)
+                {
+                    const osg::Matrix matrix = mMatrices.back() * mInstances[i];
+                    osg::Vec3f translation;
+                    osg::Quat rotation;
+                    osg::Vec3f scale;
+                    osg::Quat scaleOrientation;
+                    matrix.decompose(translation, rotation, scale, scaleOrientation);
+                    (*offsets)[i] = osg::Vec4f(translation, scale.x());
+                    (*rotations)[i] = rotation.asVec4();
+                    for (unsigned int corner = 0; corner < 8; ++corner)
+                        box.expandBy(originalBox.corner(corner) * matrix);
+                }
+
+                // The vertices are not where they are drawn, so don't let them extend the bounds
+                geom.setInitialBound(box);
+                geom.setComputeBoundingBoxCallback(new osg::Drawable::ComputeBoundingBoxCallback);
+
+                // Arrays and primitive sets are deep copied so none of their buffer objects are shared with
+                // the template. Display lists do not support instancing in OSG 3.4
+                geom.setUseDisplayList(false);
+                geom.setUseVertexBufferObjects(true);
+
+                geom.setVertexAttribArray(6, offsets, osg::Array::BIND_PER_VERTEX);
+                geom.setVertexAttribArray(7, rotations, osg::Array::BIND_PER_VERTEX);
+
+                for (unsigned int i = 0; i < geom.getNumPrimitiveSets(); ++i)
+                    geom.getPrimitiveSet(i)->setNumInstances(mInstances.size());
+
+                geom.addCullCallback(new InstancedComputeNearFarCullCallback);
+            }
+
+            /// Replace the transforms by groups as their transformations are baked into the instance attributes.
+            void removeTransforms()
+            {
+                for (const osg::ref_ptr<osg::Transform>& transform : mTransforms)
+                {
+                    osg::ref_ptr<osg::Group> group = new osg::Group(*transform, osg::CopyOp::SHALLOW_COPY);
+                    const osg::Node::ParentList parents = transform->getParents();
+                    for (osg::Group* parent : parents)
+                        parent->replaceChild(transform, group);
+                }
+                mTransforms.clear();
+            }
+
+        private:
+            const std::vector<osg::Matrix>& mInstances;
+            std::vector<osg::Matrix> mMatrices;
+            std::vector<osg::ref_ptr<osg::Transform>> mTransforms;
+        };
     }
 
     ObjectPaging::ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace)
@@ -459,10 +619,28 @@ namespace MWRender
         , mMinSize(Settings::terrain().mObjectPagingMinSize)
         , mMinSizeMergeFactor(Settings::terrain().mObjectPagingMinSizeMergeFactor)
         , mMinSizeCostMultiplier(Settings::terrain().mObjectPagingMinSizeCostMultiplier)
+        , mInstancing(Settings::terrain().mObjectPagingInstancing)
+        , mOcclusionCulling(Settings::camera().mOcclusionCulling)
         , mRefTrackerLocked(false)
     {
+        if (mInstancing)
+        {
+            mInstancingStateSet = new osg::StateSet;
+            mInstancingStateSet->setAttribute(new osg::VertexAttribDivisor(6, 1));
+            mInstancingStateSet->setAttribute(new osg::VertexAttribDivisor(7, 1));
+            // Tells the shadow casting shader to apply the instance attributes
+            mInstancingStateSet->addUniform(new osg::Uniform("useInstancing", true));
+
+            mInstancingProgramTemplate = mSceneManager->getShaderManager().getProgramTemplate()
+                ? Shader::ShaderManager::cloneProgram(mSceneManager->getShaderManager().getProgramTemplate())
+                : osg::ref_ptr<osg::Program>(new osg::Program);
+            mInstancingProgramTemplate->addBindAttribLocation("aInstanceOffset", 6);
+            mInstancingProgramTemplate->addBindAttribLocation("aInstanceRotation", 7);
+        }
     }
 
+    ObjectPaging::~ObjectPaging() = default;
+
     namespace
     {
         struct PagedCellRef
@@ -717,10 +895,12 @@ namespace MWRender
         const osg::Vec3f worldCenter = osg::Vec3f(center.x(), center.y(), 0) * getCellSize(mWorldspace);
         osg::ref_ptr<osg::Group> group = new osg::Group;
         osg::ref_ptr<osg::Group> mergeGroup = new osg::Group;
+        osg::ref_ptr<osg::Group> instancedGroup = new osg::Group;
         osg::ref_ptr<Resource::TemplateMultiRef> templateRefs = new Resource::TemplateMultiRef;
         osgUtil::StateToCompile stateToCompile(0, nullptr);
         CopyOp copyop;
         copyop.mCopyMask = copyMask;
+        std::vector<osg::Matrix> instanceMatrices;
         for (const auto& pair : nodes)
         {
             const osg::Node* cnode = pair.first;
@@ -731,11 +911,17 @@ namespace MWRender
             const float mergeBenefit = analyzeVisitor.getMergeBenefit(analyzeResult) * mMergeFactor;
             const bool merge = mergeBenefit > mergeCost;
 
+            // Draw a single copy of the geometry for all instances instead of merging a copy per instance.
+            // Active grid chunks need the geometry of each instance to find the reference under the cursor.
+            const bool instance = mInstancing && !activeGrid && analyzeResult.mInstanceable
+                && pair.second.mInstances.size() > 1;
+
             const float factor2
                 = mergeBenefit > 0 ? std::min(1.f, mergeCost * mMinSizeCostMultiplier / mergeBenefit) : 1;
             const float minSizeMergeFactor2 = (1 - factor2) * mMinSizeMergeFactor + factor2;
             const float minSizeMerged = minSizeMergeFactor2 > 0 ? mMinSize * minSizeMergeFactor2 : mMinSize;
 
+            instanceMatrices.clear();
             unsigned int numinstances = 0;
             for (const PagedCellRef* refPtr : pair.second.mInstances)
             {
@@ -752,6 +938,17 @@ namespace MWRender
                     * osg::Quat(ref.mRotation.x(), osg::Vec3f(-1, 0, 0));
                 const osg::Vec3f nodeScale(ref.mScale, ref.mScale, ref.mScale);
 
+                if (instance)
+                {
+                    osg::Matrix matrix;
+                    matrix.preMultTranslate(nodePos);
+                    matrix.preMultRotate(nodeAttitude);
+                    matrix.preMultScale(nodeScale);
+                    instanceMatrices.push_back(matrix);
+                    ++numinstances;
+                    continue;
+                }
+
                 osg::ref_ptr<osg::Group> trans;
                 if (merge)
                 {
@@ -813,7 +1010,23 @@ namespace MWRender
                 // in addition, we hint to the cache that it's still being used and should be kept in cache
                 templateRefs->addRef(cnode);
 
-                if (pair.second.mNeedCompile)
+                if (instance)
+                {
+                    // Own copies of the arrays and primitive sets are needed to draw them instanced
+                    copyop.setCopyFlags(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES
+                        | osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES);
+                    copyop.mOptimizeBillboards = false;
+                    copyop.mDistances = LODRange{ smallestDistanceToChunk, higherDistanceToChunk };
+                    osg::ref_ptr<osg::Group> copy = new osg::Group;
+                    copyop.copy(cnode, copy);
+
+                    InstancingVisitor visitor(instanceMatrices);
+                    copy->accept(visitor);
+                    visitor.removeTransforms();
+
+                    instancedGroup->addChild(copy);
+                }
+                else if (pair.second.mNeedCompile)
                 {
                     int mode = osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES;
                     if (!merge)
@@ -854,6 +1067,27 @@ namespace MWRender
             }
         }
 
+        if (instancedGroup->getNumChildren())
+        {
+            instancedGroup->setStateSet(mInstancingStateSet);
+            instancedGroup->setUserValue("instancing", true);
+            mSceneManager->recreateShaders(instancedGroup, "objects", true, mInstancingProgramTemplate);
+
+            group->addChild(instancedGroup);
+
+            if (mDebugBatches)
+            {
+                DebugVisitor dv;
+                instancedGroup->accept(dv);
+            }
+            if (compile)
+            {
+                stateToCompile._mode = osgUtil::GLObjectsVisitor::COMPILE_STATE_ATTRIBUTES
+                    | osgUtil::GLObjectsVisitor::COMPILE_DISPLAY_LISTS;
+                instancedGroup->accept(stateToCompile);
+            }
+        }
+
         osgUtil::IncrementalCompileOperation* const ico = mSceneManager->getIncrementalCompileOperation();
         if (!stateToCompile.empty() && ico)
         {
@@ -864,6 +1098,8 @@ namespace MWRender
 
         group->getBound();
         group->setNodeMask(Mask_Static);
+        if (mOcclusionCulling)
+            group->addCullCallback(new SceneUtil::OcclusionCullCallback);
         osg::UserDataContainer* udc = group->getOrCreateUserDataContainer();
         if (activeGrid)
         {
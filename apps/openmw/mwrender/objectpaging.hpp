@@ -12,6 +12,12 @@ namespace Resource
     class SceneManager;
 }
 
+namespace osg
+{
+    class Program;
+    class StateSet;
+}
+
 namespace MWRender
 {
 
@@ -21,7 +27,7 @@ namespace MWRender
     {
     public:
         ObjectPaging(Resource::SceneManager* sceneManager, ESM::RefId worldspace);
-        ~ObjectPaging() = default;
+        ~ObjectPaging();
 
         osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags,
             bool activeGrid, const osg::Vec3f& viewPoint, bool compile) override;
@@ -55,6 +61,10 @@ namespace MWRender
         float mMinSize;
         float mMinSizeMergeFactor;
         float mMinSizeCostMultiplier;
+        bool mInstancing;
+        osg::ref_ptr<osg::StateSet> mInstancingStateSet;
+        osg::ref_ptr<osg::Program> mInstancingProgramTemplate;
+        bool mOcclusionCulling;
 
         std::mutex mRefTrackerMutex;
         struct RefTracker
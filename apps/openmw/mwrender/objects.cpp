@@ -5,8 +5,10 @@
 
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/strings/algorithm.hpp>
+#include <components/sceneutil/occlusionculling.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/settings/values.hpp>
 
 #include "../mwworld/class.hpp"
 #include "../mwworld/ptr.hpp"
@@ -19,12 +21,19 @@
 
 namespace MWRender
 {
+    namespace
+    {
+        // Smaller statics hide too little to be worth drawing into the occlusion buffer
+        constexpr float minOccluderRadius = 512;
+        constexpr std::size_t maxOccluderTriangles = 4096;
+    }
 
     Objects::Objects(Resource::ResourceSystem* resourceSystem, const osg::ref_ptr<osg::Group>& rootNode,
         SceneUtil::UnrefQueue& unrefQueue)
         : mRootNode(rootNode)
         , mResourceSystem(resourceSystem)
         , mUnrefQueue(unrefQueue)
+        , mOcclusionCulling(Settings::camera().mOcclusionCulling)
     {
     }
 
@@ -87,9 +96,36 @@ namespace MWRender
         osg::ref_ptr<ObjectAnimation> anim(
             new ObjectAnimation(ptr, animationMesh, mResourceSystem, animated, allowLight));
 
+        if (mOcclusionCulling)
+            ptr.getRefData().getBaseNode()->addCullCallback(
+                new SceneUtil::OcclusionCullCallback(getOccluder(ptr, mesh, *anim)));
+
         mObjects.emplace(ptr.mRef, std::move(anim));
     }
 
+    osg::ref_ptr<const SceneUtil::OccluderMesh> Objects::getOccluder(
+        const MWWorld::Ptr& ptr, const std::string& model, Animation& animation)
+    {
+        // Other objects move or are too small
+        if (ptr.getType() != ESM::REC_STAT || model.empty())
+            return nullptr;
+
+        const auto it = mOccluders.find(model);
+        if (it != mOccluders.end())
+            return it->second;
+
+        osg::ref_ptr<const SceneUtil::OccluderMesh> occluder;
+        if (osg::Group* objectRoot = animation.getObjectRoot())
+        {
+            osg::ref_ptr<SceneUtil::OccluderMesh> mesh = SceneUtil::createOccluderMesh(*objectRoot);
+            if (mesh != nullptr && mesh->mBound.radius() >= minOccluderRadius
+                && mesh->mIndices.size() / 3 <= maxOccluderTriangles)
+                occluder = mesh;
+        }
+        mOccluders.emplace(model, occluder);
+        return occluder;
+    }
+
     void Objects::insertCreature(const MWWorld::Ptr& ptr, const std::string& mesh, bool weaponsShields)
     {
         insertBegin(ptr);
@@ -27,6 +27,7 @@ namespace MWWorld
 namespace SceneUtil
 {
     class UnrefQueue;
+    struct OccluderMesh;
 }
 
 namespace MWRender
@@ -64,9 +65,14 @@ namespace MWRender
         osg::ref_ptr<osg::Group> mRootNode;
         Resource::ResourceSystem* mResourceSystem;
         SceneUtil::UnrefQueue& mUnrefQueue;
+        const bool mOcclusionCulling;
+        std::map<std::string, osg::ref_ptr<const SceneUtil::OccluderMesh>, std::less<>> mOccluders;
 
         void insertBegin(const MWWorld::Ptr& ptr);
 
+        osg::ref_ptr<const SceneUtil::OccluderMesh> getOccluder(
+            const MWWorld::Ptr& ptr, const std::string& model, Animation& animation);
+
     public:
         Objects(Resource::ResourceSystem* resourceSystem, const osg::ref_ptr<osg::Group>& rootNode,
             SceneUtil::UnrefQueue& unrefQueue);
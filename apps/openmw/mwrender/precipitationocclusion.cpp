@@ -3,12 +3,15 @@
 #include <cassert>
 
 #include <osgUtil/CullVisitor>
+#include <osgUtil/RenderBin>
+#include <osgUtil/StateGraph>
 
 #include <components/misc/constants.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/sceneutil/depth.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/util.hpp>
 #include <components/settings/values.hpp>
 #include <components/shader/shadermanager.hpp>
@@ -19,6 +22,47 @@
 
 namespace
 {
+    constexpr char sDepthBinName[] = "PrecipitationOcclusionDepth";
+
+    // Draws the geometry skinned in the shaders with a depth program skinning the vertices
+    class DepthBin : public osgUtil::RenderBin
+    {
+    public:
+        META_Object(MWRender, DepthBin)
+        DepthBin() = default;
+        explicit DepthBin(osg::ref_ptr<osg::Program> skinningProgram)
+            : mSkinningStateSet(new osg::StateSet)
+        {
+            mSkinningStateSet->setAttributeAndModes(std::move(skinningProgram),
+                osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE | osg::StateAttribute::PROTECTED);
+        }
+        DepthBin(const DepthBin& rhs, const osg::CopyOp& copyop)
+            : osgUtil::RenderBin(rhs, copyop)
+            , mSkinningStateSet(rhs.mSkinningStateSet)
+        {
+        }
+
+        void sortImplementation() override
+        {
+            // The bone matrices are set on the state of the geometry skinned in the shaders
+            for (osgUtil::StateGraph*& graph : _stateGraphList)
+            {
+                const osg::StateSet* ss = graph->getStateSet();
+                if (ss == nullptr || ss->getUniform("boneMatrices") == nullptr)
+                    continue;
+                osgUtil::StateGraph* skinningGraph = graph->find_or_insert(mSkinningStateSet);
+                skinningGraph->_leaves = std::move(graph->_leaves);
+                for (osgUtil::RenderLeaf* leaf : skinningGraph->_leaves)
+                    leaf->_parent = skinningGraph;
+                graph = skinningGraph;
+            }
+            osgUtil::RenderBin::sortImplementation();
+        }
+
+    private:
+        osg::ref_ptr<osg::StateSet> mSkinningStateSet;
+    };
+
     class PrecipitationOcclusionUpdater : public SceneUtil::StateSetUpdater
     {
     public:
@@ -57,7 +101,10 @@ namespace
 
             Shader::ShaderManager& shaderMgr
                 = MWBase::Environment::get().getResourceSystem()->getSceneManager()->getShaderManager();
-            mProgram = shaderMgr.getProgram("depthclipped");
+            mProgram = shaderMgr.getProgram("depthclipped", { { "skinning", "0" } });
+            osgUtil::RenderBin::addRenderBinPrototype(sDepthBinName,
+                new DepthBin(shaderMgr.getProgram("depthclipped", { { "skinning", "1" } },
+                    SceneUtil::RigGeometry::makeSkinningProgramTemplate(shaderMgr.getProgramTemplate()))));
         }
 
     private:
@@ -67,7 +114,7 @@ namespace
             stateset->setAttributeAndModes(mProgram, osg::StateAttribute::ON | osg::StateAttribute::OVERRIDE);
             stateset->setTextureAttributeAndModes(0, mDummyTexture);
             stateset->setRenderBinDetails(
-                osg::StateSet::OPAQUE_BIN, "RenderBin", osg::StateSet::OVERRIDE_PROTECTED_RENDERBIN_DETAILS);
+                osg::StateSet::OPAQUE_BIN, sDepthBinName, osg::StateSet::OVERRIDE_PROTECTED_RENDERBIN_DETAILS);
         }
         void apply(osg::StateSet* stateset, osg::NodeVisitor* nv) override
         {
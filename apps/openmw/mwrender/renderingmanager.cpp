@@ -36,9 +36,11 @@
 #include <components/sceneutil/cullsafeboundsvisitor.hpp>
 #include <components/sceneutil/depth.hpp>
 #include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/occlusionculling.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/rtt.hpp>
 #include <components/sceneutil/shadow.hpp>
+#include <components/sceneutil/skinning.hpp>
 #include <components/sceneutil/statesetupdater.hpp>
 #include <components/sceneutil/visitor.hpp>
 #include <components/sceneutil/workqueue.hpp>
@@ -175,6 +177,8 @@ namespace MWRender
             stateset->addUniform(new osg::Uniform("windSpeed", 0.0f));
             stateset->addUniform(new osg::Uniform("playerPos", osg::Vec3f(0.f, 0.f, 0.f)));
             stateset->addUniform(new osg::Uniform("useTreeAnim", false));
+            // Only the instanced object paging chunks turn it on, a popped uniform doesn't go back to its default
+            stateset->addUniform(new osg::Uniform("useInstancing", false));
         }
 
         void apply(osg::StateSet* stateset, osg::NodeVisitor* nv) override
@@ -409,6 +413,8 @@ namespace MWRender
         sceneRoot->setStartLight(1);
         sceneRoot->setNodeMask(Mask_Scene);
         sceneRoot->setName("Scene Root");
+        if (Settings::camera().mOcclusionCulling)
+            sceneRoot->addCullCallback(new SceneUtil::OcclusionCulling(Settings::camera().mOcclusionBufferWidth));
 
         int shadowCastingTraversalMask = Mask_Scene;
         if (Settings::shadows().mActorShadows)
@@ -423,8 +429,8 @@ namespace MWRender
             shadowCastingTraversalMask |= Mask_Terrain;
 
         mShadowManager = std::make_unique<SceneUtil::ShadowManager>(sceneRoot, mRootNode, shadowCastingTraversalMask,
-            indoorShadowCastingTraversalMask, Mask_Terrain | Mask_Object | Mask_Static, Settings::shadows(),
-            mResourceSystem->getSceneManager()->getShaderManager());
+            indoorShadowCastingTraversalMask, Mask_Terrain | Mask_Object | Mask_Static, Mask_Terrain | Mask_Static,
+            Settings::shadows(), mResourceSystem->getSceneManager()->getShaderManager());
 
         Shader::ShaderManager::DefineMap shadowDefines = mShadowManager->getShadowDefines(Settings::shadows());
         Shader::ShaderManager::DefineMap lightDefines = sceneRoot->getLightDefines();
@@ -473,7 +479,10 @@ namespace MWRender
         if (getenv("OPENMW_DONT_PRECOMPILE") == nullptr)
         {
             mViewer->setIncrementalCompileOperation(new osgUtil::IncrementalCompileOperation);
-            mViewer->getIncrementalCompileOperation()->setTargetFrameRate(Settings::cells().mTargetFramerate);
+            osgUtil::IncrementalCompileOperation& ico = *mViewer->getIncrementalCompileOperation();
+            ico.setTargetFrameRate(Settings::cells().mTargetFramerate);
+            ico.setMinimumTimeAvailableForGLCompileAndDeletePerFrame(Settings::cells().mCompileTimeBudget / 1000.0);
+            ico.setMaximumNumOfObjectsToCompilePerFrame(Settings::cells().mCompileMaxObjects);
         }
 
         mDebugDraw = new Debug::DebugDrawer(mResourceSystem->getSceneManager()->getShaderManager());
@@ -507,6 +516,9 @@ namespace MWRender
         mPerViewUniformStateUpdater = new PerViewUniformStateUpdater(mResourceSystem->getSceneManager());
         rootNode->addCullCallback(mPerViewUniformStateUpdater);
 
+        if (Settings::general().mSkinningThreads > 0)
+            rootNode->addCullCallback(new SceneUtil::ParallelSkinning(Settings::general().mSkinningThreads));
+
         mPostProcessor = new PostProcessor(*this, viewer, mRootNode, resourceSystem->getVFS());
         resourceSystem->getSceneManager()->setOpaqueDepthTex(
             mPostProcessor->getTexture(PostProcessor::Tex_OpaqueDepth, 0),
@@ -514,6 +526,7 @@ namespace MWRender
         resourceSystem->getSceneManager()->setSoftParticles(Settings::shaders().mSoftParticles);
         resourceSystem->getSceneManager()->setSupportsNormalsRT(mPostProcessor->getSupportsNormalsRT());
         resourceSystem->getSceneManager()->setWeatherParticleOcclusion(Settings::shaders().mWeatherParticleOcclusion);
+        resourceSystem->getSceneManager()->setGpuSkinning(Settings::shaders().mGpuSkinning);
 
         // water goes after terrain for correct waterculling order
         mWater = std::make_unique<Water>(
@@ -782,6 +795,8 @@ namespace MWRender
             enableTerrain(true, store->getCell()->getWorldSpace());
             mTerrain->loadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
         }
+
+        mShadowManager->invalidateStaticShadowCasters();
     }
     void RenderingManager::removeCell(const MWWorld::CellStore* store)
     {
@@ -796,6 +811,8 @@ namespace MWRender
         }
 
         mWater->removeCell(store);
+
+        mShadowManager->invalidateStaticShadowCasters();
     }
 
     void RenderingManager::enableTerrain(bool enable, ESM::RefId worldspace)
@@ -974,16 +991,19 @@ namespace MWRender
         }
 
         ptr.getRefData().getBaseNode()->setAttitude(rot);
+        invalidateStaticShadows(ptr);
     }
 
     void RenderingManager::moveObject(const MWWorld::Ptr& ptr, const osg::Vec3f& pos)
     {
         ptr.getRefData().getBaseNode()->setPosition(pos);
+        invalidateStaticShadows(ptr);
     }
 
     void RenderingManager::scaleObject(const MWWorld::Ptr& ptr, const osg::Vec3f& scale)
     {
         ptr.getRefData().getBaseNode()->setScale(scale);
+        invalidateStaticShadows(ptr);
 
         if (ptr == mCamera->getTrackingPtr()) // update height of camera
             mCamera->processViewChange();
@@ -991,11 +1011,19 @@ namespace MWRender
 
     void RenderingManager::removeObject(const MWWorld::Ptr& ptr)
     {
+        invalidateStaticShadows(ptr);
         mActorsPaths->remove(ptr);
         mObjects->removeObject(ptr);
         mWater->removeEmitter(ptr);
     }
 
+    void RenderingManager::invalidateStaticShadows(const MWWorld::Ptr& ptr)
+    {
+        const SceneUtil::PositionAttitudeTransform* node = ptr.getRefData().getBaseNode();
+        if (node != nullptr && node->getNodeMask() == Mask_Static)
+            mShadowManager->invalidateStaticShadowCasters();
+    }
+
     void RenderingManager::setWaterEnabled(bool enabled)
     {
         mWater->setEnabled(enabled);
@@ -1473,6 +1501,7 @@ namespace MWRender
             auto quadTreeWorld = std::make_unique<Terrain::QuadTreeWorld>(mSceneRoot, mRootNode, mResourceSystem,
                 mTerrainStorage.get(), Mask_Terrain, Mask_PreCompile, Mask_Debug, compMapResolution, compMapLevel,
                 lodFactor, vertexLodMod, maxCompGeometrySize, debugChunks, worldspace, expiryDelay);
+            quadTreeWorld->setViewUpdateThreads(Settings::terrain().mViewUpdateThreads);
             if (Settings::terrain().mObjectPaging)
             {
                 newChunkMgr.mObjectPaging
@@ -1484,9 +1513,10 @@ namespace MWRender
             {
                 const float groundcoverDistance = Settings::groundcover().mRenderingDistance;
                 const float density = Settings::groundcover().mDensity;
+                const float densityLodDistance = Settings::groundcover().mDensityLodDistance;
 
-                newChunkMgr.mGroundcover = std::make_unique<Groundcover>(
-                    mResourceSystem->getSceneManager(), density, groundcoverDistance, mGroundCoverStore);
+                newChunkMgr.mGroundcover = std::make_unique<Groundcover>(mResourceSystem->getSceneManager(), density,
+                    groundcoverDistance, densityLodDistance, mGroundCoverStore);
                 quadTreeWorld->addChunkManager(newChunkMgr.mGroundcover.get());
                 mResourceSystem->addResourceManager(newChunkMgr.mGroundcover.get());
             }
@@ -1497,6 +1527,7 @@ namespace MWRender
                 mTerrainStorage.get(), Mask_Terrain, worldspace, expiryDelay, Mask_PreCompile, Mask_Debug);
 
         newChunkMgr.mTerrain->setTargetFrameRate(Settings::cells().mTargetFramerate);
+        newChunkMgr.mTerrain->setCreateOccluders(Settings::camera().mOcclusionCulling);
         float distanceMult = std::cos(osg::DegreesToRadians(std::min(mFieldOfView, 140.f)) / 2.f);
         newChunkMgr.mTerrain->setViewDistance(mViewDistance * (distanceMult ? 1.f / distanceMult : 1.f));
 
@@ -1790,6 +1821,7 @@ namespace MWRender
                 osg::Vec2i(ptr.getCell()->getCell()->getGridX(), ptr.getCell()->getCell()->getGridY()), enabled))
         {
             mTerrain->rebuildViews();
+            mShadowManager->invalidateStaticShadowCasters();
             return true;
         }
         return false;
@@ -1803,13 +1835,17 @@ namespace MWRender
             return;
         if (mObjectPaging->blacklistObject(type, refnum, ptr.getCellRef().getPosition().asVec3(),
                 osg::Vec2i(ptr.getCell()->getCell()->getGridX(), ptr.getCell()->getCell()->getGridY())))
+        {
             mTerrain->rebuildViews();
+            mShadowManager->invalidateStaticShadowCasters();
+        }
     }
     bool RenderingManager::pagingUnlockCache()
     {
         if (mObjectPaging && mObjectPaging->unlockCache())
         {
             mTerrain->rebuildViews();
+            mShadowManager->invalidateStaticShadowCasters();
             return true;
         }
         return false;
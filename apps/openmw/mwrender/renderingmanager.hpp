@@ -282,6 +282,7 @@ namespace MWRender
         void updateAmbient();
         void setFogColor(const osg::Vec4f& color);
         void updateThirdPersonViewMode();
+        void invalidateStaticShadows(const MWWorld::Ptr& ptr);
 
         struct WorldspaceChunkMgr
         {
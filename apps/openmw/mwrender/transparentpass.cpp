@@ -9,6 +9,7 @@
 #include <osgUtil/RenderStage>
 
 #include <components/sceneutil/depth.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 #include <components/shader/shadermanager.hpp>
 #include <components/stereo/multiview.hpp>
 #include <components/stereo/stereomanager.hpp>
@@ -36,6 +37,7 @@ namespace MWRender
 
         Shader::ShaderManager::DefineMap defines;
         Stereo::shaderStereoDefines(defines);
+        defines["skinning"] = "0";
 
         mStateSet->setAttributeAndModes(new osg::BlendFunc, modeOff);
         mStateSet->setAttributeAndModes(shaderManager.getProgram("depthclipped", defines), modeOn);
@@ -43,6 +45,13 @@ namespace MWRender
 
         for (unsigned int unit = 1; unit < 8; ++unit)
             mStateSet->setTextureMode(unit, GL_TEXTURE_2D, modeOff);
+
+        defines["skinning"] = "1";
+        mSkinningStateSet = new osg::StateSet(*mStateSet, osg::CopyOp::SHALLOW_COPY);
+        mSkinningStateSet->setAttributeAndModes(shaderManager.getProgram("depthclipped", defines,
+                                                    SceneUtil::RigGeometry::makeSkinningProgramTemplate(
+                                                        shaderManager.getProgramTemplate())),
+            modeOn);
     }
 
     void TransparentDepthBinCallback::drawImplementation(
@@ -115,6 +124,7 @@ namespace MWRender
         unsigned int insertStateSetPosition = state.getStateSetStackSize() - numToPop;
 
         state.insertStateSet(insertStateSetPosition, mStateSet);
+        bool skinning = false;
         for (auto rit = bin->getRenderLeafList().begin(); rit != bin->getRenderLeafList().end(); rit++)
         {
             osgUtil::RenderLeaf* rl = *rit;
@@ -131,6 +141,14 @@ namespace MWRender
                     continue;
             }
 
+            // The bone matrices are set on the state of the geometry skinned in the shaders
+            if ((ss->getUniform("boneMatrices") != nullptr) != skinning)
+            {
+                skinning = !skinning;
+                state.removeStateSet(insertStateSetPosition);
+                state.insertStateSet(insertStateSetPosition, skinning ? mSkinningStateSet : mStateSet);
+            }
+
             rl->render(renderInfo, previous);
             previous = rl;
         }
@@ -37,6 +37,8 @@ namespace MWRender
 
     private:
         osg::ref_ptr<osg::StateSet> mStateSet;
+        // Same state with the program skinning the vertices, for the geometry skinned in the shaders
+        osg::ref_ptr<osg::StateSet> mSkinningStateSet;
         bool mPostPass;
     };
 
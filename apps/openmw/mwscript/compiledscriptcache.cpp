@@ -0,0 +1,326 @@
+#include "compiledscriptcache.hpp"
+
+#include <array>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <components/debug/debuglog.hpp>
+#include <components/files/conversion.hpp>
+#include <components/misc/hash.hpp>
+#include <components/version/version.hpp>
+
+namespace MWScript
+{
+    namespace
+    {
+        constexpr std::array<char, 4> sMagic{ 'O', 'M', 'W', 'S' };
+        // Increment when the cache format or the code generated by the compiler changes
+        constexpr std::uint32_t sFormatVersion = 2;
+        constexpr std::array<char, 3> sLocalTypes{ 's', 'l', 'f' };
+
+        template <class T>
+        void writeValue(std::ostream& stream, const T& value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <class T>
+        T readValue(std::istream& stream)
+        {
+            static_assert(!std::is_same_v<T, bool>, "Not every byte is a valid bool");
+            T value;
+            stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+            return value;
+        }
+
+        // Smallest size of a query in the file: type, name and id sizes, result type and flag
+        constexpr std::size_t sMinQuerySize = 2 * sizeof(std::uint8_t) + 2 * sizeof(std::uint32_t) + sizeof(char);
+
+        void writeString(std::ostream& stream, std::string_view value)
+        {
+            writeValue(stream, static_cast<std::uint32_t>(value.size()));
+            stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+        }
+
+        // A truncated or corrupted file must fail reading before getting allocations of arbitrary sizes
+        std::uint32_t readCount(std::istream& stream, std::uint64_t end, std::size_t minElementSize)
+        {
+            const std::uint32_t count = readValue<std::uint32_t>(stream);
+            const std::uint64_t position = static_cast<std::uint64_t>(stream.tellg());
+            if (position > end || count > (end - position) / minElementSize)
+                throw std::runtime_error("Invalid element count: " + std::to_string(count));
+            return count;
+        }
+
+        std::string readString(std::istream& stream, std::uint64_t end)
+        {
+            std::string value(readCount(stream, end, 1), '\0');
+            stream.read(value.data(), static_cast<std::streamsize>(value.size()));
+            return value;
+        }
+
+        template <class T>
+        void writeVector(std::ostream& stream, const std::vector<T>& values)
+        {
+            writeValue(stream, static_cast<std::uint32_t>(values.size()));
+            stream.write(reinterpret_cast<const char*>(values.data()),
+                static_cast<std::streamsize>(values.size() * sizeof(T)));
+        }
+
+        template <class T>
+        std::vector<T> readVector(std::istream& stream, std::uint64_t end)
+        {
+            std::vector<T> values(readCount(stream, end, sizeof(T)));
+            stream.read(
+                reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+            return values;
+        }
+
+        void writeScript(std::ostream& stream, const ESM::RefId& id, const CompiledScriptCache::Script& script)
+        {
+            writeString(stream, id.serialize());
+            writeValue(stream, script.mSourceHash);
+
+            writeVector(stream, script.mProgram.mInstructions);
+            writeVector(stream, script.mProgram.mIntegers);
+            writeVector(stream, script.mProgram.mFloats);
+            writeValue(stream, static_cast<std::uint32_t>(script.mProgram.mStrings.size()));
+            for (const std::string& value : script.mProgram.mStrings)
+                writeString(stream, value);
+
+            for (const char type : sLocalTypes)
+            {
+                const std::vector<std::string>& names = script.mLocals.get(type);
+                writeValue(stream, static_cast<std::uint32_t>(names.size()));
+                for (const std::string& name : names)
+                    writeString(stream, name);
+            }
+
+            writeValue(stream, static_cast<std::uint32_t>(script.mQueries.size()));
+            for (const CompilerContextQuery& query : script.mQueries)
+            {
+                writeValue(stream, static_cast<std::uint8_t>(query.mType));
+                writeString(stream, query.mName);
+                writeString(stream, query.mId.serialize());
+                writeValue(stream, query.mResultType);
+                writeValue(stream, static_cast<std::uint8_t>(query.mResultFlag));
+            }
+        }
+
+        std::pair<ESM::RefId, CompiledScriptCache::Script> readScript(std::istream& stream, std::uint64_t end)
+        {
+            const ESM::RefId id = ESM::RefId::deserialize(readString(stream, end));
+
+            CompiledScriptCache::Script script;
+            script.mSourceHash = readValue<std::uint64_t>(stream);
+
+            script.mProgram.mInstructions = readVector<Interpreter::Type_Code>(stream, end);
+            script.mProgram.mIntegers = readVector<Interpreter::Type_Integer>(stream, end);
+            script.mProgram.mFloats = readVector<Interpreter::Type_Float>(stream, end);
+            script.mProgram.mStrings.resize(readCount(stream, end, sizeof(std::uint32_t)));
+            for (std::string& value : script.mProgram.mStrings)
+                value = readString(stream, end);
+
+            for (const char type : sLocalTypes)
+            {
+                const std::uint32_t count = readCount(stream, end, sizeof(std::uint32_t));
+                for (std::uint32_t i = 0; i < count; ++i)
+                    script.mLocals.declare(type, readString(stream, end));
+            }
+
+            script.mQueries.resize(readCount(stream, end, sMinQuerySize));
+            for (CompilerContextQuery& query : script.mQueries)
+            {
+                const std::uint8_t type = readValue<std::uint8_t>(stream);
+                if (type > static_cast<std::uint8_t>(CompilerContextQuery::Type::IsId))
+                    throw std::runtime_error("Invalid compiler context query type: " + std::to_string(type));
+                query.mType = static_cast<CompilerContextQuery::Type>(type);
+                query.mName = readString(stream, end);
+                query.mId = ESM::RefId::deserialize(readString(stream, end));
+                query.mResultType = readValue<char>(stream);
+                query.mResultFlag = readValue<std::uint8_t>(stream) != 0;
+            }
+
+            return { id, std::move(script) };
+        }
+
+        bool isSameAnswer(const Compiler::Context& context, const CompilerContextQuery& query)
+        {
+            switch (query.mType)
+            {
+                case CompilerContextQuery::Type::GlobalType:
+                    return context.getGlobalType(query.mName) == query.mResultType;
+                case CompilerContextQuery::Type::MemberType:
+                    return context.getMemberType(query.mName, query.mId)
+                        == std::make_pair(query.mResultType, query.mResultFlag);
+                case CompilerContextQuery::Type::IsId:
+                    return context.isId(query.mId) == query.mResultFlag;
+            }
+            return false;
+        }
+    }
+
+    RecordingCompilerContext::RecordingCompilerContext(const Compiler::Context& context)
+        : mContext(context)
+    {
+        setExtensions(context.getExtensions());
+    }
+
+    bool RecordingCompilerContext::canDeclareLocals() const
+    {
+        return mContext.canDeclareLocals();
+    }
+
+    char RecordingCompilerContext::getGlobalType(const std::string& name) const
+    {
+        const char result = mContext.getGlobalType(name);
+        mQueries.push_back(CompilerContextQuery{ .mType = CompilerContextQuery::Type::GlobalType,
+            .mName = name,
+            .mId = ESM::RefId(),
+            .mResultType = result });
+        return result;
+    }
+
+    std::pair<char, bool> RecordingCompilerContext::getMemberType(const std::string& name, const ESM::RefId& id) const
+    {
+        const std::pair<char, bool> result = mContext.getMemberType(name, id);
+        mQueries.push_back(CompilerContextQuery{ .mType = CompilerContextQuery::Type::MemberType,
+            .mName = name,
+            .mId = id,
+            .mResultType = result.first,
+            .mResultFlag = result.second });
+        return result;
+    }
+
+    bool RecordingCompilerContext::isId(const ESM::RefId& name) const
+    {
+        const bool result = mContext.isId(name);
+        mQueries.push_back(CompilerContextQuery{
+            .mType = CompilerContextQuery::Type::IsId, .mName = {}, .mId = name, .mResultFlag = result });
+        return result;
+    }
+
+    CompiledScriptCache::CompiledScriptCache(std::uint64_t extensionsHash, int warningsMode)
+        : mVersion(Misc::hashFnv1a(Version::getCommitHash(),
+            Misc::hashFnv1a(Version::getVersion(), Misc::hashFnv1a(std::to_string(warningsMode), extensionsHash))))
+    {
+    }
+
+    void CompiledScriptCache::load(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream.is_open())
+            return;
+
+        try
+        {
+            stream.exceptions(std::ios::failbit | std::ios::badbit);
+
+            stream.seekg(0, std::ios::end);
+            const std::uint64_t end = static_cast<std::uint64_t>(stream.tellg());
+            stream.seekg(0, std::ios::beg);
+
+            if (readValue<std::array<char, 4>>(stream) != sMagic)
+                throw std::runtime_error("Not a compiled script cache");
+
+            if (readValue<std::uint32_t>(stream) != sFormatVersion || readValue<std::uint64_t>(stream) != mVersion)
+            {
+                Log(Debug::Info) << "Compiled script cache " << Files::pathToUnicodeString(path) << " is outdated";
+                return;
+            }
+
+            // A script has at least its id size and source hash
+            const std::uint32_t count = readCount(stream, end, sizeof(std::uint32_t) + sizeof(std::uint64_t));
+            std::unordered_map<ESM::RefId, Script> scripts;
+            scripts.reserve(count);
+            for (std::uint32_t i = 0; i < count; ++i)
+                scripts.insert(readScript(stream, end));
+
+            mScripts = std::move(scripts);
+            mModified = false;
+
+            Log(Debug::Verbose) << "Loaded " << mScripts.size() << " compiled scripts from "
+                                << Files::pathToUnicodeString(path);
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to read compiled script cache " << Files::pathToUnicodeString(path) << ": "
+                                << e.what();
+        }
+    }
+
+    void CompiledScriptCache::save(const std::filesystem::path& path) const
+    {
+        if (!mModified)
+            return;
+
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        try
+        {
+            std::filesystem::create_directories(path.parent_path());
+
+            {
+                std::ofstream stream(tempPath, std::ios::binary);
+                stream.exceptions(std::ios::failbit | std::ios::badbit);
+
+                writeValue(stream, sMagic);
+                writeValue(stream, sFormatVersion);
+                writeValue(stream, mVersion);
+                writeValue(stream, static_cast<std::uint32_t>(mScripts.size()));
+                for (const auto& [id, script] : mScripts)
+                    writeScript(stream, id, script);
+            }
+
+            std::filesystem::rename(tempPath, path);
+
+            Log(Debug::Verbose) << "Saved " << mScripts.size() << " compiled scripts to "
+                                << Files::pathToUnicodeString(path);
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to write compiled script cache " << Files::pathToUnicodeString(path) << ": "
+                                << e.what();
+
+            std::error_code ec;
+            std::filesystem::remove(tempPath, ec);
+        }
+    }
+
+    const CompiledScriptCache::Script* CompiledScriptCache::find(const ESM::RefId& id, std::uint64_t sourceHash) const
+    {
+        const auto it = mScripts.find(id);
+        if (it == mScripts.end() || it->second.mSourceHash != sourceHash)
+            return nullptr;
+        return &it->second;
+    }
+
+    const CompiledScriptCache::Script* CompiledScriptCache::find(
+        const ESM::RefId& id, std::uint64_t sourceHash, const Compiler::Context& context) const
+    {
+        const Script* const script = find(id, sourceHash);
+        if (script == nullptr)
+            return nullptr;
+        for (const CompilerContextQuery& query : script->mQueries)
+            if (!isSameAnswer(context, query))
+                return nullptr;
+        return script;
+    }
+
+    void CompiledScriptCache::insert(const ESM::RefId& id, Script&& script)
+    {
+        mScripts.insert_or_assign(id, std::move(script));
+        mModified = true;
+    }
+
+    std::uint64_t CompiledScriptCache::getSourceHash(std::string_view text)
+    {
+        return Misc::hashFnv1a(text);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef GAME_SCRIPT_COMPILEDSCRIPTCACHE_H
+#define GAME_SCRIPT_COMPILEDSCRIPTCACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <components/compiler/context.hpp>
+#include <components/compiler/locals.hpp>
+#include <components/esm/refid.hpp>
+#include <components/interpreter/program.hpp>
+
+namespace MWScript
+{
+    /// Answer of the compiler context to a query made during a script compilation. The compiled code stays valid
+    /// while the context gives the same answers.
+    struct CompilerContextQuery
+    {
+        enum class Type : std::uint8_t
+        {
+            GlobalType,
+            MemberType,
+            IsId,
+        };
+
+        Type mType;
+        std::string mName;
+        ESM::RefId mId;
+        char mResultType = ' ';
+        bool mResultFlag = false;
+    };
+
+    /// Compiler context forwarding all queries to another context and recording them with the answers.
+    class RecordingCompilerContext : public Compiler::Context
+    {
+        const Compiler::Context& mContext;
+        // Recording doesn't change the answers, so it's done in const functions
+        mutable std::vector<CompilerContextQuery> mQueries;
+
+    public:
+        explicit RecordingCompilerContext(const Compiler::Context& context);
+
+        bool canDeclareLocals() const override;
+
+        char getGlobalType(const std::string& name) const override;
+
+        std::pair<char, bool> getMemberType(const std::string& name, const ESM::RefId& id) const override;
+
+        bool isId(const ESM::RefId& name) const override;
+
+        void clear() { mQueries.clear(); }
+
+        std::vector<CompilerContextQuery> takeQueries() { return std::move(mQueries); }
+    };
+
+    /// Compiled scripts persisted between runs. A script is taken from the cache only if its source text hash is
+    /// the same and the compiler context gives the same answers to the queries recorded during its compilation.
+    /// The whole cache is discarded when the compiler extensions, the warnings mode or the engine version change.
+    class CompiledScriptCache
+    {
+    public:
+        struct Script
+        {
+            std::uint64_t mSourceHash = 0;
+            Interpreter::Program mProgram;
+            Compiler::Locals mLocals;
+            std::vector<CompilerContextQuery> mQueries;
+        };
+
+        CompiledScriptCache(std::uint64_t extensionsHash, int warningsMode);
+
+        void load(const std::filesystem::path& path);
+        ///< Read scripts from \a path. Errors are logged, the cache stays empty in that case.
+
+        void save(const std::filesystem::path& path) const;
+        ///< Write scripts to \a path if there were any changes since loading.
+
+        const Script* find(const ESM::RefId& id, std::uint64_t sourceHash) const;
+
+        const Script* find(const ESM::RefId& id, std::uint64_t sourceHash, const Compiler::Context& context) const;
+        ///< Return the script only if it was compiled with the same answers from \a context.
+
+        void insert(const ESM::RefId& id, Script&& script);
+
+        static std::uint64_t getSourceHash(std::string_view text);
+
+    private:
+        std::uint64_t mVersion;
+        std::unordered_map<ESM::RefId, Script> mScripts;
+        bool mModified = false;
+    };
+}
+
+#endif
@@ -25,15 +25,23 @@
 namespace MWScript
 {
     ScriptManager::ScriptManager(const MWWorld::ESMStore& store, Compiler::Context& compilerContext, int warningsMode,
-        const std::vector<ESM::RefId>& scriptBlacklist)
+        const std::vector<ESM::RefId>& scriptBlacklist, const std::filesystem::path& cachePath)
         : mErrorHandler()
         , mStore(store)
         , mCompilerContext(compilerContext)
-        , mParser(mErrorHandler, mCompilerContext)
+        , mRecordingContext(compilerContext)
+        , mParser(mErrorHandler, mRecordingContext)
         , mGlobalScripts(store)
+        , mCachePath(cachePath)
     {
         installOpcodes(mInterpreter);
 
+        if (!mCachePath.empty())
+        {
+            mCache.emplace(mCompilerContext.getExtensions()->getHash(), warningsMode);
+            mCache->load(mCachePath);
+        }
+
         mErrorHandler.setWarningsMode(warningsMode);
 
         mScriptBlacklist.resize(scriptBlacklist.size());
@@ -41,13 +49,32 @@ namespace MWScript
         std::sort(mScriptBlacklist.begin(), mScriptBlacklist.end());
     }
 
+    ScriptManager::~ScriptManager()
+    {
+        if (mCache)
+            mCache->save(mCachePath);
+    }
+
     bool ScriptManager::compile(const ESM::RefId& name)
     {
         mParser.reset();
         mErrorHandler.reset();
+        mRecordingContext.clear();
 
         if (const ESM::Script* script = mStore.get<ESM::Script>().find(name))
         {
+            const std::uint64_t sourceHash = mCache ? CompiledScriptCache::getSourceHash(script->mScriptText) : 0;
+
+            if (mCache)
+            {
+                if (const CompiledScriptCache::Script* cached = mCache->find(name, sourceHash, mCompilerContext))
+                {
+                    mScripts.emplace(name,
+                        CompiledScript(mInterpreter.decode(Interpreter::Program(cached->mProgram)), cached->mLocals));
+                    return true;
+                }
+            }
+
             mErrorHandler.setContext(script->mId.getRefIdString());
 
             bool Success = true;
@@ -80,7 +107,17 @@ namespace MWScript
 
             if (Success)
             {
-                mScripts.emplace(name, CompiledScript(mParser.getProgram(), mParser.getLocals()));
+                Interpreter::Program program = mParser.getProgram();
+
+                // Warnings are only reported when compiling, so the scripts having some are compiled every time
+                if (mCache && mErrorHandler.countWarnings() == 0)
+                    mCache->insert(name,
+                        CompiledScriptCache::Script{ .mSourceHash = sourceHash,
+                            .mProgram = program,
+                            .mLocals = mParser.getLocals(),
+                            .mQueries = mRecordingContext.takeQueries() });
+
+                mScripts.emplace(name, CompiledScript(mInterpreter.decode(std::move(program)), mParser.getLocals()));
 
                 return true;
             }
@@ -178,6 +215,14 @@ namespace MWScript
 
         if (const ESM::Script* script = mStore.get<ESM::Script>().search(name))
         {
+            // Locals depend only on the source text, no need to validate the compiler context answers
+            if (mCache)
+            {
+                if (const CompiledScriptCache::Script* cached
+                    = mCache->find(name, CompiledScriptCache::getSourceHash(script->mScriptText)))
+                    return mOtherLocals.emplace(name, cached->mLocals).first->second;
+            }
+
             Compiler::Locals locals;
 
             const Compiler::ContextOverride override(mErrorHandler, name.getRefIdString() + "[local variables]");
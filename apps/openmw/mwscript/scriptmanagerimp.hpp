@@ -1,7 +1,9 @@
 #ifndef GAME_SCRIPT_SCRIPTMANAGER_H
 #define GAME_SCRIPT_SCRIPTMANAGER_H
 
+#include <filesystem>
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 
@@ -15,6 +17,7 @@
 
 #include "../mwbase/scriptmanager.hpp"
 
+#include "compiledscriptcache.hpp"
 #include "globalscripts.hpp"
 
 namespace MWWorld
@@ -40,16 +43,17 @@ namespace MWScript
         Compiler::StreamErrorHandler mErrorHandler;
         const MWWorld::ESMStore& mStore;
         Compiler::Context& mCompilerContext;
+        RecordingCompilerContext mRecordingContext;
         Compiler::FileParser mParser;
         Interpreter::Interpreter mInterpreter;
 
         struct CompiledScript
         {
-            Interpreter::Program mProgram;
+            Interpreter::DecodedProgram mProgram;
             Compiler::Locals mLocals;
             std::set<ESM::RefId> mInactive;
 
-            explicit CompiledScript(Interpreter::Program&& program, const Compiler::Locals& locals)
+            explicit CompiledScript(Interpreter::DecodedProgram&& program, const Compiler::Locals& locals)
                 : mProgram(std::move(program))
                 , mLocals(locals)
             {
@@ -60,10 +64,15 @@ namespace MWScript
         GlobalScripts mGlobalScripts;
         std::unordered_map<ESM::RefId, Compiler::Locals> mOtherLocals;
         std::vector<ESM::RefId> mScriptBlacklist;
+        std::filesystem::path mCachePath;
+        std::optional<CompiledScriptCache> mCache;
 
     public:
         ScriptManager(const MWWorld::ESMStore& store, Compiler::Context& compilerContext, int warningsMode,
-            const std::vector<ESM::RefId>& scriptBlacklist);
+            const std::vector<ESM::RefId>& scriptBlacklist, const std::filesystem::path& cachePath = {});
+        ///< \param cachePath File to keep compiled scripts between runs, an empty path disables the cache.
+
+        ~ScriptManager() override;
 
         void clear() override;
 
@@ -2,6 +2,7 @@
 #include <array>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstring>
 #include <memory>
@@ -117,6 +118,8 @@ namespace
     LPALEVENTCONTROLSOFT alEventControlSOFT;
     LPALEVENTCALLBACKSOFT alEventCallbackSOFT;
     LPALCREOPENDEVICESOFT alcReopenDeviceSOFT;
+    LPALDEFERUPDATESSOFT alDeferUpdatesSOFT;
+    LPALPROCESSUPDATESSOFT alProcessUpdatesSOFT;
 
     void LoadEffect(ALuint effect, const EFXEAXREVERBPROPERTIES& props)
     {
@@ -804,6 +807,11 @@ namespace MWSound
         }
         if (alcIsExtensionPresent(mDevice, "ALC_SOFT_reopen_device"))
             getALFunc(alcReopenDeviceSOFT, "alcReopenDeviceSOFT");
+        if (alIsExtensionPresent("AL_SOFT_deferred_updates"))
+        {
+            getALFunc(alDeferUpdatesSOFT, "alDeferUpdatesSOFT");
+            getALFunc(alProcessUpdatesSOFT, "alProcessUpdatesSOFT");
+        }
         if (alEventControlSOFT)
         {
             static const std::array<ALenum, 1> events{ { AL_EVENT_TYPE_DISCONNECTED_SOFT } };
@@ -1034,43 +1042,48 @@ namespace MWSound
         return ret;
     }
 
-    std::pair<Sound_Handle, size_t> OpenAL_Output::loadSound(VFS::Path::NormalizedView fname)
+    DecodedSound OpenAL_Output::decodeSound(VFS::Path::NormalizedView fname)
     {
-        getALError();
-
-        std::vector<char> data;
-        ALenum format = AL_NONE;
-        int srate = 0;
+        DecodedSound sound;
 
         try
         {
             DecoderPtr decoder = mManager.getDecoder();
             decoder->open(Misc::ResourceHelpers::correctSoundPath(fname, *decoder->mResourceMgr));
 
-            ChannelConfig chans;
-            SampleType type;
-            decoder->getInfo(&srate, &chans, &type);
-            format = getALFormat(chans, type);
-            if (format)
-                decoder->readAll(data);
+            decoder->getInfo(&sound.mSampleRate, &sound.mChannelConfig, &sound.mSampleType);
+            decoder->readAll(sound.mData);
         }
         catch (std::exception& e)
         {
             Log(Debug::Error) << "Failed to load audio from " << fname << ": " << e.what();
+            sound.mData.clear();
         }
 
-        if (data.empty())
+        return sound;
+    }
+
+    std::pair<Sound_Handle, size_t> OpenAL_Output::loadSound(DecodedSound&& sound)
+    {
+        getALError();
+
+        ALenum format = AL_NONE;
+        int srate = sound.mSampleRate;
+        if (!sound.mData.empty())
+            format = getALFormat(sound.mChannelConfig, sound.mSampleType);
+
+        if (!format)
         {
             // If we failed to get any usable audio, substitute with silence.
             format = AL_FORMAT_MONO8;
             srate = 8000;
-            data.assign(8000, -128);
+            sound.mData.assign(8000, -128);
         }
 
         ALint size;
         ALuint buf = 0;
         alGenBuffers(1, &buf);
-        alBufferData(buf, format, data.data(), data.size(), srate);
+        alBufferData(buf, format, sound.mData.data(), sound.mData.size(), srate);
         alGetBufferi(buf, AL_SIZE, &size);
         if (getALError() != AL_NO_ERROR)
         {
@@ -1089,20 +1102,18 @@ namespace MWSound
             return 0;
 
         // Make sure no sources are playing this buffer before unloading it.
-        SoundVec::const_iterator iter = mActiveSounds.begin();
-        for (; iter != mActiveSounds.end(); ++iter)
+        for (Sound* sound : mActiveSounds)
         {
-            if (!(*iter)->mHandle)
+            Voice& voice = *static_cast<Voice*>(sound->mHandle);
+            if (voice.mBuffer != buffer)
                 continue;
 
-            ALuint source = GET_PTRID((*iter)->mHandle);
-            ALint srcbuf;
-            alGetSourcei(source, AL_BUFFER, &srcbuf);
-            if ((ALuint)srcbuf == buffer)
+            if (voice.mSource != 0)
             {
-                alSourceStop(source);
-                alSourcei(source, AL_BUFFER, 0);
+                alSourceStop(voice.mSource);
+                alSourcei(voice.mSource, AL_BUFFER, 0);
             }
+            voice.mBuffer = 0;
         }
         ALint size = 0;
         alGetBufferi(buffer, AL_SIZE, &size);
@@ -1205,21 +1216,104 @@ namespace MWSound
         alSource3f(source, AL_VELOCITY, 0.0f, 0.0f, 0.0f);
     }
 
-    bool OpenAL_Output::playSound(Sound* sound, Sound_Handle data, float offset)
+    // A sound of mActiveSounds. Only the most audible ones have a source, the others are virtual: their playback
+    // position is tracked until a source is available for them.
+    struct OpenAL_Output::Voice
     {
-        ALuint source;
+        ALuint mBuffer;
+        // In seconds
+        double mLength;
+        // 0 while the sound is virtual
+        ALuint mSource = 0;
+        // Playback position of the virtual sound at mOffsetTime, in seconds
+        double mOffset = 0.0;
+        std::chrono::steady_clock::time_point mOffsetTime;
+        bool mPaused = false;
+        bool mUpdated = false;
+        float mAudibility = 0.0f;
+        // Last values set on the source, the pitch is also used to advance the virtual sound
+        ALfloat mGain = 0.0f;
+        ALfloat mPitch = 1.0f;
+        osg::Vec3f mPosition;
+    };
 
-        if (mFreeSources.empty())
+    namespace
+    {
+        double getBufferLength(ALuint buffer)
         {
-            Log(Debug::Warning) << "No free sources!";
-            return false;
+            ALint size = 0, channels = 1, bits = 8, frequency = 1;
+            alGetBufferi(buffer, AL_SIZE, &size);
+            alGetBufferi(buffer, AL_CHANNELS, &channels);
+            alGetBufferi(buffer, AL_BITS, &bits);
+            alGetBufferi(buffer, AL_FREQUENCY, &frequency);
+            if (channels <= 0 || bits <= 0 || frequency <= 0)
+                return 0.0;
+            return static_cast<double>(size) / (channels * bits / 8) / frequency;
         }
-        source = mFreeSources.front();
 
-        initCommon2D(source, sound->getPosition(), sound->getRealVolume(), getTimeScaledPitch(sound),
-            sound->getIsLooping(), sound->getUseEnv());
-        alSourcei(source, AL_BUFFER, GET_PTRID(data));
-        alSourcef(source, AL_SEC_OFFSET, offset);
+        // Gain of the sound at the listener position, matching AL_INVERSE_DISTANCE_CLAMPED
+        float getAudibility(const Sound& sound, const osg::Vec3f& listenerPos)
+        {
+            const float gain = sound.getRealVolume();
+            if (!sound.getIs3D())
+                return gain;
+            const float distance = (sound.getPosition() - listenerPos).length();
+            if (distance > sound.getMaxDistance())
+                return 0.0f;
+            return gain * sound.getMinDistance() / std::max(distance, sound.getMinDistance());
+        }
+    }
+
+    bool OpenAL_Output::playSound(Sound* sound, Sound_Handle data, float offset)
+    {
+        return playVoice(sound, data, offset);
+    }
+
+    bool OpenAL_Output::playSound3D(Sound* sound, Sound_Handle data, float offset)
+    {
+        return playVoice(sound, data, offset);
+    }
+
+    bool OpenAL_Output::playVoice(Sound* sound, Sound_Handle data, float offset)
+    {
+        auto voice = std::make_unique<Voice>();
+        voice->mBuffer = GET_PTRID(data);
+        voice->mLength = getBufferLength(voice->mBuffer);
+        voice->mOffset = offset;
+        voice->mOffsetTime = std::chrono::steady_clock::now();
+        voice->mPitch = getTimeScaledPitch(sound);
+        voice->mAudibility = getAudibility(*sound, mListenerPos);
+        if (getALError() != AL_NO_ERROR)
+            return false;
+
+        // Without a free source, the sound starts virtual and may get one when the voices are ranked
+        if (voice->mAudibility > 0.0f && !mFreeSources.empty() && !startVoice(sound, *voice))
+            return false;
+
+        sound->mHandle = voice.release();
+        mActiveSounds.push_back(sound);
+
+        return true;
+    }
+
+    bool OpenAL_Output::startVoice(Sound* sound, Voice& voice)
+    {
+        const ALuint source = mFreeSources.front();
+
+        double offset = voice.mOffset;
+        if (sound->getIsLooping() && voice.mLength > 0.0)
+            offset = std::fmod(offset, voice.mLength);
+
+        voice.mGain = sound->getRealVolume();
+        voice.mPitch = getTimeScaledPitch(sound);
+        voice.mPosition = sound->getPosition();
+        if (sound->getIs3D())
+            initCommon3D(source, voice.mPosition, sound->getMinDistance(), sound->getMaxDistance(), voice.mGain,
+                voice.mPitch, sound->getIsLooping(), sound->getUseEnv());
+        else
+            initCommon2D(source, voice.mPosition, voice.mGain, voice.mPitch, sound->getIsLooping(), sound->getUseEnv());
+        alSourcei(source, AL_BUFFER, voice.mBuffer);
+        alSourcef(source, AL_SEC_OFFSET, static_cast<ALfloat>(offset));
         if (getALError() != AL_NO_ERROR)
         {
             alSourceRewind(source);
@@ -1238,65 +1332,167 @@ namespace MWSound
         }
 
         mFreeSources.pop_front();
-        sound->mHandle = MAKE_PTRID(source);
-        mActiveSounds.push_back(sound);
-
+        voice.mSource = source;
+        voice.mUpdated = false;
         return true;
     }
 
-    bool OpenAL_Output::playSound3D(Sound* sound, Sound_Handle data, float offset)
+    void OpenAL_Output::stopVoice(Voice& voice)
     {
-        ALuint source;
+        ALint state = AL_STOPPED;
+        ALfloat offset = 0.0f;
+        alGetSourcei(voice.mSource, AL_SOURCE_STATE, &state);
+        alGetSourcef(voice.mSource, AL_SEC_OFFSET, &offset);
 
-        if (mFreeSources.empty())
+        voice.mOffset = state == AL_STOPPED ? voice.mLength : offset;
+        voice.mOffsetTime = std::chrono::steady_clock::now();
+
+        // Rewind the source to put it back into an AL_INITIAL state, for the next time it's used.
+        alSourceRewind(voice.mSource);
+        alSourcei(voice.mSource, AL_BUFFER, 0);
+        getALError();
+
+        mFreeSources.push_back(voice.mSource);
+        voice.mSource = 0;
+    }
+
+    void OpenAL_Output::advanceVoice(Voice& voice, std::chrono::steady_clock::time_point now)
+    {
+        if (!voice.mPaused)
+            voice.mOffset += std::chrono::duration<double>(now - voice.mOffsetTime).count() * voice.mPitch;
+        voice.mOffsetTime = now;
+    }
+
+    bool OpenAL_Output::freeSource()
+    {
+        if (!mFreeSources.empty())
+            return true;
+
+        Sound* leastAudible = nullptr;
+        for (Sound* sound : mActiveSounds)
         {
-            Log(Debug::Warning) << "No free sources!";
+            const Voice& voice = *static_cast<Voice*>(sound->mHandle);
+            if (voice.mSource != 0 && !voice.mPaused
+                && (leastAudible == nullptr
+                    || voice.mAudibility < static_cast<Voice*>(leastAudible->mHandle)->mAudibility))
+                leastAudible = sound;
+        }
+        if (leastAudible == nullptr)
             return false;
+
+        stopVoice(*static_cast<Voice*>(leastAudible->mHandle));
+        return true;
+    }
+
+    void OpenAL_Output::updateVoices()
+    {
+        const auto now = std::chrono::steady_clock::now();
+
+        // The sources used by the streams are not available to the sounds
+        std::size_t availableSources = mFreeSources.size();
+        mSortedSounds.clear();
+        for (Sound* sound : mActiveSounds)
+        {
+            Voice& voice = *static_cast<Voice*>(sound->mHandle);
+            // Paused sounds keep their source
+            if (voice.mPaused)
+                continue;
+            if (voice.mSource != 0)
+                ++availableSources;
+            if (voice.mSource == 0)
+            {
+                advanceVoice(voice, now);
+                voice.mPitch = getTimeScaledPitch(sound);
+            }
+            voice.mAudibility = getAudibility(*sound, mListenerPos);
+            mSortedSounds.push_back(sound);
         }
-        source = mFreeSources.front();
 
-        initCommon3D(source, sound->getPosition(), sound->getMinDistance(), sound->getMaxDistance(),
-            sound->getRealVolume(), getTimeScaledPitch(sound), sound->getIsLooping(), sound->getUseEnv());
-        alSourcei(source, AL_BUFFER, GET_PTRID(data));
-        alSourcef(source, AL_SEC_OFFSET, offset);
-        if (getALError() != AL_NO_ERROR)
+        // The sounds which have a source already keep it when they are as audible as a virtual one
+        std::stable_sort(mSortedSounds.begin(), mSortedSounds.end(), [](const Sound* lhs, const Sound* rhs) {
+            const Voice& left = *static_cast<const Voice*>(lhs->mHandle);
+            const Voice& right = *static_cast<const Voice*>(rhs->mHandle);
+            return std::make_pair(left.mAudibility, left.mSource != 0)
+                > std::make_pair(right.mAudibility, right.mSource != 0);
+        });
+
+        for (std::size_t i = 0; i < mSortedSounds.size(); ++i)
         {
-            alSourceRewind(source);
-            alSourcei(source, AL_BUFFER, 0);
-            alGetError();
-            return false;
+            Voice& voice = *static_cast<Voice*>(mSortedSounds[i]->mHandle);
+            if (voice.mSource != 0 && (i >= availableSources || voice.mAudibility <= 0.0f))
+                stopVoice(voice);
         }
 
-        alSourcePlay(source);
-        if (getALError() != AL_NO_ERROR)
+        for (std::size_t i = 0; i < std::min(availableSources, mSortedSounds.size()); ++i)
         {
-            alSourceRewind(source);
-            alSourcei(source, AL_BUFFER, 0);
-            alGetError();
+            Sound* sound = mSortedSounds[i];
+            Voice& voice = *static_cast<Voice*>(sound->mHandle);
+            if (voice.mSource != 0)
+            {
+                if (voice.mUpdated)
+                    updateVoice(sound, voice);
+            }
+            else if (voice.mAudibility > 0.0f && voice.mBuffer != 0 && isVoicePlaying(sound, voice)
+                && !mFreeSources.empty())
+                startVoice(sound, voice);
+        }
+        getALError();
+    }
+
+    void OpenAL_Output::updateVoice(Sound* sound, Voice& voice)
+    {
+        ALfloat gain = sound->getRealVolume();
+        ALfloat pitch = getTimeScaledPitch(sound);
+        const osg::Vec3f& position = sound->getPosition();
+        if (sound->getUseEnv() && mListenerEnv == Env_Underwater && !mWaterFilter)
+        {
+            gain *= 0.9f;
+            pitch *= 0.7f;
+        }
+
+        if (gain != voice.mGain)
+            alSourcef(voice.mSource, AL_GAIN, gain);
+        if (pitch != voice.mPitch)
+            alSourcef(voice.mSource, AL_PITCH, pitch);
+        if (position != voice.mPosition)
+            alSourcefv(voice.mSource, AL_POSITION, position.ptr());
+
+        voice.mGain = gain;
+        voice.mPitch = pitch;
+        voice.mPosition = position;
+        voice.mUpdated = false;
+    }
+
+    bool OpenAL_Output::isVoicePlaying(Sound* sound, Voice& voice)
+    {
+        if (voice.mBuffer == 0)
             return false;
+
+        if (voice.mSource == 0)
+        {
+            if (sound->getIsLooping())
+                return true;
+            advanceVoice(voice, std::chrono::steady_clock::now());
+            return voice.mOffset < voice.mLength;
         }
 
-        mFreeSources.pop_front();
-        sound->mHandle = MAKE_PTRID(source);
-        mActiveSounds.push_back(sound);
+        ALint state = AL_STOPPED;
+        alGetSourcei(voice.mSource, AL_SOURCE_STATE, &state);
+        getALError();
 
-        return true;
+        return state == AL_PLAYING || state == AL_PAUSED;
     }
 
     void OpenAL_Output::finishSound(Sound* sound)
     {
         if (!sound->mHandle)
             return;
-        ALuint source = GET_PTRID(sound->mHandle);
+        std::unique_ptr<Voice> voice(static_cast<Voice*>(sound->mHandle));
         sound->mHandle = nullptr;
 
-        // Rewind the stream to put the source back into an AL_INITIAL state, for
-        // the next time it's used.
-        alSourceRewind(source);
-        alSourcei(source, AL_BUFFER, 0);
-        getALError();
+        if (voice->mSource != 0)
+            stopVoice(*voice);
 
-        mFreeSources.push_back(source);
         mActiveSounds.erase(std::find(mActiveSounds.begin(), mActiveSounds.end(), sound));
     }
 
@@ -1304,29 +1500,20 @@ namespace MWSound
     {
         if (!sound->mHandle)
             return false;
-        ALuint source = GET_PTRID(sound->mHandle);
-        ALint state = AL_STOPPED;
-
-        alGetSourcei(source, AL_SOURCE_STATE, &state);
-        getALError();
-
-        return state == AL_PLAYING || state == AL_PAUSED;
+        return isVoicePlaying(sound, *static_cast<Voice*>(sound->mHandle));
     }
 
     void OpenAL_Output::updateSound(Sound* sound)
     {
         if (!sound->mHandle)
             return;
-        ALuint source = GET_PTRID(sound->mHandle);
-
-        updateCommon(source, sound->getPosition(), sound->getMaxDistance(), sound->getRealVolume(),
-            getTimeScaledPitch(sound), sound->getUseEnv());
-        getALError();
+        // Applied by finishUpdate, once the sounds which get a source are known
+        static_cast<Voice*>(sound->mHandle)->mUpdated = true;
     }
 
     bool OpenAL_Output::streamSound(DecoderPtr decoder, Stream* sound, bool getLoudnessData)
     {
-        if (mFreeSources.empty())
+        if (!freeSource())
         {
             Log(Debug::Warning) << "No free sources!";
             return false;
@@ -1357,7 +1544,7 @@ namespace MWSound
 
     bool OpenAL_Output::streamSound3D(DecoderPtr decoder, Stream* sound, bool getLoudnessData)
     {
-        if (mFreeSources.empty())
+        if (!freeSource())
         {
             Log(Debug::Warning) << "No free sources!";
             return false;
@@ -1457,12 +1644,21 @@ namespace MWSound
 
     void OpenAL_Output::startUpdate()
     {
-        alcSuspendContext(alcGetCurrentContext());
+        if (alDeferUpdatesSOFT)
+            alDeferUpdatesSOFT();
+        else
+            alcSuspendContext(alcGetCurrentContext());
     }
 
     void OpenAL_Output::finishUpdate()
     {
-        alcProcessContext(alcGetCurrentContext());
+        updateVoices();
+
+        // Everything changed since startUpdate is applied at once
+        if (alProcessUpdatesSOFT)
+            alProcessUpdatesSOFT();
+        else
+            alcProcessContext(alcGetCurrentContext());
     }
 
     void OpenAL_Output::updateListener(
@@ -1485,8 +1681,9 @@ namespace MWSound
                     ALuint filter = (env == Env_Underwater) ? mWaterFilter : AL_FILTER_NULL;
                     for (Sound* sound : mActiveSounds)
                     {
-                        if (sound->getUseEnv())
-                            alSourcei(GET_PTRID(sound->mHandle), AL_DIRECT_FILTER, filter);
+                        const ALuint source = static_cast<Voice*>(sound->mHandle)->mSource;
+                        if (source != 0 && sound->getUseEnv())
+                            alSourcei(source, AL_DIRECT_FILTER, filter);
                     }
                     for (Stream* sound : mActiveStreams)
                     {
@@ -1509,11 +1706,19 @@ namespace MWSound
 
     void OpenAL_Output::pauseSounds(int types)
     {
+        const auto now = std::chrono::steady_clock::now();
         std::vector<ALuint> sources;
         for (Sound* sound : mActiveSounds)
         {
             if ((types & sound->getPlayType()))
-                sources.push_back(GET_PTRID(sound->mHandle));
+            {
+                Voice& voice = *static_cast<Voice*>(sound->mHandle);
+                if (voice.mSource != 0)
+                    sources.push_back(voice.mSource);
+                else
+                    advanceVoice(voice, now);
+                voice.mPaused = true;
+            }
         }
         for (Stream* sound : mActiveStreams)
         {
@@ -1564,11 +1769,18 @@ namespace MWSound
 
     void OpenAL_Output::resumeSounds(int types)
     {
+        const auto now = std::chrono::steady_clock::now();
         std::vector<ALuint> sources;
         for (Sound* sound : mActiveSounds)
         {
             if ((types & sound->getPlayType()))
-                sources.push_back(GET_PTRID(sound->mHandle));
+            {
+                Voice& voice = *static_cast<Voice*>(sound->mHandle);
+                if (voice.mSource != 0)
+                    sources.push_back(voice.mSource);
+                voice.mPaused = false;
+                voice.mOffsetTime = now;
+            }
         }
         for (Stream* sound : mActiveStreams)
         {
@@ -1,6 +1,7 @@
 #ifndef GAME_SOUND_OPENAL_OUTPUT_H
 #define GAME_SOUND_OPENAL_OUTPUT_H
 
+#include <chrono>
 #include <deque>
 #include <map>
 #include <mutex>
@@ -42,6 +43,8 @@ namespace MWSound
 
         typedef std::vector<Sound*> SoundVec;
         SoundVec mActiveSounds;
+        // Sorted by audibility by updateVoices
+        SoundVec mSortedSounds;
         typedef std::vector<Stream*> StreamVec;
         StreamVec mActiveStreams;
 
@@ -70,6 +73,22 @@ namespace MWSound
         void updateCommon(
             ALuint source, const osg::Vec3f& pos, ALfloat maxdist, ALfloat gain, ALfloat pitch, bool useenv);
 
+        struct Voice;
+
+        bool playVoice(Sound* sound, Sound_Handle data, float offset);
+        bool startVoice(Sound* sound, Voice& voice);
+        void stopVoice(Voice& voice);
+        void advanceVoice(Voice& voice, std::chrono::steady_clock::time_point now);
+        void updateVoice(Sound* sound, Voice& voice);
+        bool isVoicePlaying(Sound* sound, Voice& voice);
+
+        /// Gives a source to the most audible sounds, the others are virtual until they get one.
+        void updateVoices();
+
+        /// Takes the source of the least audible sound if there is no free source.
+        /// @return false if there is still no free source
+        bool freeSource();
+
         float getTimeScaledPitch(SoundBase* sound);
 
         OpenAL_Output& operator=(const OpenAL_Output& rhs);
@@ -87,7 +106,8 @@ namespace MWSound
 
         std::vector<std::string> enumerateHrtf() override;
 
-        std::pair<Sound_Handle, size_t> loadSound(VFS::Path::NormalizedView fname) override;
+        DecodedSound decodeSound(VFS::Path::NormalizedView fname) override;
+        std::pair<Sound_Handle, size_t> loadSound(DecodedSound&& sound) override;
         size_t unloadSound(Sound_Handle data) override;
 
         bool playSound(Sound* sound, Sound_Handle data, float offset) override;
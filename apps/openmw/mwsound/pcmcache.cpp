@@ -0,0 +1,351 @@
+#include "pcmcache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <components/debug/debuglog.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/vfs/manager.hpp>
+
+#include "ffmpeg_decoder.hpp"
+#include "sound_decoder.hpp"
+
+namespace MWSound
+{
+    namespace
+    {
+        constexpr char sMagic[8] = { 'O', 'M', 'W', 'P', 'C', 'M', '1', '\0' };
+
+        // Followed by the name of the sound file, then by the samples
+        struct Header
+        {
+            char mMagic[8];
+            std::int64_t mSourceTime;
+            std::uint32_t mSampleRate;
+            std::uint32_t mChannelConfig;
+            std::uint32_t mSampleType;
+            std::uint32_t mNameSize;
+            std::uint64_t mDataSize;
+        };
+
+        // The name only has to be the same from a run to another, the header tells which sound the file holds
+        std::filesystem::path getCacheFileName(VFS::Path::NormalizedView fileName)
+        {
+            // FNV-1a
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c : fileName.value())
+            {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            std::ostringstream stream;
+            stream << std::hex << std::setw(16) << std::setfill('0') << hash << ".pcm";
+            return stream.str();
+        }
+
+        // @return nullopt if the sound file is in an archive or doesn't exist
+        std::optional<std::int64_t> getSourceTime(const VFS::Manager& vfs, VFS::Path::NormalizedView fileName)
+        {
+            if (!vfs.exists(fileName))
+                return std::nullopt;
+            const std::filesystem::path path = vfs.getAbsoluteFileName(std::filesystem::path(fileName.value()));
+            // The archives only know the names of their files
+            if (!path.is_absolute())
+                return std::nullopt;
+            std::error_code ec;
+            const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+            if (ec)
+                return std::nullopt;
+            return static_cast<std::int64_t>(time.time_since_epoch().count());
+        }
+
+        // @return nullopt if the file doesn't hold the samples of this version of the sound file
+        std::optional<Header> readHeader(const boost::iostreams::mapped_file_source& file,
+            VFS::Path::NormalizedView fileName, std::int64_t sourceTime)
+        {
+            Header header;
+            if (file.size() < sizeof(header))
+                return std::nullopt;
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (std::memcmp(header.mMagic, sMagic, sizeof(sMagic)) != 0 || header.mSourceTime != sourceTime
+                || header.mNameSize != fileName.value().size()
+                || file.size() != sizeof(header) + header.mNameSize + header.mDataSize
+                || std::string_view(file.data() + sizeof(header), header.mNameSize) != fileName.value())
+                return std::nullopt;
+            return header;
+        }
+
+        class MappedPcmDecoder final : public Sound_Decoder
+        {
+        public:
+            MappedPcmDecoder(const boost::iostreams::mapped_file_source& file, const Header& header, std::string name)
+                : Sound_Decoder(nullptr)
+                , mFile(file)
+                , mData(file.data() + sizeof(Header) + header.mNameSize)
+                , mSize(header.mDataSize)
+                , mSampleRate(static_cast<int>(header.mSampleRate))
+                , mChannelConfig(static_cast<ChannelConfig>(header.mChannelConfig))
+                , mSampleType(static_cast<SampleType>(header.mSampleType))
+                , mName(std::move(name))
+            {
+            }
+
+            ~MappedPcmDecoder() { MappedPcmDecoder::close(); }
+
+            void open(VFS::Path::NormalizedView fname) override { throw std::runtime_error("Method not implemented"); }
+
+            void close() override
+            {
+                mFile.close();
+                mData = nullptr;
+                mSize = 0;
+                mPosition = 0;
+            }
+
+            std::string getName() override { return mName; }
+
+            void getInfo(int* samplerate, ChannelConfig* chans, SampleType* type) override
+            {
+                *samplerate = mSampleRate;
+                *chans = mChannelConfig;
+                *type = mSampleType;
+            }
+
+            size_t read(char* buffer, size_t bytes) override
+            {
+                bytes = std::min(bytes, mSize - mPosition);
+                std::memcpy(buffer, mData + mPosition, bytes);
+                mPosition += bytes;
+                return bytes;
+            }
+
+            void readAll(std::vector<char>& output) override
+            {
+                output.insert(output.end(), mData + mPosition, mData + mSize);
+                mPosition = mSize;
+            }
+
+            size_t getSampleOffset() override { return bytesToFrames(mPosition, mChannelConfig, mSampleType); }
+
+        private:
+            boost::iostreams::mapped_file_source mFile;
+            const char* mData;
+            std::size_t mSize;
+            std::size_t mPosition = 0;
+            int mSampleRate;
+            ChannelConfig mChannelConfig;
+            SampleType mSampleType;
+            std::string mName;
+        };
+
+        class DecodeToCacheWorkItem : public SceneUtil::WorkItem
+        {
+        public:
+            DecodeToCacheWorkItem(const VFS::Manager& vfs, VFS::Path::NormalizedView fileName, std::int64_t sourceTime,
+                std::filesystem::path directory, std::size_t maxSize, std::shared_ptr<std::atomic_bool> aborted)
+                : mVFS(vfs)
+                , mFileName(fileName)
+                , mSourceTime(sourceTime)
+                , mDirectory(std::move(directory))
+                , mMaxSize(maxSize)
+                , mAborted(std::move(aborted))
+            {
+            }
+
+            void doWork() override
+            {
+                const std::filesystem::path path = mDirectory / getCacheFileName(mFileName);
+                std::filesystem::path tmpPath = path;
+                tmpPath += ".tmp";
+                try
+                {
+                    if (isCached(path))
+                        return;
+                    if (!decode(tmpPath))
+                        return;
+                    std::filesystem::rename(tmpPath, path);
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Warning) << "Failed to cache the samples of " << mFileName << ": " << e.what();
+                    std::error_code ec;
+                    std::filesystem::remove(tmpPath, ec);
+                    return;
+                }
+                prune();
+            }
+
+        private:
+            const VFS::Manager& mVFS;
+            VFS::Path::Normalized mFileName;
+            std::int64_t mSourceTime;
+            std::filesystem::path mDirectory;
+            std::size_t mMaxSize;
+            std::shared_ptr<std::atomic_bool> mAborted;
+
+            bool isCached(const std::filesystem::path& path) const
+            {
+                // An empty or truncated file can't be mapped, it's overwritten
+                std::error_code ec;
+                if (std::filesystem::file_size(path, ec) < sizeof(Header) || ec)
+                    return false;
+                const boost::iostreams::mapped_file_source file(path.native());
+                return readHeader(file, mFileName, mSourceTime).has_value();
+            }
+
+            // @return false if aborted
+            bool decode(const std::filesystem::path& tmpPath) const
+            {
+                std::filesystem::create_directories(mDirectory);
+
+                const DecoderPtr decoder = std::make_shared<FFmpeg_Decoder>(&mVFS);
+                decoder->open(mFileName);
+
+                int sampleRate;
+                ChannelConfig channelConfig;
+                SampleType sampleType;
+                decoder->getInfo(&sampleRate, &channelConfig, &sampleType);
+
+                Header header;
+                std::memcpy(header.mMagic, sMagic, sizeof(sMagic));
+                header.mSourceTime = mSourceTime;
+                header.mSampleRate = static_cast<std::uint32_t>(sampleRate);
+                header.mChannelConfig = static_cast<std::uint32_t>(channelConfig);
+                header.mSampleType = static_cast<std::uint32_t>(sampleType);
+                header.mNameSize = static_cast<std::uint32_t>(mFileName.value().size());
+                header.mDataSize = 0;
+
+                std::ofstream stream(tmpPath, std::ios::binary);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                stream.write(mFileName.value().data(), header.mNameSize);
+
+                std::vector<char> buffer(1 << 16);
+                while (const std::size_t size = decoder->read(buffer.data(), buffer.size()))
+                {
+                    if (*mAborted)
+                    {
+                        stream.close();
+                        std::error_code ec;
+                        std::filesystem::remove(tmpPath, ec);
+                        return false;
+                    }
+                    stream.write(buffer.data(), static_cast<std::streamsize>(size));
+                    header.mDataSize += size;
+                }
+                decoder->close();
+
+                stream.seekp(0);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                stream.close();
+                if (!stream)
+                    throw std::runtime_error("failed to write " + tmpPath.string());
+                return true;
+            }
+
+            // Removes the least recently played sounds until the cache fits in its size
+            void prune() const
+            {
+                std::vector<std::tuple<std::filesystem::file_time_type, std::uintmax_t, std::filesystem::path>> files;
+                std::uintmax_t totalSize = 0;
+                std::error_code ec;
+                for (const std::filesystem::directory_entry& entry :
+                    std::filesystem::directory_iterator(mDirectory, ec))
+                {
+                    if (entry.path().extension() != ".pcm")
+                        continue;
+                    const std::uintmax_t size = entry.file_size(ec);
+                    if (ec)
+                        continue;
+                    const std::filesystem::file_time_type time = entry.last_write_time(ec);
+                    if (ec)
+                        continue;
+                    totalSize += size;
+                    files.emplace_back(time, size, entry.path());
+                }
+
+                if (totalSize <= mMaxSize)
+                    return;
+
+                std::sort(files.begin(), files.end());
+                for (const auto& [time, size, path] : files)
+                {
+                    if (totalSize <= mMaxSize)
+                        break;
+                    if (std::filesystem::remove(path, ec))
+                        totalSize -= size;
+                }
+            }
+        };
+    }
+
+    PcmCache::PcmCache(
+        const VFS::Manager& vfs, std::filesystem::path path, std::size_t maxSize, SceneUtil::WorkQueue* workQueue)
+        : mVFS(vfs)
+        , mPath(std::move(path))
+        , mMaxSize(maxSize)
+        , mWorkQueue(workQueue)
+        , mAborted(std::make_shared<std::atomic_bool>(false))
+    {
+    }
+
+    DecoderPtr PcmCache::open(VFS::Path::NormalizedView fileName) const
+    {
+        if (mPath.empty() || mWorkQueue == nullptr)
+            return nullptr;
+
+        const std::optional<std::int64_t> sourceTime = getSourceTime(mVFS, fileName);
+        if (!sourceTime.has_value())
+            return nullptr;
+
+        const std::filesystem::path path = mPath / getCacheFileName(fileName);
+        std::error_code ec;
+        if (std::filesystem::file_size(path, ec) < sizeof(Header) || ec)
+            return nullptr;
+
+        try
+        {
+            const boost::iostreams::mapped_file_source file(path.native());
+            const std::optional<Header> header = readHeader(file, fileName, *sourceTime);
+            if (!header.has_value())
+                return nullptr;
+            // The least recently played sounds are the first to go
+            std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+            return std::make_shared<MappedPcmDecoder>(file, *header, std::string(fileName.value()));
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Failed to open the cached samples of " << fileName << ": " << e.what();
+        }
+
+        return nullptr;
+    }
+
+    void PcmCache::add(VFS::Path::NormalizedView fileName)
+    {
+        if (mPath.empty() || mWorkQueue == nullptr || !mAdded.emplace(fileName.value()).second)
+            return;
+
+        const std::optional<std::int64_t> sourceTime = getSourceTime(mVFS, fileName);
+        if (!sourceTime.has_value())
+            return;
+
+        mWorkQueue->addWorkItem(new DecodeToCacheWorkItem(mVFS, fileName, *sourceTime, mPath, mMaxSize, mAborted));
+    }
+
+    void PcmCache::abort()
+    {
+        *mAborted = true;
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef GAME_SOUND_PCMCACHE_H
+#define GAME_SOUND_PCMCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_set>
+
+#include <components/vfs/pathutil.hpp>
+
+#include "../mwbase/soundmanager.hpp"
+
+namespace VFS
+{
+    class Manager;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
+namespace MWSound
+{
+    /// Keeps the decoded samples of the streamed sounds in files, which are memory-mapped to play the sounds again
+    /// without decoding them. A file is only valid as long as the sound file it was decoded from is not modified, so
+    /// only the sound files which are not in an archive are cached.
+    class PcmCache
+    {
+    public:
+        /// @param path directory of the cache, the cache is disabled if empty
+        /// @param maxSize in bytes, the least recently played sounds are removed beyond it
+        /// @param workQueue decodes the sounds into the cache, the cache is disabled without it
+        PcmCache(const VFS::Manager& vfs, std::filesystem::path path, std::size_t maxSize,
+            SceneUtil::WorkQueue* workQueue);
+
+        /// @return a decoder reading the cached samples of the sound file, nullptr if they are not cached
+        /// @note May be called from any thread.
+        DecoderPtr open(VFS::Path::NormalizedView fileName) const;
+
+        /// Decode the sound file into the cache in the background, unless it's cached already.
+        void add(VFS::Path::NormalizedView fileName);
+
+        /// Make the sounds being decoded into the cache give up, to not hold the work queue up when it's stopped.
+        void abort();
+
+    private:
+        const VFS::Manager& mVFS;
+        std::filesystem::path mPath;
+        std::size_t mMaxSize;
+        SceneUtil::WorkQueue* mWorkQueue;
+        // The sounds added during this session, including the ones which failed to decode
+        std::unordered_set<std::string> mAdded;
+        std::shared_ptr<std::atomic_bool> mAborted;
+    };
+}
+
+#endif
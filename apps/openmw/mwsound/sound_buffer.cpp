@@ -6,10 +6,12 @@
 #include <components/debug/debuglog.hpp>
 #include <components/esm3/loadsoun.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/sceneutil/workqueue.hpp>
 #include <components/settings/values.hpp>
 #include <components/vfs/pathutil.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 
 namespace MWSound
@@ -35,8 +37,35 @@ namespace MWSound
         }
     }
 
-    SoundBufferPool::SoundBufferPool(Sound_Output& output)
+    class SoundBufferPool::DecodeWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        DecodeWorkItem(Sound_Output& output, VFS::Path::NormalizedView path)
+            : mOutput(output)
+            , mPath(path)
+        {
+        }
+
+        void doWork() override
+        {
+            if (tryStart())
+                mSound = mOutput.decodeSound(mPath);
+        }
+
+        /// @return false if a worker thread has started decoding the sound already
+        bool tryStart() { return !mStarted.exchange(true); }
+
+        DecodedSound mSound;
+
+    private:
+        Sound_Output& mOutput;
+        VFS::Path::Normalized mPath;
+        std::atomic_bool mStarted{ false };
+    };
+
+    SoundBufferPool::SoundBufferPool(Sound_Output& output, SceneUtil::WorkQueue* workQueue)
         : mOutput(&output)
+        , mWorkQueue(workQueue)
         , mBufferCacheMax(Settings::sound().mBufferCacheMax * 1024 * 1024)
         , mBufferCacheMin(
               std::min(static_cast<std::size_t>(Settings::sound().mBufferCacheMin) * 1024 * 1024, mBufferCacheMax))
@@ -77,7 +106,22 @@ namespace MWSound
         if (sfx->getHandle() != nullptr)
             return sfx;
 
-        auto [handle, size] = mOutput->loadSound(sfx->getResourceName());
+        const auto it = mPreloading.find(sfx);
+        if (it == mPreloading.end())
+            return loadSfx(sfx, mOutput->decodeSound(sfx->getResourceName()));
+
+        // The sound has to be played now, don't wait for the worker threads to get to it
+        osg::ref_ptr<DecodeWorkItem> item = std::move(it->second);
+        mPreloading.erase(it);
+        if (item->tryStart())
+            return loadSfx(sfx, mOutput->decodeSound(sfx->getResourceName()));
+        item->waitTillDone();
+        return loadSfx(sfx, std::move(item->mSound));
+    }
+
+    Sound_Buffer* SoundBufferPool::loadSfx(Sound_Buffer* sfx, DecodedSound&& sound)
+    {
+        auto [handle, size] = mOutput->loadSound(std::move(sound));
         if (handle == nullptr)
             return {};
 
@@ -95,7 +139,7 @@ namespace MWSound
         return sfx;
     }
 
-    Sound_Buffer* SoundBufferPool::load(const ESM::RefId& soundId)
+    Sound_Buffer* SoundBufferPool::findSound(const ESM::RefId& soundId)
     {
         if (mBufferNameMap.empty())
         {
@@ -103,17 +147,21 @@ namespace MWSound
                 insertSound(sound.mId, sound);
         }
 
-        Sound_Buffer* sfx;
         const auto it = mBufferNameMap.find(soundId);
         if (it != mBufferNameMap.end())
-            sfx = it->second;
-        else
-        {
-            const ESM::Sound* sound = MWBase::Environment::get().getESMStore()->get<ESM::Sound>().search(soundId);
-            if (sound == nullptr)
-                return {};
-            sfx = insertSound(soundId, *sound);
-        }
+            return it->second;
+
+        const ESM::Sound* sound = MWBase::Environment::get().getESMStore()->get<ESM::Sound>().search(soundId);
+        if (sound == nullptr)
+            return {};
+        return insertSound(soundId, *sound);
+    }
+
+    Sound_Buffer* SoundBufferPool::load(const ESM::RefId& soundId)
+    {
+        Sound_Buffer* sfx = findSound(soundId);
+        if (sfx == nullptr)
+            return {};
 
         return loadSfx(sfx);
     }
@@ -132,8 +180,47 @@ namespace MWSound
         return loadSfx(sfx);
     }
 
+    void SoundBufferPool::preload(const ESM::RefId& soundId)
+    {
+        if (mWorkQueue == nullptr)
+            return;
+
+        Sound_Buffer* sfx = findSound(soundId);
+        if (sfx == nullptr || sfx->getHandle() != nullptr || mPreloading.contains(sfx))
+            return;
+
+        osg::ref_ptr<DecodeWorkItem> item = new DecodeWorkItem(*mOutput, sfx->getResourceName());
+        // Preloaded sounds are about to be played, they go before the voices preloaded for a dialogue
+        mWorkQueue->addWorkItem(item, true);
+        mPreloading.emplace(sfx, std::move(item));
+    }
+
+    void SoundBufferPool::update()
+    {
+        for (auto it = mPreloading.begin(); it != mPreloading.end();)
+        {
+            if (!it->second->isDone())
+            {
+                ++it;
+                continue;
+            }
+
+            Sound_Buffer* const sfx = it->first;
+            if (sfx->getHandle() == nullptr)
+                loadSfx(sfx, std::move(it->second->mSound));
+            it = mPreloading.erase(it);
+        }
+    }
+
     void SoundBufferPool::clear()
     {
+        for (auto& [sfx, item] : mPreloading)
+        {
+            if (!item->tryStart())
+                item->waitTillDone();
+        }
+        mPreloading.clear();
+
         for (auto& sfx : mSoundBuffers)
         {
             if (sfx.mHandle)
@@ -195,11 +282,20 @@ namespace MWSound
         while (!mUnusedBuffers.empty() && mBufferCacheSize > mBufferCacheMin)
         {
             Sound_Buffer* const unused = mUnusedBuffers.back();
+            mUnusedBuffers.pop_back();
+
+            // Give frequently played sounds another chance. Their frequency decays, so they get unloaded eventually
+            // once they are not played anymore.
+            if (unused->mFrequency > 1)
+            {
+                unused->mFrequency /= 2;
+                mUnusedBuffers.push_front(unused);
+                continue;
+            }
 
             mBufferCacheSize -= mOutput->unloadSound(unused->getHandle());
             unused->mHandle = nullptr;
-
-            mUnusedBuffers.pop_back();
+            unused->mFrequency = 0;
         }
     }
 }
@@ -9,6 +9,8 @@
 #include "sound_output.hpp"
 #include <components/esm/refid.hpp>
 
+#include <osg/ref_ptr>
+
 namespace ESM
 {
     struct Sound;
@@ -19,6 +21,11 @@ namespace VFS
     class Manager;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWSound
 {
     class SoundBufferPool;
@@ -52,6 +59,8 @@ namespace MWSound
         float mMaxDist;
         Sound_Handle mHandle = nullptr;
         std::size_t mUses = 0;
+        // How many times the sound was played, halved every time it is spared by the eviction
+        std::size_t mFrequency = 0;
 
         friend class SoundBufferPool;
     };
@@ -59,7 +68,8 @@ namespace MWSound
     class SoundBufferPool
     {
     public:
-        SoundBufferPool(Sound_Output& output);
+        /// @param workQueue decodes the preloaded sounds, they are decoded on demand without it
+        SoundBufferPool(Sound_Output& output, SceneUtil::WorkQueue* workQueue);
 
         SoundBufferPool(const SoundBufferPool&) = delete;
 
@@ -80,8 +90,15 @@ namespace MWSound
         // Lookup for a sound by file name, and ensure it's ready for use.
         Sound_Buffer* load(std::string_view fileName);
 
+        /// Start decoding a sound in the background, so that it's ready when it has to be played.
+        void preload(const ESM::RefId& soundId);
+
+        /// Load the preloaded sounds which are decoded.
+        void update();
+
         void use(Sound_Buffer& sfx)
         {
+            ++sfx.mFrequency;
             if (sfx.mUses++ == 0)
             {
                 const auto it = std::find(mUnusedBuffers.begin(), mUnusedBuffers.end(), &sfx);
@@ -99,9 +116,15 @@ namespace MWSound
         void clear();
 
     private:
+        class DecodeWorkItem;
+
+        Sound_Buffer* findSound(const ESM::RefId& soundId);
         Sound_Buffer* loadSfx(Sound_Buffer* sfx);
+        Sound_Buffer* loadSfx(Sound_Buffer* sfx, DecodedSound&& sound);
 
         Sound_Output* mOutput;
+        SceneUtil::WorkQueue* mWorkQueue;
+        std::unordered_map<Sound_Buffer*, osg::ref_ptr<DecodeWorkItem>> mPreloading;
         std::deque<Sound_Buffer> mSoundBuffers;
         std::unordered_map<ESM::RefId, Sound_Buffer*> mBufferNameMap;
         std::unordered_map<std::string, Sound_Buffer*> mBufferFileNameMap;
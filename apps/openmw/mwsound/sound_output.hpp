@@ -10,6 +10,8 @@
 
 #include "../mwbase/soundmanager.hpp"
 
+#include "sound_decoder.hpp"
+
 namespace MWSound
 {
     class SoundManager;
@@ -30,6 +32,15 @@ namespace MWSound
 
     using HrtfMode = Settings::HrtfMode;
 
+    // Samples of a sound file, decoded before being loaded into a buffer of the implementation.
+    struct DecodedSound
+    {
+        std::vector<char> mData;
+        ChannelConfig mChannelConfig = ChannelConfig_Mono;
+        SampleType mSampleType = SampleType_UInt8;
+        int mSampleRate = 0;
+    };
+
     class Sound_Output
     {
         SoundManager& mManager;
@@ -40,7 +51,9 @@ namespace MWSound
 
         virtual std::vector<std::string> enumerateHrtf() = 0;
 
-        virtual std::pair<Sound_Handle, size_t> loadSound(VFS::Path::NormalizedView fname) = 0;
+        // Safe to call from any thread, unlike the other functions.
+        virtual DecodedSound decodeSound(VFS::Path::NormalizedView fname) = 0;
+        virtual std::pair<Sound_Handle, size_t> loadSound(DecodedSound&& sound) = 0;
         virtual size_t unloadSound(Sound_Handle data) = 0;
 
         virtual bool playSound(Sound* sound, Sound_Handle data, float offset) = 0;
@@ -1,6 +1,7 @@
 #include "soundmanagerimp.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <numeric>
 #include <sstream>
@@ -10,6 +11,7 @@
 #include <components/debug/debuglog.hpp>
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/rng.hpp>
+#include <components/sceneutil/workqueue.hpp>
 #include <components/settings/values.hpp>
 #include <components/vfs/manager.hpp>
 #include <components/vfs/pathutil.hpp>
@@ -109,11 +111,66 @@ namespace MWSound
         return static_cast<int>(a) | static_cast<int>(b);
     }
 
-    SoundManager::SoundManager(const VFS::Manager* vfs, bool useSound)
+    class SoundManager::PreloadVoiceWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        PreloadVoiceWorkItem(DecoderPtr decoder, VFS::Path::NormalizedView path, const PcmCache& pcmCache)
+            : mDecoder(std::move(decoder))
+            , mPath(path)
+            , mPcmCache(pcmCache)
+        {
+        }
+
+        void doWork() override
+        {
+            if (!tryStart())
+                return;
+            try
+            {
+                const VFS::Path::Normalized path
+                    = Misc::ResourceHelpers::correctSoundPath(mPath, *mDecoder->mResourceMgr);
+                if (DecoderPtr cached = mPcmCache.open(path))
+                    mDecoder = std::move(cached);
+                else
+                    mDecoder->open(path);
+            }
+            catch (std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to load audio from " << mPath << ": " << e.what();
+                mDecoder = nullptr;
+            }
+        }
+
+        /// @return false if a worker thread has started opening the file already
+        bool tryStart() { return !mStarted.exchange(true); }
+
+        const VFS::Path::Normalized& getPath() const { return mPath; }
+
+        /// @return nullptr if the file couldn't be opened
+        DecoderPtr takeDecoder()
+        {
+            waitTillDone();
+            return std::move(mDecoder);
+        }
+
+    private:
+        DecoderPtr mDecoder;
+        VFS::Path::Normalized mPath;
+        const PcmCache& mPcmCache;
+        std::atomic_bool mStarted{ false };
+    };
+
+    SoundManager::SoundManager(const VFS::Manager* vfs, bool useSound, const std::filesystem::path& streamCachePath)
         : mVFS(vfs)
         , mOutput(std::make_unique<OpenAL_Output>(*this))
         , mWaterSoundUpdater(makeWaterSoundUpdaterSettings())
-        , mSoundBuffers(*mOutput)
+        , mDecodeQueue(useSound && Settings::sound().mDecodingThreads > 0
+                  ? new SceneUtil::WorkQueue(static_cast<std::size_t>(Settings::sound().mDecodingThreads))
+                  : nullptr)
+        , mCacheQueue(useSound && !streamCachePath.empty() ? new SceneUtil::WorkQueue(1) : nullptr)
+        , mSoundBuffers(*mOutput, mDecodeQueue.get())
+        , mPcmCache(*vfs, streamCachePath, static_cast<std::size_t>(Settings::sound().mStreamCacheSize) * 1024 * 1024,
+              mCacheQueue.get())
         , mMusicType(MWSound::MusicType::Normal)
         , mListenerUnderwater(false)
         , mListenerPos(0, 0, 0)
@@ -163,6 +220,11 @@ namespace MWSound
     {
         SoundManager::clear();
         mSoundBuffers.clear();
+        mPcmCache.abort();
+        if (mCacheQueue)
+            mCacheQueue->stop();
+        if (mDecodeQueue)
+            mDecodeQueue->stop();
         mOutput.reset();
     }
 
@@ -174,10 +236,31 @@ namespace MWSound
 
     DecoderPtr SoundManager::loadVoice(VFS::Path::NormalizedView voicefile)
     {
+        const VFS::Path::Normalized path = Misc::ResourceHelpers::correctSoundPath(voicefile, *mVFS);
+        const auto preloaded = std::find_if(mPreloadedVoices.begin(), mPreloadedVoices.end(),
+            [&](const osg::ref_ptr<PreloadVoiceWorkItem>& item) { return item->getPath() == voicefile; });
+        if (preloaded != mPreloadedVoices.end())
+        {
+            osg::ref_ptr<PreloadVoiceWorkItem> item = std::move(*preloaded);
+            mPreloadedVoices.erase(preloaded);
+            // The voice has to be played now, don't wait for the worker threads to get to it
+            if (!item->tryStart())
+            {
+                DecoderPtr decoder = item->takeDecoder();
+                if (decoder != nullptr)
+                    mPcmCache.add(path);
+                return decoder;
+            }
+        }
+
+        if (DecoderPtr decoder = mPcmCache.open(path))
+            return decoder;
+
         try
         {
             DecoderPtr decoder = getDecoder();
-            decoder->open(Misc::ResourceHelpers::correctSoundPath(voicefile, *decoder->mResourceMgr));
+            decoder->open(path);
+            mPcmCache.add(path);
             return decoder;
         }
         catch (std::exception& e)
@@ -188,6 +271,49 @@ namespace MWSound
         return nullptr;
     }
 
+    void SoundManager::clearPreloadedVoices()
+    {
+        for (const osg::ref_ptr<PreloadVoiceWorkItem>& item : mPreloadedVoices)
+        {
+            if (!item->tryStart())
+                item->waitTillDone();
+        }
+        mPreloadedVoices.clear();
+    }
+
+    void SoundManager::preloadVoice(VFS::Path::NormalizedView filename)
+    {
+        if (!mOutput->isInitialized() || !mDecodeQueue)
+            return;
+
+        for (const osg::ref_ptr<PreloadVoiceWorkItem>& item : mPreloadedVoices)
+        {
+            if (item->getPath() == filename)
+                return;
+        }
+
+        // An opened decoder keeps its file open, only keep a few of them around. The oldest one is dropped without
+        // waiting: unless a worker thread has started opening it, it's never opened. Otherwise the file is closed
+        // when the work queue releases the item.
+        if (mPreloadedVoices.size() >= sMaxPreloadedVoices)
+        {
+            mPreloadedVoices.back()->tryStart();
+            mPreloadedVoices.pop_back();
+        }
+
+        osg::ref_ptr<PreloadVoiceWorkItem> item = new PreloadVoiceWorkItem(getDecoder(), filename, mPcmCache);
+        mDecodeQueue->addWorkItem(item);
+        mPreloadedVoices.push_front(std::move(item));
+    }
+
+    void SoundManager::preloadSound(const ESM::RefId& soundId)
+    {
+        if (!mOutput->isInitialized())
+            return;
+
+        mSoundBuffers.preload(soundId);
+    }
+
     SoundPtr SoundManager::getSoundRef()
     {
         return mSounds.get();
@@ -263,15 +389,20 @@ namespace MWSound
 
         Log(Debug::Info) << "Playing \"" << filename << "\"";
 
-        DecoderPtr decoder = getDecoder();
-        try
-        {
-            decoder->open(filename);
-        }
-        catch (const std::exception& e)
+        DecoderPtr decoder = mPcmCache.open(filename);
+        if (decoder == nullptr)
         {
-            Log(Debug::Error) << "Failed to load audio from \"" << filename << "\": " << e.what();
-            return;
+            decoder = getDecoder();
+            try
+            {
+                decoder->open(filename);
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to load audio from \"" << filename << "\": " << e.what();
+                return;
+            }
+            mPcmCache.add(filename);
         }
 
         mMusic = getStreamRef();
@@ -1094,6 +1225,8 @@ namespace MWSound
                 streamMusic(MWSound::titleMusic, MWSound::MusicType::Normal);
         }
 
+        mSoundBuffers.update();
+
         updateSounds(duration);
         if (state != MWBase::StateManager::State_NoGame)
         {
@@ -1282,6 +1415,7 @@ namespace MWSound
         for (StreamPtr& sound : mActiveTracks)
             mOutput->finishStream(sound.get());
         mActiveTracks.clear();
+        clearPreloadedVoices();
         mPlaybackPaused = false;
         std::fill(std::begin(mPausedSoundTypes), std::end(mPausedSoundTypes), 0);
     }
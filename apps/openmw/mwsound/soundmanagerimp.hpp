@@ -1,12 +1,16 @@
 #ifndef GAME_SOUND_SOUNDMANAGER_H
 #define GAME_SOUND_SOUNDMANAGER_H
 
+#include <deque>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
+#include <osg/ref_ptr>
+
 #include <components/fallback/fallback.hpp>
 #include <components/misc/objectpool.hpp>
 #include <components/misc/strings/algorithm.hpp>
@@ -14,6 +18,7 @@
 
 #include "../mwbase/soundmanager.hpp"
 
+#include "pcmcache.hpp"
 #include "regionsoundselector.hpp"
 #include "sound_buffer.hpp"
 #include "type.hpp"
@@ -24,6 +29,11 @@ namespace VFS
     class Manager;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace ESM
 {
     struct Sound;
@@ -54,8 +64,20 @@ namespace MWSound
 
         WaterSoundUpdater mWaterSoundUpdater;
 
+        osg::ref_ptr<SceneUtil::WorkQueue> mDecodeQueue;
+
+        // Decoding whole files into the cache must not hold up the preloads of mDecodeQueue
+        osg::ref_ptr<SceneUtil::WorkQueue> mCacheQueue;
+
         SoundBufferPool mSoundBuffers;
 
+        PcmCache mPcmCache;
+
+        class PreloadVoiceWorkItem;
+
+        // Front-newest
+        std::deque<osg::ref_ptr<PreloadVoiceWorkItem>> mPreloadedVoices;
+
         Misc::ObjectPool<Sound> mSounds;
 
         Misc::ObjectPool<Stream> mStreams;
@@ -114,6 +136,8 @@ namespace MWSound
         // returns a decoder to start streaming, or nullptr if the sound was not found
         DecoderPtr loadVoice(VFS::Path::NormalizedView voicefile);
 
+        void clearPreloadedVoices();
+
         SoundPtr getSoundRef();
         StreamPtr getStreamRef();
 
@@ -158,7 +182,8 @@ namespace MWSound
         ///< Stop the given object from playing given sound buffer.
 
     public:
-        SoundManager(const VFS::Manager* vfs, bool useSound);
+        /// @param streamCachePath directory of the cache of decoded music and voices, disabled if empty
+        SoundManager(const VFS::Manager* vfs, bool useSound, const std::filesystem::path& streamCachePath);
         ~SoundManager() override;
 
         void processChangedSettings(const Settings::CategorySettingVector& settings) override;
@@ -202,6 +227,12 @@ namespace MWSound
         /// and get an average loudness value (scale [0,1]) at the current time position.
         /// If the actor is not saying anything, returns 0.
 
+        void preloadVoice(VFS::Path::NormalizedView filename) override;
+        ///< Open a voice file in the background for an upcoming say()
+
+        void preloadSound(const ESM::RefId& soundId) override;
+        ///< Decode a sound in the background for an upcoming playSound()
+
         Stream* playTrack(const DecoderPtr& decoder, Type type) override;
         ///< Play a 2D audio track, using a custom decoder
 
@@ -95,6 +95,10 @@ MWState::Character::Character(const std::filesystem::path& saves, const std::str
     {
         for (const auto& iter : std::filesystem::directory_iterator(mPath))
         {
+            // Leftover of an interrupted save file write
+            if (iter.path().extension() == ".tmp")
+                continue;
+
             try
             {
                 addSlot(iter, game);
@@ -1,11 +1,14 @@
 #include "statemanagerimp.hpp"
 
+#include <chrono>
 #include <filesystem>
+#include <fstream>
 
 #include <SDL_clipboard.h>
 
 #include <components/debug/debuglog.hpp>
 
+#include <components/esm3/compressedstream.hpp>
 #include <components/esm3/esmreader.hpp>
 #include <components/esm3/esmwriter.hpp>
 #include <components/esm3/loadcell.hpp>
@@ -49,6 +52,35 @@
 
 #include "quicksavemanager.hpp"
 
+namespace
+{
+    // Write to a temporary file first and replace the destination only once everything is on disk, so a failed
+    // write never trashes an existing save file.
+    void writeSaveFile(const std::string& data, const std::filesystem::path& path, bool compress)
+    {
+        std::filesystem::path tempPath = path;
+        tempPath += ".tmp";
+
+        {
+            std::ofstream filestream(tempPath, std::ios::binary);
+            if (compress)
+                ESM::writeCompressedStream(data, filestream);
+            else
+                filestream.write(data.data(), static_cast<std::streamsize>(data.size()));
+            filestream.close();
+
+            if (filestream.fail())
+            {
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                throw std::runtime_error("Write operation failed (file stream)");
+            }
+        }
+
+        std::filesystem::rename(tempPath, path);
+    }
+}
+
 void MWState::StateManager::cleanup(bool force)
 {
     if (mState != State_NoGame || force)
@@ -107,6 +139,65 @@ MWState::StateManager::StateManager(const std::filesystem::path& saves, const st
 {
 }
 
+MWState::StateManager::~StateManager()
+{
+    if (!mPendingSave.valid())
+        return;
+
+    try
+    {
+        mPendingSave.get();
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Error) << "Failed to save game: " << e.what();
+    }
+}
+
+void MWState::StateManager::finishPendingSave(bool wait)
+{
+    if (!mPendingSave.valid())
+        return;
+
+    if (!wait && mPendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    try
+    {
+        mPendingSave.get();
+    }
+    catch (const std::exception& e)
+    {
+        std::stringstream error;
+        error << "Failed to save game: " << e.what();
+
+        Log(Debug::Error) << error.str();
+
+        std::vector<std::string> buttons;
+        buttons.emplace_back("#{Interface:OK}");
+        MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
+
+        // If no file was written, clean up the slot
+        if (mPendingSaveCharacter != nullptr && !std::filesystem::exists(mPendingSavePath))
+        {
+            for (const Slot& slot : *mPendingSaveCharacter)
+            {
+                if (slot.mPath == mPendingSavePath)
+                {
+                    mPendingSaveCharacter->deleteSlot(&slot);
+                    mPendingSaveCharacter->cleanup();
+                    break;
+                }
+            }
+            if (mLastSavegame == mPendingSavePath)
+                mLastSavegame.clear();
+        }
+    }
+
+    mPendingSavePath.clear();
+    mPendingSaveCharacter = nullptr;
+}
+
 void MWState::StateManager::requestQuit()
 {
     mQuitRequest = true;
@@ -213,6 +304,9 @@ void MWState::StateManager::resumeGame()
 
 void MWState::StateManager::saveGame(std::string_view description, const Slot* slot)
 {
+    // Only one save file may be in flight at a time; slot bookkeeping below relies on it.
+    finishPendingSave(true);
+
     MWBase::Environment::get().getLuaManager()->applyDelayedActions();
 
     MWState::Character* character = getCurrentCharacter();
@@ -272,8 +366,8 @@ void MWState::StateManager::saveGame(std::string_view description, const Slot* s
 
         Log(Debug::Info) << "Writing saved game '" << description << "' for character '" << profile.mPlayerName << "'";
 
-        // Write to a memory stream first. If there is an exception during the save process, we don't want to trash the
-        // existing save file we are overwriting.
+        // Serialize to a memory stream first. This snapshot of the game state is all the background write needs, so the
+        // game can continue as soon as it is complete.
         std::stringstream stream;
 
         ESM::ESMWriter writer;
@@ -334,21 +428,33 @@ void MWState::StateManager::saveGame(std::string_view description, const Slot* s
         if (stream.fail())
             throw std::runtime_error("Write operation failed (memory stream)");
 
-        // All good, write to file
-        std::ofstream filestream(slot->mPath, std::ios::binary);
-        filestream << stream.rdbuf();
-
-        if (filestream.fail())
-            throw std::runtime_error("Write operation failed (file stream)");
-
         Settings::saves().mCharacter.set(Files::pathToUnicodeString(slot->mPath.parent_path().filename()));
         mLastSavegame = slot->mPath;
 
-        const auto finish = std::chrono::steady_clock::now();
+        const auto serialized = std::chrono::steady_clock::now();
 
-        Log(Debug::Info) << '\'' << description << "' is saved in "
-                         << std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(finish - start).count()
+        Log(Debug::Info) << '\'' << description << "' is serialized in "
+                         << std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(serialized - start)
+                                .count()
                          << "ms";
+
+        mPendingSavePath = slot->mPath;
+        mPendingSaveCharacter = character;
+        mPendingSave = std::async(std::launch::async,
+            [data = stream.str(), path = slot->mPath, description = std::string(description),
+                compress = Settings::saves().mCompress.get()] {
+                const auto writeStart = std::chrono::steady_clock::now();
+
+                writeSaveFile(data, path, compress);
+
+                const auto finish = std::chrono::steady_clock::now();
+
+                Log(Debug::Info) << '\'' << description << "' is written in "
+                                 << std::chrono::duration_cast<std::chrono::duration<float, std::milli>>(
+                                        finish - writeStart)
+                                        .count()
+                                 << "ms (" << data.size() << " bytes)";
+            });
     }
     catch (const std::exception& e)
     {
@@ -452,6 +558,8 @@ struct SaveVersionTooNewError : SaveFormatVersionError
 
 void MWState::StateManager::loadGame(const Character* character, const std::filesystem::path& filepath)
 {
+    finishPendingSave(true);
+
     try
     {
         cleanup();
@@ -705,6 +813,8 @@ void MWState::StateManager::quickLoad()
 
 void MWState::StateManager::deleteGame(const MWState::Character* character, const MWState::Slot* slot)
 {
+    finishPendingSave(true);
+
     const std::filesystem::path savePath = slot->mPath;
     mCharacterManager.deleteSlot(character, slot);
     if (mLastSavegame == savePath)
@@ -735,6 +845,8 @@ void MWState::StateManager::update(float duration)
 {
     mTimePlayed += duration;
 
+    finishPendingSave(false);
+
     // Note: It would be nicer to trigger this from InputManager, i.e. the very beginning of the frame update.
     if (mAskLoadRecent)
     {
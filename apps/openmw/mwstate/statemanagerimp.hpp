@@ -2,6 +2,7 @@
 #define GAME_STATE_STATEMANAGER_H
 
 #include <filesystem>
+#include <future>
 #include <map>
 
 #include "../mwbase/statemanager.hpp"
@@ -21,6 +22,11 @@ namespace MWState
         double mTimePlayed;
         std::filesystem::path mLastSavegame;
 
+        // Saved game data is serialized on the main thread and written to disk by a background task
+        std::future<void> mPendingSave;
+        std::filesystem::path mPendingSavePath;
+        Character* mPendingSaveCharacter = nullptr;
+
     private:
         void cleanup(bool force = false);
 
@@ -32,9 +38,16 @@ namespace MWState
 
         std::map<int, int> buildContentFileIndexMap(const ESM::ESMReader& reader) const;
 
+        void finishPendingSave(bool wait);
+        ///< Report the result of the background save file write, if it has completed.
+        ///
+        /// \param wait Block until the pending write (if any) is complete.
+
     public:
         StateManager(const std::filesystem::path& saves, const std::vector<std::string>& contentFiles);
 
+        ~StateManager() override;
+
         void requestQuit() override;
 
         bool hasQuitRequest() const override;
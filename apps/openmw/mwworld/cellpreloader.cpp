@@ -16,6 +16,7 @@
 #include <components/misc/strings/lower.hpp>
 #include <components/resource/bulletshapemanager.hpp>
 #include <components/resource/keyframemanager.hpp>
+#include <components/resource/memoryusage.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/terrain/view.hpp>
@@ -145,8 +146,17 @@ namespace MWWorld
                                         << e.what();
                 }
             }
+
+            Resource::MemoryUsage usage;
+            for (const osg::ref_ptr<const osg::Object>& object : mPreloadedObjects)
+                if (object != nullptr)
+                    usage.add(*object);
+            mMemoryUsage = usage.getBytes();
         }
 
+        /// Approximate size of the preloaded resources in bytes, valid when the item is done.
+        std::size_t getMemoryUsage() const { return mMemoryUsage; }
+
     private:
         bool mIsExterior;
         ESM::ExteriorCellLocation mCellLocation;
@@ -160,6 +170,7 @@ namespace MWWorld
         bool mPreloadInstances;
 
         std::atomic<bool> mAbort;
+        std::atomic<std::size_t> mMemoryUsage{ 0 };
 
         osg::ref_ptr<Terrain::View> mTerrainView;
 
@@ -230,14 +241,16 @@ namespace MWWorld
         , mLastResourceCacheUpdate(0.0)
         , mLoadedTerrainTimestamp(0.0)
     {
+        mResourceSystem->setMemoryPressureCallback([this](std::size_t /*bytes*/) { mMemoryPressure = true; });
     }
 
     CellPreloader::~CellPreloader()
     {
         clearAllTasks();
+        mResourceSystem->setMemoryPressureCallback({});
     }
 
-    void CellPreloader::preload(CellStore& cell, double timestamp)
+    void CellPreloader::preload(CellStore& cell, double timestamp, std::size_t rank)
     {
         if (!mWorkQueue)
         {
@@ -253,44 +266,64 @@ namespace MWWorld
         PreloadMap::iterator found = mPreloadCells.find(&cell);
         if (found != mPreloadCells.end())
         {
-            // already preloaded, nothing to do other than updating the timestamp
-            found->second.mTimeStamp = timestamp;
+            // already preloaded, nothing to do other than updating the timestamp and rank
+            PreloadEntry& entry = found->second;
+            if (entry.mTimeStamp < timestamp)
+                entry.mRank = rank;
+            else
+                entry.mRank = std::min(entry.mRank, rank);
+            entry.mTimeStamp = timestamp;
             return;
         }
 
-        while (mPreloadCells.size() >= mMaxCacheSize)
+        while (mPreloadCells.size() >= mMaxCacheSize || (mMaxCacheMemory != 0 && getCacheMemory() >= mMaxCacheMemory))
         {
-            // throw out oldest cell to make room
-            PreloadMap::iterator oldestCell = mPreloadCells.begin();
-            double oldestTimestamp = std::numeric_limits<double>::max();
-            double threshold = 1.0; // seconds
+            // throw out the cell least likely to be entered to make room: the oldest of the ones not requested
+            // anymore, otherwise the lowest ranked one
+            PreloadMap::iterator evictedCell = mPreloadCells.end();
             for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end(); ++it)
             {
-                if (it->second.mTimeStamp < oldestTimestamp)
+                if (evictedCell == mPreloadCells.end())
+                    evictedCell = it;
+                else if (it->second.mTimeStamp != evictedCell->second.mTimeStamp)
                 {
-                    oldestTimestamp = it->second.mTimeStamp;
-                    oldestCell = it;
+                    if (it->second.mTimeStamp < evictedCell->second.mTimeStamp)
+                        evictedCell = it;
                 }
+                else if (it->second.mRank > evictedCell->second.mRank)
+                    evictedCell = it;
             }
 
-            if (oldestTimestamp + threshold < timestamp)
-            {
-                oldestCell->second.mWorkItem->abort();
-                mPreloadCells.erase(oldestCell);
-                ++mEvicted;
-            }
-            else
+            if (evictedCell == mPreloadCells.end()
+                || (evictedCell->second.mTimeStamp >= timestamp && evictedCell->second.mRank <= rank))
                 return;
+
+            evictedCell->second.mWorkItem->abort();
+            mPreloadCells.erase(evictedCell);
+            ++mEvicted;
         }
 
         osg::ref_ptr<PreloadItem> item(new PreloadItem(&cell, mResourceSystem->getSceneManager(), mBulletShapeManager,
             mResourceSystem->getKeyframeManager(), mTerrain, mLandManager, mPreloadInstances));
         mWorkQueue->addWorkItem(item);
 
-        mPreloadCells.emplace(&cell, PreloadEntry(timestamp, item));
+        mPreloadCells.emplace(&cell, PreloadEntry(timestamp, rank, item));
         ++mAdded;
     }
 
+    void CellPreloader::preload(std::span<CellStore* const> cells, double timestamp)
+    {
+        for (std::size_t rank = 0; rank < cells.size(); ++rank)
+        {
+            const PreloadMap::iterator found = mPreloadCells.find(cells[rank]);
+            if (found != mPreloadCells.end())
+                preload(*cells[rank], timestamp, rank);
+        }
+
+        for (std::size_t rank = 0; rank < cells.size(); ++rank)
+            preload(*cells[rank], timestamp, rank);
+    }
+
     void CellPreloader::notifyLoaded(CellStore* cell)
     {
         PreloadMap::iterator found = mPreloadCells.find(cell);
@@ -323,6 +356,28 @@ namespace MWWorld
 
     void CellPreloader::updateCache(double timestamp)
     {
+        if (mMemoryPressure.exchange(false))
+        {
+            // Resource caches are over the limit, release the cells that are not requested anymore so their resources
+            // can be evicted
+            const double threshold = 1.0; // seconds
+            for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();)
+            {
+                if (it->second.mTimeStamp + threshold < timestamp)
+                {
+                    if (it->second.mWorkItem)
+                    {
+                        it->second.mWorkItem->abort();
+                        it->second.mWorkItem = nullptr;
+                    }
+                    mPreloadCells.erase(it++);
+                    ++mEvicted;
+                }
+                else
+                    ++it;
+            }
+        }
+
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();)
         {
             if (mPreloadCells.size() >= mMinCacheSize && it->second.mTimeStamp < timestamp - mExpiryDelay)
@@ -457,6 +512,23 @@ namespace MWWorld
         mPreloadCells.clear();
     }
 
+    std::size_t CellPreloader::getCacheMemory() const
+    {
+        std::size_t loadedMemory = 0;
+        std::size_t loadedCount = 0;
+        for (const auto& [cell, entry] : mPreloadCells)
+        {
+            if (entry.mWorkItem == nullptr || !entry.mWorkItem->isDone())
+                continue;
+            loadedMemory += static_cast<const PreloadItem&>(*entry.mWorkItem).getMemoryUsage();
+            ++loadedCount;
+        }
+        if (loadedCount == 0)
+            return 0;
+        // Cells still being preloaded are expected to be of average size
+        return loadedMemory + loadedMemory / loadedCount * (mPreloadCells.size() - loadedCount);
+    }
+
     void CellPreloader::reportStats(unsigned int frameNumber, osg::Stats& stats) const
     {
         stats.setAttribute(frameNumber, "CellPreloader Count", mPreloadCells.size());
@@ -464,5 +536,6 @@ namespace MWWorld
         stats.setAttribute(frameNumber, "CellPreloader Evicted", mEvicted);
         stats.setAttribute(frameNumber, "CellPreloader Loaded", mLoaded);
         stats.setAttribute(frameNumber, "CellPreloader Expired", mExpired);
+        stats.setAttribute(frameNumber, "CellPreloader Memory", getCacheMemory());
     }
 }
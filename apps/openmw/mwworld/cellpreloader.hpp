@@ -7,6 +7,7 @@
 
 #include <osg/ref_ptr>
 
+#include <atomic>
 #include <map>
 #include <span>
 
@@ -50,8 +51,14 @@ namespace MWWorld
         ~CellPreloader();
 
         /// Ask a background thread to preload rendering meshes and collision shapes for objects in this cell.
+        /// @param rank Position of the cell among the ones requested at \a timestamp, the lower the more likely it is
+        /// entered. A full cache first evicts the cells not requested at \a timestamp, then the ones ranked lower.
         /// @note The cell itself must be in State_Loaded or State_Preloaded.
-        void preload(MWWorld::CellStore& cell, double timestamp);
+        void preload(MWWorld::CellStore& cell, double timestamp, std::size_t rank = 0);
+
+        /// Same as preload for each of \a cells, ranked by their order. The cells already in cache are updated first,
+        /// so they are not evicted to make room for the ones ranked higher than them.
+        void preload(std::span<MWWorld::CellStore* const> cells, double timestamp);
 
         void notifyLoaded(MWWorld::CellStore* cell);
 
@@ -69,6 +76,10 @@ namespace MWWorld
         /// The maximum number of preloaded cells.
         void setMaxCacheSize(std::size_t value) { mMaxCacheSize = value; }
 
+        /// The maximum size of resources kept by preloaded cells in bytes, 0 means no limit. Cells are requested in
+        /// order of priority, so the ones that don't fit are the least likely to be entered.
+        void setMaxCacheMemory(std::size_t value) { mMaxCacheMemory = value; }
+
         /// Enables the creation of instances in the preloading thread.
         void setPreloadInstances(bool preload);
 
@@ -76,6 +87,10 @@ namespace MWWorld
 
         std::size_t getCacheSize() const { return mPreloadCells.size(); }
 
+        /// Approximate size of resources kept by preloaded cells in bytes. The cells still being preloaded are
+        /// counted with the average size of the already preloaded ones.
+        std::size_t getCacheMemory() const;
+
         void setWorkQueue(osg::ref_ptr<SceneUtil::WorkQueue> workQueue);
 
         void setTerrainPreloadPositions(std::span<const PositionCellGrid> positions);
@@ -98,23 +113,28 @@ namespace MWWorld
         double mExpiryDelay;
         std::size_t mMinCacheSize = 0;
         std::size_t mMaxCacheSize = 0;
+        std::size_t mMaxCacheMemory = 0;
         bool mPreloadInstances;
 
         double mLastResourceCacheUpdate;
 
         struct PreloadEntry
         {
-            PreloadEntry(double timestamp, osg::ref_ptr<SceneUtil::WorkItem> workItem)
+            PreloadEntry(double timestamp, std::size_t rank, osg::ref_ptr<SceneUtil::WorkItem> workItem)
                 : mTimeStamp(timestamp)
+                , mRank(rank)
                 , mWorkItem(std::move(workItem))
             {
             }
             PreloadEntry()
                 : mTimeStamp(0.0)
+                , mRank(0)
             {
             }
 
             double mTimeStamp;
+            // Best rank the cell was requested with at mTimeStamp
+            std::size_t mRank;
             osg::ref_ptr<SceneUtil::WorkItem> mWorkItem;
         };
         typedef std::map<const MWWorld::CellStore*, PreloadEntry> PreloadMap;
@@ -133,6 +153,8 @@ namespace MWWorld
         std::size_t mAdded = 0;
         std::size_t mExpired = 0;
         std::size_t mLoaded = 0;
+        // Set from the thread updating resource caches
+        std::atomic_bool mMemoryPressure = false;
     };
 
 }
@@ -0,0 +1,98 @@
+#include "cellpreloadplanner.hpp"
+
+#include <algorithm>
+
+#include <components/misc/constants.hpp>
+
+namespace MWWorld
+{
+    namespace
+    {
+        // About the walking speed of a new character. Used when the player stands still or moves away from a target.
+        constexpr float minSpeed = 100;
+        // Expected time to reach a recently visited cell is multiplied by this factor
+        constexpr float historyFactor = 0.5f;
+        // How fast the smoothed velocity follows the actual one, per second
+        constexpr float velocitySmoothing = 4;
+    }
+
+    float getPreloadTime(const PlayerMotion& motion, const osg::Vec3f& target, float extraDistance)
+    {
+        osg::Vec3f toTarget = target - motion.mPosition;
+        osg::Vec3f velocity = motion.mVelocity;
+        if (!motion.mFlying)
+        {
+            // Walking player follows the ground, so only the horizontal movement tells where it goes
+            toTarget.z() = 0;
+            velocity.z() = 0;
+        }
+        const float distance = toTarget.length();
+        float speed = minSpeed;
+        if (distance > 0)
+            speed = std::max(speed, velocity * toTarget / distance);
+        return (distance + extraDistance) / speed;
+    }
+
+    CellPreloadPlanner::CellPreloadPlanner(std::size_t historySize)
+        : mHistorySize(historySize)
+    {
+    }
+
+    void CellPreloadPlanner::update(const osg::Vec3f& position, const osg::Vec3f& moved, float duration, bool flying)
+    {
+        mMotion.mPosition = position;
+        mMotion.mFlying = flying;
+
+        if (duration <= 0)
+            return;
+
+        // Teleportation is not a movement
+        if (moved.length2() > Constants::CellSizeInUnits * Constants::CellSizeInUnits)
+        {
+            mMotion.mVelocity = osg::Vec3f();
+            return;
+        }
+
+        const float weight = std::min(1.0f, duration * velocitySmoothing);
+        mMotion.mVelocity = mMotion.mVelocity * (1 - weight) + moved * (weight / duration);
+    }
+
+    void CellPreloadPlanner::notifyCellVisited(const CellStore& cell)
+    {
+        const auto it = std::find(mHistory.begin(), mHistory.end(), &cell);
+        if (it != mHistory.end())
+            mHistory.erase(it);
+        mHistory.push_back(&cell);
+        while (mHistory.size() > mHistorySize)
+            mHistory.pop_front();
+    }
+
+    void CellPreloadPlanner::addCandidate(CellStore& cell, const osg::Vec3f& target, float extraDistance)
+    {
+        float time = getPreloadTime(mMotion, target, extraDistance);
+        if (isVisitedRecently(cell))
+            time *= historyFactor;
+        mCandidates.push_back(Candidate{ time, &cell });
+    }
+
+    std::vector<CellStore*> CellPreloadPlanner::takeRankedCells()
+    {
+        std::stable_sort(mCandidates.begin(), mCandidates.end(),
+            [](const Candidate& lhs, const Candidate& rhs) { return lhs.mTime < rhs.mTime; });
+
+        std::vector<CellStore*> result;
+        result.reserve(mCandidates.size());
+        for (const Candidate& candidate : mCandidates)
+            if (std::find(result.begin(), result.end(), candidate.mCell) == result.end())
+                result.push_back(candidate.mCell);
+
+        mCandidates.clear();
+
+        return result;
+    }
+
+    bool CellPreloadPlanner::isVisitedRecently(const CellStore& cell) const
+    {
+        return std::find(mHistory.begin(), mHistory.end(), &cell) != mHistory.end();
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef OPENMW_APPS_OPENMW_MWWORLD_CELLPRELOADPLANNER_H
+#define OPENMW_APPS_OPENMW_MWWORLD_CELLPRELOADPLANNER_H
+
+#include <osg/Vec3f>
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace MWWorld
+{
+    class CellStore;
+
+    struct PlayerMotion
+    {
+        osg::Vec3f mPosition;
+        osg::Vec3f mVelocity;
+        // Flying, levitating or swimming player can move in a straight line to any point
+        bool mFlying = false;
+    };
+
+    /// Estimate in seconds how soon the player moving with \a motion reaches \a target. \a extraDistance is added to
+    /// the distance to the target, for example, the distance from a door destination to the cell to preload.
+    float getPreloadTime(const PlayerMotion& motion, const osg::Vec3f& target, float extraDistance);
+
+    /// Ranks the cells to preload by how soon the player is expected to enter them. The cells visited recently are
+    /// preferred because the player often goes back, for example, leaving an interior through the same door.
+    class CellPreloadPlanner
+    {
+    public:
+        explicit CellPreloadPlanner(std::size_t historySize);
+
+        void update(const osg::Vec3f& position, const osg::Vec3f& moved, float duration, bool flying);
+        ///< Update the player motion. The velocity is smoothed to not depend on single frame jitter.
+
+        void notifyCellVisited(const CellStore& cell);
+
+        void addCandidate(CellStore& cell, const osg::Vec3f& target, float extraDistance = 0);
+        ///< Add \a cell that the player can reach through \a target, for example, a door or a cell center.
+
+        std::vector<CellStore*> takeRankedCells();
+        ///< Return the candidates without duplicates starting from the one the player is expected to reach first.
+
+        const PlayerMotion& getMotion() const { return mMotion; }
+
+    private:
+        struct Candidate
+        {
+            float mTime;
+            CellStore* mCell;
+        };
+
+        std::size_t mHistorySize;
+        PlayerMotion mMotion;
+        std::deque<const CellStore*> mHistory;
+        std::vector<Candidate> mCandidates;
+
+        bool isVisitedRecently(const CellStore& cell) const;
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #include "magiceffects.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <fstream>
 
 #include <components/debug/debuglog.hpp>
@@ -68,6 +69,7 @@
 #include <components/esm4/loadweap.hpp>
 #include <components/esm4/readerutils.hpp>
 
+#include <components/files/memorystream.hpp>
 #include <components/files/openfile.hpp>
 #include <components/misc/tuplehelpers.hpp>
 #include <components/resource/resourcesystem.hpp>
@@ -348,6 +350,40 @@ namespace
         }
         return true;
     }
+
+    void openSavedReferences(
+        ESM::ESMReader& reader, const MWWorld::SavedGameContext& context, const std::vector<char>& data)
+    {
+        reader.openRecordData(std::make_unique<Files::IMemStream>(data.data(), data.size()), context.mFileName,
+            context.mFormatVersion);
+        reader.setContentFileMapping(&context.mContentFileMapping);
+    }
+
+    // Returns false if there are moved reference tags, which can only be resolved together with other cells
+    bool listSavedReferences(ESM::ESMReader& reader, std::vector<ESM::RefId>& ids, std::vector<ESM::RefNum>& refNums)
+    {
+        while (reader.isNextSub("OBJE"))
+        {
+            unsigned int unused;
+            reader.getHT(unused);
+
+            ESM::CellRef cref;
+            cref.loadId(reader, true);
+            ids.push_back(cref.mRefID);
+            // The references of removed content files are dropped when read
+            if (cref.mRefNum.isSet() && reader.applyContentFileMapping(cref.mRefNum))
+                refNums.push_back(cref.mRefNum);
+
+            // Skip until the next OBJE or MVRF
+            while (reader.hasMoreSubs() && !reader.peekNextSub("OBJE") && !reader.peekNextSub("MVRF"))
+            {
+                reader.getSubName();
+                reader.skipHSub();
+            }
+        }
+
+        return !reader.isNextSub("MVRF");
+    }
 }
 
 namespace MWWorld
@@ -758,6 +794,9 @@ namespace MWWorld
             loadRefs();
 
             mState = State_Loaded;
+
+            if (mDeferredReferences != nullptr)
+                readDeferredReferences();
         }
     }
 
@@ -852,6 +891,8 @@ namespace MWWorld
     void CellStore::listRefs()
     {
         ESM::visit([&](auto&& cell) { listRefs(cell); }, mCellVariant);
+        if (mDeferredReferences != nullptr)
+            mIds.insert(mIds.end(), mDeferredReferences->mIds.begin(), mDeferredReferences->mIds.end());
         std::sort(mIds.begin(), mIds.end());
     }
 
@@ -1071,6 +1112,10 @@ namespace MWWorld
             writer.writeFormId(refNum, true, "MVRF");
             writer.writeCellId(movedTo);
         }
+
+        // Nothing can change the deferred references without reading them
+        if (mDeferredReferences != nullptr)
+            writer.write(mDeferredReferences->mData.data(), mDeferredReferences->mData.size());
     }
 
     void CellStore::readReferences(ESM::ESMReader& reader, GetCellStoreCallback* callback)
@@ -1137,6 +1182,7 @@ namespace MWWorld
                 continue;
             }
 
+            assert(callback != nullptr);
             CellStore* otherCell = callback->getCellStore(movedToId);
 
             if (otherCell == nullptr)
@@ -1163,6 +1209,70 @@ namespace MWWorld
         requestMergedRefsUpdate();
     }
 
+    void CellStore::readReferences(
+        std::shared_ptr<const SavedGameContext> context, std::vector<char>&& data, GetCellStoreCallback* callback)
+    {
+        auto deferred = std::make_unique<DeferredReferences>();
+        deferred->mContext = std::move(context);
+        deferred->mData = std::move(data);
+
+        ESM::ESMReader reader;
+        openSavedReferences(reader, *deferred->mContext, deferred->mData);
+
+        if (mState != State_Loaded && mDeferredReferences == nullptr
+            && listSavedReferences(reader, deferred->mIds, deferred->mRefNums))
+        {
+            mHasState = true;
+            if (mState == State_Preloaded)
+            {
+                mIds.insert(mIds.end(), deferred->mIds.begin(), deferred->mIds.end());
+                std::sort(mIds.begin(), mIds.end());
+            }
+            mDeferredReferences = std::move(deferred);
+            return;
+        }
+
+        openSavedReferences(reader, *deferred->mContext, deferred->mData);
+        if (mState != State_Loaded)
+            load();
+        readReferences(reader, callback);
+    }
+
+    const std::vector<ESM::RefNum>& CellStore::getDeferredRefNums() const
+    {
+        static const std::vector<ESM::RefNum> empty;
+        return mDeferredReferences != nullptr ? mDeferredReferences->mRefNums : empty;
+    }
+
+    bool CellStore::canWriteDeferredReferences() const
+    {
+        return mDeferredReferences != nullptr && mDeferredReferences->mContext->mWritable
+            && mDeferredReferences->mRestHours <= 0 && mDeferredReferences->mRechargeDuration <= 0;
+    }
+
+    void CellStore::readDeferredReferences()
+    {
+        const std::unique_ptr<DeferredReferences> deferred = std::move(mDeferredReferences);
+
+        try
+        {
+            ESM::ESMReader reader;
+            openSavedReferences(reader, *deferred->mContext, deferred->mData);
+            readReferences(reader, nullptr);
+        }
+        catch (const std::exception& e)
+        {
+            // A saved game failing to read is not loaded, it's only found later here
+            throw std::runtime_error("Failed to read saved references for cell "
+                + std::string(getCell()->getDescription()) + ": " + e.what());
+        }
+
+        // Catch up with what happened to the references while the cell was not loaded
+        if (deferred->mRestHours > 0)
+            rest(deferred->mRestHours);
+        recharge(deferred->mRechargeDuration);
+    }
+
     void CellStore::setFog(std::unique_ptr<ESM::FogState>&& fog)
     {
         mFogState = std::move(fog);
@@ -1188,6 +1298,9 @@ namespace MWWorld
 
     void CellStore::rest(double hours)
     {
+        if (mDeferredReferences != nullptr)
+            mDeferredReferences->mRestHours += hours;
+
         if (mState == State_Loaded)
         {
             for (MWWorld::LiveCellRef<ESM::Creature>& creature : get<ESM::Creature>().mList)
@@ -1214,6 +1327,9 @@ namespace MWWorld
         if (duration <= 0)
             return;
 
+        if (mDeferredReferences != nullptr)
+            mDeferredReferences->mRechargeDuration += duration;
+
         if (mState == State_Loaded)
         {
             for (MWWorld::LiveCellRef<ESM::Creature>& creature : get<ESM::Creature>().mList)
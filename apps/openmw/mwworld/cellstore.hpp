@@ -2,6 +2,7 @@
 #define GAME_MWWORLD_CELLSTORE_H
 
 #include <algorithm>
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -17,6 +18,7 @@
 
 #include <components/esm/refid.hpp>
 #include <components/esm3/fogstate.hpp>
+#include <components/esm3/formatversion.hpp>
 #include <components/misc/tuplemeta.hpp>
 
 #include "ptr.hpp"
@@ -88,6 +90,17 @@ namespace MWWorld
     class ESMStore;
     struct CellStoreImp;
 
+    /// \brief Information about a saved game file required to read its records after the file is closed
+    struct SavedGameContext
+    {
+        std::filesystem::path mFileName;
+        ESM::FormatVersion mFormatVersion;
+        std::map<int, int> mContentFileMapping;
+        // The records can be written to a new saved game as they are: they have the current format and the content
+        // file indices don't change
+        bool mWritable = false;
+    };
+
     using CellStoreTuple = std::tuple<CellRefList<ESM::Activator>, CellRefList<ESM::Potion>,
         CellRefList<ESM::Apparatus>, CellRefList<ESM::Armor>, CellRefList<ESM::Book>, CellRefList<ESM::Clothing>,
         CellRefList<ESM::Container>, CellRefList<ESM::Creature>, CellRefList<ESM::Door>, CellRefList<ESM::Ingredient>,
@@ -336,6 +349,21 @@ namespace MWWorld
         /// references)
         void readReferences(ESM::ESMReader& reader, GetCellStoreCallback* callback);
 
+        /// Same as readReferences, but keeps the references in serialized form until the cell is loaded, unless the
+        /// cell is already loaded or the references contain moved reference tags.
+        /// @param data Remaining data of the cell state record, as returned by ESM::ESMReader::getRemainingRecordData
+        void readReferences(std::shared_ptr<const SavedGameContext> context, std::vector<char>&& data,
+            GetCellStoreCallback* callback);
+
+        bool hasDeferredReferences() const { return mDeferredReferences != nullptr; }
+
+        /// RefNums of the references kept in serialized form, empty if there are none
+        const std::vector<ESM::RefNum>& getDeferredRefNums() const;
+
+        /// @return true if the references kept in serialized form can be written by writeReferences without reading
+        /// them. They can't once the cell has rested or recharged, which only applies to read references.
+        bool canWriteDeferredReferences() const;
+
         void respawn();
         ///< Check mLastRespawn and respawn references if necessary. This is a no-op if the cell is not loaded.
 
@@ -362,6 +390,19 @@ namespace MWWorld
 
         MWWorld::TimeStamp mLastRespawn;
 
+        // References read from a saved game which are not added to this cell until it is loaded
+        struct DeferredReferences
+        {
+            std::shared_ptr<const SavedGameContext> mContext;
+            std::vector<char> mData;
+            std::vector<ESM::RefId> mIds;
+            std::vector<ESM::RefNum> mRefNums;
+            double mRestHours = 0;
+            float mRechargeDuration = 0;
+        };
+
+        std::unique_ptr<DeferredReferences> mDeferredReferences;
+
         template <typename T>
         static constexpr std::size_t getTypeIndex()
         {
@@ -414,6 +455,8 @@ namespace MWWorld
 
         bool mRechargingItemsUpToDate;
 
+        void readDeferredReferences();
+
         void updateRechargingItems();
         void rechargeItems(float duration);
         void checkItem(const Ptr& ptr);
@@ -1,5 +1,6 @@
 #include "scene.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <limits>
@@ -105,8 +106,16 @@ namespace
     // TODO: find a more clever way to make paging exclusion more reliable?
     static osg::ref_ptr<SceneUtil::PositionAttitudeTransform> pagedNode = new SceneUtil::PositionAttitudeTransform;
 
+    template <class Function>
+    void measure(double& time, Function&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
     void addObject(const MWWorld::Ptr& ptr, const MWWorld::World& world, const std::vector<ESM::RefNum>& pagedRefs,
-        MWPhysics::PhysicsSystem& physics, MWRender::RenderingManager& rendering)
+        MWPhysics::PhysicsSystem& physics, MWRender::RenderingManager& rendering, MWWorld::CellActivationStats& stats)
     {
         if (ptr.getRefData().getBaseNode() || physics.getActor(ptr))
         {
@@ -117,26 +126,32 @@ namespace
         std::string model = getModel(ptr);
         const auto rotation = makeDirectNodeRotation(ptr);
 
-        ESM::RefNum refnum = ptr.getCellRef().getRefNum();
-        if (!refnum.hasContentFile() || !std::binary_search(pagedRefs.begin(), pagedRefs.end(), refnum))
-            ptr.getClass().insertObjectRendering(ptr, model, rendering);
-        else
-            ptr.getRefData().setBaseNode(pagedNode);
-        setNodeRotation(ptr, rendering, rotation);
+        measure(stats.mRendering, [&] {
+            ESM::RefNum refnum = ptr.getCellRef().getRefNum();
+            if (!refnum.hasContentFile() || !std::binary_search(pagedRefs.begin(), pagedRefs.end(), refnum))
+                ptr.getClass().insertObjectRendering(ptr, model, rendering);
+            else
+                ptr.getRefData().setBaseNode(pagedNode);
+            setNodeRotation(ptr, rendering, rotation);
+        });
 
         if (ptr.getClass().useAnim())
-            MWBase::Environment::get().getMechanicsManager()->add(ptr);
+            measure(stats.mMechanics, [&] { MWBase::Environment::get().getMechanicsManager()->add(ptr); });
 
-        if (ptr.getClass().isActor())
-            rendering.addWaterRippleEmitter(ptr);
+        measure(stats.mRendering, [&] {
+            if (ptr.getClass().isActor())
+                rendering.addWaterRippleEmitter(ptr);
 
-        // Restore effect particles
-        world.applyLoopingParticles(ptr);
+            // Restore effect particles
+            world.applyLoopingParticles(ptr);
+        });
 
         if (!model.empty())
-            ptr.getClass().insertObject(ptr, model, rotation, physics);
+            measure(stats.mPhysics, [&] { ptr.getClass().insertObject(ptr, model, rotation, physics); });
+
+        measure(stats.mLua, [&] { MWBase::Environment::get().getLuaManager()->objectAddedToScene(ptr); });
 
-        MWBase::Environment::get().getLuaManager()->objectAddedToScene(ptr);
+        ++stats.mActivated;
     }
 
     void addObject(const MWWorld::Ptr& ptr, const MWWorld::World& world, const MWPhysics::PhysicsSystem& physics,
@@ -260,6 +275,9 @@ namespace
         }
     }
 
+    // Number of recently visited cells preferred for preloading
+    constexpr std::size_t preloadHistorySize = 8;
+
     int getCellPositionDistanceToOrigin(const std::pair<int, int>& cellPosition)
     {
         return std::abs(cellPosition.first) + std::abs(cellPosition.second);
@@ -347,13 +365,17 @@ namespace MWWorld
 
     void Scene::update(float duration)
     {
+        mActivationStats = CellActivationStats{};
+
         if (mChangeCellGridRequest.has_value())
         {
             changeCellGrid(mChangeCellGridRequest->mPosition, mChangeCellGridRequest->mCellIndex,
-                mChangeCellGridRequest->mChangeEvent);
+                mChangeCellGridRequest->mChangeEvent, mActivationBudget > 0);
             mChangeCellGridRequest.reset();
         }
 
+        activatePendingObjects(mWorld.getPlayerPtr().getRefData().getPosition().asVec3(), mActivationBudget);
+
         mPreloader->updateCache(mRendering.getReferenceTime());
         preloadCells(duration);
     }
@@ -364,6 +386,9 @@ namespace MWWorld
             return;
         Log(Debug::Info) << "Unloading cell " << cell->getCell()->getDescription();
 
+        std::erase_if(mPendingObjects, [&](const PendingObject& object) { return object.mPtr.getCell() == cell; });
+        std::erase(mDeferredCells, cell);
+
         ListAndResetObjectsVisitor visitor;
 
         cell->forEach(visitor);
@@ -420,8 +445,8 @@ namespace MWWorld
             mRendering.notifyWorldSpaceChanged();
     }
 
-    void Scene::loadCell(CellStore& cell, Loading::Listener* loadingListener, bool respawn, const osg::Vec3f& position,
-        const DetourNavigator::UpdateGuard* navigatorUpdateGuard)
+    void Scene::loadCell(CellStore& cell, Loading::Listener* loadingListener, bool respawn, bool deferObjects,
+        const osg::Vec3f& position, const DetourNavigator::UpdateGuard* navigatorUpdateGuard)
     {
         using DetourNavigator::HeightfieldShape;
 
@@ -495,7 +520,7 @@ namespace MWWorld
         if (respawn)
             cell.respawn();
 
-        insertCell(cell, loadingListener, navigatorUpdateGuard);
+        insertCell(cell, loadingListener, deferObjects, position, navigatorUpdateGuard);
 
         mRendering.addCell(&cell);
 
@@ -526,7 +551,10 @@ namespace MWWorld
         if (!cell.isExterior() && !cellVariant.isQuasiExterior())
             mRendering.configureAmbient(cellVariant);
 
-        mPreloader->notifyLoaded(&cell);
+        if (std::find(mDeferredCells.begin(), mDeferredCells.end(), &cell) == mDeferredCells.end())
+            mPreloader->notifyLoaded(&cell);
+        else
+            mPreloader->preload(cell, mRendering.getReferenceTime());
     }
 
     void Scene::clear()
@@ -612,7 +640,8 @@ namespace MWWorld
             ESM::ExteriorCellLocation(cell.x(), cell.y(), mCurrentCell->getCell()->getWorldSpace()), changeEvent };
     }
 
-    void Scene::changeCellGrid(const osg::Vec3f& pos, ESM::ExteriorCellLocation playerCellIndex, bool changeEvent)
+    void Scene::changeCellGrid(
+        const osg::Vec3f& pos, ESM::ExteriorCellLocation playerCellIndex, bool changeEvent, bool deferObjects)
     {
         const int halfGridSize
             = isEsm4Ext(playerCellIndex.mWorldspace) ? Constants::ESM4CellGridRadius : Constants::CellGridRadius;
@@ -679,7 +708,7 @@ namespace MWWorld
             if (!isCellInCollection(indexToLoad, mActiveCells))
             {
                 CellStore& cell = mWorld.getWorldModel().getExterior(indexToLoad);
-                loadCell(cell, loadingListener, changeEvent, pos, navigatorUpdateGuard.get());
+                loadCell(cell, loadingListener, changeEvent, deferObjects, pos, navigatorUpdateGuard.get());
             }
         }
 
@@ -687,6 +716,9 @@ namespace MWWorld
 
         navigatorUpdateGuard.reset();
 
+        if (!deferObjects)
+            activatePendingObjects(pos, std::numeric_limits<double>::infinity());
+
         CellStore& current = mWorld.getWorldModel().getExterior(playerCellIndex);
         MWBase::Environment::get().getWindowManager()->changeCell(&current);
 
@@ -847,6 +879,7 @@ namespace MWWorld
     {
         mHalfGridSize = cell.getCell()->isEsm4() ? Constants::ESM4CellGridRadius : Constants::CellGridRadius;
         mCurrentCell = &cell;
+        mPreloadPlanner.notifyCellVisited(cell);
 
         mRendering.enableTerrain(cell.isExterior(), cell.getCell()->getWorldSpace());
 
@@ -895,6 +928,9 @@ namespace MWWorld
         , mPreloadFastTravel(Settings::cells().mPreloadFastTravel)
         , mPredictionTime(Settings::cells().mPredictionTime)
         , mLowestPoint(std::numeric_limits<float>::max())
+        , mActivationBudget(Settings::cells().mActivationTimeBudget / 1000.0)
+        , mImmediateActivationDistance(Settings::cells().mImmediateActivationDistance)
+        , mPreloadPlanner(preloadHistorySize)
     {
         mPreloader = std::make_unique<CellPreloader>(rendering.getResourceSystem(), physics->getShapeManager(),
             rendering.getTerrain(), rendering.getLandManager());
@@ -902,6 +938,7 @@ namespace MWWorld
         mPreloader->setExpiryDelay(Settings::cells().mPreloadCellExpiryDelay);
         mPreloader->setMinCacheSize(Settings::cells().mPreloadCellCacheMin);
         mPreloader->setMaxCacheSize(Settings::cells().mPreloadCellCacheMax);
+        mPreloader->setMaxCacheMemory(static_cast<std::size_t>(Settings::cells().mPreloadCellCacheMaxMemory) << 20);
         mPreloader->setPreloadInstances(Settings::cells().mPreloadInstances);
     }
 
@@ -966,7 +1003,7 @@ namespace MWWorld
 
         // Load cell.
         mPagedRefs.clear();
-        loadCell(cell, loadingListener, changeEvent, position.asVec3(), navigatorUpdateGuard.get());
+        loadCell(cell, loadingListener, changeEvent, false, position.asVec3(), navigatorUpdateGuard.get());
 
         navigatorUpdateGuard.reset();
 
@@ -1022,26 +1059,127 @@ namespace MWWorld
         mCellChanged = false;
     }
 
-    void Scene::insertCell(
-        CellStore& cell, Loading::Listener* loadingListener, const DetourNavigator::UpdateGuard* navigatorUpdateGuard)
+    void Scene::insertCell(CellStore& cell, Loading::Listener* loadingListener, bool deferObjects,
+        const osg::Vec3f& position, const DetourNavigator::UpdateGuard* navigatorUpdateGuard)
     {
         const bool isInterior = !cell.isExterior();
         InsertVisitor insertVisitor(cell, loadingListener);
         cell.forEach(insertVisitor);
-        insertVisitor.insert(
-            [&](const MWWorld::Ptr& ptr) { addObject(ptr, mWorld, mPagedRefs, *mPhysics, mRendering); });
+
+        if (deferObjects)
+        {
+            // Only objects close to the player are added right away, the rest is activated by update
+            const float immediateDistance2 = mImmediateActivationDistance * mImmediateActivationDistance;
+            const std::size_t pendingCount = mPendingObjects.size();
+            std::erase_if(insertVisitor.mToInsert, [&](const Ptr& ptr) {
+                const float distance2 = (ptr.getRefData().getPosition().asVec3() - position).length2();
+                if (distance2 <= immediateDistance2)
+                    return false;
+                mPendingObjects.push_back(PendingObject{ ptr, distance2 });
+                if (loadingListener != nullptr)
+                    loadingListener->increaseProgress(1);
+                return true;
+            });
+            if (mPendingObjects.size() != pendingCount)
+                mDeferredCells.push_back(&cell);
+        }
+
         insertVisitor.insert([&](const MWWorld::Ptr& ptr) {
-            addObject(ptr, mWorld, *mPhysics, mLowestPoint, isInterior, mNavigator, navigatorUpdateGuard);
+            addObject(ptr, mWorld, mPagedRefs, *mPhysics, mRendering, mActivationStats);
+        });
+        measure(mActivationStats.mNavigator, [&] {
+            insertVisitor.insert([&](const MWWorld::Ptr& ptr) {
+                addObject(ptr, mWorld, *mPhysics, mLowestPoint, isInterior, mNavigator, navigatorUpdateGuard);
+            });
         });
     }
 
+    void Scene::activatePendingObjects(const osg::Vec3f& position, double budget)
+    {
+        if (mPendingObjects.empty())
+            return;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // The player keeps moving, so the order is updated every time. The nearest objects go to the back.
+        for (PendingObject& object : mPendingObjects)
+            object.mDistance2 = (object.mPtr.getRefData().getPosition().asVec3() - position).length2();
+        std::sort(mPendingObjects.begin(), mPendingObjects.end(),
+            [](const PendingObject& lhs, const PendingObject& rhs) { return lhs.mDistance2 > rhs.mDistance2; });
+
+        const float immediateDistance2 = mImmediateActivationDistance * mImmediateActivationDistance;
+        const Resource::SceneManager& sceneManager = *mRendering.getResourceSystem()->getSceneManager();
+        auto navigatorUpdateGuard = mNavigator.makeUpdateGuard();
+        std::vector<PendingObject> compiling;
+
+        while (!mPendingObjects.empty())
+        {
+            const bool immediate = mPendingObjects.back().mDistance2 <= immediateDistance2;
+            if (!immediate && std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() >= budget)
+                break;
+
+            const PendingObject object = mPendingObjects.back();
+            const Ptr ptr = object.mPtr;
+            mPendingObjects.pop_back();
+
+            // The object could have been disabled, deleted or added to the scene by a script in the meantime
+            if (ptr.mRef->isDeleted() || !ptr.getRefData().isEnabled() || ptr.getRefData().getBaseNode() != nullptr)
+                continue;
+
+            // Wait until textures and vertex buffers of the model are uploaded within the compile time budget,
+            // otherwise the draw thread creates them all at once in the frame the object becomes visible
+            if (!immediate && sceneManager.isCompiling(getModel(ptr)))
+            {
+                compiling.push_back(object);
+                continue;
+            }
+
+            try
+            {
+                addObject(ptr, mWorld, mPagedRefs, *mPhysics, mRendering, mActivationStats);
+                measure(mActivationStats.mNavigator, [&] {
+                    addObject(ptr, mWorld, *mPhysics, mLowestPoint, false, mNavigator, navigatorUpdateGuard.get());
+                });
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "failed to render '" << ptr.getCellRef().getRefId() << "': " << e.what();
+            }
+        }
+
+        navigatorUpdateGuard.reset();
+
+        // Keep the nearest objects at the back
+        mPendingObjects.insert(mPendingObjects.end(), compiling.rbegin(), compiling.rend());
+
+        // Keep the preloaded resources of the cells alive until all their objects are activated
+        const double referenceTime = mRendering.getReferenceTime();
+        std::erase_if(mDeferredCells, [&](CellStore* cell) {
+            const bool pending = std::any_of(mPendingObjects.begin(), mPendingObjects.end(),
+                [&](const PendingObject& object) { return object.mPtr.getCell() == cell; });
+            if (pending)
+                mPreloader->preload(*cell, referenceTime);
+            else
+                mPreloader->notifyLoaded(cell);
+            return !pending;
+        });
+    }
+
+    void Scene::updatePtr(const Ptr& old, const Ptr& ptr)
+    {
+        for (PendingObject& object : mPendingObjects)
+            if (object.mPtr == old)
+                object.mPtr = ptr;
+    }
+
     void Scene::addObjectToScene(const Ptr& ptr)
     {
         const bool isInterior = mCurrentCell && !mCurrentCell->isExterior();
         try
         {
-            addObject(ptr, mWorld, mPagedRefs, *mPhysics, mRendering);
-            addObject(ptr, mWorld, *mPhysics, mLowestPoint, isInterior, mNavigator);
+            addObject(ptr, mWorld, mPagedRefs, *mPhysics, mRendering, mActivationStats);
+            measure(mActivationStats.mNavigator,
+                [&] { addObject(ptr, mWorld, *mPhysics, mLowestPoint, isInterior, mNavigator); });
             mWorld.scaleObject(ptr, ptr.getCellRef().getScale());
         }
         catch (std::exception& e)
@@ -1052,6 +1190,15 @@ namespace MWWorld
 
     void Scene::removeObjectFromScene(const Ptr& ptr, bool keepActive)
     {
+        const auto pending = std::find_if(mPendingObjects.begin(), mPendingObjects.end(),
+            [&](const PendingObject& object) { return object.mPtr == ptr; });
+        if (pending != mPendingObjects.end())
+        {
+            // Not activated yet, so there is nothing to remove
+            mPendingObjects.erase(pending);
+            return;
+        }
+
         MWBase::Environment::get().getMechanicsManager()->remove(ptr, keepActive);
         // You'd expect the sounds attached to the object to be stopped here
         // because the object is nowhere to be heard, but in Morrowind, they're not.
@@ -1146,10 +1293,11 @@ namespace MWWorld
             return;
         std::vector<PositionCellGrid> exteriorPositions;
 
-        const MWWorld::ConstPtr player = mWorld.getPlayerPtr();
+        const MWWorld::Ptr player = mWorld.getPlayerPtr();
         osg::Vec3f playerPos = player.getRefData().getPosition().asVec3();
-        osg::Vec3f moved = playerPos - mLastPlayerPos;
-        osg::Vec3f predictedPos = playerPos + moved / dt * mPredictionTime;
+        mPreloadPlanner.update(
+            playerPos, playerPos - mLastPlayerPos, dt, mWorld.isFlying(player) || mWorld.isSwimming(player));
+        osg::Vec3f predictedPos = playerPos + mPreloadPlanner.getMotion().mVelocity * mPredictionTime;
 
         if (mCurrentCell->isExterior())
             exteriorPositions.push_back(PositionCellGrid{
@@ -1165,6 +1313,8 @@ namespace MWWorld
                 preloadExteriorGrid(playerPos, predictedPos);
             if (mPreloadFastTravel)
                 preloadFastTravelDestinations(playerPos, exteriorPositions);
+
+            mPreloader->preload(mPreloadPlanner.takeRankedCells(), mRendering.getReferenceTime());
         }
 
         mPreloader->setTerrainPreloadPositions(exteriorPositions);
@@ -1197,7 +1347,8 @@ namespace MWWorld
             {
                 try
                 {
-                    preloadCellWithSurroundings(mWorld.getWorldModel().getCell(door.getCellRef().getDestCell()));
+                    addPreloadCandidates(mWorld.getWorldModel().getCell(door.getCellRef().getDestCell()),
+                        door.getRefData().getPosition().asVec3());
                 }
                 catch (const std::exception& e)
                 {
@@ -1240,7 +1391,15 @@ namespace MWWorld
                 float loadDist = cellSize / 2 + cellSize - mCellLoadingThreshold + mPreloadDistance;
 
                 if (dist < loadDist)
-                    preloadCell(mWorld.getWorldModel().getExterior(cellIndex));
+                {
+                    // The player enters the cell through the nearest point of its border
+                    const float halfSize = cellSize / 2;
+                    const osg::Vec3f entrance(
+                        std::clamp(playerPos.x(), thisCellCenter.x() - halfSize, thisCellCenter.x() + halfSize),
+                        std::clamp(playerPos.y(), thisCellCenter.y() - halfSize, thisCellCenter.y() + halfSize),
+                        playerPos.z());
+                    mPreloadPlanner.addCandidate(mWorld.getWorldModel().getExterior(cellIndex), entrance);
+                }
             }
         }
     }
@@ -1283,6 +1442,28 @@ namespace MWWorld
                 mRendering.getReferenceTime());
     }
 
+    void Scene::addPreloadCandidates(CellStore& cell, const osg::Vec3f& entrance)
+    {
+        if (!cell.isExterior())
+        {
+            mPreloadPlanner.addCandidate(cell, entrance);
+            return;
+        }
+
+        const int cellX = cell.getCell()->getGridX();
+        const int cellY = cell.getCell()->getGridY();
+        const ESM::RefId worldspace = cell.getCell()->getWorldSpace();
+        const float cellSize = ESM::getCellSize(worldspace);
+
+        iterateOverCellsAround(cellX, cellY, mHalfGridSize, [&](int x, int y) {
+            // Surrounding cells are needed after the destination one
+            const float extraDistance = std::max(std::abs(x - cellX), std::abs(y - cellY)) * cellSize;
+            mPreloadPlanner.addCandidate(
+                mWorld.getWorldModel().getExterior(ESM::ExteriorCellLocation(x, y, worldspace)), entrance,
+                extraDistance);
+        });
+    }
+
     void Scene::preloadCell(CellStore& cell)
     {
         mPreloader->preload(cell, mRendering.getReferenceTime());
@@ -1320,24 +1501,21 @@ namespace MWWorld
 
         bool operator()(const MWWorld::Ptr& ptr)
         {
-            if ((ptr.getRefData().getPosition().asVec3() - mPlayerPos).length2() > mPreloadDist * mPreloadDist)
+            const osg::Vec3f position = ptr.getRefData().getPosition().asVec3();
+            if ((position - mPlayerPos).length2() > mPreloadDist * mPreloadDist)
                 return true;
 
-            if (ptr.getClass().isNpc())
-            {
-                const std::vector<ESM::Transport::Dest>& transport = ptr.get<ESM::NPC>()->mBase->mTransport.mList;
-                mList.insert(mList.begin(), transport.begin(), transport.end());
-            }
-            else
-            {
-                const std::vector<ESM::Transport::Dest>& transport = ptr.get<ESM::Creature>()->mBase->mTransport.mList;
-                mList.insert(mList.begin(), transport.begin(), transport.end());
-            }
+            const std::vector<ESM::Transport::Dest>& transport = ptr.getClass().isNpc()
+                ? ptr.get<ESM::NPC>()->mBase->mTransport.mList
+                : ptr.get<ESM::Creature>()->mBase->mTransport.mList;
+            for (const ESM::Transport::Dest& dest : transport)
+                mList.emplace(mList.begin(), position, dest);
             return true;
         }
         float mPreloadDist;
         osg::Vec3f mPlayerPos;
-        std::vector<ESM::Transport::Dest> mList;
+        // Position of the travel service provider and the destination
+        std::vector<std::pair<osg::Vec3f, ESM::Transport::Dest>> mList;
     };
 
     void Scene::preloadFastTravelDestinations(
@@ -1351,16 +1529,16 @@ namespace MWWorld
             cellStore->forEachType<ESM::Creature>(listVisitor);
         }
 
-        for (ESM::Transport::Dest& dest : listVisitor.mList)
+        for (const auto& [provider, dest] : listVisitor.mList)
         {
             if (!dest.mCellName.empty())
-                preloadCell(mWorld.getWorldModel().getInterior(dest.mCellName));
+                mPreloadPlanner.addCandidate(mWorld.getWorldModel().getInterior(dest.mCellName), provider);
             else
             {
                 osg::Vec3f pos = dest.mPos.asVec3();
                 const ESM::ExteriorCellLocation cellIndex
                     = ESM::positionToExteriorCellLocation(pos.x(), pos.y(), extWorldspace);
-                preloadCellWithSurroundings(mWorld.getWorldModel().getExterior(cellIndex));
+                addPreloadCandidates(mWorld.getWorldModel().getExterior(cellIndex), provider);
                 exteriorPositions.push_back(PositionCellGrid{ pos, gridCenterToBounds(getNewGridCenter(pos)) });
             }
         }
@@ -1369,5 +1547,14 @@ namespace MWWorld
     void Scene::reportStats(unsigned int frameNumber, osg::Stats& stats) const
     {
         mPreloader->reportStats(frameNumber, stats);
+
+        // Time is reported in microseconds because the stats are shown without a fractional part
+        stats.setAttribute(frameNumber, "CellActivation Pending", mPendingObjects.size());
+        stats.setAttribute(frameNumber, "CellActivation Activated", mActivationStats.mActivated);
+        stats.setAttribute(frameNumber, "CellActivation Rendering", mActivationStats.mRendering * 1e6);
+        stats.setAttribute(frameNumber, "CellActivation Mechanics", mActivationStats.mMechanics * 1e6);
+        stats.setAttribute(frameNumber, "CellActivation Physics", mActivationStats.mPhysics * 1e6);
+        stats.setAttribute(frameNumber, "CellActivation Lua", mActivationStats.mLua * 1e6);
+        stats.setAttribute(frameNumber, "CellActivation Navigator", mActivationStats.mNavigator * 1e6);
     }
 }
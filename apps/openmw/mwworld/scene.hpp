@@ -5,9 +5,11 @@
 #include <osg/Vec4i>
 #include <osg/ref_ptr>
 
+#include "cellpreloadplanner.hpp"
 #include "positioncellgrid.hpp"
 #include "ptr.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <set>
@@ -72,6 +74,17 @@ namespace MWWorld
         inverse
     };
 
+    /// Number of objects added to the scene during a frame and time in seconds spent on it by each subsystem
+    struct CellActivationStats
+    {
+        std::size_t mActivated = 0;
+        double mRendering = 0;
+        double mMechanics = 0;
+        double mPhysics = 0;
+        double mLua = 0;
+        double mNavigator = 0;
+    };
+
     class Scene
     {
     public:
@@ -85,6 +98,12 @@ namespace MWWorld
             bool mChangeEvent;
         };
 
+        struct PendingObject
+        {
+            Ptr mPtr;
+            float mDistance2;
+        };
+
         CellStore* mCurrentCell; // the cell the player is in
         CellStoreCollection mActiveCells;
         bool mCellChanged;
@@ -103,6 +122,8 @@ namespace MWWorld
         bool mPreloadFastTravel;
         float mPredictionTime;
         float mLowestPoint;
+        double mActivationBudget;
+        float mImmediateActivationDistance;
 
         int mHalfGridSize = Constants::CellGridRadius;
 
@@ -114,13 +135,25 @@ namespace MWWorld
 
         std::optional<ChangeCellGridRequest> mChangeCellGridRequest;
 
-        void insertCell(CellStore& cell, Loading::Listener* loadingListener,
-            const DetourNavigator::UpdateGuard* navigatorUpdateGuard);
+        // Objects of the active cells not added to the scene yet
+        std::vector<PendingObject> mPendingObjects;
+        std::vector<CellStore*> mDeferredCells;
+        CellActivationStats mActivationStats;
+
+        CellPreloadPlanner mPreloadPlanner;
+
+        void insertCell(CellStore& cell, Loading::Listener* loadingListener, bool deferObjects,
+            const osg::Vec3f& position, const DetourNavigator::UpdateGuard* navigatorUpdateGuard);
+
+        void activatePendingObjects(const osg::Vec3f& position, double budget);
+        ///< Add pending objects to the scene starting from the nearest to \a position until \a budget (in seconds)
+        /// is spent. Objects closer than the immediate activation distance are added regardless of the budget.
 
         osg::Vec2i mCurrentGridCenter;
 
         // Load and unload cells as necessary to create a cell grid with "X" and "Y" in the center
-        void changeCellGrid(const osg::Vec3f& pos, ESM::ExteriorCellLocation playerCellIndex, bool changeEvent = true);
+        void changeCellGrid(const osg::Vec3f& pos, ESM::ExteriorCellLocation playerCellIndex, bool changeEvent = true,
+            bool deferObjects = false);
 
         void requestChangeCellGrid(const osg::Vec3f& position, const osg::Vec2i& cell, bool changeEvent = true);
 
@@ -129,13 +162,14 @@ namespace MWWorld
         void preloadExteriorGrid(const osg::Vec3f& playerPos, const osg::Vec3f& predictedPos);
         void preloadFastTravelDestinations(
             const osg::Vec3f& playerPos, std::vector<PositionCellGrid>& exteriorPositions);
+        void addPreloadCandidates(CellStore& cell, const osg::Vec3f& entrance);
 
         osg::Vec4i gridCenterToBounds(const osg::Vec2i& centerCell) const;
         osg::Vec2i getNewGridCenter(const osg::Vec3f& pos, const osg::Vec2i* currentGridCenter = nullptr) const;
 
         void unloadCell(CellStore* cell, const DetourNavigator::UpdateGuard* navigatorUpdateGuard);
-        void loadCell(CellStore& cell, Loading::Listener* loadingListener, bool respawn, const osg::Vec3f& position,
-            const DetourNavigator::UpdateGuard* navigatorUpdateGuard);
+        void loadCell(CellStore& cell, Loading::Listener* loadingListener, bool respawn, bool deferObjects,
+            const osg::Vec3f& position, const DetourNavigator::UpdateGuard* navigatorUpdateGuard);
 
     public:
         Scene(MWWorld::World& world, MWRender::RenderingManager& rendering, MWPhysics::PhysicsSystem* physics,
@@ -186,6 +220,9 @@ namespace MWWorld
         void removeObjectFromScene(const Ptr& ptr, bool keepActive = false);
         ///< Remove an object from the scene, but not from the world model.
 
+        void updatePtr(const Ptr& old, const Ptr& ptr);
+        ///< Update the object not added to the scene yet after it was moved to another active cell.
+
         void addPostponedPhysicsObjects();
 
         void removeFromPagedRefs(const Ptr& ptr);
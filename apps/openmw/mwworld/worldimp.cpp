@@ -1174,6 +1174,7 @@ namespace MWWorld
                 {
                     newPtr = currCell->moveTo(ptr, newCell);
 
+                    mWorldScene->updatePtr(ptr, newPtr);
                     mRendering->updatePtr(ptr, newPtr);
                     MWBase::Environment::get().getSoundManager()->updatePtr(ptr, newPtr);
                     mPhysics->updatePtr(ptr, newPtr);
@@ -11,6 +11,7 @@
 #include <components/esm3/cellstate.hpp>
 #include <components/esm3/esmreader.hpp>
 #include <components/esm3/esmwriter.hpp>
+#include <components/esm3/formatversion.hpp>
 #include <components/esm3/loadregn.hpp>
 #include <components/esm4/loadwrld.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
@@ -119,6 +120,20 @@ namespace MWWorld
                 MWBase::Environment::get().getLuaManager()->exteriorCreated(*cellStore);
             return cellStore;
         }
+
+        // A missing mapping keeps the indices too
+        bool isIdentityMapping(const std::map<int, int>* mapping, std::size_t numContentFiles)
+        {
+            if (mapping == nullptr)
+                return true;
+            for (std::size_t i = 0; i < numContentFiles; ++i)
+            {
+                const auto it = mapping->find(static_cast<int>(i));
+                if (it == mapping->end() || it->second != static_cast<int>(i))
+                    return false;
+            }
+            return true;
+        }
     }
 }
 
@@ -149,6 +164,26 @@ void MWWorld::WorldModel::clear()
     mCells.clear();
     std::fill(mIdCache.begin(), mIdCache.end(), std::make_pair(ESM::RefId(), (MWWorld::CellStore*)nullptr));
     mIdCacheIndex = 0;
+    mSavedGameContext = nullptr;
+    mDeferredRefNums.clear();
+}
+
+MWWorld::Ptr MWWorld::WorldModel::getPtr(ESM::RefNum refNum) const
+{
+    Ptr ptr = mPtrRegistry.getOrEmpty(refNum);
+    if (!ptr.isEmpty())
+        return ptr;
+
+    // The object may be in a cell which has not read its saved references yet
+    const auto it = mDeferredRefNums.find(refNum);
+    if (it == mDeferredRefNums.end())
+        return ptr;
+    CellStore* const cellStore = it->second;
+    mDeferredRefNums.erase(it);
+    if (!cellStore->hasDeferredReferences())
+        return ptr;
+    cellStore->load();
+    return mPtrRegistry.getOrEmpty(refNum);
 }
 
 MWWorld::Ptr MWWorld::WorldModel::getPtrAndCache(const ESM::RefId& name, CellStore& cellStore)
@@ -168,7 +203,7 @@ MWWorld::Ptr MWWorld::WorldModel::getPtrAndCache(const ESM::RefId& name, CellSto
 
 void MWWorld::WorldModel::writeCell(ESM::ESMWriter& writer, CellStore& cell) const
 {
-    if (cell.getState() != CellStore::State_Loaded)
+    if (cell.getState() != CellStore::State_Loaded && !cell.canWriteDeferredReferences())
         cell.load();
 
     ESM::CellState cellState;
@@ -441,6 +476,7 @@ int MWWorld::WorldModel::countSavedGameRecords() const
 
 void MWWorld::WorldModel::write(ESM::ESMWriter& writer, Loading::Listener& progress) const
 {
+    // Deferred references never have moved reference tags, so reading them while writing doesn't add cells
     for (auto& [id, cellStore] : mCells)
         if (cellStore.hasState())
         {
@@ -495,6 +531,27 @@ bool MWWorld::WorldModel::readRecord(ESM::ESMReader& reader, uint32_t type)
         if (state.mHasFogOfWar)
             cellStore->readFog(reader);
 
+        if (Settings::saves().mDeferCellStateLoading)
+        {
+            if (mSavedGameContext == nullptr || mSavedGameContext->mFileName != reader.getName())
+            {
+                auto context = std::make_shared<SavedGameContext>();
+                context->mFileName = reader.getName();
+                context->mFormatVersion = reader.getFormatVersion();
+                if (const std::map<int, int>* mapping = reader.getContentFileMapping())
+                    context->mContentFileMapping = *mapping;
+                context->mWritable = context->mFormatVersion == ESM::CurrentSaveGameFormatVersion
+                    && isIdentityMapping(reader.getContentFileMapping(), reader.getGameFiles().size());
+                mSavedGameContext = std::move(context);
+            }
+
+            cellStore->readReferences(mSavedGameContext, reader.getRemainingRecordData(), &callback);
+            for (ESM::RefNum refNum : cellStore->getDeferredRefNums())
+                mDeferredRefNums.emplace(refNum, cellStore);
+
+            return true;
+        }
+
         if (cellStore->getState() != CellStore::State_Loaded)
             cellStore->load();
 
@@ -3,6 +3,7 @@
 
 #include <list>
 #include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
@@ -67,7 +68,7 @@ namespace MWWorld
 
         Ptr getPtrByRefId(const ESM::RefId& name);
 
-        Ptr getPtr(ESM::RefNum refNum) const { return mPtrRegistry.getOrEmpty(refNum); }
+        Ptr getPtr(ESM::RefNum refNum) const;
 
         PtrRegistryView getPtrRegistryView() const { return PtrRegistryView(mPtrRegistry); }
 
@@ -116,6 +117,9 @@ namespace MWWorld
         ESM::Cell mDraftCell;
         std::vector<std::pair<ESM::RefId, CellStore*>> mIdCache;
         std::size_t mIdCacheIndex = 0;
+        std::shared_ptr<const SavedGameContext> mSavedGameContext;
+        // Cells holding the references which are not read from a saved game yet
+        mutable std::unordered_map<ESM::RefNum, CellStore*> mDeferredRefNums;
 
         CellStore& getOrInsertCellStore(const ESM::Cell& cell);
 
@@ -0,0 +1,62 @@
+#include "apps/openmw/mwdialogue/saidfiles.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+namespace MWDialogue
+{
+    namespace
+    {
+        using Files = std::vector<std::string_view>;
+
+        TEST(MWDialogueGetSaidFilesTest, shouldReturnQuotedFile)
+        {
+            EXPECT_EQ(getSaidFiles("Say \"vo\\d\\m\\Hlo_DM001.mp3\" \"Hello\"\n"), Files{ "vo\\d\\m\\Hlo_DM001.mp3" });
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldReturnUnquotedFile)
+        {
+            EXPECT_EQ(getSaidFiles("say vo\\a.mp3 \"Hello\""), Files{ "vo\\a.mp3" });
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldKeepSpacesInQuotedFile)
+        {
+            EXPECT_EQ(getSaidFiles("Say \"vo\\a b.mp3\", \"Hello\""), Files{ "vo\\a b.mp3" });
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldIgnoreCase)
+        {
+            EXPECT_EQ(getSaidFiles("SAY \"a.mp3\" \"\"\nsAy \"b.mp3\" \"\""), (Files{ "a.mp3", "b.mp3" }));
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldReturnFileSaidByOtherObject)
+        {
+            EXPECT_EQ(getSaidFiles("\"fargoth\"->Say \"a.mp3\" \"Hello\""), Files{ "a.mp3" });
+            EXPECT_EQ(getSaidFiles("fargoth -> say \"a.mp3\" \"Hello\""), Files{ "a.mp3" });
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldSkipWhitespace)
+        {
+            EXPECT_EQ(getSaidFiles("\t  Say\t  \"a.mp3\" \"Hello\"\r\n   \n"), Files{ "a.mp3" });
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldReturnFilesOfEveryLine)
+        {
+            EXPECT_EQ(getSaidFiles("Journal \"A1\" 10\nSay \"a.mp3\" \"\"\nGoodbye\nSay \"b.mp3\" \"\""),
+                (Files{ "a.mp3", "b.mp3" }));
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldIgnoreOtherInstructions)
+        {
+            EXPECT_EQ(
+                getSaidFiles("if ( SayDone == 1 )\nsaydone\nSayFile \"a.mp3\"\nsay\nsay \"\" \"Hello\""), Files{});
+        }
+
+        TEST(MWDialogueGetSaidFilesTest, shouldIgnoreUnterminatedQuotedFile)
+        {
+            EXPECT_EQ(getSaidFiles("Say \"a.mp3"), Files{});
+        }
+    }
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 #include <sstream>
 
+#include <components/compiler/generator.hpp>
+
 #include "test_utils.hpp"
 
 namespace
@@ -58,6 +60,16 @@ namespace
             mInterpreter.run(script.mProgram, context);
         }
 
+        Interpreter::DecodedProgram decode(Interpreter::Program program) const
+        {
+            return mInterpreter.decode(std::move(program));
+        }
+
+        void run(const Interpreter::DecodedProgram& program, TestInterpreterContext& context)
+        {
+            mInterpreter.run(program, context);
+        }
+
         template <typename T, typename... TArgs>
         void installOpcode(int code, TArgs&&... args)
         {
@@ -573,6 +585,42 @@ End)mwscript";
         }
     }
 
+    TEST_F(MWScriptTest, mwscript_test_decoded_program)
+    {
+        if (const auto script = compile(sScript3))
+        {
+            const Interpreter::DecodedProgram program = decode(script->mProgram);
+            TestInterpreterContext context;
+            for (int i = 1; i < 10; ++i)
+            {
+                context.setLocalShort(0, i);
+                run(program, context);
+                EXPECT_EQ(context.getLocalShort(1), i + 1);
+                EXPECT_EQ(context.getLocalShort(2), i - 1);
+                EXPECT_EQ(context.getLocalShort(3), (i + 1) * (i - 1));
+            }
+        }
+        else
+        {
+            FAIL();
+        }
+    }
+
+    TEST_F(MWScriptTest, mwscript_test_decoded_program_unknown_opcode_should_throw_on_execution)
+    {
+        Interpreter::Program program;
+        program.mInstructions = {
+            Compiler::Generator::segment5(20), // return
+            Compiler::Generator::segment5(0x3ffffff),
+        };
+        const Interpreter::DecodedProgram decoded = decode(program);
+        TestInterpreterContext context;
+        EXPECT_NO_THROW(run(decoded, context));
+
+        program.mInstructions.erase(program.mInstructions.begin());
+        EXPECT_THROW(run(decode(program), context), std::runtime_error);
+    }
+
     TEST_F(MWScriptTest, mwscript_test_forum_thread)
     {
         registerExtensions();
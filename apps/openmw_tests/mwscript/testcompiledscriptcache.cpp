@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+#include <components/testing/util.hpp>
+
+#include "apps/openmw/mwscript/compiledscriptcache.hpp"
+
+#include "test_utils.hpp"
+
+namespace
+{
+    using namespace MWScript;
+
+    class GlobalsCompilerContext : public Compiler::Context
+    {
+    public:
+        std::map<std::string, char> mGlobals;
+
+        bool canDeclareLocals() const override { return true; }
+
+        char getGlobalType(const std::string& name) const override
+        {
+            const auto it = mGlobals.find(name);
+            return it == mGlobals.end() ? ' ' : it->second;
+        }
+
+        std::pair<char, bool> getMemberType(const std::string& /*name*/, const ESM::RefId& /*id*/) const override
+        {
+            return { ' ', false };
+        }
+
+        bool isId(const ESM::RefId& /*name*/) const override { return false; }
+    };
+
+    const std::string sScript = R"mwscript(Begin cached
+short counter
+set counter to ( counter + cached_step )
+End)mwscript";
+
+    struct MWScriptCompiledScriptCacheTest : ::testing::Test
+    {
+        const std::uint64_t mExtensionsHash = 42;
+        const int mWarningsMode = 1;
+        const ESM::RefId mId = ESM::RefId::stringRefId("cached");
+        const std::filesystem::path mPath = TestingOpenMW::outputFilePath("compiled_scripts.cache");
+        GlobalsCompilerContext mContext;
+        TestErrorHandler mErrorHandler;
+
+        MWScriptCompiledScriptCacheTest() { mContext.mGlobals.emplace("cached_step", 's'); }
+
+        CompiledScriptCache::Script compile()
+        {
+            RecordingCompilerContext context(mContext);
+            Compiler::FileParser parser(mErrorHandler, context);
+            std::istringstream input(sScript);
+            Compiler::Scanner scanner(mErrorHandler, input, context.getExtensions());
+            scanner.scan(parser);
+            EXPECT_TRUE(mErrorHandler.isGood());
+            return CompiledScriptCache::Script{ .mSourceHash = CompiledScriptCache::getSourceHash(sScript),
+                .mProgram = parser.getProgram(),
+                .mLocals = parser.getLocals(),
+                .mQueries = context.takeQueries() };
+        }
+
+        void saveScript()
+        {
+            std::filesystem::remove(mPath);
+            CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+            cache.insert(mId, compile());
+            cache.save(mPath);
+        }
+    };
+
+    TEST_F(MWScriptCompiledScriptCacheTest, recordingContextShouldRecordQueries)
+    {
+        const CompiledScriptCache::Script script = compile();
+        ASSERT_EQ(script.mQueries.size(), 1);
+        EXPECT_EQ(script.mQueries[0].mType, CompilerContextQuery::Type::GlobalType);
+        EXPECT_EQ(script.mQueries[0].mName, "cached_step");
+        EXPECT_EQ(script.mQueries[0].mResultType, 's');
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldLoadSavedScript)
+    {
+        saveScript();
+        const CompiledScriptCache::Script expected = compile();
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+        cache.load(mPath);
+        const CompiledScriptCache::Script* script
+            = cache.find(mId, CompiledScriptCache::getSourceHash(sScript), mContext);
+        ASSERT_NE(script, nullptr);
+        EXPECT_EQ(script->mProgram.mInstructions, expected.mProgram.mInstructions);
+        EXPECT_EQ(script->mProgram.mIntegers, expected.mProgram.mIntegers);
+        EXPECT_EQ(script->mProgram.mFloats, expected.mProgram.mFloats);
+        EXPECT_EQ(script->mProgram.mStrings, expected.mProgram.mStrings);
+        EXPECT_EQ(script->mLocals.get('s'), expected.mLocals.get('s'));
+        EXPECT_EQ(script->mQueries.size(), expected.mQueries.size());
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldNotFindScriptWithDifferentSource)
+    {
+        saveScript();
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+        cache.load(mPath);
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript + "\n"), mContext), nullptr);
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldNotFindScriptWithDifferentContextAnswers)
+    {
+        saveScript();
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+        cache.load(mPath);
+        mContext.mGlobals["cached_step"] = 'f';
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript), mContext), nullptr);
+        EXPECT_NE(cache.find(mId, CompiledScriptCache::getSourceHash(sScript)), nullptr);
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldDiscardCacheForDifferentExtensions)
+    {
+        saveScript();
+
+        CompiledScriptCache cache(mExtensionsHash + 1, mWarningsMode);
+        cache.load(mPath);
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript)), nullptr);
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldDiscardCacheForDifferentWarningsMode)
+    {
+        saveScript();
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode + 1);
+        cache.load(mPath);
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript)), nullptr);
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldIgnoreCorruptedFile)
+    {
+        saveScript();
+        std::filesystem::resize_file(mPath, std::filesystem::file_size(mPath) / 2);
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+        cache.load(mPath);
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript)), nullptr);
+    }
+
+    TEST_F(MWScriptCompiledScriptCacheTest, shouldIgnoreFileWithInvalidSize)
+    {
+        saveScript();
+        {
+            // Replace the size of the first script id by a size larger than the file
+            std::fstream stream(mPath, std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(4 + sizeof(std::uint32_t) + sizeof(std::uint64_t) + sizeof(std::uint32_t));
+            const std::uint32_t size = std::numeric_limits<std::uint32_t>::max();
+            stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        }
+
+        CompiledScriptCache cache(mExtensionsHash, mWarningsMode);
+        cache.load(mPath);
+        EXPECT_EQ(cache.find(mId, CompiledScriptCache::getSourceHash(sScript)), nullptr);
+    }
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <components/sceneutil/workqueue.hpp>
+#include <components/testing/util.hpp>
+#include <components/vfs/filesystemarchive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include "apps/openmw/mwsound/pcmcache.hpp"
+#include "apps/openmw/mwsound/sound_decoder.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace MWSound
+{
+    namespace
+    {
+        constexpr std::uint32_t sSampleRate = 8000;
+        constexpr std::uint32_t sNumSamples = 800;
+
+        // 16-bit mono PCM
+        std::string makeWav()
+        {
+            std::string data;
+            const auto append = [&](const auto& value) {
+                data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+            };
+            const std::uint32_t dataSize = sNumSamples * sizeof(std::int16_t);
+            data += "RIFF";
+            append(static_cast<std::uint32_t>(36 + dataSize));
+            data += "WAVEfmt ";
+            append(std::uint32_t{ 16 });
+            append(std::uint16_t{ 1 });
+            append(std::uint16_t{ 1 });
+            append(sSampleRate);
+            append(static_cast<std::uint32_t>(sSampleRate * sizeof(std::int16_t)));
+            append(static_cast<std::uint16_t>(sizeof(std::int16_t)));
+            append(std::uint16_t{ 16 });
+            data += "data";
+            append(dataSize);
+            for (std::uint32_t i = 0; i < sNumSamples; ++i)
+                append(static_cast<std::int16_t>(i * 40));
+            return data;
+        }
+
+        void writeFile(const std::filesystem::path& path, const std::string& data)
+        {
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream stream(path, std::ios::binary);
+            stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        std::vector<std::filesystem::path> listCacheFiles(const std::filesystem::path& directory)
+        {
+            std::vector<std::filesystem::path> result;
+            std::error_code ec;
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, ec))
+                if (entry.path().extension() == ".pcm")
+                    result.push_back(entry.path());
+            return result;
+        }
+
+        struct MWSoundPcmCacheTest : ::testing::Test
+        {
+            const std::filesystem::path mDataPath
+                = std::filesystem::absolute(TestingOpenMW::outputFilePath("pcm_cache_data"));
+            const std::filesystem::path mCachePath
+                = std::filesystem::absolute(TestingOpenMW::outputFilePath("pcm_cache"));
+            const VFS::Path::Normalized mFileName{ "sound/a.wav" };
+            const VFS::Path::Normalized mOtherFileName{ "sound/b.wav" };
+            const std::string mWav = makeWav();
+            osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue = new SceneUtil::WorkQueue(1);
+            VFS::Manager mVFS;
+
+            MWSoundPcmCacheTest()
+            {
+                std::filesystem::remove_all(mDataPath);
+                std::filesystem::remove_all(mCachePath);
+                writeFile(mDataPath / "sound" / "a.wav", mWav);
+                writeFile(mDataPath / "sound" / "b.wav", mWav);
+                mVFS.addArchive(std::make_unique<VFS::FileSystemArchive>(mDataPath));
+                mVFS.buildIndex();
+            }
+
+            ~MWSoundPcmCacheTest() override { mWorkQueue->stop(); }
+
+            // The work queue has a single thread, so the items added before are done once this one is
+            void waitForWorkQueue()
+            {
+                osg::ref_ptr<SceneUtil::WorkItem> item = new SceneUtil::WorkItem;
+                mWorkQueue->addWorkItem(item);
+                item->waitTillDone();
+            }
+
+            static std::uintmax_t getCacheFileSize(VFS::Path::NormalizedView fileName)
+            {
+                constexpr std::uintmax_t headerSize = 40;
+                return headerSize + fileName.value().size() + sNumSamples * sizeof(std::int16_t);
+            }
+        };
+
+        TEST_F(MWSoundPcmCacheTest, addedSoundShouldBeOpenedFromCache)
+        {
+            PcmCache cache(mVFS, mCachePath, 1024 * 1024, mWorkQueue.get());
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+
+            cache.add(mFileName);
+            waitForWorkQueue();
+
+            const DecoderPtr decoder = cache.open(mFileName);
+            ASSERT_NE(decoder, nullptr);
+            int sampleRate = 0;
+            ChannelConfig channelConfig;
+            SampleType sampleType;
+            decoder->getInfo(&sampleRate, &channelConfig, &sampleType);
+            EXPECT_EQ(sampleRate, static_cast<int>(sSampleRate));
+            EXPECT_EQ(channelConfig, ChannelConfig_Mono);
+            EXPECT_EQ(sampleType, SampleType_Int16);
+
+            std::vector<char> samples;
+            decoder->readAll(samples);
+            EXPECT_EQ(samples, std::vector<char>(mWav.end() - sNumSamples * sizeof(std::int16_t), mWav.end()));
+        }
+
+        TEST_F(MWSoundPcmCacheTest, cacheFileWithInvalidHeaderShouldBeIgnored)
+        {
+            PcmCache cache(mVFS, mCachePath, 1024 * 1024, mWorkQueue.get());
+            cache.add(mFileName);
+            waitForWorkQueue();
+
+            const std::vector<std::filesystem::path> files = listCacheFiles(mCachePath);
+            ASSERT_EQ(files.size(), 1);
+            {
+                std::fstream stream(files[0], std::ios::binary | std::ios::in | std::ios::out);
+                stream.write("NOTAPCM", 7);
+            }
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+
+            std::filesystem::resize_file(files[0], 16);
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+        }
+
+        TEST_F(MWSoundPcmCacheTest, cacheFileShouldBeIgnoredWhenSoundFileIsModified)
+        {
+            PcmCache cache(mVFS, mCachePath, 1024 * 1024, mWorkQueue.get());
+            cache.add(mFileName);
+            waitForWorkQueue();
+            ASSERT_NE(cache.open(mFileName), nullptr);
+
+            const std::filesystem::path soundPath = mDataPath / "sound" / "a.wav";
+            std::filesystem::last_write_time(
+                soundPath, std::filesystem::last_write_time(soundPath) + std::chrono::hours(1));
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+        }
+
+        TEST_F(MWSoundPcmCacheTest, soundFilesFromArchivesShouldNotBeCached)
+        {
+            TestingOpenMW::VFSTestFile file(mWav);
+            const std::unique_ptr<VFS::Manager> vfs = TestingOpenMW::createTestVFS({ { mFileName.value(), &file } });
+
+            PcmCache cache(*vfs, mCachePath, 1024 * 1024, mWorkQueue.get());
+            cache.add(mFileName);
+            waitForWorkQueue();
+
+            EXPECT_TRUE(listCacheFiles(mCachePath).empty());
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+        }
+
+        TEST_F(MWSoundPcmCacheTest, leastRecentlyPlayedSoundShouldBeRemovedWhenCacheIsFull)
+        {
+            PcmCache cache(mVFS, mCachePath, getCacheFileSize(mFileName), mWorkQueue.get());
+            cache.add(mFileName);
+            waitForWorkQueue();
+
+            const std::vector<std::filesystem::path> files = listCacheFiles(mCachePath);
+            ASSERT_EQ(files.size(), 1);
+            ASSERT_EQ(std::filesystem::file_size(files[0]), getCacheFileSize(mFileName));
+            std::filesystem::last_write_time(
+                files[0], std::filesystem::last_write_time(files[0]) - std::chrono::hours(1));
+
+            cache.add(mOtherFileName);
+            waitForWorkQueue();
+
+            EXPECT_EQ(listCacheFiles(mCachePath).size(), 1);
+            EXPECT_FALSE(std::filesystem::exists(files[0]));
+            EXPECT_EQ(cache.open(mFileName), nullptr);
+            EXPECT_NE(cache.open(mOtherFileName), nullptr);
+        }
+    }
+}
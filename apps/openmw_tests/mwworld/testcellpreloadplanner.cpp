@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include "apps/openmw/mwworld/cellpreloadplanner.hpp"
+
+namespace MWWorld
+{
+    namespace
+    {
+        TEST(MWWorldGetPreloadTimeTest, shouldUseMinSpeedForStandingPlayer)
+        {
+            const PlayerMotion motion{ .mPosition = osg::Vec3f(0, 0, 0), .mVelocity = osg::Vec3f(0, 0, 0) };
+            EXPECT_FLOAT_EQ(getPreloadTime(motion, osg::Vec3f(1000, 0, 0), 0), 10);
+        }
+
+        TEST(MWWorldGetPreloadTimeTest, shouldPreferTargetInMovementDirection)
+        {
+            const PlayerMotion motion{ .mPosition = osg::Vec3f(0, 0, 0), .mVelocity = osg::Vec3f(500, 0, 0) };
+            EXPECT_LT(getPreloadTime(motion, osg::Vec3f(2000, 0, 0), 0),
+                getPreloadTime(motion, osg::Vec3f(-1000, 0, 0), 0));
+            EXPECT_FLOAT_EQ(getPreloadTime(motion, osg::Vec3f(2000, 0, 0), 0), 4);
+        }
+
+        TEST(MWWorldGetPreloadTimeTest, shouldAddExtraDistance)
+        {
+            const PlayerMotion motion{ .mPosition = osg::Vec3f(0, 0, 0), .mVelocity = osg::Vec3f(500, 0, 0) };
+            EXPECT_FLOAT_EQ(getPreloadTime(motion, osg::Vec3f(2000, 0, 0), 1000), 6);
+        }
+
+        TEST(MWWorldGetPreloadTimeTest, shouldIgnoreVerticalDistanceForWalkingPlayer)
+        {
+            const PlayerMotion motion{ .mPosition = osg::Vec3f(0, 0, 0), .mVelocity = osg::Vec3f(0, 0, 0) };
+            EXPECT_FLOAT_EQ(getPreloadTime(motion, osg::Vec3f(1000, 0, 5000), 0), 10);
+        }
+
+        TEST(MWWorldGetPreloadTimeTest, shouldUseVerticalDistanceForFlyingPlayer)
+        {
+            const PlayerMotion motion{
+                .mPosition = osg::Vec3f(0, 0, 0), .mVelocity = osg::Vec3f(0, 0, 300), .mFlying = true
+            };
+            EXPECT_FLOAT_EQ(getPreloadTime(motion, osg::Vec3f(0, 0, 3000), 0), 10);
+        }
+
+        TEST(MWWorldCellPreloadPlannerTest, updateShouldSmoothVelocity)
+        {
+            CellPreloadPlanner planner(1);
+            planner.update(osg::Vec3f(10, 0, 0), osg::Vec3f(10, 0, 0), 0.1f, false);
+            EXPECT_FLOAT_EQ(planner.getMotion().mVelocity.x(), 40);
+            planner.update(osg::Vec3f(20, 0, 0), osg::Vec3f(10, 0, 0), 0.1f, false);
+            EXPECT_FLOAT_EQ(planner.getMotion().mVelocity.x(), 64);
+        }
+
+        TEST(MWWorldCellPreloadPlannerTest, updateShouldResetVelocityOnTeleport)
+        {
+            CellPreloadPlanner planner(1);
+            planner.update(osg::Vec3f(10, 0, 0), osg::Vec3f(10, 0, 0), 0.1f, false);
+            planner.update(osg::Vec3f(1e5f, 0, 0), osg::Vec3f(1e5f, 0, 0), 0.1f, false);
+            EXPECT_EQ(planner.getMotion().mVelocity, osg::Vec3f(0, 0, 0));
+            EXPECT_EQ(planner.getMotion().mPosition, osg::Vec3f(1e5f, 0, 0));
+        }
+    }
+}
@@ -0,0 +1,259 @@
+#include <gtest/gtest.h>
+
+#include <components/esm/exteriorcelllocation.hpp>
+#include <components/esm3/cellref.hpp>
+#include <components/esm3/cellstate.hpp>
+#include <components/esm3/esmreader.hpp>
+#include <components/esm3/esmwriter.hpp>
+#include <components/esm3/formatversion.hpp>
+#include <components/esm3/loadstat.hpp>
+#include <components/esm3/objectstate.hpp>
+#include <components/esm3/readerscache.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+#include <components/settings/values.hpp>
+
+#include "apps/openmw/mwbase/environment.hpp"
+#include "apps/openmw/mwbase/luamanager.hpp"
+#include "apps/openmw/mwclass/classes.hpp"
+#include "apps/openmw/mwworld/cellstore.hpp"
+#include "apps/openmw/mwworld/esmstore.hpp"
+#include "apps/openmw/mwworld/worldmodel.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace MWWorld
+{
+    namespace
+    {
+        struct LuaManagerStub final : MWBase::LuaManager
+        {
+            void newGameStarted() override {}
+            void gameLoaded() override {}
+            void gameEnded() override {}
+            void noGame() override {}
+            void objectAddedToScene(const Ptr&) override {}
+            void objectRemovedFromScene(const Ptr&) override {}
+            void objectTeleported(const Ptr&) override {}
+            void itemConsumed(const Ptr&, const Ptr&) override {}
+            void objectActivated(const Ptr&, const Ptr&) override {}
+            void useItem(const Ptr&, const Ptr&, bool) override {}
+            void animationTextKey(const Ptr&, const std::string&) override {}
+            void playAnimation(const Ptr&, const std::string&, const MWRender::AnimPriority&, int, bool, float,
+                std::string_view, std::string_view, float, uint32_t, bool) override
+            {
+            }
+            void skillLevelUp(const Ptr&, ESM::RefId, std::string_view) override {}
+            void skillUse(const Ptr&, ESM::RefId, int, float) override {}
+            void exteriorCreated(CellStore&) override {}
+            void actorDied(const Ptr&) override {}
+            void questUpdated(const ESM::RefId&, int) override {}
+            void uiModeChanged(const Ptr&) override {}
+            void inputEvent(const InputEvent&) override {}
+            ActorControls* getActorControls(const Ptr&) const override { return nullptr; }
+            void clear() override {}
+            void setupPlayer(const Ptr&) override {}
+            void write(ESM::ESMWriter&, Loading::Listener&) override {}
+            void saveLocalScripts(const Ptr&, ESM::LuaScripts&) override {}
+            void applyDelayedActions() override {}
+            void readRecord(ESM::ESMReader&, uint32_t) override {}
+            void loadLocalScripts(const Ptr&, const ESM::LuaScripts&) override {}
+            void setContentFileMapping(const std::map<int, int>&) override {}
+            void reloadAllScripts() override {}
+            void handleConsoleCommand(const std::string&, const std::string&, const Ptr&) override {}
+            std::string formatResourceUsageStats() const override { return {}; }
+        };
+
+        struct MWWorldWorldModelDeferredReferencesTest : ::testing::Test
+        {
+            MWBase::Environment mEnvironment;
+            LuaManagerStub mLuaManager;
+            ESMStore mStore;
+            ESM::ReadersCache mReaders;
+            std::unique_ptr<WorldModel> mWorldModel;
+            ESM::ObjectState mObject;
+            const ESM::ExteriorCellLocation mLocation{ 0, 0, ESM::Cell::sDefaultWorldspaceId };
+
+            MWWorldWorldModelDeferredReferencesTest()
+            {
+                Settings::saves().mDeferCellStateLoading.set(true);
+
+                MWClass::registerClasses();
+
+                ESM::Static record;
+                record.blank();
+                record.mId = ESM::RefId::stringRefId("static");
+                mStore.insertStatic(record);
+
+                mObject.blank();
+                mObject.mRef.mRefID = record.mId;
+                mObject.mRef.mRefNum = ESM::RefNum{ .mIndex = 42, .mContentFile = -1 };
+                mObject.mPosition.pos[0] = 13;
+                mObject.mPosition.pos[1] = 14;
+                mObject.mPosition.pos[2] = 15;
+                mObject.mRef.mPos = mObject.mPosition;
+
+                mEnvironment.setESMStore(mStore);
+                mEnvironment.setLuaManager(mLuaManager);
+                mWorldModel = std::make_unique<WorldModel>(mStore, mReaders);
+                mEnvironment.setWorldModel(*mWorldModel);
+            }
+
+            ~MWWorldWorldModelDeferredReferencesTest() override
+            {
+                mWorldModel = nullptr;
+                Settings::saves().mDeferCellStateLoading.reset();
+            }
+
+            static std::string save(const std::function<void(ESM::ESMWriter&)>& writeRecords)
+            {
+                std::stringstream stream;
+                ESM::ESMWriter writer;
+                writer.setFormatVersion(ESM::CurrentSaveGameFormatVersion);
+                writer.save(stream);
+                writeRecords(writer);
+                writer.close();
+                return stream.str();
+            }
+
+            std::string makeSavedCell(const std::function<void(ESM::ESMWriter&)>& writeExtraSubRecords = {}) const
+            {
+                return save([&](ESM::ESMWriter& writer) {
+                    ESM::CellState state;
+                    state.mId = ESM::RefId::esm3ExteriorCell(mLocation.mX, mLocation.mY);
+                    state.mIsInterior = false;
+                    state.mWaterLevel = 0;
+                    state.mHasFogOfWar = 0;
+                    state.mLastRespawn = ESM::TimeStamp{};
+
+                    writer.startRecord(ESM::REC_CSTA);
+                    writer.writeCellId(state.mId);
+                    state.save(writer);
+                    writer.writeHNT("OBJE", ESM::Static::sRecordId);
+                    mObject.save(writer);
+                    if (writeExtraSubRecords)
+                        writeExtraSubRecords(writer);
+                    writer.endRecord(ESM::REC_CSTA);
+                });
+            }
+
+            void load(const std::string& data)
+            {
+                ESM::ESMReader reader;
+                reader.open(std::make_unique<std::stringstream>(data), "test.omwsave");
+                while (reader.hasMoreRecs())
+                {
+                    const ESM::NAME name = reader.getRecName();
+                    reader.getRecHeader();
+                    ASSERT_TRUE(mWorldModel->readRecord(reader, name.toInt()));
+                }
+            }
+
+            CellStore& getCell() const { return mWorldModel->getExterior(mLocation, false); }
+
+            std::string writeWorldModel() const
+            {
+                Loading::Listener listener;
+                return save([&](ESM::ESMWriter& writer) { mWorldModel->write(writer, listener); });
+            }
+
+            void expectSavedCell(const std::string& data) const
+            {
+                ESM::ESMReader reader;
+                reader.open(std::make_unique<std::stringstream>(data), "test.omwsave");
+                ASSERT_TRUE(reader.hasMoreRecs());
+                ASSERT_EQ(reader.getRecName().toInt(), ESM::REC_CSTA);
+                reader.getRecHeader();
+
+                ESM::CellState state;
+                state.mId = reader.getCellId();
+                state.load(reader);
+                EXPECT_EQ(state.mId, ESM::RefId::esm3ExteriorCell(mLocation.mX, mLocation.mY));
+
+                ASSERT_TRUE(reader.isNextSub("OBJE"));
+                unsigned int recordId;
+                reader.getHT(recordId);
+                ESM::ObjectState result;
+                result.mRef.loadId(reader, true);
+                result.load(reader);
+                EXPECT_EQ(result.mRef.mRefID, mObject.mRef.mRefID);
+                EXPECT_EQ(result.mRef.mRefNum, mObject.mRef.mRefNum);
+                EXPECT_EQ(result.mPosition.asVec3(), mObject.mPosition.asVec3());
+                EXPECT_FALSE(reader.hasMoreSubs());
+                EXPECT_FALSE(reader.hasMoreRecs());
+            }
+        };
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, cellShouldReadDeferredReferencesWhenLoaded)
+        {
+            load(makeSavedCell());
+            CellStore& cell = getCell();
+            EXPECT_NE(cell.getState(), CellStore::State_Loaded);
+            EXPECT_TRUE(cell.hasDeferredReferences());
+            EXPECT_TRUE(cell.hasState());
+
+            cell.load();
+            EXPECT_FALSE(cell.hasDeferredReferences());
+            const Ptr ptr = cell.search(mObject.mRef.mRefID);
+            ASSERT_FALSE(ptr.isEmpty());
+            EXPECT_EQ(ptr.getCellRef().getRefNum(), mObject.mRef.mRefNum);
+            EXPECT_EQ(ptr.getRefData().getPosition().asVec3(), mObject.mPosition.asVec3());
+        }
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, preloadedCellShouldHaveDeferredIdsWithoutReadingThem)
+        {
+            load(makeSavedCell());
+            CellStore& cell = getCell();
+            cell.preload();
+            EXPECT_TRUE(cell.hasId(mObject.mRef.mRefID));
+            EXPECT_EQ(cell.getState(), CellStore::State_Preloaded);
+            EXPECT_TRUE(cell.hasDeferredReferences());
+        }
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, getPtrShouldReadDeferredReferencesOfOwningCell)
+        {
+            load(makeSavedCell());
+            EXPECT_TRUE(mWorldModel->getPtr(ESM::RefNum{ .mIndex = 43, .mContentFile = -1 }).isEmpty());
+            EXPECT_TRUE(getCell().hasDeferredReferences());
+
+            const Ptr ptr = mWorldModel->getPtr(mObject.mRef.mRefNum);
+            ASSERT_FALSE(ptr.isEmpty());
+            EXPECT_EQ(ptr.getCellRef().getRefId(), mObject.mRef.mRefID);
+            EXPECT_EQ(getCell().getState(), CellStore::State_Loaded);
+            EXPECT_FALSE(getCell().hasDeferredReferences());
+        }
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, writeShouldSaveDeferredReferencesWithoutReadingThem)
+        {
+            load(makeSavedCell());
+            ASSERT_EQ(mWorldModel->countSavedGameRecords(), 1);
+            EXPECT_TRUE(getCell().hasDeferredReferences());
+
+            expectSavedCell(writeWorldModel());
+            EXPECT_NE(getCell().getState(), CellStore::State_Loaded);
+            EXPECT_TRUE(getCell().hasDeferredReferences());
+        }
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, writeShouldReadDeferredReferencesOfRestedCell)
+        {
+            load(makeSavedCell());
+            getCell().rest(1);
+            EXPECT_FALSE(getCell().canWriteDeferredReferences());
+
+            expectSavedCell(writeWorldModel());
+            EXPECT_EQ(getCell().getState(), CellStore::State_Loaded);
+            EXPECT_FALSE(getCell().hasDeferredReferences());
+        }
+
+        TEST_F(MWWorldWorldModelDeferredReferencesTest, loadShouldThrowOnInvalidDeferredReferences)
+        {
+            load(makeSavedCell([](ESM::ESMWriter& writer) { writer.writeHNT("FLAG", std::uint8_t{ 1 }); }));
+            EXPECT_TRUE(getCell().hasDeferredReferences());
+            EXPECT_THROW(getCell().load(), std::runtime_error);
+        }
+    }
+}
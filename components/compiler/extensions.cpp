@@ -1,8 +1,11 @@
 #include "extensions.hpp"
 
 #include <cassert>
+#include <sstream>
 #include <stdexcept>
 
+#include <components/misc/hash.hpp>
+
 #include "generator.hpp"
 #include "literals.hpp"
 
@@ -204,4 +207,22 @@ namespace Compiler
         for (const auto& mKeyword : mKeywords)
             keywords.push_back(mKeyword.first);
     }
+
+    std::uint64_t Extensions::getHash() const
+    {
+        std::ostringstream description;
+
+        for (const auto& [keyword, index] : mKeywords)
+            description << keyword << ' ' << index << '\n';
+
+        for (const auto& [keyword, function] : mFunctions)
+            description << keyword << ' ' << function.mReturn << ' ' << function.mArguments << ' ' << function.mCode
+                        << ' ' << function.mCodeExplicit << ' ' << function.mSegment << '\n';
+
+        for (const auto& [keyword, instruction] : mInstructions)
+            description << keyword << ' ' << instruction.mArguments << ' ' << instruction.mCode << ' '
+                        << instruction.mCodeExplicit << ' ' << instruction.mSegment << '\n';
+
+        return Misc::hashFnv1a(description.str());
+    }
 }
@@ -1,6 +1,7 @@
 #ifndef COMPILER_EXTENSIONS_H_INCLUDED
 #define COMPILER_EXTENSIONS_H_INCLUDED
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -106,6 +107,10 @@ namespace Compiler
 
         void listKeywords(std::vector<std::string>& keywords) const;
         ///< Append all known keywords to \a kaywords.
+
+        std::uint64_t getHash() const;
+        ///< Return a hash of all registered keywords, functions and instructions. It's stable between runs, so it
+        /// can be used to find out whether code compiled in a previous run is still valid.
     };
 }
 
@@ -0,0 +1,286 @@
+#include "compressedstream.hpp"
+
+#include <components/files/streamwithbuffer.hpp>
+
+#include <lz4.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace ESM
+{
+    namespace
+    {
+        constexpr std::array<char, 4> sMagic{ 'O', 'M', 'W', 'Z' };
+        constexpr std::uint32_t sVersion = 1;
+
+        struct StreamHeader
+        {
+            std::array<char, 4> mMagic;
+            std::uint32_t mVersion;
+            std::uint32_t mBlockSize;
+            std::uint64_t mSize;
+        };
+
+        struct BlockHeader
+        {
+            std::uint32_t mSize;
+            std::uint32_t mCompressedSize;
+        };
+
+        constexpr std::size_t sStreamHeaderSize = sizeof(StreamHeader::mMagic) + sizeof(StreamHeader::mVersion)
+            + sizeof(StreamHeader::mBlockSize) + sizeof(StreamHeader::mSize);
+
+        constexpr std::size_t sBlockHeaderSize = sizeof(BlockHeader::mSize) + sizeof(BlockHeader::mCompressedSize);
+
+        template <class T>
+        void writeValue(std::ostream& stream, const T& value)
+        {
+            stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template <class T>
+        void readValue(std::istream& stream, T& value)
+        {
+            stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+
+        StreamHeader readStreamHeader(std::istream& stream)
+        {
+            StreamHeader header;
+            readValue(stream, header.mMagic);
+            readValue(stream, header.mVersion);
+            readValue(stream, header.mBlockSize);
+            readValue(stream, header.mSize);
+            if (!stream)
+                throw std::runtime_error("Failed to read compressed stream header");
+            if (header.mMagic != sMagic)
+                throw std::runtime_error("Not a compressed stream");
+            if (header.mVersion != sVersion)
+                throw std::runtime_error("Unsupported compressed stream version: " + std::to_string(header.mVersion));
+            if (header.mBlockSize == 0 || header.mBlockSize > static_cast<std::uint32_t>(LZ4_MAX_INPUT_SIZE))
+                throw std::runtime_error("Invalid compressed stream block size: " + std::to_string(header.mBlockSize));
+            return header;
+        }
+
+        class CompressedStreamBuf final : public std::streambuf
+        {
+        public:
+            explicit CompressedStreamBuf(std::unique_ptr<std::istream>&& stream)
+                : mStream(std::move(stream))
+                , mHeader(readStreamHeader(*mStream))
+                , mBlockCount(static_cast<std::size_t>((mHeader.mSize + mHeader.mBlockSize - 1) / mHeader.mBlockSize))
+                , mBlockOffsets{ static_cast<std::streamoff>(sStreamHeaderSize) }
+                , mBlockIndex(0)
+                , mBlockStart(0)
+            {
+                mBlockOffsets.reserve(mBlockCount + 1);
+                setg(nullptr, nullptr, nullptr);
+            }
+
+            int_type underflow() final
+            {
+                if (gptr() == egptr())
+                {
+                    const std::size_t next = eback() == nullptr ? mBlockIndex : mBlockIndex + 1;
+                    if (next >= mBlockCount)
+                        return traits_type::eof();
+                    loadBlock(next);
+                }
+
+                return traits_type::to_int_type(*gptr());
+            }
+
+            pos_type seekoff(off_type offset, std::ios_base::seekdir whence, std::ios_base::openmode mode) final
+            {
+                if ((mode & std::ios_base::out) || !(mode & std::ios_base::in))
+                    return traits_type::eof();
+
+                std::uint64_t base;
+                switch (whence)
+                {
+                    case std::ios_base::beg:
+                        base = 0;
+                        break;
+                    case std::ios_base::cur:
+                        base = tell();
+                        break;
+                    case std::ios_base::end:
+                        base = mHeader.mSize;
+                        break;
+                    default:
+                        return traits_type::eof();
+                }
+
+                if (offset < 0 && static_cast<std::uint64_t>(-offset) > base)
+                    return traits_type::eof();
+
+                return seek(base + offset);
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode mode) final
+            {
+                if ((mode & std::ios_base::out) || !(mode & std::ios_base::in))
+                    return traits_type::eof();
+
+                if (pos < 0)
+                    return traits_type::eof();
+
+                return seek(static_cast<std::uint64_t>(static_cast<off_type>(pos)));
+            }
+
+        private:
+            std::unique_ptr<std::istream> mStream;
+            const StreamHeader mHeader;
+            const std::size_t mBlockCount;
+            // Offsets of the block headers in the underlying stream, filled in as the stream is traversed
+            std::vector<std::streamoff> mBlockOffsets;
+            std::size_t mBlockIndex;
+            std::uint64_t mBlockStart;
+            std::vector<char> mCompressed;
+            std::vector<char> mBlock;
+
+            std::uint64_t tell() const
+            {
+                if (eback() == nullptr)
+                    return mBlockStart;
+                return mBlockStart + static_cast<std::uint64_t>(gptr() - eback());
+            }
+
+            pos_type seek(std::uint64_t pos)
+            {
+                if (pos > mHeader.mSize)
+                    return traits_type::eof();
+
+                const std::size_t index = static_cast<std::size_t>(pos / mHeader.mBlockSize);
+
+                if (index >= mBlockCount)
+                {
+                    // Positioned at the end; nothing is left to decode
+                    mBlockIndex = mBlockCount;
+                    mBlockStart = pos;
+                    setg(nullptr, nullptr, nullptr);
+                    return static_cast<off_type>(pos);
+                }
+
+                if (index != mBlockIndex || eback() == nullptr)
+                    loadBlock(index);
+
+                setg(eback(), eback() + static_cast<std::ptrdiff_t>(pos - mBlockStart), egptr());
+                return static_cast<off_type>(pos);
+            }
+
+            BlockHeader readBlockHeader(std::size_t index)
+            {
+                mStream->clear();
+                mStream->seekg(mBlockOffsets[index]);
+
+                BlockHeader header;
+                readValue(*mStream, header.mSize);
+                readValue(*mStream, header.mCompressedSize);
+                if (!*mStream)
+                    throw std::runtime_error("Failed to read compressed block " + std::to_string(index) + " header");
+
+                const std::uint64_t blockStart = static_cast<std::uint64_t>(index) * mHeader.mBlockSize;
+                const std::uint64_t expectedSize
+                    = std::min<std::uint64_t>(mHeader.mBlockSize, mHeader.mSize - blockStart);
+                if (header.mSize != expectedSize)
+                    throw std::runtime_error("Invalid compressed block " + std::to_string(index)
+                        + " size: " + std::to_string(header.mSize) + ", expected: " + std::to_string(expectedSize));
+                if (header.mCompressedSize > static_cast<std::uint32_t>(LZ4_compressBound(header.mSize)))
+                    throw std::runtime_error("Invalid compressed block " + std::to_string(index)
+                        + " compressed size: " + std::to_string(header.mCompressedSize));
+
+                return header;
+            }
+
+            void loadBlock(std::size_t index)
+            {
+                // Walk the block headers up to the requested one, skipping over the compressed data
+                while (mBlockOffsets.size() <= index)
+                {
+                    const std::size_t last = mBlockOffsets.size() - 1;
+                    const BlockHeader header = readBlockHeader(last);
+                    mBlockOffsets.push_back(mBlockOffsets[last] + static_cast<std::streamoff>(sBlockHeaderSize)
+                        + static_cast<std::streamoff>(header.mCompressedSize));
+                }
+
+                const BlockHeader header = readBlockHeader(index);
+
+                mCompressed.resize(header.mCompressedSize);
+                mStream->read(mCompressed.data(), static_cast<std::streamsize>(mCompressed.size()));
+                if (!*mStream)
+                    throw std::runtime_error("Failed to read compressed block " + std::to_string(index));
+
+                mBlock.resize(header.mSize);
+                const int size = LZ4_decompress_safe(mCompressed.data(), mBlock.data(),
+                    static_cast<int>(mCompressed.size()), static_cast<int>(mBlock.size()));
+                if (size < 0 || static_cast<std::size_t>(size) != mBlock.size())
+                    throw std::runtime_error("Failed to decompress block " + std::to_string(index));
+
+                if (mBlockOffsets.size() == index + 1)
+                    mBlockOffsets.push_back(mBlockOffsets[index] + static_cast<std::streamoff>(sBlockHeaderSize)
+                        + static_cast<std::streamoff>(header.mCompressedSize));
+
+                mBlockIndex = index;
+                mBlockStart = static_cast<std::uint64_t>(index) * mHeader.mBlockSize;
+                setg(mBlock.data(), mBlock.data(), mBlock.data() + mBlock.size());
+            }
+        };
+    }
+
+    void writeCompressedStream(std::string_view data, std::ostream& stream, std::size_t blockSize)
+    {
+        if (blockSize == 0 || blockSize > static_cast<std::size_t>(LZ4_MAX_INPUT_SIZE))
+            throw std::invalid_argument("Invalid compressed stream block size: " + std::to_string(blockSize));
+
+        writeValue(stream, sMagic);
+        writeValue(stream, sVersion);
+        writeValue(stream, static_cast<std::uint32_t>(blockSize));
+        writeValue(stream, static_cast<std::uint64_t>(data.size()));
+
+        std::vector<char> compressed(static_cast<std::size_t>(LZ4_compressBound(static_cast<int>(blockSize))));
+
+        for (std::size_t offset = 0; offset < data.size(); offset += blockSize)
+        {
+            const std::size_t size = std::min(blockSize, data.size() - offset);
+            const int compressedSize = LZ4_compress_default(data.data() + offset, compressed.data(),
+                static_cast<int>(size), static_cast<int>(compressed.size()));
+            if (compressedSize == 0)
+                throw std::runtime_error("Failed to compress");
+
+            writeValue(stream, static_cast<std::uint32_t>(size));
+            writeValue(stream, static_cast<std::uint32_t>(compressedSize));
+            stream.write(compressed.data(), compressedSize);
+        }
+    }
+
+    bool isCompressedStream(std::istream& stream)
+    {
+        const std::streampos position = stream.tellg();
+
+        std::array<char, 4> magic{};
+        readValue(stream, magic);
+        const bool result = stream.gcount() == static_cast<std::streamsize>(magic.size()) && magic == sMagic;
+
+        stream.clear();
+        stream.seekg(position);
+
+        return result;
+    }
+
+    std::unique_ptr<std::istream> openCompressedStream(std::unique_ptr<std::istream>&& stream)
+    {
+        return std::make_unique<Files::StreamWithBuffer<CompressedStreamBuf>>(
+            std::make_unique<CompressedStreamBuf>(std::move(stream)));
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef OPENMW_COMPONENTS_ESM3_COMPRESSEDSTREAM_H
+#define OPENMW_COMPONENTS_ESM3_COMPRESSEDSTREAM_H
+
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+#include <string_view>
+
+namespace ESM
+{
+    /// Default amount of uncompressed data per block of a compressed stream.
+    inline constexpr std::size_t sDefaultCompressedBlockSize = 256 * 1024;
+
+    /// Write \a data as a block-compressed stream: a small header followed by independently LZ4-compressed blocks.
+    /// Each block can be decoded on its own, so the stream can be read and seeked without decompressing the whole
+    /// file.
+    void writeCompressedStream(
+        std::string_view data, std::ostream& stream, std::size_t blockSize = sDefaultCompressedBlockSize);
+
+    /// Check whether \a stream starts with a compressed stream header. The stream position is left unchanged.
+    bool isCompressedStream(std::istream& stream);
+
+    /// Wrap a block-compressed stream into a seekable stream of decompressed data. Blocks are read and decoded on
+    /// demand, only one block is kept in memory at a time.
+    std::unique_ptr<std::istream> openCompressedStream(std::unique_ptr<std::istream>&& stream);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "esmreader.hpp"
 
+#include "compressedstream.hpp"
 #include "readerscache.hpp"
 
 #include <components/esm3/cellid.hpp>
@@ -120,7 +121,7 @@ namespace ESM
     void ESMReader::openRaw(std::unique_ptr<std::istream>&& stream, const std::filesystem::path& name)
     {
         close();
-        mEsm = std::move(stream);
+        mEsm = isCompressedStream(*stream) ? openCompressedStream(std::move(stream)) : std::move(stream);
         mCtx.filename = name;
         mEsm->seekg(0, mEsm->end);
         mCtx.leftFile = mFileSize = mEsm->tellg();
@@ -132,6 +133,18 @@ namespace ESM
         openRaw(Files::openBinaryInputFileStream(filename), filename);
     }
 
+    void ESMReader::openRecordData(
+        std::unique_ptr<std::istream>&& stream, const std::filesystem::path& name, FormatVersion formatVersion)
+    {
+        openRaw(std::move(stream), name);
+
+        mHeader.mFormatVersion = formatVersion;
+
+        // The whole stream is the body of a single record
+        mCtx.leftRec = mCtx.leftFile;
+        mCtx.leftFile = 0;
+    }
+
     void ESMReader::open(std::unique_ptr<std::istream>&& stream, const std::filesystem::path& name)
     {
         openRaw(std::move(stream), name);
@@ -372,6 +385,27 @@ namespace ESM
         mCtx.subCached = false;
     }
 
+    std::vector<char> ESMReader::getRemainingRecordData()
+    {
+        std::vector<char> result;
+
+        // A sub-record name may already be read by a failed isNextSub()
+        if (mCtx.subCached)
+            result.insert(result.end(), std::begin(mCtx.subName.mData), std::end(mCtx.subName.mData));
+
+        if (mCtx.leftRec > 0)
+        {
+            const std::size_t offset = result.size();
+            result.resize(offset + static_cast<std::size_t>(mCtx.leftRec));
+            getExact(result.data() + offset, static_cast<std::size_t>(mCtx.leftRec));
+        }
+
+        mCtx.leftRec = 0;
+        mCtx.subCached = false;
+
+        return result;
+    }
+
     void ESMReader::getRecHeader(uint32_t& flags)
     {
         if (mCtx.leftFile < static_cast<std::streamsize>(3 * sizeof(uint32_t)))
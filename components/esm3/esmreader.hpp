@@ -88,7 +88,7 @@ namespace ESM
         void close();
 
         /// Raw opening. Opens the file and sets everything up but doesn't
-        /// parse the header.
+        /// parse the header. Block-compressed streams are decompressed transparently.
         void openRaw(std::unique_ptr<std::istream>&& stream, const std::filesystem::path& name);
 
         /// Load ES file from a new stream, parses the header. Closes the
@@ -99,6 +99,11 @@ namespace ESM
 
         void openRaw(const std::filesystem::path& filename);
 
+        /// Open a stream holding sub-records of a single record, as returned by getRemainingRecordData(). There is no
+        /// file header, so the format version of the file the data was read from has to be provided.
+        void openRecordData(
+            std::unique_ptr<std::istream>&& stream, const std::filesystem::path& name, FormatVersion formatVersion);
+
         /// Get the current position in the file. Make sure that the file has been opened!
         size_t getFileOffset() const { return mEsm->tellg(); }
 
@@ -118,7 +123,7 @@ namespace ESM
 
         // Used only when loading saves to adjust FormIds if load order was changes.
         void setContentFileMapping(const std::map<int, int>* mapping) { mContentFileMapping = mapping; }
-        const std::map<int, int>* getContentFileMapping();
+        const std::map<int, int>* getContentFileMapping() const { return mContentFileMapping; }
 
         // Returns false if content file not found.
         bool applyContentFileMapping(FormId& id);
@@ -292,6 +297,11 @@ namespace ESM
         // already been read
         void skipRecord();
 
+        // Read the rest of this record without parsing it, e.g. to parse it
+        // later with openRecordData(). Assumes the name and header have
+        // already been read
+        std::vector<char> getRemainingRecordData();
+
         /* Read record header. This updatesleftFile BEYOND the data that
            follows the header, ie beyond the entire record. You should use
            leftRec to orient yourself inside the record itself.
@@ -21,18 +21,37 @@ namespace Interpreter
         throw std::runtime_error(error);
     }
 
+    [[noreturn]] static void abortInvalidCode(void* /*opcode*/, Runtime& /*runtime*/, unsigned int code)
+    {
+        switch (code >> 30)
+        {
+            case 0:
+                abortUnknownCode(0, code >> 24);
+            case 2:
+                abortUnknownCode(2, (code >> 20) & 0x3ff);
+        }
+
+        switch (code >> 26)
+        {
+            case 0x30:
+                abortUnknownCode(3, (code >> 8) & 0x3ffff);
+            case 0x32:
+                abortUnknownCode(5, code & 0x3ffffff);
+        }
+
+        abortUnknownSegment(code);
+    }
+
     template <typename T>
-    auto& getDispatcher(const T& segment, unsigned int seg, int opcode)
+    DecodedInstruction makeInstruction(const T& segment, int opcode, unsigned int arg0, Type_Code code)
     {
         auto it = segment.find(opcode);
         if (it == segment.end())
-        {
-            abortUnknownCode(seg, opcode);
-        }
-        return it->second;
+            return DecodedInstruction{ &abortInvalidCode, nullptr, code };
+        return DecodedInstruction{ it->second.mExecute, it->second.mObject, arg0 };
     }
 
-    void Interpreter::execute(Type_Code code)
+    DecodedInstruction Interpreter::decode(Type_Code code) const
     {
         unsigned int segSpec = code >> 30;
 
@@ -43,7 +62,7 @@ namespace Interpreter
                 const int opcode = code >> 24;
                 const unsigned int arg0 = code & 0xffffff;
 
-                return getDispatcher(mSegment0, 0, opcode)->execute(mRuntime, arg0);
+                return makeInstruction(mSegment0, opcode, arg0, code);
             }
 
             case 2:
@@ -51,7 +70,7 @@ namespace Interpreter
                 const int opcode = (code >> 20) & 0x3ff;
                 const unsigned int arg0 = code & 0xfffff;
 
-                return getDispatcher(mSegment2, 2, opcode)->execute(mRuntime, arg0);
+                return makeInstruction(mSegment2, opcode, arg0, code);
             }
         }
 
@@ -64,18 +83,28 @@ namespace Interpreter
                 const int opcode = (code >> 8) & 0x3ffff;
                 const unsigned int arg0 = code & 0xff;
 
-                return getDispatcher(mSegment3, 3, opcode)->execute(mRuntime, arg0);
+                return makeInstruction(mSegment3, opcode, arg0, code);
             }
 
             case 0x32:
             {
                 const int opcode = code & 0x3ffffff;
 
-                return getDispatcher(mSegment5, 5, opcode)->execute(mRuntime);
+                return makeInstruction(mSegment5, opcode, 0, code);
             }
         }
 
-        abortUnknownSegment(code);
+        return DecodedInstruction{ &abortInvalidCode, nullptr, code };
+    }
+
+    DecodedProgram Interpreter::decode(Program&& program) const
+    {
+        DecodedProgram result;
+        result.mInstructions.reserve(program.mInstructions.size());
+        for (const Type_Code code : program.mInstructions)
+            result.mInstructions.push_back(decode(code));
+        result.mProgram = std::move(program);
+        return result;
     }
 
     void Interpreter::begin()
@@ -105,7 +134,8 @@ namespace Interpreter
         }
     }
 
-    void Interpreter::run(const Program& program, Context& context)
+    template <class GetInstruction>
+    void Interpreter::run(const Program& program, GetInstruction&& getInstruction, Context& context)
     {
         begin();
 
@@ -113,11 +143,12 @@ namespace Interpreter
         {
             mRuntime.configure(program, context);
 
-            while (mRuntime.getPC() >= 0 && static_cast<std::size_t>(mRuntime.getPC()) < program.mInstructions.size())
+            const std::size_t size = program.mInstructions.size();
+            while (mRuntime.getPC() >= 0 && static_cast<std::size_t>(mRuntime.getPC()) < size)
             {
-                const Type_Code instruction = program.mInstructions[mRuntime.getPC()];
+                const DecodedInstruction instruction = getInstruction(static_cast<std::size_t>(mRuntime.getPC()));
                 mRuntime.setPC(mRuntime.getPC() + 1);
-                execute(instruction);
+                instruction.mExecute(instruction.mOpcode, mRuntime, instruction.mArg0);
             }
         }
         catch (...)
@@ -128,4 +159,15 @@ namespace Interpreter
 
         end();
     }
+
+    void Interpreter::run(const Program& program, Context& context)
+    {
+        // Most of the programs run this way are run once, decoding all of them upfront would not pay off
+        run(program, [&](std::size_t index) { return decode(program.mInstructions[index]); }, context);
+    }
+
+    void Interpreter::run(const DecodedProgram& program, Context& context)
+    {
+        run(program.mProgram, [&](std::size_t index) { return program.mInstructions[index]; }, context);
+    }
 }
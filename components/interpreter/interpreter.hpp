@@ -5,7 +5,9 @@
 #include <memory>
 #include <stack>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <components/misc/strings/format.hpp>
 
@@ -18,29 +20,71 @@ namespace Interpreter
 {
     struct Program;
 
+    /// Instruction with the opcode handler and argument resolved ahead of execution.
+    struct DecodedInstruction
+    {
+        using Execute = void (*)(void* opcode, Runtime& runtime, unsigned int arg0);
+
+        Execute mExecute;
+        void* mOpcode;
+        unsigned int mArg0;
+    };
+
+    /// Program with every instruction decoded by an interpreter, so it is executed without looking up opcodes.
+    /// Must not outlive the interpreter which decoded it.
+    struct DecodedProgram
+    {
+        Program mProgram;
+        std::vector<DecodedInstruction> mInstructions;
+    };
+
     class Interpreter
     {
+        template <typename T>
+        struct Handler
+        {
+            std::unique_ptr<T> mOpcode;
+            void* mObject;
+            DecodedInstruction::Execute mExecute;
+        };
+
         std::stack<Runtime> mCallstack;
         bool mRunning = false;
         Runtime mRuntime;
-        std::map<int, std::unique_ptr<Opcode1>> mSegment0;
-        std::map<int, std::unique_ptr<Opcode1>> mSegment2;
-        std::map<int, std::unique_ptr<Opcode1>> mSegment3;
-        std::map<int, std::unique_ptr<Opcode0>> mSegment5;
+        std::map<int, Handler<Opcode1>> mSegment0;
+        std::map<int, Handler<Opcode1>> mSegment2;
+        std::map<int, Handler<Opcode1>> mSegment3;
+        std::map<int, Handler<Opcode0>> mSegment5;
 
-        void execute(Type_Code code);
+        DecodedInstruction decode(Type_Code code) const;
 
         void begin();
 
         void end();
 
+        template <class GetInstruction>
+        void run(const Program& program, GetInstruction&& getInstruction, Context& context);
+
+        template <typename T>
+        static void executeOpcode(void* opcode, Runtime& runtime, unsigned int arg0)
+        {
+            // Qualified call to skip the virtual dispatch, the concrete type is known at installation
+            if constexpr (std::is_base_of_v<Opcode0, T>)
+                static_cast<T*>(opcode)->T::execute(runtime);
+            else
+                static_cast<T*>(opcode)->T::execute(runtime, arg0);
+        }
+
         template <typename T, typename... Args>
         void installSegment(auto& segment, std::string_view name, int code, Args&&... args)
         {
             if (segment.find(code) != segment.end())
                 throw std::invalid_argument(Misc::StringUtils::format(
                     "Duplicated interpreter instruction code in segment %s: 0x%x", name, code));
-            segment.emplace(code, std::make_unique<T>(std::forward<Args>(args)...));
+            using Segment = std::decay_t<decltype(segment)>;
+            auto opcode = std::make_unique<T>(std::forward<Args>(args)...);
+            void* const object = opcode.get();
+            segment.emplace(code, typename Segment::mapped_type{ std::move(opcode), object, &executeOpcode<T> });
         }
 
     public:
@@ -73,7 +117,14 @@ namespace Interpreter
             installSegment<T>(mSegment5, "5", code, std::forward<TArgs>(args)...);
         }
 
+        DecodedProgram decode(Program&& program) const;
+        ///< Resolve opcodes of all instructions of \a program. Opcodes installed later are not taken into account.
+        /// Unknown opcodes are reported when executed.
+
         void run(const Program& program, Context& context);
+        ///< Decodes each instruction when it's executed.
+
+        void run(const DecodedProgram& program, Context& context);
     };
 }
 
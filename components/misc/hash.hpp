@@ -4,6 +4,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <string_view>
 
 namespace Misc
 {
@@ -22,6 +23,18 @@ namespace Misc
     {
         return (53 + std::hash<int32_t>{}(x)) * 53 + std::hash<int32_t>{}(y);
     }
+
+    /// 64-bit FNV-1a. Unlike std::hash the result doesn't depend on the platform or the standard library
+    /// implementation, so it can be stored on disk.
+    inline std::uint64_t hashFnv1a(std::string_view value, std::uint64_t seed = 0xcbf29ce484222325)
+    {
+        for (const char c : value)
+        {
+            seed ^= static_cast<unsigned char>(c);
+            seed *= 0x100000001b3;
+        }
+        return seed;
+    }
 }
 
 #endif
@@ -3,7 +3,9 @@
 #ifndef OPENMW_COMPONENTS_NIF_NIFKEY_HPP
 #define OPENMW_COMPONENTS_NIF_NIFKEY_HPP
 
-#include <map>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 
 #include "exception.hpp"
 #include "niffile.hpp"
@@ -44,15 +46,54 @@ namespace Nif
     template <typename T, T (NIFStream::*getValue)()>
     struct KeyMapT
     {
-        using MapType = std::map<float, KeyT<T>>;
-
         using ValueType = T;
         using KeyType = KeyT<T>;
 
         std::string mFrameName;
         float mLegacyWeight;
         uint32_t mInterpolationType = InterpolationType_Unknown;
-        MapType mKeys;
+
+        // The keys sorted by time without duplicates, one array per member
+        std::vector<float> mTimes;
+        std::vector<T> mValues;
+        // Only for Quadratic interpolation, and never for QuaternionKeyList, empty otherwise
+        std::vector<T> mInTans;
+        std::vector<T> mOutTans;
+
+        std::size_t size() const { return mTimes.size(); }
+
+        bool empty() const { return mTimes.empty(); }
+
+        bool hasTangents() const
+        {
+            return mInterpolationType == InterpolationType_Quadratic && !std::is_same_v<T, osg::Quat>;
+        }
+
+        // Replaces the key at the same time if there is one. Cheap for keys in order, as they usually are.
+        void insert(float time, const KeyType& key)
+        {
+            auto it = mTimes.end();
+            if (!mTimes.empty() && !(mTimes.back() < time))
+                it = std::lower_bound(mTimes.begin(), mTimes.end(), time);
+            const std::ptrdiff_t index = it - mTimes.begin();
+            if (it == mTimes.end() || *it != time)
+            {
+                mTimes.insert(it, time);
+                mValues.insert(mValues.begin() + index, key.mValue);
+                if (hasTangents())
+                {
+                    mInTans.insert(mInTans.begin() + index, key.mInTan);
+                    mOutTans.insert(mOutTans.begin() + index, key.mOutTan);
+                }
+                return;
+            }
+            mValues[index] = key.mValue;
+            if (hasTangents())
+            {
+                mInTans[index] = key.mInTan;
+                mOutTans[index] = key.mOutTan;
+            }
+        }
 
         // Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
         void read(NIFStream* nif, bool morph = false)
@@ -81,6 +122,14 @@ namespace Nif
 
             KeyType key = {};
 
+            mTimes.reserve(count);
+            mValues.reserve(count);
+            if (hasTangents())
+            {
+                mInTans.reserve(count);
+                mOutTans.reserve(count);
+            }
+
             if (mInterpolationType == InterpolationType_Linear || mInterpolationType == InterpolationType_Constant)
             {
                 for (size_t i = 0; i < count; i++)
@@ -88,7 +137,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readValue(*nif, key);
-                    mKeys[time] = key;
+                    insert(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_Quadratic)
@@ -98,7 +147,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readQuadratic(*nif, key);
-                    mKeys[time] = key;
+                    insert(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_TBC)
@@ -108,7 +157,7 @@ namespace Nif
                     float time;
                     nif->read(time);
                     readTBC(*nif, key);
-                    mKeys[time] = key;
+                    insert(time, key);
                 }
             }
             else if (mInterpolationType == InterpolationType_XYZ)
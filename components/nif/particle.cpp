@@ -681,7 +681,12 @@ namespace Nif
         uint32_t numVisKeys;
         nif->read(numVisKeys);
         for (size_t i = 0; i < numVisKeys; i++)
-            mVisKeyList->mKeys[nif->get<float>()].mValue = nif->get<uint8_t>() != 0;
+        {
+            BoolKeyMap::KeyType key{};
+            const float time = nif->get<float>();
+            key.mValue = nif->get<uint8_t>() != 0;
+            mVisKeyList->insert(time, key);
+        }
     }
 
     void NiPSysCollider::read(NIFStream* nif)
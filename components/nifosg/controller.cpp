@@ -11,6 +11,7 @@
 
 #include <components/nif/data.hpp>
 #include <components/sceneutil/morphgeometry.hpp>
+#include <components/sceneutil/skeleton.hpp>
 
 #include "matrixtransform.hpp"
 
@@ -262,6 +263,15 @@ namespace NifOsg
         {
             if (mKeyFrames.size() <= 1)
                 return;
+            // Facial animation and such is too small to notice from afar
+            if (!mSkeletonSearched)
+            {
+                mSkeleton = SceneUtil::Skeleton::find(nv->getNodePath());
+                mSkeletonSearched = true;
+            }
+            osg::ref_ptr<const SceneUtil::Skeleton> skeleton;
+            if (mSkeleton.lock(skeleton) && skeleton->skipsMorphs())
+                return;
             float input = getInputValue(nv);
             size_t i = 1;
             for (std::vector<FloatInterpolator>::iterator it = mKeyFrames.begin() + 1; it != mKeyFrames.end();
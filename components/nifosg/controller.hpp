@@ -1,10 +1,13 @@
 #ifndef COMPONENTS_NIFOSG_CONTROLLER_H
 #define COMPONENTS_NIFOSG_CONTROLLER_H
 
+#include <algorithm>
 #include <set>
 #include <type_traits>
+#include <vector>
 
 #include <osg/Texture2D>
+#include <osg/observer_ptr>
 
 #include <components/nif/controller.hpp>
 #include <components/nif/data.hpp>
@@ -27,6 +30,7 @@ namespace osgParticle
 namespace SceneUtil
 {
     class MorphGeometry;
+    class Skeleton;
 }
 
 namespace NifOsg
@@ -38,23 +42,23 @@ namespace NifOsg
     template <typename MapT>
     class ValueInterpolator
     {
-        typename MapT::MapType::const_iterator retrieveKey(float time) const
+        // Index of the first key at or after the time, which must be within the track. Starts from the key found by
+        // the previous call, optimized for the most common case where time moves linearly along the keyframe track.
+        std::size_t retrieveKey(float time) const
         {
-            // retrieve the current position in the map, optimized for the most common case
-            // where time moves linearly along the keyframe track
-            if (mLastHighKey != mKeys->mKeys.end())
+            const std::vector<float>& times = mKeys->mTimes;
+            std::size_t index = mCursor;
+            if (index == 0 || index >= times.size() || times[index - 1] >= time)
+                index = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+            else if (times[index] < time)
             {
-                if (time > mLastHighKey->first)
-                {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                }
-                if (mLastHighKey != mKeys->mKeys.end() && time >= mLastLowKey->first && time <= mLastHighKey->first)
-                    return mLastHighKey;
+                // try if we're there by incrementing one
+                ++index;
+                if (times[index] < time)
+                    index = std::lower_bound(times.begin() + index, times.end(), time) - times.begin();
             }
-
-            return mKeys->mKeys.lower_bound(time);
+            mCursor = index;
+            return index;
         }
 
     public:
@@ -74,22 +78,12 @@ namespace NifOsg
             if (interpolator->mData.empty())
                 return;
             mKeys = interpolator->mData->mKeyList;
-            if (mKeys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueInterpolator(std::shared_ptr<const MapT> keys, ValueT defaultVal = ValueT())
             : mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueT interpKey(float time) const
@@ -97,80 +91,71 @@ namespace NifOsg
             if (empty())
                 return mDefaultVal;
 
-            const typename MapT::MapType& keys = mKeys->mKeys;
+            const std::vector<float>& times = mKeys->mTimes;
 
-            if (time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if (time <= times.front())
+                return mKeys->mValues.front();
 
-            typename MapT::MapType::const_iterator it = retrieveKey(time);
+            if (time > times.back())
+                return mKeys->mValues.back();
 
             // now do the actual interpolation
-            if (it != keys.end())
-            {
-                // cache for next time
-                mLastHighKey = it;
-                mLastLowKey = --it;
+            const std::size_t high = retrieveKey(time);
+            const std::size_t low = high - 1;
 
-                float a = (time - mLastLowKey->first) / (mLastHighKey->first - mLastLowKey->first);
+            float a = (time - times[low]) / (times[high] - times[low]);
 
-                return interpolate(mLastLowKey->second, mLastHighKey->second, a, mKeys->mInterpolationType);
-            }
-
-            return keys.rbegin()->second.mValue;
+            return interpolate(low, high, a);
         }
 
-        bool empty() const { return !mKeys || mKeys->mKeys.empty(); }
+        bool empty() const { return !mKeys || mKeys->empty(); }
 
     private:
-        template <typename ValueType>
-        ValueType interpolate(
-            const Nif::KeyT<ValueType>& a, const Nif::KeyT<ValueType>& b, float fraction, unsigned int type) const
+        ValueT interpolate(std::size_t low, std::size_t high, float fraction) const
         {
-            switch (type)
+            const ValueT& a = mKeys->mValues[low];
+            const ValueT& b = mKeys->mValues[high];
+            switch (mKeys->mInterpolationType)
             {
                 case Nif::InterpolationType_Constant:
-                    return fraction > 0.5f ? b.mValue : a.mValue;
+                    return fraction > 0.5f ? b : a;
                 case Nif::InterpolationType_Quadratic:
                 {
-                    // Using a cubic Hermite spline.
-                    // b1(t) = 2t^3  - 3t^2 + 1
-                    // b2(t) = -2t^3 + 3t^2
-                    // b3(t) = t^3 - 2t^2 + t
-                    // b4(t) = t^3 - t^2
-                    // f(t) = a.mValue * b1(t) + b.mValue * b2(t) + a.mOutTan * b3(t) + b.mInTan * b4(t)
-                    const float t = fraction;
-                    const float t2 = t * t;
-                    const float t3 = t2 * t;
-                    const float b1 = 2.f * t3 - 3.f * t2 + 1;
-                    const float b2 = -2.f * t3 + 3.f * t2;
-                    const float b3 = t3 - 2.f * t2 + t;
-                    const float b4 = t3 - t2;
-                    return a.mValue * b1 + b.mValue * b2 + a.mOutTan * b3 + b.mInTan * b4;
+                    if constexpr (std::is_same_v<ValueT, osg::Quat>)
+                        break; // TODO: Implement Quadratic interpolation
+                    else
+                    {
+                        // Using a cubic Hermite spline.
+                        // b1(t) = 2t^3  - 3t^2 + 1
+                        // b2(t) = -2t^3 + 3t^2
+                        // b3(t) = t^3 - 2t^2 + t
+                        // b4(t) = t^3 - t^2
+                        // f(t) = a.mValue * b1(t) + b.mValue * b2(t) + a.mOutTan * b3(t) + b.mInTan * b4(t)
+                        const float t = fraction;
+                        const float t2 = t * t;
+                        const float t3 = t2 * t;
+                        const float b1 = 2.f * t3 - 3.f * t2 + 1;
+                        const float b2 = -2.f * t3 + 3.f * t2;
+                        const float b3 = t3 - 2.f * t2 + t;
+                        const float b4 = t3 - t2;
+                        return a * b1 + b * b2 + mKeys->mOutTans[low] * b3 + mKeys->mInTans[high] * b4;
+                    }
                 }
                 // TODO: Implement TBC interpolation
                 default:
-                    return a.mValue + ((b.mValue - a.mValue) * fraction);
+                    break;
             }
-        }
-        osg::Quat interpolate(
-            const Nif::KeyT<osg::Quat>& a, const Nif::KeyT<osg::Quat>& b, float fraction, unsigned int type) const
-        {
-            switch (type)
+            if constexpr (std::is_same_v<ValueT, osg::Quat>)
             {
-                case Nif::InterpolationType_Constant:
-                    return fraction > 0.5f ? b.mValue : a.mValue;
-                // TODO: Implement Quadratic and TBC interpolation
-                default:
-                {
-                    osg::Quat result;
-                    result.slerp(fraction, a.mValue, b.mValue);
-                    return result;
-                }
+                osg::Quat result;
+                result.slerp(fraction, a, b);
+                return result;
             }
+            else
+                return a + ((b - a) * fraction);
         }
 
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        mutable std::size_t mCursor = 0;
 
         std::shared_ptr<const MapT> mKeys;
 
@@ -215,6 +200,9 @@ namespace NifOsg
     private:
         std::vector<FloatInterpolator> mKeyFrames;
         std::vector<float> mWeights;
+        // The skeleton above the geometry, looked up once
+        bool mSkeletonSearched = false;
+        osg::observer_ptr<const SceneUtil::Skeleton> mSkeleton;
     };
 
 #ifdef _MSC_VER
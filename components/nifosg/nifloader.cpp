@@ -27,7 +27,6 @@
 // particle
 #include <osgParticle/BoxPlacer>
 #include <osgParticle/ConstantRateCounter>
-#include <osgParticle/ModularProgram>
 #include <osgParticle/ParticleSystem>
 #include <osgParticle/ParticleSystemUpdater>
 
@@ -1123,7 +1122,7 @@ namespace NifOsg
             osg::Group* attachTo, osgParticle::ParticleSystem* partsys,
             osgParticle::ParticleProcessor::ReferenceFrame rf)
         {
-            osgParticle::ModularProgram* program = new osgParticle::ModularProgram;
+            ParticleProgram* program = new ParticleProgram;
             attachTo->addChild(program);
             program->setParticleSystem(partsys);
             program->setReferenceFrame(rf);
@@ -1142,7 +1141,7 @@ namespace NifOsg
                 else if (modifier->recType == Nif::RC_NiParticleBomb)
                 {
                     auto bomb = static_cast<const Nif::NiParticleBomb*>(modifier.getPtr());
-                    osg::ref_ptr<osgParticle::ModularProgram> bombProgram(new osgParticle::ModularProgram);
+                    osg::ref_ptr<ParticleProgram> bombProgram(new ParticleProgram);
                     attachTo->addChild(bombProgram);
                     bombProgram->setParticleSystem(partsys);
                     bombProgram->setReferenceFrame(rf);
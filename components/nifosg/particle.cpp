@@ -216,6 +216,101 @@ namespace NifOsg
             std::numeric_limits<float>::epsilon(), mLifetime + mLifetimeRandom * Misc::Rng::rollClosedProbability()));
     }
 
+    void ParticleBatch::add(osgParticle::Particle& particle)
+    {
+        const osg::Vec3& position = particle.getPosition();
+        const osg::Vec3& velocity = particle.getVelocity();
+        mParticles[mSize] = &particle;
+        mAge[mSize] = static_cast<float>(particle.getAge());
+        mLifeTime[mSize] = static_cast<float>(particle.getLifeTime());
+        mPositionX[mSize] = position.x();
+        mPositionY[mSize] = position.y();
+        mPositionZ[mSize] = position.z();
+        mVelocityX[mSize] = velocity.x();
+        mVelocityY[mSize] = velocity.y();
+        mVelocityZ[mSize] = velocity.z();
+        ++mSize;
+    }
+
+    bool ParticleBatch::gather(osgParticle::ParticleSystem& system, int& index)
+    {
+        mSize = 0;
+        mWritten = 0;
+        const int numParticles = system.numParticles();
+        for (; index < numParticles && mSize < sMaxSize; ++index)
+        {
+            osgParticle::Particle* particle = system.getParticle(index);
+            if (particle->isAlive())
+                add(*particle);
+        }
+        return mSize != 0;
+    }
+
+    void ParticleBatch::scatter() const
+    {
+        if (mWritten & Attribute_Velocity)
+            for (std::size_t i = 0; i < mSize; ++i)
+                mParticles[i]->setVelocity(getVelocity(i));
+
+        if (mWritten & Attribute_Size)
+            for (std::size_t i = 0; i < mSize; ++i)
+                mParticles[i]->setSizeRange(osgParticle::rangef(mParticleSize[i], mParticleSize[i]));
+
+        if (mWritten & Attribute_Color)
+            for (std::size_t i = 0; i < mSize; ++i)
+            {
+                const osg::Vec4f color(mColor[i].r(), mColor[i].g(), mColor[i].b(), 1.f);
+                mParticles[i]->setColorRange(osgParticle::rangev4(color, color));
+                mParticles[i]->setAlphaRange(osgParticle::rangef(mColor[i].a(), mColor[i].a()));
+            }
+    }
+
+    void ParticleBatchOperator::operate(osgParticle::Particle* particle, double dt)
+    {
+        ParticleBatch batch;
+        batch.add(*particle);
+        operateBatch(batch, static_cast<float>(dt));
+        batch.scatter();
+    }
+
+    void ParticleBatchOperator::operateParticles(osgParticle::ParticleSystem* system, double dt)
+    {
+        if (!isEnabled())
+            return;
+        ParticleBatch batch;
+        for (int index = 0; batch.gather(*system, index);)
+        {
+            operateBatch(batch, static_cast<float>(dt));
+            batch.scatter();
+        }
+    }
+
+    void ParticleProgram::execute(double dt)
+    {
+        const int numOperators = getNumOperators();
+        for (int i = 0; i < numOperators; ++i)
+            if (dynamic_cast<ParticleBatchOperator*>(getOperator(i)) == nullptr)
+                return osgParticle::ModularProgram::execute(dt);
+
+        for (int i = 0; i < numOperators; ++i)
+            getOperator(i)->beginOperate(this);
+
+        ParticleBatch batch;
+        for (int index = 0; batch.gather(*getParticleSystem(), index);)
+        {
+            for (int i = 0; i < numOperators; ++i)
+            {
+                auto* op = static_cast<ParticleBatchOperator*>(getOperator(i));
+                if (op->isEnabled())
+                    op->operateBatch(batch, static_cast<float>(dt));
+            }
+            batch.scatter();
+        }
+
+        for (int i = 0; i < numOperators; ++i)
+            getOperator(i)->endOperate();
+    }
+
     GrowFadeAffector::GrowFadeAffector(float growTime, float fadeTime)
         : mGrowTime(growTime)
         , mFadeTime(fadeTime)
@@ -231,7 +326,7 @@ namespace NifOsg
     }
 
     GrowFadeAffector::GrowFadeAffector(const GrowFadeAffector& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
     {
         mGrowTime = copy.mGrowTime;
         mFadeTime = copy.mFadeTime;
@@ -243,14 +338,19 @@ namespace NifOsg
         mCachedDefaultSize = program->getParticleSystem()->getDefaultParticleTemplate().getSizeRange().minimum;
     }
 
-    void GrowFadeAffector::operate(osgParticle::Particle* particle, double /* dt */)
+    void GrowFadeAffector::operateBatch(ParticleBatch& batch, float /* dt */)
     {
-        float size = mCachedDefaultSize;
-        if (particle->getAge() < mGrowTime && mGrowTime != 0.f)
-            size *= particle->getAge() / mGrowTime;
-        if (particle->getLifeTime() - particle->getAge() < mFadeTime && mFadeTime != 0.f)
-            size *= (particle->getLifeTime() - particle->getAge()) / mFadeTime;
-        particle->setSizeRange(osgParticle::rangef(size, size));
+        for (std::size_t i = 0; i < batch.mSize; ++i)
+        {
+            float size = mCachedDefaultSize;
+            if (batch.mAge[i] < mGrowTime && mGrowTime != 0.f)
+                size *= batch.mAge[i] / mGrowTime;
+            const float remaining = batch.mLifeTime[i] - batch.mAge[i];
+            if (remaining < mFadeTime && mFadeTime != 0.f)
+                size *= remaining / mFadeTime;
+            batch.mParticleSize[i] = size;
+        }
+        batch.mWritten |= ParticleBatch::Attribute_Size;
     }
 
     ParticleColorAffector::ParticleColorAffector(const Nif::NiColorData* clrdata)
@@ -261,21 +361,19 @@ namespace NifOsg
     ParticleColorAffector::ParticleColorAffector() {}
 
     ParticleColorAffector::ParticleColorAffector(const ParticleColorAffector& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
     {
         mData = copy.mData;
     }
 
-    void ParticleColorAffector::operate(osgParticle::Particle* particle, double /* dt */)
+    void ParticleColorAffector::operateBatch(ParticleBatch& batch, float /* dt */)
     {
-        assert(particle->getLifeTime() > 0);
-        float time = static_cast<float>(particle->getAge() / particle->getLifeTime());
-        osg::Vec4f color = mData.interpKey(time);
-        float alpha = color.a();
-        color.a() = 1.0f;
-
-        particle->setColorRange(osgParticle::rangev4(color, color));
-        particle->setAlphaRange(osgParticle::rangef(alpha, alpha));
+        for (std::size_t i = 0; i < batch.mSize; ++i)
+        {
+            assert(batch.mLifeTime[i] > 0);
+            batch.mColor[i] = mData.interpKey(batch.mAge[i] / batch.mLifeTime[i]);
+        }
+        batch.mWritten |= ParticleBatch::Attribute_Color;
     }
 
     GravityAffector::GravityAffector(const Nif::NiGravity* gravity)
@@ -288,7 +386,7 @@ namespace NifOsg
     }
 
     GravityAffector::GravityAffector(const GravityAffector& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
     {
         mForce = copy.mForce;
         mType = copy.mType;
@@ -311,39 +409,63 @@ namespace NifOsg
         mCachedWorldDirection.normalize();
     }
 
-    void GravityAffector::operate(osgParticle::Particle* particle, double dt)
+    void GravityAffector::operateBatch(ParticleBatch& batch, float dt)
     {
         const float magic = 1.6f;
         switch (mType)
         {
             case Nif::ForceType::Wind:
             {
-                float decayFactor = 1.f;
-                if (mDecay != 0.f)
+                const osg::Vec3f force = mCachedWorldDirection * (mForce * dt * magic);
+                if (mDecay == 0.f)
                 {
-                    osg::Plane gravityPlane(mCachedWorldDirection, mCachedWorldPosition);
-                    float distance = std::abs(gravityPlane.distance(particle->getPosition()));
-                    decayFactor = std::exp(-1.f * mDecay * distance);
+                    for (std::size_t i = 0; i < batch.mSize; ++i)
+                    {
+                        batch.mVelocityX[i] += force.x();
+                        batch.mVelocityY[i] += force.y();
+                        batch.mVelocityZ[i] += force.z();
+                    }
+                    break;
                 }
 
-                particle->addVelocity(mCachedWorldDirection * mForce * dt * decayFactor * magic);
-
+                // Distance of the particles to the plane going through the position along the direction
+                const float planeDistance = -(mCachedWorldDirection * mCachedWorldPosition);
+                for (std::size_t i = 0; i < batch.mSize; ++i)
+                {
+                    const float distance = std::abs(mCachedWorldDirection.x() * batch.mPositionX[i]
+                        + mCachedWorldDirection.y() * batch.mPositionY[i]
+                        + mCachedWorldDirection.z() * batch.mPositionZ[i] + planeDistance);
+                    const float decayFactor = std::exp(-1.f * mDecay * distance);
+                    batch.mVelocityX[i] += force.x() * decayFactor;
+                    batch.mVelocityY[i] += force.y() * decayFactor;
+                    batch.mVelocityZ[i] += force.z() * decayFactor;
+                }
                 break;
             }
             case Nif::ForceType::Point:
             {
-                osg::Vec3f diff = mCachedWorldPosition - particle->getPosition();
-
-                float decayFactor = 1.f;
-                if (mDecay != 0.f)
-                    decayFactor = std::exp(-1.f * mDecay * diff.length());
-
-                diff.normalize();
-
-                particle->addVelocity(diff * mForce * dt * decayFactor * magic);
+                const float force = mForce * dt * magic;
+                for (std::size_t i = 0; i < batch.mSize; ++i)
+                {
+                    const float x = mCachedWorldPosition.x() - batch.mPositionX[i];
+                    const float y = mCachedWorldPosition.y() - batch.mPositionY[i];
+                    const float z = mCachedWorldPosition.z() - batch.mPositionZ[i];
+                    const float length = std::sqrt(x * x + y * y + z * z);
+
+                    float factor = force;
+                    if (mDecay != 0.f)
+                        factor *= std::exp(-1.f * mDecay * length);
+                    if (length > 0.f)
+                        factor /= length;
+
+                    batch.mVelocityX[i] += x * factor;
+                    batch.mVelocityY[i] += y * factor;
+                    batch.mVelocityZ[i] += z * factor;
+                }
                 break;
             }
         }
+        batch.mWritten |= ParticleBatch::Attribute_Velocity;
     }
 
     ParticleBomb::ParticleBomb(const Nif::NiParticleBomb* bomb)
@@ -357,7 +479,7 @@ namespace NifOsg
     }
 
     ParticleBomb::ParticleBomb(const ParticleBomb& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
     {
         mRange = copy.mRange;
         mStrength = copy.mStrength;
@@ -381,47 +503,51 @@ namespace NifOsg
         }
     }
 
-    void ParticleBomb::operate(osgParticle::Particle* particle, double dt)
+    void ParticleBomb::operateBatch(ParticleBatch& batch, float dt)
     {
-        float decay = 1.f;
-        osg::Vec3f explosionDir;
+        for (std::size_t i = 0; i < batch.mSize; ++i)
+        {
+            float decay = 1.f;
+            osg::Vec3f explosionDir;
 
-        osg::Vec3f particleDir = particle->getPosition() - mCachedWorldPosition;
-        float distance = particleDir.length();
-        particleDir.normalize();
+            osg::Vec3f particleDir = batch.getPosition(i) - mCachedWorldPosition;
+            float distance = particleDir.length();
+            particleDir.normalize();
 
-        switch (mDecayType)
-        {
-            case Nif::DecayType::None:
-                break;
-            case Nif::DecayType::Linear:
-                decay = 1.f - distance / mRange;
-                break;
-            case Nif::DecayType::Exponential:
-                decay = std::exp(-distance / mRange);
-                break;
-        }
+            switch (mDecayType)
+            {
+                case Nif::DecayType::None:
+                    break;
+                case Nif::DecayType::Linear:
+                    decay = 1.f - distance / mRange;
+                    break;
+                case Nif::DecayType::Exponential:
+                    decay = std::exp(-distance / mRange);
+                    break;
+            }
 
-        if (decay <= 0.f)
-            return;
+            if (decay <= 0.f)
+                continue;
 
-        switch (mSymmetryType)
-        {
-            case Nif::SymmetryType::Spherical:
-                explosionDir = particleDir;
-                break;
-            case Nif::SymmetryType::Cylindrical:
-                explosionDir = particleDir - mCachedWorldDirection * (mCachedWorldDirection * particleDir);
-                explosionDir.normalize();
-                break;
-            case Nif::SymmetryType::Planar:
-                explosionDir = mCachedWorldDirection;
-                if (explosionDir * particleDir < 0)
-                    explosionDir = -explosionDir;
-                break;
-        }
+            switch (mSymmetryType)
+            {
+                case Nif::SymmetryType::Spherical:
+                    explosionDir = particleDir;
+                    break;
+                case Nif::SymmetryType::Cylindrical:
+                    explosionDir = particleDir - mCachedWorldDirection * (mCachedWorldDirection * particleDir);
+                    explosionDir.normalize();
+                    break;
+                case Nif::SymmetryType::Planar:
+                    explosionDir = mCachedWorldDirection;
+                    if (explosionDir * particleDir < 0)
+                        explosionDir = -explosionDir;
+                    break;
+            }
 
-        particle->addVelocity(explosionDir * mStrength * decay * dt);
+            batch.setVelocity(i, batch.getVelocity(i) + explosionDir * mStrength * decay * dt);
+        }
+        batch.mWritten |= ParticleBatch::Attribute_Velocity;
     }
 
     Emitter::Emitter()
@@ -614,7 +740,7 @@ namespace NifOsg
     }
 
     PlanarCollider::PlanarCollider(const PlanarCollider& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
         , mBounceFactor(copy.mBounceFactor)
         , mExtents(copy.mExtents)
         , mPosition(copy.mPosition)
@@ -643,31 +769,38 @@ namespace NifOsg
         }
     }
 
-    void PlanarCollider::operate(osgParticle::Particle* particle, double dt)
+    void PlanarCollider::operateBatch(ParticleBatch& batch, float /* dt */)
     {
-        // Does the particle in question move towards the collider?
-        float velDotProduct = particle->getVelocity() * mPlaneInParticleSpace.getNormal();
-        if (velDotProduct <= 0)
-            return;
-
-        // Does it intersect the collider's plane?
-        osg::BoundingSphere bs(particle->getPosition(), 0.f);
-        if (mPlaneInParticleSpace.intersect(bs) != 1)
-            return;
-
-        // Is it inside the collider's bounds?
-        osg::Vec3f relativePos = particle->getPosition() - mPositionInParticleSpace;
-        float xDotProduct = relativePos * mXVectorInParticleSpace;
-        float yDotProduct = relativePos * mYVectorInParticleSpace;
-        if (-mExtents.x() * 0.5f > xDotProduct || mExtents.x() * 0.5f < xDotProduct)
-            return;
-        if (-mExtents.y() * 0.5f > yDotProduct || mExtents.y() * 0.5f < yDotProduct)
-            return;
-
-        // Deflect the particle
-        osg::Vec3 reflectedVelocity = particle->getVelocity() - mPlaneInParticleSpace.getNormal() * (2 * velDotProduct);
-        reflectedVelocity *= mBounceFactor;
-        particle->setVelocity(reflectedVelocity);
+        for (std::size_t i = 0; i < batch.mSize; ++i)
+        {
+            const osg::Vec3f velocity = batch.getVelocity(i);
+            const osg::Vec3f position = batch.getPosition(i);
+
+            // Does the particle in question move towards the collider?
+            float velDotProduct = velocity * mPlaneInParticleSpace.getNormal();
+            if (velDotProduct <= 0)
+                continue;
+
+            // Does it intersect the collider's plane?
+            osg::BoundingSphere bs(position, 0.f);
+            if (mPlaneInParticleSpace.intersect(bs) != 1)
+                continue;
+
+            // Is it inside the collider's bounds?
+            osg::Vec3f relativePos = position - mPositionInParticleSpace;
+            float xDotProduct = relativePos * mXVectorInParticleSpace;
+            float yDotProduct = relativePos * mYVectorInParticleSpace;
+            if (-mExtents.x() * 0.5f > xDotProduct || mExtents.x() * 0.5f < xDotProduct)
+                continue;
+            if (-mExtents.y() * 0.5f > yDotProduct || mExtents.y() * 0.5f < yDotProduct)
+                continue;
+
+            // Deflect the particle
+            osg::Vec3 reflectedVelocity = velocity - mPlaneInParticleSpace.getNormal() * (2 * velDotProduct);
+            reflectedVelocity *= mBounceFactor;
+            batch.setVelocity(i, reflectedVelocity);
+        }
+        batch.mWritten |= ParticleBatch::Attribute_Velocity;
     }
 
     SphericalCollider::SphericalCollider(const Nif::NiSphericalCollider* collider)
@@ -682,7 +815,7 @@ namespace NifOsg
     }
 
     SphericalCollider::SphericalCollider(const SphericalCollider& copy, const osg::CopyOp& copyop)
-        : osgParticle::Operator(copy, copyop)
+        : ParticleBatchOperator(copy, copyop)
         , mBounceFactor(copy.mBounceFactor)
         , mSphere(copy.mSphere)
         , mSphereInParticleSpace(copy.mSphereInParticleSpace)
@@ -696,46 +829,51 @@ namespace NifOsg
             mSphereInParticleSpace.center() = program->transformLocalToWorld(mSphereInParticleSpace.center());
     }
 
-    void SphericalCollider::operate(osgParticle::Particle* particle, double dt)
+    void SphericalCollider::operateBatch(ParticleBatch& batch, float dt)
     {
-        osg::Vec3f cent
-            = (particle->getPosition() - mSphereInParticleSpace.center()); // vector from sphere center to particle
+        for (std::size_t i = 0; i < batch.mSize; ++i)
+        {
+            const osg::Vec3f velocity = batch.getVelocity(i);
+            const osg::Vec3f position = batch.getPosition(i);
 
-        bool insideSphere = cent.length2() <= mSphereInParticleSpace.radius2();
+            osg::Vec3f cent = (position - mSphereInParticleSpace.center()); // vector from sphere center to particle
+
+            bool insideSphere = cent.length2() <= mSphereInParticleSpace.radius2();
+
+            // if outside, make sure the particle is flying towards the sphere
+            if (!insideSphere && cent * velocity >= 0.0f)
+                continue;
 
-        if (insideSphere
-            || (cent * particle->getVelocity()
-                < 0.0f)) // if outside, make sure the particle is flying towards the sphere
-        {
             // Collision test (finding point of contact) is performed by solving a quadratic equation:
             // ||vec(cent) + vec(vel)*k|| = R      /^2
             // k^2 + 2*k*(vec(cent)*vec(vel))/||vec(vel)||^2 + (||vec(cent)||^2 - R^2)/||vec(vel)||^2 = 0
 
-            float b = -(cent * particle->getVelocity()) / particle->getVelocity().length2();
+            float b = -(cent * velocity) / velocity.length2();
 
-            osg::Vec3f u = cent + particle->getVelocity() * b;
+            osg::Vec3f u = cent + velocity * b;
 
-            if (insideSphere || (u.length2() < mSphereInParticleSpace.radius2()))
-            {
-                float d = (mSphereInParticleSpace.radius2() - u.length2()) / particle->getVelocity().length2();
-                float k = insideSphere ? (std::sqrt(d) + b) : (b - std::sqrt(d));
+            if (!insideSphere && u.length2() >= mSphereInParticleSpace.radius2())
+                continue;
 
-                if (k < dt)
-                {
-                    // collision detected; reflect off the tangent plane
-                    osg::Vec3f contact = particle->getPosition() + particle->getVelocity() * k;
+            float d = (mSphereInParticleSpace.radius2() - u.length2()) / velocity.length2();
+            float k = insideSphere ? (std::sqrt(d) + b) : (b - std::sqrt(d));
 
-                    osg::Vec3 normal = (contact - mSphereInParticleSpace.center());
-                    normal.normalize();
+            if (k < dt)
+            {
+                // collision detected; reflect off the tangent plane
+                osg::Vec3f contact = position + velocity * k;
 
-                    float dotproduct = particle->getVelocity() * normal;
+                osg::Vec3 normal = (contact - mSphereInParticleSpace.center());
+                normal.normalize();
 
-                    osg::Vec3 reflectedVelocity = particle->getVelocity() - normal * (2 * dotproduct);
-                    reflectedVelocity *= mBounceFactor;
-                    particle->setVelocity(reflectedVelocity);
-                }
+                float dotproduct = velocity * normal;
+
+                osg::Vec3 reflectedVelocity = velocity - normal * (2 * dotproduct);
+                reflectedVelocity *= mBounceFactor;
+                batch.setVelocity(i, reflectedVelocity);
             }
         }
+        batch.mWritten |= ParticleBatch::Attribute_Velocity;
     }
 
 }
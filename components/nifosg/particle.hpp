@@ -1,10 +1,12 @@
 #ifndef OPENMW_COMPONENTS_NIFOSG_PARTICLE_H
 #define OPENMW_COMPONENTS_NIFOSG_PARTICLE_H
 
+#include <cstddef>
 #include <optional>
 
 #include <osgParticle/Counter>
 #include <osgParticle/Emitter>
+#include <osgParticle/ModularProgram>
 #include <osgParticle/Operator>
 #include <osgParticle/Particle>
 #include <osgParticle/Placer>
@@ -98,7 +100,91 @@ namespace NifOsg
         float mLifetimeRandom;
     };
 
-    class PlanarCollider : public osgParticle::Operator
+    // Attributes of a batch of alive particles copied into separate arrays, so that the modifiers update them in
+    // loops the compiler can vectorize instead of through a virtual call per particle and modifier.
+    struct ParticleBatch
+    {
+        static constexpr std::size_t sMaxSize = 64;
+
+        enum Attribute
+        {
+            Attribute_Velocity = 1 << 0,
+            Attribute_Size = 1 << 1,
+            Attribute_Color = 1 << 2,
+        };
+
+        std::size_t mSize = 0;
+        // Attributes to copy back to the particles
+        int mWritten = 0;
+
+        osgParticle::Particle* mParticles[sMaxSize];
+        float mAge[sMaxSize];
+        float mLifeTime[sMaxSize];
+        float mPositionX[sMaxSize];
+        float mPositionY[sMaxSize];
+        float mPositionZ[sMaxSize];
+        float mVelocityX[sMaxSize];
+        float mVelocityY[sMaxSize];
+        float mVelocityZ[sMaxSize];
+        // Only read by scatter
+        float mParticleSize[sMaxSize];
+        osg::Vec4f mColor[sMaxSize];
+
+        void add(osgParticle::Particle& particle);
+
+        /// Fills the batch with the alive particles of the system starting from the given index, which is advanced
+        /// past the last gathered particle.
+        /// @return false if there was no alive particle left
+        bool gather(osgParticle::ParticleSystem& system, int& index);
+
+        void scatter() const;
+
+        osg::Vec3f getPosition(std::size_t i) const { return osg::Vec3f(mPositionX[i], mPositionY[i], mPositionZ[i]); }
+
+        osg::Vec3f getVelocity(std::size_t i) const { return osg::Vec3f(mVelocityX[i], mVelocityY[i], mVelocityZ[i]); }
+
+        void setVelocity(std::size_t i, const osg::Vec3f& velocity)
+        {
+            mVelocityX[i] = velocity.x();
+            mVelocityY[i] = velocity.y();
+            mVelocityZ[i] = velocity.z();
+        }
+    };
+
+    // Operator updating the particles a batch at a time.
+    class ParticleBatchOperator : public osgParticle::Operator
+    {
+    public:
+        ParticleBatchOperator() = default;
+        ParticleBatchOperator(const ParticleBatchOperator& copy, const osg::CopyOp& copyop)
+            : osgParticle::Operator(copy, copyop)
+        {
+        }
+
+        void operate(osgParticle::Particle* particle, double dt) final;
+        void operateParticles(osgParticle::ParticleSystem* system, double dt) final;
+
+        virtual void operateBatch(ParticleBatch& batch, float dt) = 0;
+    };
+
+    // Runs all its ParticleBatchOperators on a batch of particles before moving to the next one, so the particles are
+    // only copied once per frame whatever the number of operators is.
+    class ParticleProgram : public osgParticle::ModularProgram
+    {
+    public:
+        ParticleProgram() = default;
+        ParticleProgram(const ParticleProgram& copy, const osg::CopyOp& copyop)
+            : osgParticle::ModularProgram(copy, copyop)
+        {
+        }
+
+        META_Node(NifOsg, ParticleProgram)
+
+    protected:
+        void execute(double dt) override;
+    };
+
+    class PlanarCollider : public ParticleBatchOperator
     {
     public:
         PlanarCollider(const Nif::NiPlanarCollider* collider);
@@ -108,7 +194,7 @@ namespace NifOsg
         META_Object(NifOsg, PlanarCollider)
 
         void beginOperate(osgParticle::Program* program) override;
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
 
     private:
         float mBounceFactor{ 0.f };
@@ -119,7 +205,7 @@ namespace NifOsg
         osg::Plane mPlane, mPlaneInParticleSpace;
     };
 
-    class SphericalCollider : public osgParticle::Operator
+    class SphericalCollider : public ParticleBatchOperator
     {
     public:
         SphericalCollider(const Nif::NiSphericalCollider* collider);
@@ -129,7 +215,7 @@ namespace NifOsg
         META_Object(NifOsg, SphericalCollider)
 
         void beginOperate(osgParticle::Program* program) override;
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
 
     private:
         float mBounceFactor;
@@ -137,7 +223,7 @@ namespace NifOsg
         osg::BoundingSphere mSphereInParticleSpace;
     };
 
-    class GrowFadeAffector : public osgParticle::Operator
+    class GrowFadeAffector : public ParticleBatchOperator
     {
     public:
         GrowFadeAffector(float growTime, float fadeTime);
@@ -149,7 +235,7 @@ namespace NifOsg
         META_Object(NifOsg, GrowFadeAffector)
 
         void beginOperate(osgParticle::Program* program) override;
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
 
     private:
         float mGrowTime;
@@ -158,7 +244,7 @@ namespace NifOsg
         float mCachedDefaultSize;
     };
 
-    class ParticleColorAffector : public osgParticle::Operator
+    class ParticleColorAffector : public ParticleBatchOperator
     {
     public:
         ParticleColorAffector(const Nif::NiColorData* clrdata);
@@ -169,13 +255,13 @@ namespace NifOsg
 
         META_Object(NifOsg, ParticleColorAffector)
 
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
 
     private:
         Vec4Interpolator mData;
     };
 
-    class GravityAffector : public osgParticle::Operator
+    class GravityAffector : public ParticleBatchOperator
     {
     public:
         GravityAffector(const Nif::NiGravity* gravity);
@@ -186,7 +272,7 @@ namespace NifOsg
 
         META_Object(NifOsg, GravityAffector)
 
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
         void beginOperate(osgParticle::Program*) override;
 
     private:
@@ -199,7 +285,7 @@ namespace NifOsg
         osg::Vec3f mCachedWorldDirection;
     };
 
-    class ParticleBomb : public osgParticle::Operator
+    class ParticleBomb : public ParticleBatchOperator
     {
     public:
         ParticleBomb(const Nif::NiParticleBomb* bomb);
@@ -210,7 +296,7 @@ namespace NifOsg
 
         META_Object(NifOsg, ParticleBomb)
 
-        void operate(osgParticle::Particle* particle, double dt) override;
+        void operateBatch(ParticleBatch& batch, float dt) override;
         void beginOperate(osgParticle::Program*) override;
 
     private:
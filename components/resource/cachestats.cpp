@@ -24,6 +24,7 @@ namespace Resource
             "Get",
             "Hit",
             "Expired",
+            "Memory",
         };
 
         for (std::string_view suffix : suffixes)
@@ -36,5 +37,6 @@ namespace Resource
         dst.setAttribute(frameNumber, makeAttribute(prefix, "Get"), static_cast<double>(src.mGet));
         dst.setAttribute(frameNumber, makeAttribute(prefix, "Hit"), static_cast<double>(src.mHit));
         dst.setAttribute(frameNumber, makeAttribute(prefix, "Expired"), static_cast<double>(src.mExpired));
+        dst.setAttribute(frameNumber, makeAttribute(prefix, "Memory"), static_cast<double>(src.mMemory));
     }
 }
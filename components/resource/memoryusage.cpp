@@ -0,0 +1,179 @@
+#include "memoryusage.hpp"
+
+#include <osg/Geometry>
+#include <osg/Image>
+#include <osg/NodeVisitor>
+#include <osg/Texture>
+
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h>
+
+#include "bulletshape.hpp"
+
+namespace Resource
+{
+    class MemoryUsageVisitor : public osg::NodeVisitor
+    {
+    public:
+        explicit MemoryUsageVisitor(MemoryUsage& usage)
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mUsage(usage)
+        {
+        }
+
+        void apply(osg::Node& node) override
+        {
+            if (const osg::StateSet* stateSet = node.getStateSet())
+                mUsage.addStateSet(*stateSet);
+            traverse(node);
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            if (const osg::StateSet* stateSet = drawable.getStateSet())
+                mUsage.addStateSet(*stateSet);
+            if (const osg::Geometry* geometry = drawable.asGeometry())
+                mUsage.addGeometry(*geometry);
+        }
+
+    private:
+        MemoryUsage& mUsage;
+    };
+
+    void MemoryUsage::add(const osg::Object& object)
+    {
+        if (const osg::Node* node = dynamic_cast<const osg::Node*>(&object))
+            addNode(*node);
+        else if (const osg::StateSet* stateSet = dynamic_cast<const osg::StateSet*>(&object))
+            addStateSet(*stateSet);
+        else if (const osg::Texture* texture = dynamic_cast<const osg::Texture*>(&object))
+            addTexture(*texture);
+        else if (const osg::BufferData* data = dynamic_cast<const osg::BufferData*>(&object))
+        {
+            if (!markCounted(data))
+                return;
+            if (const osg::Image* image = data->asImage())
+                mBytes += image->getTotalSizeInBytesIncludingMipmaps();
+            else
+                mBytes += data->getTotalDataSize();
+        }
+        else if (const BulletShapeInstance* instance = dynamic_cast<const BulletShapeInstance*>(&object))
+        {
+            // Instances share the collision meshes with the source
+            if (instance->getSource() != nullptr)
+                add(*instance->getSource());
+        }
+        else if (const BulletShape* shape = dynamic_cast<const BulletShape*>(&object))
+        {
+            if (!markCounted(shape))
+                return;
+            if (shape->mCollisionShape != nullptr)
+                addCollisionShape(*shape->mCollisionShape);
+            if (shape->mAvoidCollisionShape != nullptr)
+                addCollisionShape(*shape->mAvoidCollisionShape);
+        }
+    }
+
+    void MemoryUsage::addNode(const osg::Node& node)
+    {
+        if (!markCounted(&node))
+            return;
+        MemoryUsageVisitor visitor(*this);
+        // The visitor doesn't modify the node
+        const_cast<osg::Node&>(node).accept(visitor);
+    }
+
+    void MemoryUsage::addStateSet(const osg::StateSet& stateSet)
+    {
+        if (!markCounted(&stateSet))
+            return;
+        for (const osg::StateSet::AttributeList& attributes : stateSet.getTextureAttributeList())
+        {
+            for (const auto& [type, attribute] : attributes)
+            {
+                if (const osg::Texture* texture = attribute.first->asTexture())
+                    addTexture(*texture);
+            }
+        }
+    }
+
+    void MemoryUsage::addTexture(const osg::Texture& texture)
+    {
+        for (unsigned i = 0; i < texture.getNumImages(); ++i)
+            if (const osg::Image* image = texture.getImage(i))
+                add(*image);
+    }
+
+    void MemoryUsage::addGeometry(const osg::Geometry& geometry)
+    {
+        if (!markCounted(&geometry))
+            return;
+
+        osg::Geometry::ArrayList arrays;
+        geometry.getArrayList(arrays);
+        for (const osg::ref_ptr<osg::Array>& array : arrays)
+            add(*array);
+
+        for (unsigned i = 0; i < geometry.getNumPrimitiveSets(); ++i)
+            if (const osg::DrawElements* elements = geometry.getPrimitiveSet(i)->getDrawElements())
+                add(*elements);
+    }
+
+    void MemoryUsage::addCollisionShape(const btCollisionShape& shape)
+    {
+        if (!markCounted(&shape))
+            return;
+
+        if (shape.isCompound())
+        {
+            const btCompoundShape& compound = static_cast<const btCompoundShape&>(shape);
+            for (int i = 0, n = compound.getNumChildShapes(); i < n; ++i)
+                addCollisionShape(*compound.getChildShape(i));
+            return;
+        }
+
+        if (shape.getShapeType() == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE)
+        {
+            addCollisionShape(*static_cast<const btScaledBvhTriangleMeshShape&>(shape).getChildShape());
+            return;
+        }
+
+        if (shape.getShapeType() != TRIANGLE_MESH_SHAPE_PROXYTYPE)
+            return;
+
+        // getOptimizedBvh is not const but doesn't modify the shape
+        auto& mesh = const_cast<btBvhTriangleMeshShape&>(static_cast<const btBvhTriangleMeshShape&>(shape));
+
+        if (const btOptimizedBvh* bvh = mesh.getOptimizedBvh())
+            mBytes += bvh->calculateSerializeBufferSize();
+
+        const btStridingMeshInterface* meshInterface = mesh.getMeshInterface();
+        if (meshInterface == nullptr || !markCounted(meshInterface))
+            return;
+
+        for (int part = 0, n = meshInterface->getNumSubParts(); part < n; ++part)
+        {
+            const unsigned char* vertices = nullptr;
+            int numVertices = 0;
+            PHY_ScalarType vertexType;
+            int vertexStride = 0;
+            const unsigned char* indices = nullptr;
+            int indexStride = 0;
+            int numFaces = 0;
+            PHY_ScalarType indexType;
+            meshInterface->getLockedReadOnlyVertexIndexBase(&vertices, numVertices, vertexType, vertexStride, &indices,
+                indexStride, numFaces, indexType, part);
+            mBytes += static_cast<std::size_t>(numVertices) * vertexStride
+                + static_cast<std::size_t>(numFaces) * indexStride;
+            meshInterface->unLockReadOnlyVertexBase(part);
+        }
+    }
+
+    std::size_t getMemoryUsage(const osg::Object& object)
+    {
+        MemoryUsage usage;
+        usage.add(object);
+        return usage.getBytes();
+    }
+}
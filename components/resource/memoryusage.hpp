@@ -0,0 +1,51 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_MEMORYUSAGE_H
+#define OPENMW_COMPONENTS_RESOURCE_MEMORYUSAGE_H
+
+#include <cstddef>
+#include <unordered_set>
+
+class btCollisionShape;
+
+namespace osg
+{
+    class Object;
+    class Node;
+    class StateSet;
+    class Geometry;
+    class Texture;
+}
+
+namespace Resource
+{
+    /// Approximates the memory used by the data of resources: images, vertex arrays, primitive sets and collision
+    /// meshes. Small per object overhead is not counted. Data shared by several added objects is counted once.
+    class MemoryUsage
+    {
+    public:
+        void add(const osg::Object& object);
+
+        std::size_t getBytes() const { return mBytes; }
+
+    private:
+        std::size_t mBytes = 0;
+        std::unordered_set<const void*> mCounted;
+
+        bool markCounted(const void* data) { return mCounted.insert(data).second; }
+
+        void addNode(const osg::Node& node);
+
+        void addStateSet(const osg::StateSet& stateSet);
+
+        void addGeometry(const osg::Geometry& geometry);
+
+        void addTexture(const osg::Texture& texture);
+
+        void addCollisionShape(const btCollisionShape& shape);
+
+        friend class MemoryUsageVisitor;
+    };
+
+    std::size_t getMemoryUsage(const osg::Object& object);
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "niffilemanager.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include <osg/Object>
@@ -49,9 +50,14 @@ namespace Resource
         {
             auto file = std::make_shared<Nif::NIFFile>(name.value());
             Nif::Reader reader(*file, mEncoder);
-            reader.parse(mVFS->get(name));
+            Files::IStreamPtr stream = mVFS->get(name);
+            // Parsed records take about as much memory as the file
+            stream->seekg(0, std::ios::end);
+            const std::size_t size = static_cast<std::size_t>(std::max<std::streamoff>(0, stream->tellg()));
+            stream->seekg(0, std::ios::beg);
+            reader.parse(std::move(stream));
             obj = new NifFileHolder(file);
-            mCache->addEntryToObjectCache(name.value(), obj);
+            mCache->addEntryToObjectCache(name.value(), obj, 0.0, size);
             return file;
         }
     }
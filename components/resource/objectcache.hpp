@@ -3,6 +3,7 @@
 // - removeExpiredObjectsInCache no longer keeps a lock while the unref happens.
 // - template allows customized KeyType.
 // - objects with uninitialized time stamp are not removed.
+// - the memory used by objects is accounted, least recently used objects are evicted when over a budget.
 
 /* -*-c++-*- OpenSceneGraph - Copyright (C) 1998-2006 Robert Osfield
  *
@@ -21,6 +22,7 @@
 #define OPENMW_COMPONENTS_RESOURCE_OBJECTCACHE
 
 #include "cachestats.hpp"
+#include "memoryusage.hpp"
 
 #include <osg/Node>
 #include <osg/Referenced>
@@ -47,6 +49,7 @@ namespace Resource
     {
         osg::ref_ptr<osg::Object> mValue;
         double mLastUsage;
+        std::size_t mSize = 0;
     };
 
     template <typename KeyType>
@@ -69,32 +72,83 @@ namespace Resource
                     if (item.mLastUsage > expiryTime)
                         return false;
                     ++mExpired;
+                    mMemory -= item.mSize;
                     if (item.mValue != nullptr)
                         objectsToRemove.push_back(std::move(item.mValue));
                     return true;
                 });
+                if (mMaxMemory != 0)
+                    evict(mMaxMemory, objectsToRemove);
             }
             // note, actual unref happens outside of the lock
             objectsToRemove.clear();
         }
 
+        /** Evict least recently used objects not referenced from elsewhere until the memory used by the cache is not
+         * greater than maxMemory. Objects referenced from elsewhere are kept, evicting them doesn't free memory.*/
+        void trim(std::size_t maxMemory)
+        {
+            std::vector<osg::ref_ptr<osg::Object>> objectsToRemove;
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                evict(maxMemory, objectsToRemove);
+            }
+            objectsToRemove.clear();
+        }
+
+        /** Set the memory budget for update in bytes, 0 means no limit.*/
+        void setMaxMemory(std::size_t value)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMaxMemory = value;
+        }
+
+        /** Measure the memory used by added objects even without a budget of this cache, for a budget shared with
+         * other caches. Otherwise objects added without a known size are counted as empty.*/
+        void setMeasureMemory(bool value)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mMeasureMemory = value;
+        }
+
+        std::size_t getMemory() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mMemory;
+        }
+
         /** Remove all objects in the cache regardless of having external references or expiry times.*/
         void clear()
         {
             std::lock_guard<std::mutex> lock(mMutex);
             mItems.clear();
+            mMemory = 0;
         }
 
-        /** Add a key,object,timestamp triple to the Registry::ObjectCache.*/
+        /** Add a key,object,timestamp triple to the Registry::ObjectCache. The memory used by the object is measured
+         * with getMemoryUsage when there is a budget, see setMaxMemory and setMeasureMemory.*/
         template <class K>
         void addEntryToObjectCache(K&& key, osg::Object* object, double timestamp = 0.0)
+        {
+            // Measuring traverses the whole object, skip it when nothing limits the memory
+            const std::size_t size = object == nullptr || !measuresMemory() ? 0 : getMemoryUsage(*object);
+            addEntryToObjectCache(std::forward<K>(key), object, timestamp, size);
+        }
+
+        /** Add a key,object,timestamp triple to the Registry::ObjectCache with the known object size in bytes.*/
+        template <class K>
+        void addEntryToObjectCache(K&& key, osg::Object* object, double timestamp, std::size_t size)
         {
             std::lock_guard<std::mutex> lock(mMutex);
             const auto it = mItems.find(key);
             if (it == mItems.end())
-                mItems.emplace_hint(it, std::forward<K>(key), Item{ object, timestamp });
+                mItems.emplace_hint(it, std::forward<K>(key), Item{ object, timestamp, size });
             else
-                it->second = Item{ object, timestamp };
+            {
+                mMemory -= it->second.mSize;
+                it->second = Item{ object, timestamp, size };
+            }
+            mMemory += size;
         }
 
         /** Remove Object from cache.*/
@@ -103,7 +157,10 @@ namespace Resource
             std::lock_guard<std::mutex> lock(mMutex);
             const auto itr = mItems.find(key);
             if (itr != mItems.end())
+            {
+                mMemory -= itr->second.mSize;
                 mItems.erase(itr);
+            }
         }
 
         /** Get an ref_ptr<Object> from the object cache*/
@@ -180,6 +237,7 @@ namespace Resource
                 .mGet = mGet,
                 .mHit = mHit,
                 .mExpired = mExpired,
+                .mMemory = mMemory,
             };
         }
 
@@ -191,6 +249,15 @@ namespace Resource
         std::size_t mGet = 0;
         std::size_t mHit = 0;
         std::size_t mExpired = 0;
+        std::size_t mMemory = 0;
+        std::size_t mMaxMemory = 0;
+        bool mMeasureMemory = false;
+
+        bool measuresMemory() const
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            return mMaxMemory != 0 || mMeasureMemory;
+        }
 
         Item* find(const auto& key)
         {
@@ -201,6 +268,28 @@ namespace Resource
             ++mHit;
             return &it->second;
         }
+
+        void evict(std::size_t maxMemory, std::vector<osg::ref_ptr<osg::Object>>& objectsToRemove)
+        {
+            if (mMemory <= maxMemory)
+                return;
+            std::vector<typename decltype(mItems)::iterator> candidates;
+            for (auto it = mItems.begin(); it != mItems.end(); ++it)
+                if (it->second.mSize != 0 && (it->second.mValue == nullptr || it->second.mValue->referenceCount() <= 1))
+                    candidates.push_back(it);
+            std::sort(candidates.begin(), candidates.end(),
+                [](const auto& lhs, const auto& rhs) { return lhs->second.mLastUsage < rhs->second.mLastUsage; });
+            for (const auto& it : candidates)
+            {
+                if (mMemory <= maxMemory)
+                    break;
+                ++mExpired;
+                mMemory -= it->second.mSize;
+                if (it->second.mValue != nullptr)
+                    objectsToRemove.push_back(std::move(it->second.mValue));
+                mItems.erase(it);
+            }
+        }
     };
 }
 
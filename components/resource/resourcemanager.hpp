@@ -28,6 +28,10 @@ namespace Resource
         virtual void updateCache(double referenceTime) = 0;
         virtual void clearCache() = 0;
         virtual void setExpiryDelay(double expiryDelay) = 0;
+        virtual void setMaxCacheMemory(std::size_t value) = 0;
+        virtual void setMeasureCacheMemory(bool value) = 0;
+        virtual std::size_t getCacheMemory() const = 0;
+        virtual void trimCache(std::size_t maxMemory) = 0;
         virtual void reportStats(unsigned int frameNumber, osg::Stats* stats) const = 0;
         virtual void releaseGLObjects(osg::State* state) = 0;
     };
@@ -60,6 +64,19 @@ namespace Resource
         void setExpiryDelay(double expiryDelay) final { mExpiryDelay = expiryDelay; }
         double getExpiryDelay() const { return mExpiryDelay; }
 
+        /// The maximum size of cached objects in bytes, 0 means no limit. Least recently used objects that are not
+        /// referenced from elsewhere are evicted by updateCache when exceeded.
+        void setMaxCacheMemory(std::size_t value) final { mCache->setMaxMemory(value); }
+
+        /// Measure the size of cached objects without a budget of this cache, for the budget of ResourceSystem.
+        void setMeasureCacheMemory(bool value) final { mCache->setMeasureMemory(value); }
+
+        /// Approximate size of cached objects in bytes.
+        std::size_t getCacheMemory() const final { return mCache->getMemory(); }
+
+        /// Evict least recently used objects that are not referenced from elsewhere to fit into maxMemory bytes.
+        void trimCache(std::size_t maxMemory) final { mCache->trim(maxMemory); }
+
         const VFS::Manager* getVFS() const { return mVFS; }
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override {}
@@ -81,11 +81,47 @@ namespace Resource
         mNifFileManager->setExpiryDelay(0.0);
     }
 
+    void ResourceSystem::setMaxCacheMemory(std::size_t value)
+    {
+        mMaxCacheMemory = value;
+        for (BaseResourceManager* manager : mResourceManagers)
+            manager->setMeasureCacheMemory(value != 0);
+    }
+
+    void ResourceSystem::setMemoryPressureCallback(std::function<void(std::size_t)> callback)
+    {
+        mMemoryPressureCallback = std::move(callback);
+    }
+
+    std::size_t ResourceSystem::getCacheMemory() const
+    {
+        std::size_t result = 0;
+        for (const BaseResourceManager* manager : mResourceManagers)
+            result += manager->getCacheMemory();
+        return result;
+    }
+
     void ResourceSystem::updateCache(double referenceTime)
     {
         for (std::vector<BaseResourceManager*>::iterator it = mResourceManagers.begin(); it != mResourceManagers.end();
              ++it)
             (*it)->updateCache(referenceTime);
+
+        const std::size_t maxMemory = mMaxCacheMemory;
+        if (maxMemory == 0)
+            return;
+
+        const std::size_t memory = getCacheMemory();
+        if (memory <= maxMemory)
+            return;
+
+        if (mMemoryPressureCallback)
+            mMemoryPressureCallback(memory - maxMemory);
+
+        // Each manager gets the share of the budget proportional to its size
+        const double ratio = static_cast<double>(maxMemory) / static_cast<double>(memory);
+        for (BaseResourceManager* manager : mResourceManagers)
+            manager->trimCache(static_cast<std::size_t>(manager->getCacheMemory() * ratio));
     }
 
     void ResourceSystem::clearCache()
@@ -97,6 +133,7 @@ namespace Resource
 
     void ResourceSystem::addResourceManager(BaseResourceManager* resourceMgr)
     {
+        resourceMgr->setMeasureCacheMemory(mMaxCacheMemory != 0);
         mResourceManagers.push_back(resourceMgr);
     }
 
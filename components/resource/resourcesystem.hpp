@@ -1,6 +1,9 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 #define OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 
+#include <atomic>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -67,6 +70,20 @@ namespace Resource
         /// How long to keep objects in cache after no longer being referenced.
         void setExpiryDelay(double expiryDelay);
 
+        /// The maximum size of objects cached by all resource managers in bytes, 0 means no limit. When exceeded,
+        /// updateCache evicts least recently used objects not referenced from elsewhere from each manager in proportion
+        /// to its size. Objects shared by caches, like images used by nodes, are counted by each of them.
+        /// @note Objects are only measured while there is a limit, set it before they are cached.
+        void setMaxCacheMemory(std::size_t value);
+
+        /// Called by updateCache with the number of bytes over the limit set by setMaxCacheMemory before evicting
+        /// objects. Users holding references to cached objects can release them so they can be evicted.
+        /// @note Called from the thread calling updateCache.
+        void setMemoryPressureCallback(std::function<void(std::size_t)> callback);
+
+        /// Approximate size of objects cached by all resource managers in bytes.
+        std::size_t getCacheMemory() const;
+
         /// @note May be called from any thread.
         const VFS::Manager* getVFS() const;
 
@@ -89,6 +106,9 @@ namespace Resource
 
         const VFS::Manager* mVFS;
 
+        std::atomic<std::size_t> mMaxCacheMemory = 0;
+        std::function<void(std::size_t)> mMemoryPressureCallback;
+
         ResourceSystem(const ResourceSystem&);
         void operator=(const ResourceSystem&);
     };
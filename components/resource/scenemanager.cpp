@@ -2,6 +2,7 @@
 
 #include <cstdlib>
 #include <filesystem>
+#include <set>
 
 #include <osg/AlphaFunc>
 #include <osg/ColorMaski>
@@ -44,6 +45,7 @@
 #include <components/sceneutil/extradata.hpp>
 #include <components/sceneutil/lightmanager.hpp>
 #include <components/sceneutil/optimizer.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 #include <components/sceneutil/riggeometryosgaextension.hpp>
 #include <components/sceneutil/util.hpp>
 #include <components/sceneutil/visitor.hpp>
@@ -133,6 +135,45 @@ namespace
 
 namespace Resource
 {
+    struct CompilingTemplates
+    {
+        std::mutex mMutex;
+        std::set<std::string, std::less<>> mNames;
+
+        void erase(std::string_view name)
+        {
+            const std::lock_guard lock(mMutex);
+            if (const auto it = mNames.find(name); it != mNames.end())
+                mNames.erase(it);
+        }
+    };
+
+    namespace
+    {
+        class TemplateCompiledCallback : public osgUtil::IncrementalCompileOperation::CompileCompletedCallback
+        {
+        public:
+            TemplateCompiledCallback(std::shared_ptr<CompilingTemplates> templates, std::string name)
+                : mTemplates(std::move(templates))
+                , mName(std::move(name))
+            {
+            }
+
+            bool compileCompleted(osgUtil::IncrementalCompileOperation::CompileSet* /*compileSet*/) override
+            {
+                mTemplates->erase(mName);
+                // There is no attachment point, let the IncrementalCompileOperation drop the compile set
+                return false;
+            }
+
+            void cancel() const { mTemplates->erase(mName); }
+
+        private:
+            std::shared_ptr<CompilingTemplates> mTemplates;
+            std::string mName;
+        };
+    }
+
     void TemplateMultiRef::addRef(const osg::Node* node)
     {
         mObjects.emplace_back(node);
@@ -464,6 +505,7 @@ namespace Resource
         , mMaxAnisotropy(1)
         , mUnRefImageDataAfterApply(false)
         , mParticleSystemMask(~0u)
+        , mCompilingTemplates(std::make_shared<CompilingTemplates>())
     {
     }
 
@@ -549,10 +591,18 @@ namespace Resource
     {
         mLightingMethod = method;
 
-        if (mLightingMethod == SceneUtil::LightingMethod::SingleUBO)
+        if (mLightingMethod == SceneUtil::LightingMethod::SingleUBO
+            || mLightingMethod == SceneUtil::LightingMethod::Clustered)
         {
             osg::ref_ptr<osg::Program> program = new osg::Program;
             program->addBindUniformBlock("LightBufferBinding", static_cast<int>(UBOBinding::LightBuffer));
+            if (mLightingMethod == SceneUtil::LightingMethod::Clustered)
+            {
+                program->addBindUniformBlock(
+                    "LightClusterGridBinding", static_cast<int>(UBOBinding::LightClusterGrid));
+                program->addBindUniformBlock(
+                    "LightClusterIndexBinding", static_cast<int>(UBOBinding::LightClusterIndices));
+            }
             mShaderManager->setProgramTemplate(program);
         }
     }
@@ -562,6 +612,17 @@ namespace Resource
         return mLightingMethod;
     }
 
+    void SceneManager::setGpuSkinning(bool enabled)
+    {
+        mSkinningProgramTemplate = nullptr;
+        if (!enabled)
+            return;
+
+        // Must be called after setLightingMethod to keep the bindings of its template
+        mSkinningProgramTemplate
+            = SceneUtil::RigGeometry::makeSkinningProgramTemplate(mShaderManager->getProgramTemplate());
+    }
+
     void SceneManager::setConvertAlphaTestToAlphaToCoverage(bool convert)
     {
         mConvertAlphaTestToAlphaToCoverage = convert;
@@ -1029,7 +1090,17 @@ namespace Resource
                 shareState(loaded);
 
             if (compile && mIncrementalCompileOperation)
-                mIncrementalCompileOperation->add(loaded);
+            {
+                {
+                    const std::lock_guard lock(mCompilingTemplates->mMutex);
+                    mCompilingTemplates->mNames.emplace(normalized.value());
+                }
+                osg::ref_ptr<osgUtil::IncrementalCompileOperation::CompileSet> compileSet
+                    = new osgUtil::IncrementalCompileOperation::CompileSet(loaded);
+                compileSet->_compileCompletedCallback
+                    = new TemplateCompiledCallback(mCompilingTemplates, std::string(normalized.value()));
+                mIncrementalCompileOperation->add(compileSet);
+            }
             else
                 loaded->getBound();
 
@@ -1111,6 +1182,13 @@ namespace Resource
         return mIncrementalCompileOperation.get();
     }
 
+    bool SceneManager::isCompiling(std::string_view name) const
+    {
+        const VFS::Path::Normalized normalized(name);
+        const std::lock_guard lock(mCompilingTemplates->mMutex);
+        return mCompilingTemplates->mNames.contains(normalized.value());
+    }
+
     Resource::ImageManager* SceneManager::getImageManager()
     {
         return mImageManager;
@@ -1197,6 +1275,9 @@ namespace Resource
                 if (refcount <= 2) // ref by ObjectCache + ref by _subgraphToCompile.
                 {
                     // no other ref = not needed anymore.
+                    if (const auto* callback
+                        = dynamic_cast<const TemplateCompiledCallback*>((*it)->_compileCompletedCallback.get()))
+                        callback->cancel();
                     it = sets.erase(it);
                 }
                 else
@@ -1245,6 +1326,7 @@ namespace Resource
         shaderVisitor->setAdjustCoverageForAlphaTest(mAdjustCoverageForAlphaTest);
         shaderVisitor->setSupportsNormalsRT(mSupportsNormalsRT);
         shaderVisitor->setWeatherParticleOcclusion(mWeatherParticleOcclusion);
+        shaderVisitor->setSkinningProgramTemplate(mSkinningProgramTemplate);
         return shaderVisitor;
     }
 }
@@ -34,6 +34,7 @@ namespace Resource
     class NifFileManager;
     class BgsmFileManager;
     class SharedStateManager;
+    struct CompilingTemplates;
 }
 
 namespace osgUtil
@@ -141,7 +142,9 @@ namespace Resource
             // If we add more UBO's, we should probably assign their bindings dynamically according to the current count
             // of UBO's in the programTemplate
             LightBuffer,
-            PostProcessor
+            PostProcessor,
+            LightClusterGrid,
+            LightClusterIndices
         };
         void setLightingMethod(SceneUtil::LightingMethod method);
         SceneUtil::LightingMethod getLightingMethod() const;
@@ -196,6 +199,11 @@ namespace Resource
 
         osgUtil::IncrementalCompileOperation* getIncrementalCompileOperation();
 
+        /// Check if the GL objects of a scene template requested with compile = true are still waiting to be created
+        /// by the IncrementalCompileOperation. Drawing an instance of it before that creates them in the draw thread.
+        /// @note Thread safe.
+        bool isCompiling(std::string_view name) const;
+
         Resource::ImageManager* getImageManager();
 
         /// @param mask The node mask to apply to loaded particle system nodes.
@@ -232,6 +240,9 @@ namespace Resource
 
         void setWeatherParticleOcclusion(bool value) { mWeatherParticleOcclusion = value; }
 
+        /// Skin the rigged meshes in the shaders when they use the objects shaders.
+        void setGpuSkinning(bool enabled);
+
     private:
         osg::ref_ptr<Shader::ShaderVisitor> createShaderVisitor(const std::string& shaderPrefix = "objects");
         osg::ref_ptr<osg::Node> loadErrorMarker();
@@ -254,6 +265,7 @@ namespace Resource
         std::array<osg::ref_ptr<osg::Texture>, 2> mOpaqueDepthTex;
         bool mSoftParticles = false;
         bool mWeatherParticleOcclusion = false;
+        osg::ref_ptr<osg::Program> mSkinningProgramTemplate;
 
         osg::ref_ptr<Resource::SharedStateManager> mSharedStateManager;
         mutable std::mutex mSharedStateMutex;
@@ -271,6 +283,7 @@ namespace Resource
 
         unsigned int mParticleSystemMask;
         mutable osg::ref_ptr<osg::Node> mErrorMarker;
+        std::shared_ptr<CompilingTemplates> mCompilingTemplates;
 
         SceneManager(const SceneManager&);
         void operator=(const SceneManager&);
@@ -102,6 +102,17 @@ namespace Resource
                 "CellPreloader Evicted",
                 "CellPreloader Loaded",
                 "CellPreloader Expired",
+                "CellPreloader Memory",
+            };
+
+            constexpr std::string_view cellActivation[] = {
+                "CellActivation Pending",
+                "CellActivation Activated",
+                "CellActivation Rendering",
+                "CellActivation Mechanics",
+                "CellActivation Physics",
+                "CellActivation Lua",
+                "CellActivation Navigator",
             };
 
             constexpr std::string_view navMesh[] = {
@@ -131,16 +142,26 @@ namespace Resource
             for (std::string_view name : firstPage)
                 statNames.emplace_back(name);
 
+            constexpr std::size_t cachesPerPage = 4;
+
             for (std::size_t i = 0; i < std::size(caches); ++i)
             {
                 Resource::addCacheStatsAttibutes(caches[i], statNames);
-                if ((i + 1) % 5 != 0)
+                if ((i + 1) % cachesPerPage != 0)
                     statNames.emplace_back();
+                else
+                    while (statNames.size() % itemsPerPage != 0)
+                        statNames.emplace_back();
             }
 
             for (std::string_view name : cellPreloader)
                 statNames.emplace_back(name);
 
+            statNames.emplace_back();
+
+            for (std::string_view name : cellActivation)
+                statNames.emplace_back(name);
+
             while (statNames.size() % itemsPerPage != 0)
                 statNames.emplace_back();
 
@@ -0,0 +1,134 @@
+#include "lightcluster.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        // Signed distance of a point to the plane of the points projected to the given normalized device coordinate.
+        // Positive distances are on the side of greater coordinates.
+        float getPlaneDistance(const osg::Matrix& projection, int axis, float ndc, const osg::Vec3f& point)
+        {
+            const osg::Vec4f plane(projection(0, axis) - ndc * projection(0, 3),
+                projection(1, axis) - ndc * projection(1, 3), projection(2, axis) - ndc * projection(2, 3),
+                projection(3, axis) - ndc * projection(3, 3));
+            const float length = osg::Vec3f(plane.x(), plane.y(), plane.z()).length();
+            if (length == 0)
+                return 0;
+            return (plane.x() * point.x() + plane.y() * point.y() + plane.z() * point.z() + plane.w()) / length;
+        }
+
+        // The first and last tiles extend beyond the screen so vertices outside of it still find their lights
+        bool getTiles(const osg::Matrix& projection, int axis, int numTiles, const osg::BoundingSphere& bound,
+            int& begin, int& end)
+        {
+            const auto boundary = [&](int i) { return -1.f + 2.f * i / numTiles; };
+            const float radius = bound.radius();
+
+            begin = 0;
+            while (begin < numTiles - 1
+                && getPlaneDistance(projection, axis, boundary(begin + 1), bound.center()) >= radius)
+                ++begin;
+
+            end = numTiles;
+            while (end > 1 && getPlaneDistance(projection, axis, boundary(end - 1), bound.center()) <= -radius)
+                --end;
+
+            return begin < end;
+        }
+    }
+
+    LightClusters::LightClusters()
+        : mClusters(sNumClusters, 0)
+    {
+        setDepthRange(0);
+    }
+
+    void LightClusters::build(const osg::Matrix& projection, const std::vector<Light>& lights, int maxLightsPerCluster)
+    {
+        maxLightsPerCluster = std::clamp(maxLightsPerCluster, 0, 0xffff);
+
+        float farDepth = 0;
+        for (const Light& light : lights)
+            farDepth = std::max(farDepth, -light.mViewBound.center().z() + light.mViewBound.radius());
+        setDepthRange(farDepth);
+
+        mRanges.clear();
+        for (const Light& light : lights)
+        {
+            const osg::BoundingSphere& bound = light.mViewBound;
+            const float depth = -bound.center().z();
+
+            Range range;
+            if (depth + bound.radius() <= 0
+                || !getTiles(projection, 0, sTilesX, bound, range.mBegin[0], range.mEnd[0])
+                || !getTiles(projection, 1, sTilesY, bound, range.mBegin[1], range.mEnd[1]))
+                range.mBegin[2] = range.mEnd[2] = 0;
+            else
+            {
+                range.mBegin[2] = getSlice(depth - bound.radius());
+                range.mEnd[2] = getSlice(depth + bound.radius()) + 1;
+            }
+            mRanges.push_back(range);
+        }
+
+        const auto forEachCluster = [](const Range& range, auto&& f) {
+            for (int z = range.mBegin[2]; z < range.mEnd[2]; ++z)
+                for (int y = range.mBegin[1]; y < range.mEnd[1]; ++y)
+                    for (int x = range.mBegin[0]; x < range.mEnd[0]; ++x)
+                        f((z * sTilesY + y) * sTilesX + x);
+        };
+
+        mCounts.assign(sNumClusters, 0);
+        for (const Range& range : mRanges)
+            forEachCluster(range, [&](int cluster) {
+                mCounts[cluster] = std::min(mCounts[cluster] + 1, maxLightsPerCluster);
+            });
+
+        // Clusters are ordered from near to far so the farthest ones are the first to miss lights when the list of
+        // indices is full
+        int offset = 0;
+        for (int cluster = 0; cluster < sNumClusters; ++cluster)
+        {
+            const int count = std::min(mCounts[cluster], sMaxIndices - offset);
+            mClusters[cluster] = static_cast<std::uint32_t>(offset) | static_cast<std::uint32_t>(count) << 16;
+            offset += count;
+            mCounts[cluster] = 0;
+        }
+
+        mIndices.resize(offset);
+        for (std::size_t i = 0; i < lights.size(); ++i)
+        {
+            forEachCluster(mRanges[i], [&](int cluster) {
+                const std::uint32_t data = mClusters[cluster];
+                if (static_cast<std::uint32_t>(mCounts[cluster]) < data >> 16)
+                    mIndices[(data & 0xffff) + mCounts[cluster]++] = static_cast<std::uint16_t>(lights[i].mIndex);
+            });
+        }
+    }
+
+    int LightClusters::getClusterIndex(const osg::Vec3f& viewPos, const osg::Matrix& projection) const
+    {
+        const osg::Vec4f clip = osg::Vec4f(viewPos, 1.f) * projection;
+        const float ndcX = clip.x() / clip.w();
+        const float ndcY = clip.y() / clip.w();
+        const int x = std::clamp(static_cast<int>((ndcX * 0.5f + 0.5f) * sTilesX), 0, sTilesX - 1);
+        const int y = std::clamp(static_cast<int>((ndcY * 0.5f + 0.5f) * sTilesY), 0, sTilesY - 1);
+        return (getSlice(-viewPos.z()) * sTilesY + y) * sTilesX + x;
+    }
+
+    int LightClusters::getSlice(float depth) const
+    {
+        const float slice = std::log2(std::max(depth, 1.f)) * mDepthScale + mDepthBias;
+        return std::clamp(static_cast<int>(slice), 0, sSlices - 1);
+    }
+
+    void LightClusters::setDepthRange(float farDepth)
+    {
+        farDepth = std::max(farDepth, sNearSliceDepth * 2);
+        mDepthScale = sSlices / std::log2(farDepth / sNearSliceDepth);
+        mDepthBias = -std::log2(sNearSliceDepth) * mDepthScale;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_LIGHTCLUSTER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_LIGHTCLUSTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <osg/BoundingSphere>
+#include <osg/Matrix>
+
+namespace SceneUtil
+{
+    /// Assigns lights to the cells (clusters) of a view space grid: tiles of the screen split into slices of depth
+    /// growing exponentially with the distance to the camera. Shaders find the cluster of a fragment from its view
+    /// position and only loop over the lights of that cluster.
+    /// @par The layout of the data matches files/shaders/lib/light/lighting_util.glsl: every cluster is packed as
+    /// offset | count << 16 into the list of light indices, indices are 16 bit.
+    class LightClusters
+    {
+    public:
+        static constexpr int sTilesX = 16;
+        static constexpr int sTilesY = 8;
+        static constexpr int sSlices = 16;
+        static constexpr int sNumClusters = sTilesX * sTilesY * sSlices;
+        static constexpr int sMaxIndices = 8192;
+        /// Everything closer to the camera falls into the first slice
+        static constexpr float sNearSliceDepth = 64.f;
+
+        struct Light
+        {
+            osg::BoundingSphere mViewBound;
+            int mIndex;
+        };
+
+        LightClusters();
+
+        /// @param lights Sorted by priority, lights further in the list are dropped first from full clusters
+        /// @param maxLightsPerCluster Lights per cluster above this count are ignored
+        void build(const osg::Matrix& projection, const std::vector<Light>& lights, int maxLightsPerCluster);
+
+        const std::vector<std::uint32_t>& getClusters() const { return mClusters; }
+
+        const std::vector<std::uint16_t>& getIndices() const { return mIndices; }
+
+        /// The slice of a view position is log2(depth) * scale + bias
+        float getDepthScale() const { return mDepthScale; }
+
+        float getDepthBias() const { return mDepthBias; }
+
+        /// Same computation as the shaders
+        int getClusterIndex(const osg::Vec3f& viewPos, const osg::Matrix& projection) const;
+
+    private:
+        std::vector<std::uint32_t> mClusters;
+        std::vector<std::uint16_t> mIndices;
+        float mDepthScale;
+        float mDepthBias;
+
+        struct Range
+        {
+            int mBegin[3];
+            int mEnd[3];
+        };
+
+        std::vector<Range> mRanges;
+        std::vector<int> mCounts;
+
+        int getSlice(float depth) const;
+
+        void setDepthRange(float farDepth);
+    };
+}
+
+#endif
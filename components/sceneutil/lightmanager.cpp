@@ -9,6 +9,7 @@
 #include <osg/BufferObject>
 #include <osg/Endian>
 #include <osg/ValueObject>
+#include <osg/Vec4i>
 
 #include <osgUtil/CullVisitor>
 
@@ -72,6 +73,7 @@ namespace SceneUtil
             { "legacy", LightingMethod::FFP },
             { "shaders compatibility", LightingMethod::PerObjectUniform },
             { "shaders", LightingMethod::SingleUBO },
+            { "shaders clustered", LightingMethod::Clustered },
         };
     }
 
@@ -627,7 +629,8 @@ namespace SceneUtil
         {
             osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
 
-            if (node->getLightingMethod() == LightingMethod::SingleUBO)
+            if (node->getLightingMethod() == LightingMethod::SingleUBO
+                || node->getLightingMethod() == LightingMethod::Clustered)
             {
                 const size_t frameId = cv->getTraversalNumber() % 2;
                 stateset->setAttributeAndModes(mUBBs[frameId], osg::StateAttribute::ON);
@@ -641,6 +644,9 @@ namespace SceneUtil
                     buffer->setDiffuse(0, sun->getDiffuse());
                     buffer->setSpecular(0, sun->getSpecular());
                 }
+
+                if (node->getLightingMethod() == LightingMethod::Clustered)
+                    node->applyLightClusters(cv, stateset);
             }
             else if (node->getLightingMethod() == LightingMethod::PerObjectUniform)
             {
@@ -668,11 +674,13 @@ namespace SceneUtil
         std::array<osg::ref_ptr<osg::UniformBufferBinding>, 2> mUBBs;
     };
 
-    UBOManager::UBOManager(int lightCount)
+    UBOManager::UBOManager(int lightCount, bool lightClusters)
         : mDummyProgram(new osg::Program)
         , mInitLayout(false)
         , mDirty({ true, true })
         , mTemplate(new LightBuffer(lightCount))
+        , mLightClusterGridStride(sizeof(osg::Vec4i))
+        , mLightClusterIndexStride(sizeof(osg::Vec4i))
     {
         static const std::string dummyVertSource = generateDummyShader(lightCount);
 
@@ -682,6 +690,17 @@ namespace SceneUtil
         mDummyProgram->addBindUniformBlock(
             "LightBufferBinding", static_cast<int>(Resource::SceneManager::UBOBinding::LightBuffer));
 
+        if (lightClusters)
+        {
+            mLightClustersDummyProgram = new osg::Program;
+            mLightClustersDummyProgram->addShader(
+                new osg::Shader(osg::Shader::VERTEX, generateLightClustersDummyShader()));
+            mLightClustersDummyProgram->addBindUniformBlock("LightClusterGridBinding",
+                static_cast<int>(Resource::SceneManager::UBOBinding::LightClusterGrid));
+            mLightClustersDummyProgram->addBindUniformBlock("LightClusterIndexBinding",
+                static_cast<int>(Resource::SceneManager::UBOBinding::LightClusterIndices));
+        }
+
         for (size_t i = 0; i < mLightBuffers.size(); ++i)
         {
             mLightBuffers[i] = new LightBuffer(lightCount);
@@ -696,13 +715,18 @@ namespace SceneUtil
     UBOManager::UBOManager(const UBOManager& copy, const osg::CopyOp& copyop)
         : osg::StateAttribute(copy, copyop)
         , mDummyProgram(copy.mDummyProgram)
+        , mLightClustersDummyProgram(copy.mLightClustersDummyProgram)
         , mInitLayout(copy.mInitLayout)
+        , mLightClusterGridStride(copy.mLightClusterGridStride.load())
+        , mLightClusterIndexStride(copy.mLightClusterIndexStride.load())
     {
     }
 
     void UBOManager::releaseGLObjects(osg::State* state) const
     {
         mDummyProgram->releaseGLObjects(state);
+        if (mLightClustersDummyProgram)
+            mLightClustersDummyProgram->releaseGLObjects(state);
     }
 
     int UBOManager::compare(const StateAttribute& sa) const
@@ -730,6 +754,12 @@ namespace SceneUtil
                 initSharedLayout(ext, handle, frame);
                 mInitLayout = true;
             }
+
+            if (mInitLayout && mLightClustersDummyProgram)
+            {
+                mLightClustersDummyProgram->apply(state);
+                initLightClustersLayout(ext, mLightClustersDummyProgram->getPCP(state)->getHandle());
+            }
         }
         else if (mDirty[index])
         {
@@ -766,6 +796,26 @@ namespace SceneUtil
         return shader;
     }
 
+    std::string UBOManager::generateLightClustersDummyShader()
+    {
+        return R"GLSL(
+            #version 120
+            #extension GL_ARB_uniform_buffer_object : require
+            uniform LightClusterGridBinding {
+                ivec4 LightClusterGrid[)GLSL"
+            + std::to_string(LightClusters::sNumClusters / 4) + R"GLSL(];
+            };
+            uniform LightClusterIndexBinding {
+                ivec4 LightClusterIndices[)GLSL"
+            + std::to_string(LightClusters::sMaxIndices / 8) + R"GLSL(];
+            };
+            void main()
+            {
+                gl_Position = vec4(LightClusterGrid[0] + LightClusterIndices[0]);
+            }
+        )GLSL";
+    }
+
     void UBOManager::initSharedLayout(osg::GLExtensions* ext, int handle, unsigned int frame) const
     {
         constexpr std::array<unsigned int, 1> index
@@ -790,6 +840,28 @@ namespace SceneUtil
         mTemplate->configureLayout(offsets[0], offsets[1], offsets[2], totalBlockSize, stride);
     }
 
+    void UBOManager::initLightClustersLayout(osg::GLExtensions* ext, int handle) const
+    {
+        std::array<const char*, 2> names = {
+            "LightClusterGrid[0]",
+            "LightClusterIndices[0]",
+        };
+        std::array<unsigned int, 2> indices;
+        std::array<int, 2> strides = { -1, -1 };
+
+        ext->glGetUniformIndices(handle, names.size(), names.data(), indices.data());
+        ext->glGetActiveUniformsiv(handle, indices.size(), indices.data(), GL_UNIFORM_ARRAY_STRIDE, strides.data());
+
+        if (strides[0] < static_cast<int>(sizeof(osg::Vec4i)) || strides[1] < static_cast<int>(sizeof(osg::Vec4i)))
+        {
+            Log(Debug::Error) << "Unexpected light cluster array strides " << strides[0] << " and " << strides[1];
+            return;
+        }
+
+        mLightClusterGridStride = strides[0];
+        mLightClusterIndexStride = strides[1];
+    }
+
     LightingMethod LightManager::getLightingMethodFromString(const std::string& value)
     {
         auto it = lightingMethodSettingMap.find(value);
@@ -824,6 +896,7 @@ namespace SceneUtil
         mSupported[static_cast<int>(LightingMethod::FFP)] = true;
         mSupported[static_cast<int>(LightingMethod::PerObjectUniform)] = true;
         mSupported[static_cast<int>(LightingMethod::SingleUBO)] = supportsUBO && supportsGPU4;
+        mSupported[static_cast<int>(LightingMethod::Clustered)] = supportsUBO && supportsGPU4;
 
         setUpdateCallback(new LightManagerUpdateCallback);
 
@@ -835,7 +908,9 @@ namespace SceneUtil
         {
             static bool hasLoggedWarnings = false;
 
-            if (settings.mLightingMethod == LightingMethod::SingleUBO && !hasLoggedWarnings)
+            if ((settings.mLightingMethod == LightingMethod::SingleUBO
+                    || settings.mLightingMethod == LightingMethod::Clustered)
+                && !hasLoggedWarnings)
             {
                 if (!supportsUBO)
                     Log(Debug::Warning) << "GL_ARB_uniform_buffer_object not supported: switching to shader "
@@ -848,6 +923,8 @@ namespace SceneUtil
 
             if (!supportsUBO || !supportsGPU4 || settings.mLightingMethod == LightingMethod::PerObjectUniform)
                 initPerObjectUniform(settings.mMaxLights);
+            else if (settings.mLightingMethod == LightingMethod::Clustered)
+                initClustered(settings.mMaxLights);
             else
                 initSingleUBO(settings.mMaxLights);
 
@@ -903,17 +980,36 @@ namespace SceneUtil
     {
         Shader::ShaderManager::DefineMap defines;
 
+        const bool clustered = getLightingMethod() == LightingMethod::Clustered;
+        // the clustered method uses the light buffer of the single UBO method
+        const bool useUBO = getLightingMethod() == LightingMethod::SingleUBO || clustered;
+
         defines["maxLights"] = std::to_string(getMaxLights());
         defines["maxLightsInScene"] = std::to_string(getMaxLightsInScene());
         defines["lightingMethodFFP"] = getLightingMethod() == LightingMethod::FFP ? "1" : "0";
         defines["lightingMethodPerObjectUniform"] = getLightingMethod() == LightingMethod::PerObjectUniform ? "1" : "0";
-        defines["lightingMethodUBO"] = getLightingMethod() == LightingMethod::SingleUBO ? "1" : "0";
-        defines["useUBO"] = std::to_string(getLightingMethod() == LightingMethod::SingleUBO);
+        defines["lightingMethodUBO"] = useUBO ? "1" : "0";
+        defines["lightingMethodClustered"] = clustered ? "1" : "0";
+        defines["useUBO"] = std::to_string(useUBO);
         // exposes bitwise operators
-        defines["useGPUShader4"] = std::to_string(getLightingMethod() == LightingMethod::SingleUBO);
+        defines["useGPUShader4"] = std::to_string(useUBO);
         defines["getLight"] = getLightingMethod() == LightingMethod::FFP ? "gl_LightSource" : "LightBuffer";
-        defines["startLight"] = getLightingMethod() == LightingMethod::SingleUBO ? "0" : "1";
-        defines["endLight"] = getLightingMethod() == LightingMethod::FFP ? defines["maxLights"] : "PointLightCount";
+        if (clustered)
+        {
+            // locals of doLighting holding the range of the cluster in the light indices
+            defines["startLight"] = "clusterStart";
+            defines["endLight"] = "clusterEnd";
+        }
+        else
+        {
+            defines["startLight"] = getLightingMethod() == LightingMethod::SingleUBO ? "0" : "1";
+            defines["endLight"] = getLightingMethod() == LightingMethod::FFP ? defines["maxLights"] : "PointLightCount";
+        }
+        defines["lightClusterTilesX"] = std::to_string(LightClusters::sTilesX);
+        defines["lightClusterTilesY"] = std::to_string(LightClusters::sTilesY);
+        defines["lightClusterSlices"] = std::to_string(LightClusters::sSlices);
+        defines["lightClusterGridSize"] = std::to_string(LightClusters::sNumClusters / 4);
+        defines["lightClusterIndexSize"] = std::to_string(LightClusters::sMaxIndices / 8);
 
         return defines;
     }
@@ -975,6 +1071,15 @@ namespace SceneUtil
         getOrCreateStateSet()->setAttributeAndModes(mUBOManager);
     }
 
+    void LightManager::initClustered(int targetLights)
+    {
+        setLightingMethod(LightingMethod::Clustered);
+        setMaxLights(targetLights);
+
+        mUBOManager = new UBOManager(getMaxLightsInScene(), true);
+        getOrCreateStateSet()->setAttributeAndModes(mUBOManager);
+    }
+
     void LightManager::setLightingMethod(LightingMethod method)
     {
         mLightingMethod = method;
@@ -984,6 +1089,7 @@ namespace SceneUtil
                 mStateSetGenerator = std::make_unique<StateSetGeneratorFFP>();
                 break;
             case LightingMethod::SingleUBO:
+            case LightingMethod::Clustered:
                 mStateSetGenerator = std::make_unique<StateSetGeneratorSingleUBO>();
                 break;
             case LightingMethod::PerObjectUniform:
@@ -1034,6 +1140,14 @@ namespace SceneUtil
         mLights.clear();
         mLightsInViewSpace.clear();
 
+        for (auto it = mLightClusterBuffers.begin(); it != mLightClusterBuffers.end();)
+        {
+            if (!it->second.mCamera.valid())
+                it = mLightClusterBuffers.erase(it);
+            else
+                ++it;
+        }
+
         // Do an occasional cleanup for orphaned lights.
         for (int i = 0; i < 2; ++i)
         {
@@ -1089,15 +1203,7 @@ namespace SceneUtil
         if (getLightingMethod() == LightingMethod::SingleUBO)
         {
             for (size_t i = 0; i < lightList.size(); ++i)
-            {
-                auto id = lightList[i]->mLightSource->getId();
-                if (getLightIndexMap(frameNum).find(id) != getLightIndexMap(frameNum).end())
-                    continue;
-
-                int index = getLightIndexMap(frameNum).size() + 1;
-                updateGPUPointLight(index, lightList[i]->mLightSource, frameNum, viewMatrix);
-                getLightIndexMap(frameNum).emplace(id, index);
-            }
+                getLightBufferIndex(lightList[i]->mLightSource, frameNum, viewMatrix);
         }
 
         auto& stateSetCache = mStateSetCache[frameNum % 2];
@@ -1161,7 +1267,8 @@ namespace SceneUtil
             }
 
             const bool fillPPLights = mPPLightBuffer && it->first->getName() == Constants::SceneCamera;
-            const bool sceneLimitReached = getLightingMethod() == LightingMethod::SingleUBO
+            const bool sceneLimitReached
+                = (getLightingMethod() == LightingMethod::SingleUBO || getLightingMethod() == LightingMethod::Clustered)
                 && it->second.size() > static_cast<size_t>(getMaxLightsInScene() - 1);
 
             if (fillPPLights || sceneLimitReached)
@@ -1216,6 +1323,104 @@ namespace SceneUtil
         buf->setPosition(index, light->getPosition() * (*viewMatrix));
     }
 
+    int LightManager::getLightBufferIndex(LightSource* lightSource, size_t frameNum, const osg::RefMatrix* viewMatrix)
+    {
+        auto& lightIndexMap = getLightIndexMap(frameNum);
+        auto found = lightIndexMap.find(lightSource->getId());
+        if (found != lightIndexMap.end())
+            return found->second;
+
+        int index = lightIndexMap.size() + 1;
+        updateGPUPointLight(index, lightSource, frameNum, viewMatrix);
+        lightIndexMap.emplace(lightSource->getId(), index);
+        return index;
+    }
+
+    void LightManager::applyLightClusters(osgUtil::CullVisitor* cv, osg::StateSet* stateset)
+    {
+        const size_t frameNum = cv->getTraversalNumber();
+        const size_t frameId = frameNum % 2;
+
+        mClusteredLights.clear();
+        if (cv->getTraversalMask() & getLightingMask())
+        {
+            // Don't use Camera::getViewMatrix, that one might be relative to another camera!
+            const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
+            for (const LightSourceViewBound& light : getLightsInViewSpace(cv, viewMatrix, frameNum))
+                mClusteredLights.push_back(
+                    { light.mViewBound, getLightBufferIndex(light.mLightSource, frameNum, viewMatrix) });
+
+            // Prefer the closest lights in crowded clusters
+            std::sort(mClusteredLights.begin(), mClusteredLights.end(),
+                [](const LightClusters::Light& left, const LightClusters::Light& right) {
+                    return left.mViewBound.center().length2() - left.mViewBound.radius2()
+                        < right.mViewBound.center().length2() - right.mViewBound.radius2();
+                });
+        }
+
+        mLightClusters.build(*cv->getProjectionMatrix(), mClusteredLights, getMaxLights() - getStartLight());
+
+        LightClusterBuffers& buffers = getLightClusterBuffers(cv->getCurrentCamera());
+
+        osg::IntArray& grid = *buffers.mGrid[frameId];
+        const int gridStride = buffers.mGridStride / sizeof(int);
+        const std::vector<std::uint32_t>& clusters = mLightClusters.getClusters();
+        for (std::size_t i = 0; i < clusters.size(); ++i)
+            grid[(i / 4) * gridStride + i % 4] = static_cast<int>(clusters[i]);
+        grid.dirty();
+
+        osg::IntArray& indices = *buffers.mIndices[frameId];
+        const int indexStride = buffers.mIndexStride / sizeof(int);
+        const std::vector<std::uint16_t>& lightIndices = mLightClusters.getIndices();
+        for (std::size_t i = 0; i < lightIndices.size(); i += 2)
+        {
+            const std::uint32_t second = i + 1 < lightIndices.size() ? lightIndices[i + 1] : 0;
+            indices[(i / 8) * indexStride + (i / 2) % 4] = static_cast<int>(lightIndices[i] | second << 16);
+        }
+        indices.dirty();
+
+        buffers.mDepth[frameId]->set(osg::Vec2f(mLightClusters.getDepthScale(), mLightClusters.getDepthBias()));
+
+        stateset->setAttributeAndModes(buffers.mGridBindings[frameId], osg::StateAttribute::ON);
+        stateset->setAttributeAndModes(buffers.mIndexBindings[frameId], osg::StateAttribute::ON);
+        stateset->addUniform(buffers.mDepth[frameId]);
+    }
+
+    LightManager::LightClusterBuffers& LightManager::getLightClusterBuffers(osg::Camera* camera)
+    {
+        LightClusterBuffers& buffers = mLightClusterBuffers[camera];
+
+        const int gridStride = mUBOManager->getLightClusterGridStride();
+        const int indexStride = mUBOManager->getLightClusterIndexStride();
+        if (buffers.mCamera.valid() && buffers.mCamera == camera && buffers.mGridStride == gridStride
+            && buffers.mIndexStride == indexStride)
+            return buffers;
+
+        buffers.mCamera = camera;
+        buffers.mGridStride = gridStride;
+        buffers.mIndexStride = indexStride;
+
+        const auto createBinding = [](Resource::SceneManager::UBOBinding binding, osg::IntArray* data) {
+            osg::ref_ptr<osg::UniformBufferObject> ubo = new osg::UniformBufferObject;
+            ubo->setUsage(GL_STREAM_DRAW);
+            data->setBufferObject(ubo);
+            return new osg::UniformBufferBinding(static_cast<int>(binding), data, 0, data->getTotalDataSize());
+        };
+
+        for (size_t i = 0; i < 2; ++i)
+        {
+            buffers.mGrid[i] = new osg::IntArray(LightClusters::sNumClusters / 4 * gridStride / sizeof(int));
+            buffers.mIndices[i] = new osg::IntArray(LightClusters::sMaxIndices / 8 * indexStride / sizeof(int));
+            buffers.mGridBindings[i]
+                = createBinding(Resource::SceneManager::UBOBinding::LightClusterGrid, buffers.mGrid[i]);
+            buffers.mIndexBindings[i]
+                = createBinding(Resource::SceneManager::UBOBinding::LightClusterIndices, buffers.mIndices[i]);
+            buffers.mDepth[i] = new osg::Uniform("LightClusterDepth", osg::Vec2f());
+        }
+
+        return buffers;
+    }
+
     osg::ref_ptr<osg::Uniform> LightManager::generateLightBufferUniform(const osg::Matrixf& sun)
     {
         osg::ref_ptr<osg::Uniform> uniform = new osg::Uniform(osg::Uniform::FLOAT_MAT4, "LightBuffer", getMaxLights());
@@ -1273,6 +1478,9 @@ namespace SceneUtil
         if (!(cv->getTraversalMask() & mLightManager->getLightingMask()))
             return false;
 
+        if (mLightManager->getLightingMethod() == LightingMethod::Clustered)
+            return false;
+
         // Possible optimizations:
         // - organize lights in a quad tree
 
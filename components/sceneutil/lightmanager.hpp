@@ -2,10 +2,13 @@
 #define OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <unordered_map>
 
+#include <osg/Array>
+#include <osg/BufferIndexBinding>
 #include <osg/Group>
 #include <osg/Light>
 #include <osg/NodeVisitor>
@@ -13,6 +16,7 @@
 
 #include <components/sceneutil/nodecallback.hpp>
 
+#include "lightcluster.hpp"
 #include "lightingmethod.hpp"
 
 namespace SceneUtil
@@ -156,7 +160,7 @@ namespace SceneUtil
     class UBOManager : public osg::StateAttribute
     {
     public:
-        UBOManager(int lightCount = 1);
+        UBOManager(int lightCount = 1, bool lightClusters = false);
         UBOManager(const UBOManager& copy, const osg::CopyOp& copyop = osg::CopyOp::SHALLOW_COPY);
 
         void releaseGLObjects(osg::State* state) const override;
@@ -169,15 +173,25 @@ namespace SceneUtil
 
         auto& getLightBuffer(size_t frameNum) { return mLightBuffers[frameNum % 2]; }
 
+        /// Array stride in bytes of the light cluster grid and index blocks, the std140 stride until the layout is
+        /// known
+        int getLightClusterGridStride() const { return mLightClusterGridStride; }
+        int getLightClusterIndexStride() const { return mLightClusterIndexStride; }
+
     private:
         std::string generateDummyShader(int maxLightsInScene);
+        std::string generateLightClustersDummyShader();
         void initSharedLayout(osg::GLExtensions* ext, int handle, unsigned int frame) const;
+        void initLightClustersLayout(osg::GLExtensions* ext, int handle) const;
 
         osg::ref_ptr<osg::Program> mDummyProgram;
+        osg::ref_ptr<osg::Program> mLightClustersDummyProgram;
         mutable bool mInitLayout;
         mutable std::array<osg::ref_ptr<LightBuffer>, 2> mLightBuffers;
         mutable std::array<bool, 2> mDirty;
         osg::ref_ptr<LightBuffer> mTemplate;
+        mutable std::atomic<int> mLightClusterGridStride;
+        mutable std::atomic<int> mLightClusterIndexStride;
     };
 
     struct LightSettings
@@ -211,7 +225,7 @@ namespace SceneUtil
         };
 
         using LightList = std::vector<const LightSourceViewBound*>;
-        using SupportedMethods = std::array<bool, 3>;
+        using SupportedMethods = std::array<bool, 4>;
 
         META_Node(SceneUtil, LightManager)
 
@@ -243,6 +257,10 @@ namespace SceneUtil
         osg::ref_ptr<osg::StateSet> getLightListStateSet(
             const LightList& lightList, size_t frameNum, const osg::RefMatrix* viewMatrix);
 
+        /// Internal use only, called automatically by the LightManager's cull callback with the clustered lighting
+        /// method. Bins the lights of the current camera into clusters and adds them to the stateset.
+        void applyLightClusters(osgUtil::CullVisitor* cv, osg::StateSet* stateset);
+
         void setSunlight(osg::ref_ptr<osg::Light> sun);
         osg::ref_ptr<osg::Light> getSunlight();
 
@@ -283,6 +301,7 @@ namespace SceneUtil
         void initFFP(int targetLights);
         void initPerObjectUniform(int targetLights);
         void initSingleUBO(int targetLights);
+        void initClustered(int targetLights);
 
         void updateSettings(float lightBoundsMultiplier, float maximumLightDistance, float lightFadeStart);
 
@@ -292,6 +311,8 @@ namespace SceneUtil
         void updateGPUPointLight(
             int index, LightSource* lightSource, size_t frameNum, const osg::RefMatrix* viewMatrix);
 
+        int getLightBufferIndex(LightSource* lightSource, size_t frameNum, const osg::RefMatrix* viewMatrix);
+
         std::vector<LightSourceTransform> mLights;
 
         using LightSourceViewBoundCollection = std::vector<LightSourceViewBound>;
@@ -334,6 +355,25 @@ namespace SceneUtil
         SupportedMethods mSupported;
 
         std::shared_ptr<PPLightBuffer> mPPLightBuffer;
+
+        // Double buffered cluster data of a camera, packed into ivec4 arrays
+        struct LightClusterBuffers
+        {
+            osg::observer_ptr<osg::Camera> mCamera;
+            int mGridStride = 0;
+            int mIndexStride = 0;
+            std::array<osg::ref_ptr<osg::IntArray>, 2> mGrid;
+            std::array<osg::ref_ptr<osg::IntArray>, 2> mIndices;
+            std::array<osg::ref_ptr<osg::UniformBufferBinding>, 2> mGridBindings;
+            std::array<osg::ref_ptr<osg::UniformBufferBinding>, 2> mIndexBindings;
+            std::array<osg::ref_ptr<osg::Uniform>, 2> mDepth;
+        };
+
+        LightClusters mLightClusters;
+        std::vector<LightClusters::Light> mClusteredLights;
+        std::map<const osg::Camera*, LightClusterBuffers> mLightClusterBuffers;
+
+        LightClusterBuffers& getLightClusterBuffers(osg::Camera* camera);
     };
 
     /// To receive lighting, objects must be decorated by a LightListCallback. Light list callbacks must be added via
@@ -345,6 +385,7 @@ namespace SceneUtil
     /// starting point is to attach a LightListCallback to each game object's base node.
     /// @note Not thread safe for CullThreadPerCamera threading mode.
     /// @note Due to lack of OSG support, the callback does not work on Drawables.
+    /// @note Does nothing with the clustered lighting method, lights are assigned to view space clusters instead.
     class LightListCallback : public SceneUtil::NodeCallback<LightListCallback, osg::Node*, osgUtil::CullVisitor*>
     {
     public:
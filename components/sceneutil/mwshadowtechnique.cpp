@@ -26,11 +26,13 @@
 #include <osg/Depth>
 #include <osg/ClipControl>
 
+#include <algorithm>
 #include <sstream>
 #include <deque>
 #include <vector>
 
 #include "glextensions.hpp"
+#include "riggeometry.hpp"
 #include "shadowsbin.hpp"
 
 namespace {
@@ -127,6 +129,16 @@ std::string debugFragmentShaderSource =
 #endif
         "}                                                                       \n";
 
+std::string staticShadowCopyVertexShaderSource = "varying vec2 uv; void main(void){gl_Position = vec4(gl_Vertex.xy, 0.0, 1.0); uv = gl_MultiTexCoord0.xy;}";
+std::string staticShadowCopyFragmentShaderSource =
+        "uniform sampler2D staticShadowTexture;                                  \n"
+        "varying vec2 uv;                                                        \n"
+        "                                                                        \n"
+        "void main(void)                                                         \n"
+        "{                                                                       \n"
+        "    gl_FragDepth = texture2D(staticShadowTexture, uv).r;                \n"
+        "}                                                                       \n";
+
 std::string debugFrustumVertexShaderSource = "varying float depth; uniform mat4 transform; void main(void){gl_Position = transform * gl_Vertex; depth = gl_Position.z / gl_Position.w;}";
 std::string debugFrustumFragmentShaderSource =
         "varying float depth;                                                    \n"
@@ -245,6 +257,9 @@ class VDSMCameraCullCallback : public osg::NodeCallback
 
         void operator()(osg::Node*, osg::NodeVisitor* nv) override;
 
+        /** Draw the given geometry before the casters, used to copy the static shadow cache. */
+        void setBackground(osg::Drawable* drawable, osg::StateSet* stateset) { _background = drawable; _backgroundStateSet = stateset; }
+
         osg::RefMatrix* getProjectionMatrix() { return _projectionMatrix.get(); }
         osgUtil::RenderStage* getRenderStage() { return _renderStage.get(); }
 
@@ -254,6 +269,8 @@ class VDSMCameraCullCallback : public osg::NodeCallback
         osg::ref_ptr<osg::RefMatrix>            _projectionMatrix;
         osg::ref_ptr<osgUtil::RenderStage>      _renderStage;
         osg::Polytope                           _polytope;
+        osg::ref_ptr<osg::Drawable>             _background;
+        osg::ref_ptr<osg::StateSet>             _backgroundStateSet;
 };
 
 VDSMCameraCullCallback::VDSMCameraCullCallback(MWShadowTechnique* vdsm, osg::Polytope& polytope):
@@ -280,6 +297,12 @@ void VDSMCameraCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
         cv->pushCullingSet();
     }
 #endif
+    if (_background)
+    {
+        cv->pushStateSet(_backgroundStateSet.get());
+        _background->accept(*nv);
+        cv->popStateSet();
+    }
     // bin has to go inside camera cull or the rendertexture stage will override it
     cv->pushStateSet(_vdsm->getOrCreateShadowsBinStateSet());
     if (_vdsm->getShadowedScene())
@@ -346,6 +369,71 @@ void VDSMCameraCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
     _projectionMatrix = cv->getProjectionMatrix();
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// ShadowMapDrawTimer
+//
+class ShadowMapDrawTimer : public osg::Camera::DrawCallback
+{
+    public:
+
+        ShadowMapDrawTimer(std::atomic<osg::Timer_t>& ticks) : _ticks(ticks) {}
+
+        // used as both the initial and the final draw callback of a camera
+        void operator()(osg::RenderInfo& /*renderInfo*/) const override
+        {
+            osg::Timer_t now = osg::Timer::instance()->tick();
+            if (_drawing)
+                _ticks += now - _start;
+            else
+                _start = now;
+            _drawing = !_drawing;
+        }
+
+    protected:
+
+        std::atomic<osg::Timer_t>&              _ticks;
+        mutable osg::Timer_t                    _start = 0;
+        mutable bool                            _drawing = false;
+};
+
+// Spreads the shadow maps over the frames of an update interval so that as few of them as possible render in the same frame
+std::vector<unsigned int> computeShadowMapUpdatePhases(unsigned int numShadowMaps, unsigned int maxInterval)
+{
+    std::vector<unsigned int> phases;
+    std::vector<unsigned int> load(maxInterval, 0);
+    for (unsigned int i = 0; i < numShadowMaps; ++i)
+    {
+        unsigned int interval = i < 32 ? std::min(1u << i, maxInterval) : maxInterval;
+        unsigned int bestPhase = 0;
+        unsigned int bestLoad = ~0u;
+        for (unsigned int phase = 0; phase < interval; ++phase)
+        {
+            unsigned int phaseLoad = 0;
+            for (unsigned int frame = phase; frame < maxInterval; frame += interval)
+                phaseLoad = std::max(phaseLoad, load[frame]);
+            if (phaseLoad < bestLoad)
+            {
+                bestLoad = phaseLoad;
+                bestPhase = phase;
+            }
+        }
+        for (unsigned int frame = bestPhase; frame < maxInterval; frame += interval)
+            ++load[frame];
+        phases.push_back(bestPhase);
+    }
+    return phases;
+}
+
+void addShadowMapDrawTimer(osg::Camera* camera, std::atomic<osg::Timer_t>& ticks)
+{
+    if (!camera || camera->getInitialDrawCallback())
+        return;
+    osg::ref_ptr<ShadowMapDrawTimer> timer = new ShadowMapDrawTimer(ticks);
+    camera->setInitialDrawCallback(timer);
+    camera->setFinalDrawCallback(timer);
+}
+
 } // namespace
 
 MWShadowTechnique::ComputeLightSpaceBounds::ComputeLightSpaceBounds() :
@@ -531,7 +619,9 @@ void MWShadowTechnique::LightData::setLightData(osg::RefMatrix* lm, const osg::L
 //
 MWShadowTechnique::ShadowData::ShadowData(MWShadowTechnique::ViewDependentData* vdd):
     _viewDependentData(vdd),
-    _textureUnit(0)
+    _textureUnit(0),
+    _staticRevision(~0u),
+    _rendered(false)
 {
 
     const ShadowSettings* settings = vdd->getViewDependentShadowMap()->getShadowedScene()->getShadowSettings();
@@ -615,6 +705,28 @@ MWShadowTechnique::ShadowData::ShadowData(MWShadowTechnique::ViewDependentData*
         // attach the texture and use it as the color buffer.
         _camera->attach(osg::Camera::DEPTH_BUFFER, _texture.get());
         //_camera->attach(osg::Camera::COLOR_BUFFER, _texture.get());
+
+        if (vdd->getViewDependentShadowMap()->isStaticShadowCacheEnabled())
+        {
+            // raw depth values are copied, so no comparison or filtering
+            _staticTexture = new osg::Texture2D;
+            _staticTexture->setTextureSize(textureSize.x(), textureSize.y());
+            _staticTexture->setInternalFormat(GL_DEPTH_COMPONENT);
+            _staticTexture->setFilter(osg::Texture2D::MIN_FILTER,osg::Texture2D::NEAREST);
+            _staticTexture->setFilter(osg::Texture2D::MAG_FILTER,osg::Texture2D::NEAREST);
+            _staticTexture->setWrap(osg::Texture2D::WRAP_S,osg::Texture2D::CLAMP_TO_EDGE);
+            _staticTexture->setWrap(osg::Texture2D::WRAP_T,osg::Texture2D::CLAMP_TO_EDGE);
+
+            // same settings as the main camera, but rendered first and only when the cache is updated
+            _staticCamera = new osg::Camera(*_camera);
+            _staticCamera->setName("StaticShadowCamera");
+            _staticCamera->setRenderOrder(osg::Camera::PRE_RENDER, -1);
+            _staticCamera->detach(osg::Camera::DEPTH_BUFFER);
+            _staticCamera->attach(osg::Camera::DEPTH_BUFFER, _staticTexture.get());
+
+            _staticStateSet = new osg::StateSet;
+            _staticStateSet->setTextureAttribute(0, _staticTexture.get(), osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
+        }
     }
 }
 
@@ -623,6 +735,11 @@ void MWShadowTechnique::ShadowData::releaseGLObjects(osg::State* state) const
     OSG_INFO<<"MWShadowTechnique::ShadowData::releaseGLObjects"<<std::endl;
     _texture->releaseGLObjects(state);
     _camera->releaseGLObjects(state);
+    if (_staticCamera)
+    {
+        _staticTexture->releaseGLObjects(state);
+        _staticCamera->releaseGLObjects(state);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
@@ -806,7 +923,8 @@ MWShadowTechnique::MWShadowTechnique():
     ShadowTechnique(),
     _enableShadows(false),
     _debugHud(nullptr),
-    _castingPrograms{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }
+    _castingPrograms{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+    _skinningCastingPrograms{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr }
 {
     _shadowRecievingPlaceholderStateSet = new osg::StateSet;
     mSetDummyStateWhenDisabled = false;
@@ -815,6 +933,7 @@ MWShadowTechnique::MWShadowTechnique():
 MWShadowTechnique::MWShadowTechnique(const MWShadowTechnique& vdsm, const osg::CopyOp& copyop):
     ShadowTechnique(vdsm,copyop)
     , _castingPrograms(vdsm._castingPrograms)
+    , _skinningCastingPrograms(vdsm._skinningCastingPrograms)
 {
     _shadowRecievingPlaceholderStateSet = new osg::StateSet;
     _enableShadows = vdsm._enableShadows;
@@ -914,22 +1033,70 @@ void SceneUtil::MWShadowTechnique::disableFrontFaceCulling()
     }
 }
 
+void SceneUtil::MWShadowTechnique::enableStaticShadowCache(unsigned int staticCastersMask, float margin, float maxLightAngle)
+{
+    _staticShadowCastersMask = staticCastersMask;
+    _staticShadowCacheMargin = margin;
+    _staticShadowCacheMaxLightAngle = maxLightAngle;
+    invalidateStaticShadowCache();
+}
+
+void SceneUtil::MWShadowTechnique::disableStaticShadowCache()
+{
+    _staticShadowCastersMask = 0;
+}
+
+void SceneUtil::MWShadowTechnique::setShadowMapUpdateInterval(unsigned int maxInterval)
+{
+    unsigned int interval = 1;
+    while (interval * 2 <= maxInterval && interval < (1u << 16))
+        interval *= 2;
+    _maxShadowMapUpdateInterval = interval;
+    _shadowMapUpdateInterval = interval;
+    _framesSinceIntervalChange = 0;
+    _shadowMapUpdatePhases.clear();
+}
+
+void SceneUtil::MWShadowTechnique::setShadowMapBudget(float budget)
+{
+    _shadowMapBudget = std::max(budget, 0.f);
+    _averageShadowMapCost = 0.0;
+    _framesSinceIntervalChange = 0;
+}
+
 void SceneUtil::MWShadowTechnique::setupCastingShader(Shader::ShaderManager & shaderManager)
 {
     // This can't be part of the constructor as OSG mandates that there be a trivial constructor available
 
-    osg::ref_ptr<osg::Shader> castingVertexShader = shaderManager.getShader("shadowcasting.vert");
+    osg::ref_ptr<osg::Shader> castingVertexShader
+        = shaderManager.getShader("shadowcasting.vert", { {"skinning", "0"} });
+    // Geometry skinned in the shaders gets its own variant, so that the others don't pay for the bone matrices
+    osg::ref_ptr<osg::Shader> skinningCastingVertexShader
+        = shaderManager.getShader("shadowcasting.vert", { {"skinning", "1"} });
     std::string useGPUShader4 = SceneUtil::getGLExtensions().isGpuShader4Supported ? "1" : "0";
     for (int alphaFunc = GL_NEVER; alphaFunc <= GL_ALWAYS; ++alphaFunc)
     {
+        osg::ref_ptr<osg::Shader> castingFragmentShader
+            = shaderManager.getShader("shadowcasting.frag", { {"alphaFunc", std::to_string(alphaFunc)},
+                                                              {"alphaToCoverage", "0"},
+                                                              {"adjustCoverage", "1"},
+                                                              {"useGPUShader4", useGPUShader4}
+                                                            });
+
         auto& program = _castingPrograms[alphaFunc - GL_NEVER];
         program = new osg::Program();
+        // Instanced geometry passes the transformations of its instances in these attributes
+        program->addBindAttribLocation("aInstanceOffset", 6);
+        program->addBindAttribLocation("aInstanceRotation", 7);
         program->addShader(castingVertexShader);
-        program->addShader(shaderManager.getShader("shadowcasting.frag", { {"alphaFunc", std::to_string(alphaFunc)},
-                                                                                    {"alphaToCoverage", "0"},
-                                                                                    {"adjustCoverage", "1"},
-                                                                                    {"useGPUShader4", useGPUShader4}
-                                                                                  }));
+        program->addShader(castingFragmentShader);
+
+        auto& skinningProgram = _skinningCastingPrograms[alphaFunc - GL_NEVER];
+        skinningProgram = new osg::Program();
+        // Skinned geometry passes the influences of its vertices in these attributes
+        SceneUtil::RigGeometry::addSkinningAttribLocations(*skinningProgram);
+        skinningProgram->addShader(skinningCastingVertexShader);
+        skinningProgram->addShader(castingFragmentShader);
     }
 }
 
@@ -1177,6 +1344,9 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
     //    create a list of light sources + their matrices to place them
     selectActiveLights(&cv, vdd);
 
+    // the draw time of shadow maps is only known after the previous frame was drawn
+    osg::Timer_t shadowMapTicks = _shadowMapDrawTicks.exchange(0);
+    unsigned int frameCount = vdd->_frameCount++;
 
     unsigned int pos_x = 0;
     unsigned int textureUnit = settings->getBaseShadowTextureUnit();
@@ -1187,6 +1357,8 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
     previous_sdl.swap(sdl);
 
     unsigned int numShadowMapsPerLight = settings->getNumShadowMapsPerLight();
+    if (_shadowMapUpdatePhases.size() != numShadowMapsPerLight)
+        _shadowMapUpdatePhases = computeShadowMapUpdatePhases(numShadowMapsPerLight, _shadowMapUpdateInterval);
 
     LightDataList& pll = vdd->getLightDataList();
     for(LightDataList::iterator itr = pll.begin();
@@ -1350,6 +1522,11 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
 
             osg::ref_ptr<osg::Camera> camera = sd->_camera;
 
+            // shadow maps which aren't rendered this frame keep the light space they were rendered with
+            bool updateShadowMap = shouldUpdateShadowMap(*sd, sm_i, frameCount);
+            osg::Matrixd previousViewMatrix = camera->getViewMatrix();
+            osg::Matrixd previousProjectionMatrix = camera->getProjectionMatrix();
+
             camera->setProjectionMatrix(projectionMatrix);
             camera->setViewMatrix(viewMatrix);
 
@@ -1486,22 +1663,73 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
             else
                 cropShadowCameraToMainFrustum(frustum, camera, reducedNear, reducedFar, extraPlanes);
 
-            osg::ref_ptr<VDSMCameraCullCallback> vdsmCallback = new VDSMCameraCullCallback(this, local_polytope);
-            camera->setCullCallback(vdsmCallback.get());
+            osg::ref_ptr<VDSMCameraCullCallback> vdsmCallback;
+            if (updateShadowMap)
+            {
+                osg::Timer_t cullStart = osg::Timer::instance()->tick();
 
-            // 4.3 traverse RTT camera
-            //
+                // the scene root is traversed by both static and dynamic casters
+                unsigned int staticCastersMask = _staticShadowCastersMask & ~_shadowedScene->getNodeMask();
+                bool useStaticShadowCache = sd->_staticCamera && (settings->getCastsShadowTraversalMask() & staticCastersMask) != 0;
+                bool renderStaticCasters = false;
+                if (useStaticShadowCache)
+                {
+                    renderStaticCasters = updateStaticShadowCache(*sd, pl, camera.get());
 
-            cv.pushStateSet(_shadowCastingStateSet.get());
+                    // the cached light space covers more than this frame's part of the view, so cull with its bounds instead.
+                    // Casters between the light and the near plane are kept as they are clamped to it.
+                    local_polytope.setToUnitFrustum(false, true);
+                    local_polytope.transformProvidingInverse(camera->getProjectionMatrix());
+                }
+
+                if (renderStaticCasters)
+                {
+                    osg::ref_ptr<VDSMCameraCullCallback> staticCallback = new VDSMCameraCullCallback(this, local_polytope);
+                    sd->_staticCamera->setCullCallback(staticCallback.get());
 
-            cullShadowCastingScene(&cv, camera.get());
+                    cv.pushStateSet(_shadowCastingStateSet.get());
 
-            cv.popStateSet();
+                    cullShadowCastingScene(&cv, sd->_staticCamera.get(), staticCastersMask | _shadowedScene->getNodeMask());
+
+                    cv.popStateSet();
+                }
+
+                vdsmCallback = new VDSMCameraCullCallback(this, local_polytope);
+                camera->setCullCallback(vdsmCallback.get());
+                if (useStaticShadowCache)
+                    vdsmCallback->setBackground(_staticShadowCopy.get(), sd->_staticStateSet.get());
+
+                // 4.3 traverse RTT camera
+                //
+
+                cv.pushStateSet(_shadowCastingStateSet.get());
+
+                cullShadowCastingScene(&cv, camera.get(), useStaticShadowCache ? ~staticCastersMask : ~0u);
+
+                cv.popStateSet();
+
+                shadowMapTicks += osg::Timer::instance()->tick() - cullStart;
+                sd->_rendered = true;
+
+                if (_shadowMapBudget > 0)
+                {
+                    addShadowMapDrawTimer(camera.get(), _shadowMapDrawTicks);
+                    addShadowMapDrawTimer(sd->_staticCamera.get(), _shadowMapDrawTicks);
+                }
+            }
+            else
+            {
+                camera->setViewMatrix(previousViewMatrix);
+                camera->setProjectionMatrix(previousProjectionMatrix);
+            }
 
             if (!orthographicViewFrustum && settings->getShadowMapProjectionHint()==ShadowSettings::PERSPECTIVE_SHADOW_MAP)
             {
+                if (updateShadowMap)
+                    sd->_validRegionMatrix = camera->getViewMatrix() * camera->getProjectionMatrix();
+
                 {
-                    osg::Matrix validRegionMatrix = cv.getCurrentCamera()->getInverseViewMatrix() *  camera->getViewMatrix() * camera->getProjectionMatrix();
+                    osg::Matrix validRegionMatrix = cv.getCurrentCamera()->getInverseViewMatrix() * sd->_validRegionMatrix;
 
                     std::string validRegionUniformName = "validRegionMatrix" + std::to_string(sm_i);
                     osg::ref_ptr<osg::Uniform> validRegionUniform;
@@ -1524,13 +1752,16 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
                     validRegionUniform->set(validRegionMatrix);
                 }
 
-                if (settings->getMultipleShadowMapHint() == ShadowSettings::CASCADED)
-                    adjustPerspectiveShadowMapCameraSettings(vdsmCallback->getRenderStage(), frustum, pl, camera.get(), cascaseNear, cascadeFar);
-                else
-                    adjustPerspectiveShadowMapCameraSettings(vdsmCallback->getRenderStage(), frustum, pl, camera.get(), reducedNear, reducedFar);
-                if (vdsmCallback->getProjectionMatrix())
+                if (updateShadowMap)
                 {
-                    vdsmCallback->getProjectionMatrix()->set(camera->getProjectionMatrix());
+                    if (settings->getMultipleShadowMapHint() == ShadowSettings::CASCADED)
+                        adjustPerspectiveShadowMapCameraSettings(vdsmCallback->getRenderStage(), frustum, pl, camera.get(), cascaseNear, cascadeFar);
+                    else
+                        adjustPerspectiveShadowMapCameraSettings(vdsmCallback->getRenderStage(), frustum, pl, camera.get(), reducedNear, reducedFar);
+                    if (vdsmCallback->getProjectionMatrix())
+                    {
+                        vdsmCallback->getProjectionMatrix()->set(camera->getProjectionMatrix());
+                    }
                 }
             }
  
@@ -1583,6 +1814,8 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
 
     vdd->setNumValidShadows(numValidShadows);
 
+    updateShadowMapInterval(osg::Timer::instance()->delta_m(0, shadowMapTicks));
+
     if (numValidShadows>0)
     {
         prepareStateSetForRenderingShadow(*vdd, cv.getTraversalNumber());
@@ -1766,6 +1999,8 @@ void MWShadowTechnique::createShaders()
     _shadowCastingStateSet->setTextureAttribute(0, _fallbackBaseTexture.get(), osg::StateAttribute::ON);
     _shadowCastingStateSet->addUniform(new osg::Uniform("useDiffuseMapForShadowAlpha", true));
     _shadowCastingStateSet->addUniform(new osg::Uniform("alphaTestShadows", false));
+    // The instanced chunks turn it on, the casters drawn after them must not keep it
+    _shadowCastingStateSet->addUniform(new osg::Uniform("useInstancing", false));
     osg::ref_ptr<osg::Depth> depth = new osg::Depth;
     depth->setWriteMask(true);
     osg::ref_ptr<osg::ClipControl> clipcontrol = new osg::ClipControl(osg::ClipControl::LOWER_LEFT, osg::ClipControl::NEGATIVE_ONE_TO_ONE);
@@ -1773,6 +2008,24 @@ void MWShadowTechnique::createShaders()
     _shadowCastingStateSet->setAttribute(depth, osg::StateAttribute::ON|osg::StateAttribute::OVERRIDE);
     _shadowCastingStateSet->setMode(GL_DEPTH_CLAMP, osg::StateAttribute::ON);
 
+    {
+        // full screen quad writing the depth of the static shadow cache, drawn before the casters
+        _staticShadowCopy = osg::createTexturedQuadGeometry(osg::Vec3(-1, -1, 0), osg::Vec3(2, 0, 0), osg::Vec3(0, 2, 0));
+        _staticShadowCopy->setCullingActive(false);
+
+        osg::ref_ptr<osg::Program> program = new osg::Program;
+        program->addShader(new osg::Shader(osg::Shader::VERTEX, staticShadowCopyVertexShaderSource));
+        program->addShader(new osg::Shader(osg::Shader::FRAGMENT, staticShadowCopyFragmentShaderSource));
+
+        osg::StateSet* stateset = _staticShadowCopy->getOrCreateStateSet();
+        stateset->setAttributeAndModes(program, osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
+        stateset->addUniform(new osg::Uniform("staticShadowTexture", 0));
+        stateset->setAttribute(new osg::Depth(osg::Depth::ALWAYS), osg::StateAttribute::ON | osg::StateAttribute::PROTECTED);
+        stateset->setMode(GL_POLYGON_OFFSET_FILL, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED);
+        stateset->setMode(GL_CULL_FACE, osg::StateAttribute::OFF | osg::StateAttribute::PROTECTED);
+        stateset->setRenderBinDetails(-1, "RenderBin");
+    }
+
     // TODO: compare performance when alpha testing is handled here versus using a discard in the fragment shader
 }
 
@@ -3096,14 +3349,14 @@ void MWShadowTechnique::cullShadowReceivingScene(osgUtil::CullVisitor* cv) const
     return;
 }
 
-void MWShadowTechnique::cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Camera* camera) const
+void MWShadowTechnique::cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Camera* camera, unsigned int castersMask) const
 {
     OSG_INFO<<"cullShadowCastingScene()"<<std::endl;
 
     // record the traversal mask on entry so we can reapply it later.
     unsigned int traversalMask = cv->getTraversalMask();
 
-    cv->setTraversalMask( traversalMask & _shadowedScene->getShadowSettings()->getCastsShadowTraversalMask() );
+    cv->setTraversalMask( traversalMask & _shadowedScene->getShadowSettings()->getCastsShadowTraversalMask() & castersMask );
 
         if (camera) camera->accept(*cv);
 
@@ -3112,6 +3365,44 @@ void MWShadowTechnique::cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Ca
     return;
 }
 
+bool MWShadowTechnique::updateStaticShadowCache(ShadowData& sd, const LightData& positionedLight, osg::Camera* camera) const
+{
+    unsigned int revision = _staticShadowCacheRevision;
+    bool valid = sd._staticRevision == revision
+        && positionedLight.lightDir * sd._staticLightDir >= std::cos(osg::DegreesToRadians(double(_staticShadowCacheMaxLightAngle)));
+
+    if (valid)
+    {
+        // the light space needed this frame has to fit in the cached one
+        osg::Matrixd clipToCache = osg::Matrixd::inverse(camera->getViewMatrix() * camera->getProjectionMatrix()) *
+            sd._staticViewMatrix * sd._staticProjectionMatrix;
+        for (int i = 0; i < 8 && valid; ++i)
+        {
+            osg::Vec3d corner = osg::Vec3d(i & 1 ? 1.0 : -1.0, i & 2 ? 1.0 : -1.0, i & 4 ? 1.0 : -1.0) * clipToCache;
+            valid = std::abs(corner.x()) <= 1.0 && std::abs(corner.y()) <= 1.0 && std::abs(corner.z()) <= 1.0;
+        }
+    }
+
+    if (!valid)
+    {
+        OSG_INFO<<"Updating static shadow cache"<<std::endl;
+
+        double scale = 1.0 / (1.0 + _staticShadowCacheMargin);
+        sd._staticViewMatrix = camera->getViewMatrix();
+        sd._staticProjectionMatrix = camera->getProjectionMatrix() * osg::Matrixd::scale(scale, scale, scale);
+        sd._staticLightDir = positionedLight.lightDir;
+        sd._staticRevision = revision;
+
+        sd._staticCamera->setViewMatrix(sd._staticViewMatrix);
+        sd._staticCamera->setProjectionMatrix(sd._staticProjectionMatrix);
+    }
+
+    camera->setViewMatrix(sd._staticViewMatrix);
+    camera->setProjectionMatrix(sd._staticProjectionMatrix);
+
+    return !valid;
+}
+
 osg::StateSet* MWShadowTechnique::prepareStateSetForRenderingShadow(ViewDependentData& vdd, unsigned int traversalNumber) const
 {
     OSG_INFO<<"   prepareStateSetForRenderingShadow() "<<vdd.getStateSet(traversalNumber)<<std::endl;
@@ -3179,6 +3470,43 @@ osg::StateSet* MWShadowTechnique::prepareStateSetForRenderingShadow(ViewDependen
     return stateset;
 }
 
+void MWShadowTechnique::updateShadowMapInterval(double cost)
+{
+    unsigned int interval = _maxShadowMapUpdateInterval;
+    if (_shadowMapBudget > 0)
+    {
+        _averageShadowMapCost = _averageShadowMapCost * 0.9 + cost * 0.1;
+
+        // give the average time to settle before changing the interval again
+        interval = _shadowMapUpdateInterval;
+        if (++_framesSinceIntervalChange >= 30)
+        {
+            if (_averageShadowMapCost > _shadowMapBudget)
+                interval = std::min(interval * 2, _maxShadowMapUpdateInterval);
+            else if (_averageShadowMapCost < _shadowMapBudget * 0.5)
+                interval = std::max(interval / 2, 1u);
+        }
+    }
+
+    if (interval == _shadowMapUpdateInterval)
+        return;
+
+    OSG_INFO<<"MWShadowTechnique::updateShadowMapInterval() interval="<<interval<<" average cost="<<_averageShadowMapCost<<"ms"<<std::endl;
+
+    _shadowMapUpdateInterval = interval;
+    _framesSinceIntervalChange = 0;
+    _shadowMapUpdatePhases.clear();
+}
+
+bool MWShadowTechnique::shouldUpdateShadowMap(const ShadowData& sd, unsigned int shadowMapNumber, unsigned int frameCount) const
+{
+    if (!sd._rendered || _shadowMapUpdateInterval <= 1 || shadowMapNumber >= _shadowMapUpdatePhases.size())
+        return true;
+
+    unsigned int interval = shadowMapNumber < 32 ? std::min(1u << shadowMapNumber, _shadowMapUpdateInterval) : _shadowMapUpdateInterval;
+    return frameCount % interval == _shadowMapUpdatePhases[shadowMapNumber];
+}
+
 void MWShadowTechnique::resizeGLObjectBuffers(unsigned int /*maxSize*/)
 {
     // the way that ViewDependentData is mapped shouldn't
@@ -3344,7 +3672,7 @@ osg::ref_ptr<osg::StateSet> SceneUtil::MWShadowTechnique::getOrCreateShadowsBinS
     {
         if (_shadowsBin == nullptr)
         {
-            _shadowsBin = new ShadowsBin(_castingPrograms);
+            _shadowsBin = new ShadowsBin(_castingPrograms, _skinningCastingPrograms);
             osgUtil::RenderBin::addRenderBinPrototype(_shadowsBinName, _shadowsBin);
         }
         _shadowsBinStateSet = new osg::StateSet;
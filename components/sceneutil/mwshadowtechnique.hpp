@@ -21,6 +21,7 @@
 #define COMPONENTS_SCENEUTIL_MWSHADOWTECHNIQUE_H 1
 
 #include <array>
+#include <atomic>
 #include <mutex>
 #include <string>
 
@@ -29,6 +30,7 @@
 #include <osg/MatrixTransform>
 #include <osg/LightSource>
 #include <osg/PolygonOffset>
+#include <osg/Timer>
 
 #include <osgShadow/ShadowTechnique>
 
@@ -88,6 +90,27 @@ namespace SceneUtil {
 
         virtual void setupCastingShader(Shader::ShaderManager &shaderManager);
 
+        /** Render the casters matching staticCastersMask to a separate depth texture per shadow map, only updated when the light
+        * direction turns by more than maxLightAngle degrees or the shadow map no longer covers its part of the view. The cached
+        * area is larger than needed by the given fraction. Other casters are rendered on top of the cached depth every frame.
+        * Only works with orthographic shadow maps as perspective ones depend on the view direction.*/
+        virtual void enableStaticShadowCache(unsigned int staticCastersMask, float margin, float maxLightAngle);
+
+        virtual void disableStaticShadowCache();
+
+        /** Static casters have been added, removed or moved.*/
+        void invalidateStaticShadowCache() { ++_staticShadowCacheRevision; }
+
+        bool isStaticShadowCacheEnabled() const { return _staticShadowCastersMask != 0; }
+
+        /** Render shadow map i only every min(2^i, maxInterval) frames, with maxInterval rounded down to a power of two. Shadow
+        * maps which aren't rendered keep the light space they were rendered with and are reprojected to the current view.*/
+        virtual void setShadowMapUpdateInterval(unsigned int maxInterval);
+
+        /** Adapt the update interval, up to the maximum one, so the time spent culling and drawing shadow maps stays under the
+        * given number of milliseconds per frame. 0 disables it.*/
+        virtual void setShadowMapBudget(float budget);
+
         class ComputeLightSpaceBounds : public osg::NodeVisitor, public osg::CullStack
         {
         public:
@@ -194,6 +217,19 @@ namespace SceneUtil {
             unsigned int                        _textureUnit;
             osg::ref_ptr<osg::Texture2D>        _texture;
             osg::ref_ptr<osg::Camera>           _camera;
+
+            // static shadow cache, copied to _texture before rendering the other casters
+            osg::ref_ptr<osg::Texture2D>        _staticTexture;
+            osg::ref_ptr<osg::Camera>           _staticCamera;
+            osg::ref_ptr<osg::StateSet>         _staticStateSet;
+            osg::Matrixd                        _staticViewMatrix;
+            osg::Matrixd                        _staticProjectionMatrix;
+            osg::Vec3d                          _staticLightDir;
+            unsigned int                        _staticRevision;
+
+            // light space of the last rendering, reused by the frames which don't render this shadow map
+            bool                                _rendered;
+            osg::Matrixd                        _validRegionMatrix;
         };
 
         typedef std::list< osg::ref_ptr<ShadowData> > ShadowDataList;
@@ -230,6 +266,8 @@ namespace SceneUtil {
             ShadowDataList              _shadowDataList;
 
             unsigned int _numValidShadows;
+
+            unsigned int _frameCount = 0;
         };
 
         virtual ViewDependentData* createViewDependentData(osgUtil::CullVisitor* cv);
@@ -254,7 +292,16 @@ namespace SceneUtil {
 
         virtual void cullShadowReceivingScene(osgUtil::CullVisitor* cv) const;
 
-        virtual void cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Camera* camera) const;
+        virtual void cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Camera* camera, unsigned int castersMask = ~0u) const;
+
+        /** Make the camera use the light space of the static shadow cache, updating the cache first if needed.
+        * @return true if the static casters have to be rendered again.*/
+        virtual bool updateStaticShadowCache(ShadowData& sd, const LightData& positionedLight, osg::Camera* camera) const;
+
+        /** Adapt the update interval of shadow maps to the time spent on them in the last frame.*/
+        virtual void updateShadowMapInterval(double cost);
+
+        bool shouldUpdateShadowMap(const ShadowData& sd, unsigned int shadowMapNumber, unsigned int frameCount) const;
 
         virtual osg::StateSet* prepareStateSetForRenderingShadow(ViewDependentData& vdd, unsigned int traversalNumber) const;
 
@@ -299,6 +346,20 @@ namespace SceneUtil {
 
         unsigned int                            _worldMask = ~0u;
 
+        unsigned int                            _staticShadowCastersMask = 0;
+        float                                   _staticShadowCacheMargin = 0.2f;
+        float                                   _staticShadowCacheMaxLightAngle = 0.5f;
+        std::atomic<unsigned int>               _staticShadowCacheRevision{ 0 };
+        osg::ref_ptr<osg::Geometry>             _staticShadowCopy;
+
+        unsigned int                            _maxShadowMapUpdateInterval = 1;
+        unsigned int                            _shadowMapUpdateInterval = 1;
+        unsigned int                            _framesSinceIntervalChange = 0;
+        std::vector<unsigned int>               _shadowMapUpdatePhases;
+        float                                   _shadowMapBudget = 0.f;
+        double                                  _averageShadowMapCost = 0.0;
+        std::atomic<osg::Timer_t>               _shadowMapDrawTicks{ 0 };
+
         class DebugHUD final : public osg::Referenced
         {
         public:
@@ -324,6 +385,7 @@ namespace SceneUtil {
 
         osg::ref_ptr<DebugHUD>                  _debugHud;
         std::array<osg::ref_ptr<osg::Program>, GL_ALWAYS - GL_NEVER + 1> _castingPrograms;
+        std::array<osg::ref_ptr<osg::Program>, GL_ALWAYS - GL_NEVER + 1> _skinningCastingPrograms;
         const std::string _shadowsBinName = "ShadowsBin_" + std::to_string(reinterpret_cast<std::uint64_t>(this));
         osg::ref_ptr<osgUtil::RenderBin> _shadowsBin;
         osg::ref_ptr<osg::StateSet> _shadowsBinStateSet;
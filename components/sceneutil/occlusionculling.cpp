@@ -0,0 +1,505 @@
+#include "occlusionculling.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <typeinfo>
+
+#include <osg/Geometry>
+#include <osg/NodeVisitor>
+#include <osg/TriangleFunctor>
+#include <osg/Viewport>
+#include <osgUtil/CullVisitor>
+
+#include <components/misc/constants.hpp>
+
+namespace SceneUtil
+{
+    namespace
+    {
+        // Distance to the camera below which geometry is neither an occluder nor occluded
+        constexpr float minW = 1;
+        // Triangles are clipped to this multiple of the screen size to keep the rasterizer in integer range
+        constexpr float guardBand = 2;
+        constexpr std::int64_t subpixels = 16;
+        // Eye point movement between frames that invalidates the occluders of the previous frame
+        constexpr float maxEyeMovement = Constants::CellSizeInUnits;
+
+        struct ScreenRect
+        {
+            float mMinX;
+            float mMinY;
+            float mMaxX;
+            float mMaxY;
+            float mMaxDepth;
+        };
+
+        std::optional<ScreenRect> getScreenRect(
+            const osg::BoundingBox& box, const osg::Matrix& modelViewProjection, int width, int height)
+        {
+            ScreenRect rect{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), 0 };
+            for (unsigned int i = 0; i < 8; ++i)
+            {
+                const osg::Vec4d clip = osg::Vec4d(box.corner(i), 1) * modelViewProjection;
+                if (clip.w() < minW)
+                    return std::nullopt;
+                const float invW = static_cast<float>(1 / clip.w());
+                const float x = static_cast<float>((clip.x() * invW * 0.5 + 0.5) * width);
+                const float y = static_cast<float>((clip.y() * invW * 0.5 + 0.5) * height);
+                rect.mMinX = std::min(rect.mMinX, x);
+                rect.mMinY = std::min(rect.mMinY, y);
+                rect.mMaxX = std::max(rect.mMaxX, x);
+                rect.mMaxY = std::max(rect.mMaxY, y);
+                rect.mMaxDepth = std::max(rect.mMaxDepth, invW);
+            }
+            return rect;
+        }
+
+        std::int64_t floorDiv(std::int64_t value, std::int64_t divisor)
+        {
+            return value >= 0 ? value / divisor : -((divisor - 1 - value) / divisor);
+        }
+
+        struct ScreenVertex
+        {
+            std::int64_t mX;
+            std::int64_t mY;
+            float mDepth;
+        };
+
+        // Edge function of a counter-clockwise triangle stepped over pixel centers. Pixel centers exactly on the edge
+        // belong to the triangle only for top and left edges, so triangles sharing an edge don't leave gaps or overlap.
+        struct Edge
+        {
+            std::int64_t mStepX;
+            std::int64_t mStepY;
+            std::int64_t mValue;
+
+            Edge(const ScreenVertex& a, const ScreenVertex& b, std::int64_t x, std::int64_t y)
+            {
+                const std::int64_t dx = b.mX - a.mX;
+                const std::int64_t dy = b.mY - a.mY;
+                const bool topLeft = dy < 0 || (dy == 0 && dx < 0);
+                mStepX = -dy * subpixels;
+                mStepY = dx * subpixels;
+                mValue = dx * (y - a.mY) - dy * (x - a.mX) - (topLeft ? 0 : 1);
+            }
+        };
+
+        bool isTransparent(const osg::StateSet* stateSet)
+        {
+            return stateSet != nullptr
+                && ((stateSet->getMode(GL_BLEND) & osg::StateAttribute::ON)
+                    || stateSet->getAttribute(osg::StateAttribute::ALPHAFUNC) != nullptr
+                    || stateSet->getRenderingHint() == osg::StateSet::TRANSPARENT_BIN);
+        }
+
+        struct CollectTriangles
+        {
+            OccluderMesh* mMesh = nullptr;
+            osg::Matrixf mMatrix;
+
+            void operator()(const osg::Vec3& v1, const osg::Vec3& v2, const osg::Vec3& v3,
+                bool /*temp*/ = false) // Note: unused temp argument left here for OSG versions less than 3.5.6
+            {
+                for (const osg::Vec3& vertex : { v1, v2, v3 })
+                {
+                    mMesh->mIndices.push_back(static_cast<unsigned int>(mMesh->mVertices.size()));
+                    mMesh->mVertices.push_back(mMatrix.preMult(vertex));
+                    mMesh->mBound.expandBy(mMesh->mVertices.back());
+                }
+            }
+        };
+
+        class OccluderMeshVisitor : public osg::NodeVisitor
+        {
+        public:
+            OccluderMeshVisitor()
+                : osg::NodeVisitor(TRAVERSE_ACTIVE_CHILDREN)
+                , mMesh(new OccluderMesh)
+            {
+            }
+
+            void apply(osg::Drawable& drawable) override
+            {
+                // Skinned, morphed and particle geometry doesn't stay where it is
+                if (typeid(drawable) != typeid(osg::Geometry) || isTransparent(drawable.getStateSet()))
+                    return;
+                for (const osg::Node* node : getNodePath())
+                    if (isTransparent(node->getStateSet()))
+                        return;
+
+                osg::TriangleFunctor<CollectTriangles> functor;
+                functor.mMesh = mMesh;
+                functor.mMatrix = osg::computeLocalToWorld(getNodePath());
+                drawable.accept(functor);
+            }
+
+            osg::ref_ptr<OccluderMesh> mMesh;
+        };
+    }
+
+    osg::ref_ptr<OccluderMesh> createOccluderMesh(osg::Node& node)
+    {
+        OccluderMeshVisitor visitor;
+        node.accept(visitor);
+        if (visitor.mMesh->mIndices.empty())
+            return nullptr;
+        return visitor.mMesh;
+    }
+
+    OcclusionBuffer::OcclusionBuffer(int width, int height)
+    {
+        while (true)
+        {
+            mLevels.push_back(Level{ width, height, std::vector<float>(static_cast<std::size_t>(width) * height, 0) });
+            if (width == 1 && height == 1)
+                break;
+            width = (width + 1) / 2;
+            height = (height + 1) / 2;
+        }
+    }
+
+    void OcclusionBuffer::clear()
+    {
+        for (Level& level : mLevels)
+            std::fill(level.mDepths.begin(), level.mDepths.end(), 0.f);
+    }
+
+    void OcclusionBuffer::addOccluder(const OccluderMesh& mesh, const osg::Matrix& modelViewProjection)
+    {
+        if (mesh.mBound.valid())
+        {
+            const std::optional<ScreenRect> rect
+                = getScreenRect(mesh.mBound, modelViewProjection, getWidth(), getHeight());
+            // Skip occluders covering no pixel center
+            if (rect.has_value()
+                && (std::ceil(rect->mMinX - 0.5f) > std::min(std::floor(rect->mMaxX - 0.5f), getWidth() - 1.f)
+                    || std::ceil(rect->mMinY - 0.5f) > std::min(std::floor(rect->mMaxY - 0.5f), getHeight() - 1.f)
+                    || rect->mMaxX < 0 || rect->mMaxY < 0))
+                return;
+        }
+
+        const osg::Matrixf matrix(modelViewProjection);
+        mClipVertices.resize(mesh.mVertices.size());
+        for (std::size_t i = 0; i < mesh.mVertices.size(); ++i)
+            mClipVertices[i] = osg::Vec4f(mesh.mVertices[i], 1) * matrix;
+
+        for (std::size_t i = 0; i + 2 < mesh.mIndices.size(); i += 3)
+            addTriangle(mClipVertices[mesh.mIndices[i]], mClipVertices[mesh.mIndices[i + 1]],
+                mClipVertices[mesh.mIndices[i + 2]]);
+    }
+
+    void OcclusionBuffer::addTriangle(const osg::Vec4f& a, const osg::Vec4f& b, const osg::Vec4f& c)
+    {
+        const auto isInside = [](const osg::Vec4f& v) {
+            return v.w() >= minW && std::abs(v.x()) <= guardBand * v.w() && std::abs(v.y()) <= guardBand * v.w();
+        };
+        if (isInside(a) && isInside(b) && isInside(c))
+            return rasterizeTriangle(a, b, c);
+        if (a.w() < minW && b.w() < minW && c.w() < minW)
+            return;
+
+        // Each clipping plane adds at most one vertex to the polygon
+        constexpr std::size_t numPlanes = 5;
+        std::array<osg::Vec4f, 3 + numPlanes> polygon{ a, b, c };
+        std::array<osg::Vec4f, 3 + numPlanes> clipped;
+        std::size_t size = 3;
+        for (std::size_t plane = 0; plane < numPlanes && size >= 3; ++plane)
+        {
+            const auto distance = [plane](const osg::Vec4f& v) {
+                switch (plane)
+                {
+                    case 0:
+                        return v.w() - minW;
+                    case 1:
+                        return guardBand * v.w() - v.x();
+                    case 2:
+                        return guardBand * v.w() + v.x();
+                    case 3:
+                        return guardBand * v.w() - v.y();
+                    default:
+                        return guardBand * v.w() + v.y();
+                }
+            };
+            std::size_t clippedSize = 0;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const osg::Vec4f& current = polygon[i];
+                const osg::Vec4f& next = polygon[(i + 1) % size];
+                const float currentDistance = distance(current);
+                const float nextDistance = distance(next);
+                if (currentDistance >= 0)
+                    clipped[clippedSize++] = current;
+                if ((currentDistance >= 0) != (nextDistance >= 0))
+                    clipped[clippedSize++]
+                        = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+            }
+            polygon = clipped;
+            size = clippedSize;
+        }
+
+        for (std::size_t i = 1; i + 1 < size; ++i)
+            rasterizeTriangle(polygon[0], polygon[i], polygon[i + 1]);
+    }
+
+    void OcclusionBuffer::rasterizeTriangle(const osg::Vec4f& a, const osg::Vec4f& b, const osg::Vec4f& c)
+    {
+        const int width = getWidth();
+        const int height = getHeight();
+        const auto toScreen = [&](const osg::Vec4f& v) {
+            const float invW = 1 / v.w();
+            return ScreenVertex{ std::llround((v.x() * invW * 0.5f + 0.5f) * width * subpixels),
+                std::llround((v.y() * invW * 0.5f + 0.5f) * height * subpixels), invW };
+        };
+
+        const ScreenVertex v0 = toScreen(a);
+        ScreenVertex v1 = toScreen(b);
+        ScreenVertex v2 = toScreen(c);
+
+        std::int64_t area = (v1.mX - v0.mX) * (v2.mY - v0.mY) - (v1.mY - v0.mY) * (v2.mX - v0.mX);
+        if (area == 0)
+            return;
+        if (area < 0)
+        {
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        // Pixels with centers within the bounding box of the triangle
+        const std::int64_t half = subpixels / 2;
+        const int minX = static_cast<int>(std::max<std::int64_t>(
+            0, -floorDiv(half - std::min({ v0.mX, v1.mX, v2.mX }), subpixels)));
+        const int maxX = static_cast<int>(
+            std::min<std::int64_t>(width - 1, floorDiv(std::max({ v0.mX, v1.mX, v2.mX }) - half, subpixels)));
+        const int minY = static_cast<int>(std::max<std::int64_t>(
+            0, -floorDiv(half - std::min({ v0.mY, v1.mY, v2.mY }), subpixels)));
+        const int maxY = static_cast<int>(
+            std::min<std::int64_t>(height - 1, floorDiv(std::max({ v0.mY, v1.mY, v2.mY }) - half, subpixels)));
+        if (minX > maxX || minY > maxY)
+            return;
+
+        const std::int64_t startX = minX * subpixels + half;
+        const std::int64_t startY = minY * subpixels + half;
+        Edge e0(v1, v2, startX, startY);
+        Edge e1(v2, v0, startX, startY);
+        Edge e2(v0, v1, startX, startY);
+
+        // 1/w is linear in screen space. The farthest depth within a pixel is at one of its corners.
+        const float scale = 1.f / subpixels;
+        const float x1 = (v1.mX - v0.mX) * scale;
+        const float y1 = (v1.mY - v0.mY) * scale;
+        const float x2 = (v2.mX - v0.mX) * scale;
+        const float y2 = (v2.mY - v0.mY) * scale;
+        const float z1 = v1.mDepth - v0.mDepth;
+        const float z2 = v2.mDepth - v0.mDepth;
+        const float determinant = area * scale * scale;
+        const float depthStepX = (z1 * y2 - z2 * y1) / determinant;
+        const float depthStepY = (z2 * x1 - z1 * x2) / determinant;
+        const float minDepth = std::min({ v0.mDepth, v1.mDepth, v2.mDepth });
+        float rowDepth = v0.mDepth + depthStepX * (startX - v0.mX) * scale + depthStepY * (startY - v0.mY) * scale
+            - 0.5f * (std::abs(depthStepX) + std::abs(depthStepY));
+
+        std::vector<float>& depths = mLevels.front().mDepths;
+        for (int y = minY; y <= maxY; ++y)
+        {
+            std::int64_t w0 = e0.mValue;
+            std::int64_t w1 = e1.mValue;
+            std::int64_t w2 = e2.mValue;
+            float depth = rowDepth;
+            float* row = depths.data() + static_cast<std::size_t>(y) * width;
+            for (int x = minX; x <= maxX; ++x)
+            {
+                if ((w0 | w1 | w2) >= 0)
+                    row[x] = std::max(row[x], std::max(depth, minDepth));
+                w0 += e0.mStepX;
+                w1 += e1.mStepX;
+                w2 += e2.mStepX;
+                depth += depthStepX;
+            }
+            e0.mValue += e0.mStepY;
+            e1.mValue += e1.mStepY;
+            e2.mValue += e2.mStepY;
+            rowDepth += depthStepY;
+        }
+    }
+
+    void OcclusionBuffer::buildHierarchy()
+    {
+        for (std::size_t i = 1; i < mLevels.size(); ++i)
+        {
+            const Level& source = mLevels[i - 1];
+            Level& target = mLevels[i];
+            for (int y = 0; y < target.mHeight; ++y)
+            {
+                for (int x = 0; x < target.mWidth; ++x)
+                {
+                    float depth = std::numeric_limits<float>::max();
+                    for (int sy = y * 2; sy < std::min(y * 2 + 2, source.mHeight); ++sy)
+                        for (int sx = x * 2; sx < std::min(x * 2 + 2, source.mWidth); ++sx)
+                            depth = std::min(depth, source.mDepths[sy * source.mWidth + sx]);
+                    target.mDepths[y * target.mWidth + x] = depth;
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::isOccluded(const osg::BoundingBox& box, const osg::Matrix& modelViewProjection) const
+    {
+        const int width = getWidth();
+        const int height = getHeight();
+        const std::optional<ScreenRect> rect = getScreenRect(box, modelViewProjection, width, height);
+        if (!rect.has_value() || rect->mMaxX < 0 || rect->mMaxY < 0 || rect->mMinX >= width || rect->mMinY >= height)
+            return false;
+
+        // A pixel counts as covered when its center is, so one more pixel around the box is checked to be sure the
+        // part of the box within the border pixels is covered too.
+        const auto toPixel = [](float value, int size) {
+            return static_cast<int>(std::clamp(std::floor(value), -1.f, static_cast<float>(size)));
+        };
+        const int minX = std::max(0, toPixel(rect->mMinX, width) - 1);
+        const int minY = std::max(0, toPixel(rect->mMinY, height) - 1);
+        const int maxX = std::min(width - 1, toPixel(rect->mMaxX, width) + 1);
+        const int maxY = std::min(height - 1, toPixel(rect->mMaxY, height) + 1);
+
+        std::size_t levelIndex = 0;
+        while (levelIndex + 1 < mLevels.size()
+            && std::max((maxX >> levelIndex) - (minX >> levelIndex), (maxY >> levelIndex) - (minY >> levelIndex)) > 3)
+            ++levelIndex;
+
+        const Level& level = mLevels[levelIndex];
+        for (int y = minY >> levelIndex; y <= maxY >> levelIndex; ++y)
+            for (int x = minX >> levelIndex; x <= maxX >> levelIndex; ++x)
+                if (level.mDepths[y * level.mWidth + x] <= rect->mMaxDepth)
+                    return false;
+
+        return true;
+    }
+
+    OcclusionView::OcclusionView(const osg::Camera& camera, int width, int height)
+        : mCamera(&camera)
+        , mBuffer(width, height)
+    {
+    }
+
+    OcclusionView* OcclusionView::get(osgUtil::CullVisitor& cv)
+    {
+        OcclusionView* view = dynamic_cast<OcclusionView*>(cv.getUserData());
+        // Nested cameras like water reflections are culled with the same visitor
+        if (view == nullptr || view->mCamera != cv.getCurrentCamera())
+            return nullptr;
+        return view;
+    }
+
+    void OcclusionView::addOccluder(const OccluderMesh& mesh, const osg::Matrix& modelView)
+    {
+        mOccluders.push_back(Occluder{ &mesh, modelView * mInverseViewMatrix });
+    }
+
+    bool OcclusionView::isOccluded(const osg::BoundingBox& box, const osg::Matrix& modelView) const
+    {
+        return mBuffer.isOccluded(box, modelView * mProjectionMatrix);
+    }
+
+    void OcclusionView::begin(osgUtil::CullVisitor& cv)
+    {
+        const unsigned int frameNumber = cv.getFrameStamp()->getFrameNumber();
+        if (frameNumber == mFrameNumber)
+            return;
+        mFrameNumber = frameNumber;
+
+        const osg::Matrix& viewMatrix = *cv.getModelViewMatrix();
+        mProjectionMatrix = *cv.getProjectionMatrix();
+        mInverseViewMatrix.invert(viewMatrix);
+
+        mBuffer.clear();
+
+        // After a teleport the occluders of the previous frame are likely not there anymore
+        const osg::Vec3f eyePoint = mInverseViewMatrix.getTrans();
+        if ((eyePoint - mEyePoint).length2() < maxEyeMovement * maxEyeMovement)
+        {
+            const osg::Matrix viewProjection = viewMatrix * mProjectionMatrix;
+            for (const Occluder& occluder : mOccluders)
+                mBuffer.addOccluder(*occluder.mMesh, osg::Matrix(occluder.mWorldMatrix) * viewProjection);
+        }
+        mEyePoint = eyePoint;
+        mOccluders.clear();
+
+        mBuffer.buildHierarchy();
+    }
+
+    OcclusionCulling::OcclusionCulling(int width)
+        : mWidth(width)
+    {
+    }
+
+    void OcclusionCulling::operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+    {
+        const osg::Camera* camera = cv->getCurrentCamera();
+        const osg::Viewport* viewport = cv->getViewport();
+        // The buffer only supports perspective projections
+        if (camera->getName() != Constants::SceneCamera || viewport == nullptr || viewport->width() <= 0
+            || (*cv->getProjectionMatrix())(3, 3) != 0)
+        {
+            traverse(node, cv);
+            return;
+        }
+
+        const int height = std::max(1, static_cast<int>(std::lround(mWidth * viewport->height() / viewport->width())));
+        OcclusionView& view = getView(*camera, height);
+        view.begin(*cv);
+
+        osg::ref_ptr<osg::Referenced> previous = cv->getUserData();
+        cv->setUserData(&view);
+        traverse(node, cv);
+        cv->setUserData(previous);
+    }
+
+    OcclusionView& OcclusionCulling::getView(const osg::Camera& camera, int height)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        osg::ref_ptr<OcclusionView>& view = mViews[&camera];
+        if (view == nullptr || view->mBuffer.getWidth() != mWidth || view->mBuffer.getHeight() != height)
+            view = new OcclusionView(camera, mWidth, height);
+        return *view;
+    }
+
+    OcclusionCullCallback::OcclusionCullCallback(osg::ref_ptr<const OccluderMesh> occluder)
+        : mOccluder(std::move(occluder))
+    {
+    }
+
+    void OcclusionCullCallback::operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+    {
+        OcclusionView* view = OcclusionView::get(*cv);
+        if (view == nullptr)
+        {
+            traverse(node, cv);
+            return;
+        }
+
+        // The model view matrix already includes the matrix of a transform while its bound is in the space of its
+        // parent
+        osg::BoundingBox box;
+        if (osg::Group* group = node->asTransform())
+        {
+            for (unsigned int i = 0; i < group->getNumChildren(); ++i)
+                box.expandBy(group->getChild(i)->getBound());
+        }
+        else
+            box.expandBy(node->getBound());
+
+        const osg::Matrix& modelView = *cv->getModelViewMatrix();
+        if (box.valid() && view->isOccluded(box, modelView))
+            return;
+
+        if (mOccluder != nullptr)
+            view->addOccluder(*mOccluder, modelView);
+
+        traverse(node, cv);
+    }
+}
@@ -0,0 +1,155 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_OCCLUSIONCULLING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_OCCLUSIONCULLING_H
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <osg/BoundingBox>
+#include <osg/Matrix>
+#include <osg/Matrixf>
+
+#include <components/sceneutil/nodecallback.hpp>
+
+namespace osg
+{
+    class Camera;
+}
+
+namespace osgUtil
+{
+    class CullVisitor;
+}
+
+namespace SceneUtil
+{
+    /// Triangles hiding everything behind them, in the local space of the node they belong to. Must not be larger than
+    /// the visible geometry of the node.
+    struct OccluderMesh : public osg::Referenced
+    {
+        std::vector<osg::Vec3f> mVertices;
+        std::vector<unsigned int> mIndices;
+        osg::BoundingBox mBound;
+    };
+
+    /// Collects the triangles of the opaque geometry of a node, in the local space of the node.
+    /// @return nullptr if there are no such triangles
+    osg::ref_ptr<OccluderMesh> createOccluderMesh(osg::Node& node);
+
+    /// Software rasterized depth buffer of occluders with a hierarchy of the farthest depths for fast tests.
+    /// @par Depth is stored as 1/w of the clip space coordinates, so a greater value is closer to the camera, 0 means no
+    /// occluder and the depth range of the projection doesn't matter. Written depths are the farthest depth of the
+    /// triangle within the pixel, so the buffer never claims an occluder is closer than it is.
+    class OcclusionBuffer
+    {
+    public:
+        OcclusionBuffer(int width, int height);
+
+        int getWidth() const { return mLevels.front().mWidth; }
+
+        int getHeight() const { return mLevels.front().mHeight; }
+
+        float getDepth(int x, int y) const { return mLevels.front().mDepths[y * getWidth() + x]; }
+
+        void clear();
+
+        void addOccluder(const OccluderMesh& mesh, const osg::Matrix& modelViewProjection);
+
+        /// Has to be called after the last occluder is added and before the buffer is tested.
+        void buildHierarchy();
+
+        /// @return true when the box is entirely behind the occluders. Boxes close to the camera are never occluded.
+        bool isOccluded(const osg::BoundingBox& box, const osg::Matrix& modelViewProjection) const;
+
+    private:
+        struct Level
+        {
+            int mWidth;
+            int mHeight;
+            std::vector<float> mDepths;
+        };
+
+        std::vector<Level> mLevels;
+        std::vector<osg::Vec4f> mClipVertices;
+
+        void addTriangle(const osg::Vec4f& a, const osg::Vec4f& b, const osg::Vec4f& c);
+
+        void rasterizeTriangle(const osg::Vec4f& a, const osg::Vec4f& b, const osg::Vec4f& c);
+    };
+
+    /// Occlusion state of a camera. The occluders registered while culling a frame are rasterized at the beginning of
+    /// the next frame with the view of that frame because the occluders and the nodes they hide are culled in any
+    /// order.
+    class OcclusionView : public osg::Referenced
+    {
+    public:
+        OcclusionView(const osg::Camera& camera, int width, int height);
+
+        /// @return the view of the camera currently culled by the visitor, nullptr if it doesn't use occlusion culling
+        static OcclusionView* get(osgUtil::CullVisitor& cv);
+
+        void addOccluder(const OccluderMesh& mesh, const osg::Matrix& modelView);
+
+        bool isOccluded(const osg::BoundingBox& box, const osg::Matrix& modelView) const;
+
+    private:
+        struct Occluder
+        {
+            osg::ref_ptr<const OccluderMesh> mMesh;
+            osg::Matrixf mWorldMatrix;
+        };
+
+        const osg::Camera* mCamera;
+        OcclusionBuffer mBuffer;
+        std::vector<Occluder> mOccluders;
+        osg::Matrix mInverseViewMatrix;
+        osg::Matrix mProjectionMatrix;
+        osg::Vec3f mEyePoint;
+        unsigned int mFrameNumber = ~0u;
+
+        void begin(osgUtil::CullVisitor& cv);
+
+        friend class OcclusionCulling;
+    };
+
+    /// Enables occlusion culling for the scene camera while culling the subgraph of the node it is attached to.
+    class OcclusionCulling : public SceneUtil::NodeCallback<OcclusionCulling, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        /// @param width Width of the depth buffer in pixels, the height follows the aspect ratio of the viewport
+        explicit OcclusionCulling(int width);
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv);
+
+    private:
+        int mWidth;
+        std::mutex mMutex;
+        std::map<const osg::Camera*, osg::ref_ptr<OcclusionView>> mViews;
+
+        OcclusionView& getView(const osg::Camera& camera, int height);
+    };
+
+    /// Skips the node when its bound is occluded and registers the occluder mesh of the node, if any.
+    class OcclusionCullCallback
+        : public SceneUtil::NodeCallback<OcclusionCullCallback, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        explicit OcclusionCullCallback(osg::ref_ptr<const OccluderMesh> occluder = nullptr);
+
+        OcclusionCullCallback(const OcclusionCullCallback& copy, const osg::CopyOp& copyop)
+            : osg::Object(copy, copyop)
+            , SceneUtil::NodeCallback<OcclusionCullCallback, osg::Node*, osgUtil::CullVisitor*>(copy, copyop)
+            , mOccluder(copy.mOccluder)
+        {
+        }
+
+        META_Object(SceneUtil, OcclusionCullCallback)
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv);
+
+    private:
+        osg::ref_ptr<const OccluderMesh> mOccluder;
+    };
+}
+
+#endif
@@ -1,5 +1,6 @@
 #include "riggeometry.hpp"
 
+#include <algorithm>
 #include <unordered_map>
 
 #include <osg/MatrixTransform>
@@ -8,12 +9,28 @@
 
 #include <components/debug/debuglog.hpp>
 #include <components/resource/scenemanager.hpp>
+#include <components/shader/shadermanager.hpp>
 
 #include "skeleton.hpp"
 #include "util.hpp"
 
 namespace SceneUtil
 {
+    namespace
+    {
+        bool computesNearFarFromPrimitives(const osg::NodeVisitor& nv)
+        {
+            const osgUtil::CullVisitor* cv = static_cast<const osgUtil::CullVisitor*>(&nv);
+            return cv->getComputeNearFarMode() == osg::CullSettings::COMPUTE_NEAR_FAR_USING_PRIMITIVES
+                || cv->getComputeNearFarMode() == osg::CullSettings::COMPUTE_NEAR_USING_PRIMITIVES;
+        }
+
+        template <class Array>
+        auto getData(Array& array)
+        {
+            return array.empty() ? nullptr : &array.front();
+        }
+    }
 
     RigGeometry::RigGeometry()
     {
@@ -24,6 +41,7 @@ namespace SceneUtil
     RigGeometry::RigGeometry(const RigGeometry& copy, const osg::CopyOp& copyop)
         : Drawable(copy, copyop)
         , mData(copy.mData)
+        , mGpuSkinning(copy.mGpuSkinning)
     {
         setSourceGeometry(copy.mSourceGeometry);
         setNumChildrenRequiringUpdateTraversal(1);
@@ -56,6 +74,22 @@ namespace SceneUtil
             to.setComputeBoundingBoxCallback(new CopyBoundingBoxCallback());
             to.setComputeBoundingSphereCallback(new CopyBoundingSphereCallback());
 
+            if (mGpuSkinning)
+            {
+                // The shaders transform the shared vertices, only the bone matrices differ between the geometries
+                to.setVertexAttribArray(sBoneIndicesAttribLocation, mData->mBoneIndices, osg::Array::BIND_PER_VERTEX);
+                to.setVertexAttribArray(sBoneWeightsAttribLocation, mData->mBoneWeights, osg::Array::BIND_PER_VERTEX);
+
+                osg::ref_ptr<osg::StateSet> stateset = from.getStateSet()
+                    ? new osg::StateSet(*from.getStateSet(), osg::CopyOp::SHALLOW_COPY)
+                    : new osg::StateSet;
+                stateset->addUniform(new osg::Uniform(osg::Uniform::FLOAT_VEC4, "boneMatrices",
+                    static_cast<int>(mData->mBones.size() * 3)));
+                stateset->addUniform(new osg::Uniform("skinningOffset", osg::Vec3f()));
+                to.setStateSet(stateset);
+                continue;
+            }
+
             // vertices and normals are modified every frame, so we need to deep copy them.
             // assign a dedicated VBO to make sure that modifications don't interfere with source geometry's VBO.
             osg::ref_ptr<osg::VertexBufferObject> vbo(new osg::VertexBufferObject);
@@ -98,6 +132,41 @@ namespace SceneUtil
         return mSourceGeometry;
     }
 
+    void RigGeometry::addSkinningAttribLocations(osg::Program& program)
+    {
+        program.addBindAttribLocation("aBoneIndices", sBoneIndicesAttribLocation);
+        program.addBindAttribLocation("aBoneWeights", sBoneWeightsAttribLocation);
+    }
+
+    osg::ref_ptr<osg::Program> RigGeometry::makeSkinningProgramTemplate(const osg::Program* programTemplate)
+    {
+        osg::ref_ptr<osg::Program> result = programTemplate ? Shader::ShaderManager::cloneProgram(programTemplate)
+                                                            : osg::ref_ptr<osg::Program>(new osg::Program);
+        addSkinningAttribLocations(*result);
+        return result;
+    }
+
+    bool RigGeometry::supportsGpuSkinning() const
+    {
+        if (!mData || !mData->mBoneIndices || mData->mBones.empty() || mData->mBones.size() > sMaxGpuSkinningBones)
+            return false;
+        // The vertices without influences past the last influenced one would have no attributes
+        return mSourceGeometry && mSourceGeometry->getVertexArray()
+            && mSourceGeometry->getVertexArray()->getNumElements() == mData->mBoneIndices->size();
+    }
+
+    void RigGeometry::setGpuSkinning(bool enabled)
+    {
+        enabled = enabled && supportsGpuSkinning();
+        if (enabled == mGpuSkinning)
+            return;
+        mGpuSkinning = enabled;
+        mLastFrameNumber = 0;
+        mPendingSkinning = nullptr;
+        if (mSourceGeometry)
+            setSourceGeometry(mSourceGeometry);
+    }
+
     bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
     {
         const osg::NodePath& path = nv->getNodePath();
@@ -148,64 +217,90 @@ namespace SceneUtil
         }
 
         unsigned int traversalNumber = nv->getTraversalNumber();
-        if (mLastFrameNumber == traversalNumber || (mLastFrameNumber != 0 && !mSkeleton->getActive()))
+        // Skip the skinning when the bones haven't moved since the last one, e.g. with the animation LOD
+        if (mLastFrameNumber == traversalNumber
+            || (mLastFrameNumber != 0
+                && (!mSkeleton->getActive() || mSkeleton->getLastAnimatedFrameNumber() <= mLastFrameNumber)))
         {
-            osg::Geometry& geom = *getGeometry(mLastFrameNumber);
+            // near and far planes computed from primitives need the skinned vertices
+            if (mPendingSkinning != nullptr && computesNearFarFromPrimitives(*nv))
+            {
+                mPendingSkinning->finish();
+                mPendingSkinning = nullptr;
+            }
+
+            osg::Geometry& geom = *getGeometry(mCurrentGeometry);
             nv->pushOntoNodePath(&geom);
             nv->apply(geom);
             nv->popFromNodePath();
             return;
         }
         mLastFrameNumber = traversalNumber;
-        osg::Geometry& geom = *getGeometry(mLastFrameNumber);
+        // The other geometry may still be drawn for a frame that reused it
+        mCurrentGeometry = (mCurrentGeometry + 1) % 2;
+        osg::Geometry& geom = *getGeometry(mCurrentGeometry);
 
         mSkeleton->updateBoneMatrices(traversalNumber);
 
-        // skinning
-        const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-        const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-        const osg::Vec4Array* tangentSrc = mSourceTangents;
+        mPendingSkinning = nullptr;
+        ParallelSkinning* parallelSkinning = ParallelSkinning::getCurrent();
+        if (mGpuSkinning)
+            updateBoneMatrices(geom);
+        else if (parallelSkinning != nullptr && !computesNearFarFromPrimitives(*nv))
+        {
+            osg::ref_ptr<RigGeometry> self(this);
+            osg::ref_ptr<osg::Geometry> geomRef(&geom);
+            mPendingSkinning = new SkinningJob([self, geomRef] { self->skin(*geomRef); });
+            parallelSkinning->addJob(mPendingSkinning);
+        }
+        else
+            skin(geom);
 
-        osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
-        osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
-        osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
+        nv->pushOntoNodePath(&geom);
+        nv->apply(geom);
+        nv->popFromNodePath();
+    }
 
-        for (const auto& [influences, vertices] : mData->mInfluences)
+    void RigGeometry::updatePalette()
+    {
+        mPalette.resize(mNodes.size());
+        for (std::size_t i = 0; i < mNodes.size(); ++i)
         {
-            osg::Matrixf resultMat(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
+            if (const Bone* bone = mNodes[i])
+                mPalette.set(i, mData->mBones[i].mInvBindMatrix * bone->mMatrixInSkeletonSpace);
+            else
+                mPalette.setMissing(i);
+        }
+    }
 
-            for (const auto& [index, weight] : influences)
-            {
-                const Bone* bone = mNodes[index];
-                if (bone == nullptr)
-                    continue;
-
-                osg::Matrixf boneMat = mData->mBones[index].mInvBindMatrix * bone->mMatrixInSkeletonSpace;
-                float* boneMatPtr = boneMat.ptr();
-                float* resultMatPtr = resultMat.ptr();
-                for (int i = 0; i < 16; ++i, ++resultMatPtr, ++boneMatPtr)
-                    if (i % 4 != 3)
-                        *resultMatPtr += *boneMatPtr * weight;
-            }
+    void RigGeometry::skin(osg::Geometry& geom)
+    {
+        updatePalette();
 
-            if (mGeomToSkelMatrix)
-                resultMat *= (*mGeomToSkelMatrix);
+        osg::Matrixf geomToSkelMatrix;
+        if (mGeomToSkelMatrix)
+            geomToSkelMatrix = *mGeomToSkelMatrix;
 
-            for (unsigned short vertex : vertices)
-            {
-                (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-                if (normalDst)
-                    (*normalDst)[vertex] = osg::Matrixf::transform3x3((*normalSrc)[vertex], resultMat);
+        osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
+        osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
+        osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
 
-                if (tangentDst)
-                {
-                    const osg::Vec4f& srcTangent = (*tangentSrc)[vertex];
-                    osg::Vec3f transformedTangent = osg::Matrixf::transform3x3(
-                        osg::Vec3f(srcTangent.x(), srcTangent.y(), srcTangent.z()), resultMat);
-                    (*tangentDst)[vertex] = osg::Vec4f(transformedTangent, srcTangent.w());
-                }
-            }
+        SkinningArrays arrays;
+        arrays.mPositionSrc = getData(*static_cast<const osg::Vec3Array*>(mSourceGeometry->getVertexArray()));
+        arrays.mPositionDst = getData(*positionDst);
+        if (normalDst)
+        {
+            arrays.mNormalSrc = getData(*static_cast<const osg::Vec3Array*>(mSourceGeometry->getNormalArray()));
+            arrays.mNormalDst = getData(*normalDst);
         }
+        if (tangentDst)
+        {
+            arrays.mTangentSrc = getData(*mSourceTangents);
+            arrays.mTangentDst = getData(*tangentDst);
+        }
+
+        for (const auto& [influences, vertices] : mData->mInfluences)
+            skinVertices(mPalette, influences, mGeomToSkelMatrix ? &geomToSkelMatrix : nullptr, vertices, arrays);
 
         positionDst->dirty();
         if (normalDst)
@@ -214,10 +309,32 @@ namespace SceneUtil
             tangentDst->dirty();
 
         geom.osg::Drawable::dirtyGLObjects();
+    }
 
-        nv->pushOntoNodePath(&geom);
-        nv->apply(geom);
-        nv->popFromNodePath();
+    void RigGeometry::updateBoneMatrices(osg::Geometry& geom)
+    {
+        updatePalette();
+
+        // As on the CPU, the translation of geomToSkel is applied once after blending whatever the weights sum to
+        osg::Matrixf geomToSkelMatrix;
+        if (mGeomToSkelMatrix)
+            geomToSkelMatrix = *mGeomToSkelMatrix;
+        const osg::Vec3f offset = geomToSkelMatrix.getTrans();
+        geomToSkelMatrix.setTrans(0, 0, 0);
+
+        osg::StateSet& stateset = *geom.getStateSet();
+        osg::Uniform& boneMatrices = *stateset.getUniform("boneMatrices");
+        for (std::size_t i = 0; i < mPalette.size(); ++i)
+        {
+            osg::Matrixf matrix(mPalette.get(i));
+            if (mGeomToSkelMatrix)
+                matrix.postMult(geomToSkelMatrix);
+            // The shaders only need the first three columns, the last one is always (0, 0, 0, 1)
+            for (int column = 0; column < 3; ++column)
+                boneMatrices.setElement(static_cast<unsigned int>(i * 3 + column),
+                    osg::Vec4f(matrix(0, column), matrix(1, column), matrix(2, column), matrix(3, column)));
+        }
+        stateset.getUniform("skinningOffset")->set(offset);
     }
 
     void RigGeometry::updateBounds(osg::NodeVisitor* nv)
@@ -329,6 +446,8 @@ namespace SceneUtil
 
         mData->mInfluences.reserve(influencesToVertices.size());
         mData->mInfluences.assign(influencesToVertices.begin(), influencesToVertices.end());
+
+        bakeVertexInfluences();
     }
 
     void RigGeometry::setInfluences(const std::vector<BoneWeights>& influences)
@@ -342,6 +461,37 @@ namespace SceneUtil
 
         mData->mInfluences.reserve(influencesToVertices.size());
         mData->mInfluences.assign(influencesToVertices.begin(), influencesToVertices.end());
+
+        bakeVertexInfluences();
+    }
+
+    void RigGeometry::bakeVertexInfluences()
+    {
+        std::size_t numVertices = 0;
+        for (const auto& [weights, vertices] : mData->mInfluences)
+            for (unsigned short vertex : vertices)
+                numVertices = std::max<std::size_t>(numVertices, vertex + 1);
+
+        // Vertices without influences keep zero weights
+        osg::ref_ptr<osg::Vec4Array> boneIndices = new osg::Vec4Array(static_cast<unsigned int>(numVertices));
+        osg::ref_ptr<osg::Vec4Array> boneWeights = new osg::Vec4Array(static_cast<unsigned int>(numVertices));
+        for (const auto& [weights, vertices] : mData->mInfluences)
+        {
+            const PackedInfluences packed = packInfluences(weights, mData->mBones.size());
+            for (unsigned short vertex : vertices)
+            {
+                (*boneIndices)[vertex] = packed.mIndices;
+                (*boneWeights)[vertex] = packed.mWeights;
+            }
+        }
+
+        // Shared by all the instances of the mesh
+        osg::ref_ptr<osg::VertexBufferObject> vbo(new osg::VertexBufferObject);
+        boneIndices->setVertexBufferObject(vbo);
+        boneWeights->setVertexBufferObject(vbo);
+
+        mData->mBoneIndices = std::move(boneIndices);
+        mData->mBoneWeights = std::move(boneWeights);
     }
 
     void RigGeometry::accept(osg::NodeVisitor& nv)
@@ -374,12 +524,36 @@ namespace SceneUtil
 
     void RigGeometry::accept(osg::PrimitiveFunctor& func) const
     {
-        getGeometry(mLastFrameNumber)->accept(func);
+        const osg::Geometry& geom = *getGeometry(mCurrentGeometry);
+        if (!mGpuSkinning || mPalette.size() != mData->mBones.size())
+        {
+            geom.accept(func);
+            return;
+        }
+
+        // Only the shaders transform the vertices, intersections need them too
+        const osg::Vec3Array& positions = *static_cast<const osg::Vec3Array*>(mSourceGeometry->getVertexArray());
+        mSkinnedPositions.assign(positions.begin(), positions.end());
+
+        SkinningArrays arrays;
+        arrays.mPositionSrc = getData(positions);
+        arrays.mPositionDst = getData(mSkinnedPositions);
+
+        osg::Matrixf geomToSkelMatrix;
+        if (mGeomToSkelMatrix)
+            geomToSkelMatrix = *mGeomToSkelMatrix;
+
+        for (const auto& [influences, vertices] : mData->mInfluences)
+            skinVertices(mPalette, influences, mGeomToSkelMatrix ? &geomToSkelMatrix : nullptr, vertices, arrays);
+
+        func.setVertexArray(static_cast<unsigned int>(mSkinnedPositions.size()), getData(mSkinnedPositions));
+        for (const osg::ref_ptr<osg::PrimitiveSet>& primitiveSet : geom.getPrimitiveSetList())
+            primitiveSet->accept(func);
     }
 
-    osg::Geometry* RigGeometry::getGeometry(unsigned int frame) const
+    osg::Geometry* RigGeometry::getGeometry(unsigned int index) const
     {
-        return mGeometry[frame % 2].get();
+        return mGeometry[index].get();
     }
 
 }
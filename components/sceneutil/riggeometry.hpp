@@ -3,6 +3,9 @@
 
 #include <osg/Geometry>
 #include <osg/Matrixf>
+#include <osg/Program>
+
+#include "skinning.hpp"
 
 namespace SceneUtil
 {
@@ -60,6 +63,27 @@ namespace SceneUtil
 
         osg::ref_ptr<osg::Geometry> getSourceGeometry() const;
 
+        /// Maximum number of bones of a mesh skinned by the shaders, see lib/util/skinning.glsl.
+        static constexpr std::size_t sMaxGpuSkinningBones = 64;
+
+        /// Attributes holding the indices and the weights of the bones influencing every vertex.
+        static constexpr unsigned int sBoneIndicesAttribLocation = 4;
+        static constexpr unsigned int sBoneWeightsAttribLocation = 5;
+
+        static void addSkinningAttribLocations(osg::Program& program);
+
+        /// @return a copy of \a programTemplate, or a new program if it's null, with the skinning attribute locations
+        static osg::ref_ptr<osg::Program> makeSkinningProgramTemplate(const osg::Program* programTemplate);
+
+        /// @return true if the shaders can skin this mesh: it has up to sMaxGpuSkinningBones bones. Only the 4 most
+        /// influential bones of every vertex are used then.
+        bool supportsGpuSkinning() const;
+
+        /// Leave the skinning to the shaders, which must be compiled with the skinning define. Only the bone matrices
+        /// are updated every frame then.
+        void setGpuSkinning(bool enabled);
+        bool getGpuSkinning() const { return mGpuSkinning; }
+
         void accept(osg::NodeVisitor& nv) override;
         bool supports(const osg::PrimitiveFunctor&) const override { return true; }
         void accept(osg::PrimitiveFunctor&) const override;
@@ -80,10 +104,16 @@ namespace SceneUtil
 
     private:
         void cull(osg::NodeVisitor* nv);
+        void updatePalette();
+        void skin(osg::Geometry& geom);
+        void updateBoneMatrices(osg::Geometry& geom);
+        void bakeVertexInfluences();
         void updateBounds(osg::NodeVisitor* nv);
 
         osg::ref_ptr<osg::Geometry> mGeometry[2];
-        osg::Geometry* getGeometry(unsigned int frame) const;
+        // Alternates on every skinning, so that the geometry being drawn is never modified
+        unsigned int mCurrentGeometry{ 0 };
+        osg::Geometry* getGeometry(unsigned int index) const;
 
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
         osg::ref_ptr<const osg::Vec4Array> mSourceTangents;
@@ -96,12 +126,20 @@ namespace SceneUtil
         {
             std::vector<BoneInfo> mBones;
             std::vector<std::pair<BoneWeights, VertexList>> mInfluences;
+            // Per vertex influences for the skinning in the shaders, see packInfluences
+            osg::ref_ptr<osg::Vec4Array> mBoneIndices;
+            osg::ref_ptr<osg::Vec4Array> mBoneWeights;
         };
         osg::ref_ptr<InfluenceData> mData;
         std::vector<Bone*> mNodes;
+        SkinningPalette mPalette;
+        osg::ref_ptr<SkinningJob> mPendingSkinning;
+        // Positions skinned on the CPU for the primitive functors when the shaders do the skinning
+        mutable std::vector<osg::Vec3f> mSkinnedPositions;
 
         unsigned int mLastFrameNumber{ 0 };
         bool mBoundsFirstFrame{ true };
+        bool mGpuSkinning{ false };
 
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
@@ -76,6 +76,19 @@ namespace SceneUtil
 
         mShadowSettings->setMultipleShadowMapHint(osgShadow::ShadowSettings::CASCADED);
 
+        if (settings.mCacheStaticShadowCasters)
+        {
+            // Perspective shadow maps change with the view direction so they can't be cached
+            mShadowSettings->setShadowMapProjectionHint(osgShadow::ShadowSettings::ORTHOGRAPHIC_SHADOW_MAP);
+            mShadowTechnique->enableStaticShadowCache(
+                mStaticShadowCastingMask, settings.mStaticShadowCacheMargin, settings.mStaticShadowCacheSunAngle);
+        }
+        else
+            mShadowTechnique->disableStaticShadowCache();
+
+        mShadowTechnique->setShadowMapUpdateInterval(settings.mMaximumShadowMapUpdateInterval);
+        mShadowTechnique->setShadowMapBudget(settings.mShadowMapBudget);
+
         if (settings.mEnableDebugHud)
             mShadowTechnique->enableDebugHUD();
         else
@@ -108,11 +121,13 @@ namespace SceneUtil
 
     ShadowManager::ShadowManager(osg::ref_ptr<osg::Group> sceneRoot, osg::ref_ptr<osg::Group> rootNode,
         unsigned int outdoorShadowCastingMask, unsigned int indoorShadowCastingMask, unsigned int worldMask,
-        const Settings::ShadowsCategory& settings, Shader::ShaderManager& shaderManager)
+        unsigned int staticShadowCastingMask, const Settings::ShadowsCategory& settings,
+        Shader::ShaderManager& shaderManager)
         : mShadowedScene(new osgShadow::ShadowedScene)
         , mShadowTechnique(new MWShadowTechnique)
         , mOutdoorShadowCastingMask(outdoorShadowCastingMask)
         , mIndoorShadowCastingMask(indoorShadowCastingMask)
+        , mStaticShadowCastingMask(staticShadowCastingMask)
     {
         if (sInstance)
             throw std::logic_error("A ShadowManager already exists");
@@ -208,4 +223,9 @@ namespace SceneUtil
             mShadowTechnique->enableShadows();
         mShadowSettings->setCastsShadowTraversalMask(mOutdoorShadowCastingMask);
     }
+
+    void ShadowManager::invalidateStaticShadowCasters()
+    {
+        mShadowTechnique->invalidateStaticShadowCache();
+    }
 }
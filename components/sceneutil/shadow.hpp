@@ -32,7 +32,8 @@ namespace SceneUtil
 
         explicit ShadowManager(osg::ref_ptr<osg::Group> sceneRoot, osg::ref_ptr<osg::Group> rootNode,
             unsigned int outdoorShadowCastingMask, unsigned int indoorShadowCastingMask, unsigned int worldMask,
-            const Settings::ShadowsCategory& settings, Shader::ShaderManager& shaderManager);
+            unsigned int staticShadowCastingMask, const Settings::ShadowsCategory& settings,
+            Shader::ShaderManager& shaderManager);
         ~ShadowManager();
 
         void setupShadowSettings(const Settings::ShadowsCategory& settings, Shader::ShaderManager& shaderManager);
@@ -45,6 +46,9 @@ namespace SceneUtil
 
         void enableOutdoorMode();
 
+        /// Static shadow casters have been added, moved or removed
+        void invalidateStaticShadowCasters();
+
     protected:
         static ShadowManager* sInstance;
 
@@ -56,6 +60,7 @@ namespace SceneUtil
 
         unsigned int mOutdoorShadowCastingMask;
         unsigned int mIndoorShadowCastingMask;
+        unsigned int mStaticShadowCastingMask;
     };
 }
 
@@ -43,7 +43,7 @@ namespace
 namespace SceneUtil
 {
 
-    ShadowsBin::ShadowsBin(const CastingPrograms& castingPrograms)
+    ShadowsBin::ShadowsBin(const CastingPrograms& castingPrograms, const CastingPrograms& skinningCastingPrograms)
     {
         mNoTestStateSet = new osg::StateSet;
         mNoTestStateSet->addUniform(new osg::Uniform("useDiffuseMapForShadowAlpha", false));
@@ -60,6 +60,10 @@ namespace SceneUtil
             mAlphaFuncShaders[i] = new osg::StateSet;
             mAlphaFuncShaders[i]->setAttribute(castingPrograms[i],
                 osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | osg::StateAttribute::OVERRIDE);
+
+            mSkinningAlphaFuncShaders[i] = new osg::StateSet;
+            mSkinningAlphaFuncShaders[i]->setAttribute(skinningCastingPrograms[i],
+                osg::StateAttribute::ON | osg::StateAttribute::PROTECTED | osg::StateAttribute::OVERRIDE);
         }
     }
 
@@ -106,6 +110,18 @@ namespace SceneUtil
                     state.mAlphaFuncOverride, rap.second);
             }
 
+            // Instanced drawing depends on the attribute divisors and uniforms of the original state
+            found = attributes.lower_bound(std::make_pair(osg::StateAttribute::VERTEXATTRIBDIVISOR, 0));
+            if (found != attributes.end() && found->first.first == osg::StateAttribute::VERTEXATTRIBDIVISOR)
+                state.mImportantState = true;
+
+            // So does skinning in the shaders, on the bone matrices
+            if (ss->getUniform("boneMatrices"))
+            {
+                state.mSkinning = true;
+                state.mImportantState = true;
+            }
+
             if (!cullFaceOverridden)
             {
                 // osg::FrontFace specifies triangle winding, not front-face culling. We can't safely reparent anything
@@ -141,10 +157,14 @@ namespace SceneUtil
             sg = sg_new;
         }
 
-        // GL_ALWAYS is set by default by mwshadowtechnique
-        if (state.mAlphaFunc && state.mAlphaFunc->getFunction() != GL_ALWAYS)
+        // GL_ALWAYS is set by default by mwshadowtechnique, but only without skinning
+        const bool hasAlphaFunc = state.mAlphaFunc && state.mAlphaFunc->getFunction() != GL_ALWAYS;
+        if (hasAlphaFunc || state.mSkinning)
         {
-            sg_new = sg->find_or_insert(mAlphaFuncShaders[state.mAlphaFunc->getFunction() - GL_NEVER]);
+            const GLenum alphaFunc = hasAlphaFunc ? state.mAlphaFunc->getFunction() : GL_ALWAYS;
+            const Array<osg::ref_ptr<osg::StateSet>>& shaders
+                = state.mSkinning ? mSkinningAlphaFuncShaders : mAlphaFuncShaders;
+            sg_new = sg->find_or_insert(shaders[alphaFunc - GL_NEVER]);
             sg_new->_leaves = std::move(sg->_leaves);
             for (RenderLeaf* leaf : sg_new->_leaves)
                 leaf->_parent = sg_new;
@@ -22,12 +22,13 @@ namespace SceneUtil
         using CastingPrograms = Array<osg::ref_ptr<osg::Program>>;
 
         META_Object(SceneUtil, ShadowsBin)
-        ShadowsBin(const CastingPrograms& castingPrograms);
+        ShadowsBin(const CastingPrograms& castingPrograms, const CastingPrograms& skinningCastingPrograms);
         ShadowsBin(const ShadowsBin& rhs, const osg::CopyOp& copyop)
             : osgUtil::RenderBin(rhs, copyop)
             , mNoTestStateSet(rhs.mNoTestStateSet)
             , mShaderAlphaTestStateSet(rhs.mShaderAlphaTestStateSet)
             , mAlphaFuncShaders(rhs.mAlphaFuncShaders)
+            , mSkinningAlphaFuncShaders(rhs.mSkinningAlphaFuncShaders)
         {
         }
 
@@ -43,6 +44,7 @@ namespace SceneUtil
                 , mMaterial(nullptr)
                 , mMaterialOverride(false)
                 , mImportantState(false)
+                , mSkinning(false)
             {
             }
 
@@ -53,6 +55,7 @@ namespace SceneUtil
             osg::Material* mMaterial;
             bool mMaterialOverride;
             bool mImportantState;
+            bool mSkinning;
             bool needTexture() const;
             bool needShadows() const;
             // A state is interesting if there's anything about it that might affect whether we can optimise child state
@@ -73,6 +76,7 @@ namespace SceneUtil
         osg::ref_ptr<osg::StateSet> mShaderAlphaTestStateSet;
 
         Array<osg::ref_ptr<osg::StateSet>> mAlphaFuncShaders;
+        Array<osg::ref_ptr<osg::StateSet>> mSkinningAlphaFuncShaders;
     };
 }
 
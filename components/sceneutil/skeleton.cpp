@@ -2,13 +2,26 @@
 
 #include <osg/MatrixTransform>
 
+#include <osgUtil/CullVisitor>
+
 #include <components/debug/debuglog.hpp>
+#include <components/misc/constants.hpp>
 #include <components/misc/strings/lower.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
 
 namespace SceneUtil
 {
+    namespace
+    {
+        unsigned int nextLodPhase()
+        {
+            static std::atomic<unsigned int> phase{ 0 };
+            return phase++;
+        }
+    }
 
     class InitBoneCacheVisitor : public osg::NodeVisitor
     {
@@ -39,6 +52,7 @@ namespace SceneUtil
         , mActive(Active)
         , mLastFrameNumber(0)
         , mLastCullFrameNumber(0)
+        , mLodPhase(nextLodPhase())
     {
     }
 
@@ -49,6 +63,10 @@ namespace SceneUtil
         , mActive(copy.mActive)
         , mLastFrameNumber(0)
         , mLastCullFrameNumber(0)
+        , mLodPixelSize(copy.mLodPixelSize)
+        , mLodMaxInterval(copy.mLodMaxInterval)
+        , mLodPhase(nextLodPhase())
+        , mMorphDistance(copy.mMorphDistance)
     {
     }
 
@@ -121,6 +139,62 @@ namespace SceneUtil
         return mActive != Inactive;
     }
 
+    void Skeleton::setAnimationLod(float pixelSize, unsigned int maxInterval)
+    {
+        mLodPixelSize = pixelSize;
+        mLodMaxInterval = std::bit_floor(std::max(maxInterval, 1u));
+    }
+
+    unsigned int Skeleton::getAnimationLodInterval(float pixelSize, float lodPixelSize, unsigned int maxInterval)
+    {
+        unsigned int interval = 1;
+        while (interval * 2 <= maxInterval && pixelSize < lodPixelSize)
+        {
+            interval *= 2;
+            lodPixelSize /= 2;
+        }
+        return interval;
+    }
+
+    bool Skeleton::skipsMorphs() const
+    {
+        return mMorphDistance > 0 && mLastLodFrameNumber != 0 && mViewDistance > mMorphDistance;
+    }
+
+    Skeleton* Skeleton::find(const osg::NodePath& path)
+    {
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+            if (Skeleton* skeleton = dynamic_cast<Skeleton*>(*it))
+                return skeleton;
+        return nullptr;
+    }
+
+    void Skeleton::updateLod(osg::NodeVisitor& nv)
+    {
+        osgUtil::CullVisitor& cv = static_cast<osgUtil::CullVisitor&>(nv);
+        if (cv.getCurrentCamera()->getName() != Constants::SceneCamera)
+            return;
+
+        if (mLastLodFrameNumber != nv.getTraversalNumber())
+        {
+            mLastLodFrameNumber = nv.getTraversalNumber();
+            mPixelSize = 0;
+            mViewDistance = std::numeric_limits<float>::max();
+        }
+        mPixelSize = std::max(mPixelSize, cv.clampedPixelSize(getBound()));
+        mViewDistance = std::min(mViewDistance, cv.getDistanceToViewPoint(getBound().center(), true));
+    }
+
+    bool Skeleton::isAnimationDue(unsigned int traversalNumber) const
+    {
+        // Only the skeletons the scene camera saw in the previous frame have a known size
+        if (mLodPixelSize <= 0 || mLastLodFrameNumber + 1 != traversalNumber)
+            return true;
+
+        const unsigned int interval = getAnimationLodInterval(mPixelSize, mLodPixelSize, mLodMaxInterval);
+        return (traversalNumber + mLodPhase) % interval == 0;
+    }
+
     void Skeleton::markDirty()
     {
         mLastFrameNumber = 0;
@@ -136,9 +210,16 @@ namespace SceneUtil
                 return;
             if (mActive == SemiActive && mLastFrameNumber != 0 && mLastCullFrameNumber + 3 <= nv.getTraversalNumber())
                 return;
+            if (mLastFrameNumber != 0 && !isAnimationDue(nv.getTraversalNumber()))
+                return;
+            mLastAnimatedFrameNumber = nv.getTraversalNumber();
         }
         else if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
+        {
             mLastCullFrameNumber = nv.getTraversalNumber();
+            if (mLodPixelSize > 0 || mMorphDistance > 0)
+                updateLod(nv);
+        }
 
         osg::Group::traverse(nv);
     }
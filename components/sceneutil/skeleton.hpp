@@ -3,6 +3,8 @@
 
 #include <osg/Group>
 
+#include <limits>
+
 #include <memory>
 #include <unordered_map>
 
@@ -56,6 +58,28 @@ namespace SceneUtil
 
         bool getActive() const;
 
+        /// Animate the skeleton less often when it's small on screen: every 2 frames when its bounding sphere covers
+        /// less than pixelSize pixels, every 4 frames below half of that and so on, up to every maxInterval frames.
+        /// maxInterval is rounded down to a power of two.
+        /// @note Disabled when pixelSize is 0.
+        void setAnimationLod(float pixelSize, unsigned int maxInterval);
+
+        /// @return the number of frames between two animation updates of a skeleton covering pixelSize pixels, see
+        /// setAnimationLod
+        static unsigned int getAnimationLodInterval(float pixelSize, float lodPixelSize, unsigned int maxInterval);
+
+        /// Stop the morph animations below the skeleton beyond the given distance from the camera, 0 to never stop.
+        void setMorphDistance(float distance) { mMorphDistance = distance; }
+
+        /// @return true if the morph animations below the skeleton should be left as they are
+        bool skipsMorphs() const;
+
+        /// @return the last frame in which the update traversal animated the skeleton
+        unsigned int getLastAnimatedFrameNumber() const { return mLastAnimatedFrameNumber; }
+
+        /// @return the nearest skeleton in the path, nullptr if there is none
+        static Skeleton* find(const osg::NodePath& path);
+
         void traverse(osg::NodeVisitor& nv) override;
 
         void markDirty();
@@ -64,6 +88,9 @@ namespace SceneUtil
         void childRemoved(unsigned int, unsigned int) override;
 
     private:
+        void updateLod(osg::NodeVisitor& nv);
+        bool isAnimationDue(unsigned int traversalNumber) const;
+
         // The root bone is not a "real" bone, it has no corresponding node in the scene graph.
         // As far as the scene graph goes we support multiple root bones.
         std::unique_ptr<Bone> mRootBone;
@@ -78,6 +105,18 @@ namespace SceneUtil
 
         unsigned int mLastFrameNumber;
         unsigned int mLastCullFrameNumber;
+        unsigned int mLastAnimatedFrameNumber = 0;
+
+        float mLodPixelSize = 0;
+        unsigned int mLodMaxInterval = 1;
+        // Spreads the updates of the skeletons animated at the same rate over the frames
+        unsigned int mLodPhase;
+        float mMorphDistance = 0;
+
+        // Size and distance of the skeleton seen by the scene camera in the last frame it was culled by it
+        unsigned int mLastLodFrameNumber = 0;
+        float mPixelSize = 0;
+        float mViewDistance = std::numeric_limits<float>::max();
     };
 
 }
@@ -0,0 +1,269 @@
+#include "skinning.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include <osgUtil/CullVisitor>
+
+#include "workqueue.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OPENMW_SKINNING_SSE
+#endif
+
+namespace SceneUtil
+{
+    namespace
+    {
+        // The few operations the skinning needs, on SSE or plain floats when it isn't available
+#ifdef OPENMW_SKINNING_SSE
+        struct Float4
+        {
+            __m128 mValue;
+
+            static Float4 load(const float* values) { return { _mm_loadu_ps(values) }; }
+
+            static Float4 splat(float value) { return { _mm_set1_ps(value) }; }
+
+            static Float4 zero() { return { _mm_setzero_ps() }; }
+
+            void store(float* values) const { _mm_storeu_ps(values, mValue); }
+
+            Float4 operator+(Float4 other) const { return { _mm_add_ps(mValue, other.mValue) }; }
+
+            Float4 operator*(Float4 other) const { return { _mm_mul_ps(mValue, other.mValue) }; }
+        };
+#else
+        struct Float4
+        {
+            float mValue[4];
+
+            static Float4 load(const float* values) { return { { values[0], values[1], values[2], values[3] } }; }
+
+            static Float4 splat(float value) { return { { value, value, value, value } }; }
+
+            static Float4 zero() { return splat(0); }
+
+            void store(float* values) const { std::memcpy(values, mValue, sizeof(mValue)); }
+
+            Float4 operator+(Float4 other) const
+            {
+                return { { mValue[0] + other.mValue[0], mValue[1] + other.mValue[1], mValue[2] + other.mValue[2],
+                    mValue[3] + other.mValue[3] } };
+            }
+
+            Float4 operator*(Float4 other) const
+            {
+                return { { mValue[0] * other.mValue[0], mValue[1] * other.mValue[1], mValue[2] * other.mValue[2],
+                    mValue[3] * other.mValue[3] } };
+            }
+        };
+#endif
+
+        // Rows of a matrix multiplying row vectors, as osg::Matrixf does. The last column is ignored.
+        struct Rows
+        {
+            Float4 mRows[4];
+
+            Float4 transform(const osg::Vec3f& v) const
+            {
+                return mRows[0] * Float4::splat(v.x()) + mRows[1] * Float4::splat(v.y())
+                    + mRows[2] * Float4::splat(v.z()) + mRows[3];
+            }
+
+            Float4 transform3x3(const osg::Vec3f& v) const
+            {
+                return mRows[0] * Float4::splat(v.x()) + mRows[1] * Float4::splat(v.y())
+                    + mRows[2] * Float4::splat(v.z());
+            }
+        };
+
+        osg::Vec3f toVec3(Float4 value)
+        {
+            float values[4];
+            value.store(values);
+            return osg::Vec3f(values[0], values[1], values[2]);
+        }
+    }
+
+    void SkinningPalette::set(std::size_t index, const osg::Matrixf& matrix)
+    {
+        std::memcpy(mMatrices[index].mValues, matrix.ptr(), sizeof(mMatrices[index].mValues));
+    }
+
+    void SkinningPalette::setMissing(std::size_t index)
+    {
+        std::fill(std::begin(mMatrices[index].mValues), std::end(mMatrices[index].mValues), 0.f);
+    }
+
+    void skinVertices(const SkinningPalette& palette, const std::vector<std::pair<std::size_t, float>>& weights,
+        const osg::Matrixf* geomToSkel, const std::vector<unsigned short>& vertices, const SkinningArrays& arrays)
+    {
+        Rows matrix{ { Float4::zero(), Float4::zero(), Float4::zero(), Float4::zero() } };
+        for (const auto& [index, weight] : weights)
+        {
+            const float* bone = palette.get(index);
+            const Float4 w = Float4::splat(weight);
+            for (int row = 0; row < 4; ++row)
+                matrix.mRows[row] = matrix.mRows[row] + Float4::load(bone + row * 4) * w;
+        }
+
+        if (geomToSkel)
+        {
+            // The blended matrix is affine: its last column is (0, 0, 0, 1) whatever the sum of the weights is
+            const Rows transform{ { Float4::load(geomToSkel->ptr()), Float4::load(geomToSkel->ptr() + 4),
+                Float4::load(geomToSkel->ptr() + 8), Float4::load(geomToSkel->ptr() + 12) } };
+            for (int row = 0; row < 4; ++row)
+            {
+                const osg::Vec3f blended = toVec3(matrix.mRows[row]);
+                matrix.mRows[row] = row == 3 ? transform.transform(blended) : transform.transform3x3(blended);
+            }
+        }
+
+        for (unsigned short vertex : vertices)
+        {
+            arrays.mPositionDst[vertex] = toVec3(matrix.transform(arrays.mPositionSrc[vertex]));
+
+            if (arrays.mNormalDst)
+                arrays.mNormalDst[vertex] = toVec3(matrix.transform3x3(arrays.mNormalSrc[vertex]));
+
+            if (arrays.mTangentDst)
+            {
+                const osg::Vec4f& tangent = arrays.mTangentSrc[vertex];
+                arrays.mTangentDst[vertex] = osg::Vec4f(
+                    toVec3(matrix.transform3x3(osg::Vec3f(tangent.x(), tangent.y(), tangent.z()))), tangent.w());
+            }
+        }
+    }
+
+    PackedInfluences packInfluences(const std::vector<std::pair<std::size_t, float>>& weights, std::size_t numBones)
+    {
+        std::vector<std::pair<std::size_t, float>> valid;
+        valid.reserve(weights.size());
+        float totalWeight = 0;
+        for (const auto& [index, weight] : weights)
+        {
+            if (index >= numBones)
+                continue;
+            valid.emplace_back(index, weight);
+            totalWeight += weight;
+        }
+
+        float scale = 1;
+        if (valid.size() > 4)
+        {
+            std::stable_sort(
+                valid.begin(), valid.end(), [](const auto& l, const auto& r) { return l.second > r.second; });
+            valid.resize(4);
+            float keptWeight = 0;
+            for (const auto& [index, weight] : valid)
+                keptWeight += weight;
+            if (keptWeight > 0)
+                scale = totalWeight / keptWeight;
+        }
+
+        PackedInfluences result;
+        for (std::size_t i = 0; i < valid.size(); ++i)
+        {
+            result.mIndices[i] = static_cast<float>(valid[i].first);
+            result.mWeights[i] = valid[i].second * scale;
+        }
+        return result;
+    }
+
+    namespace
+    {
+        enum JobState
+        {
+            Job_Pending,
+            Job_Running,
+            Job_Done,
+        };
+
+        thread_local ParallelSkinning* sCurrentParallelSkinning = nullptr;
+
+        class SkinningWorkItem : public WorkItem
+        {
+        public:
+            explicit SkinningWorkItem(ParallelSkinning& parallelSkinning)
+                : mParallelSkinning(parallelSkinning)
+            {
+            }
+
+            void doWork() override { mParallelSkinning.runRemainingJobs(); }
+
+        private:
+            ParallelSkinning& mParallelSkinning;
+        };
+    }
+
+    bool SkinningJob::tryRun()
+    {
+        int expected = Job_Pending;
+        if (!mState.compare_exchange_strong(expected, Job_Running, std::memory_order_acquire))
+            return false;
+        mFunction();
+        mFunction = nullptr;
+        mState.store(Job_Done, std::memory_order_release);
+        return true;
+    }
+
+    void SkinningJob::finish()
+    {
+        if (tryRun())
+            return;
+        while (mState.load(std::memory_order_acquire) != Job_Done)
+            std::this_thread::yield();
+    }
+
+    ParallelSkinning::ParallelSkinning(std::size_t workerThreads)
+        : mWorkQueue(new WorkQueue(workerThreads))
+        , mWorkerThreads(workerThreads)
+    {
+    }
+
+    ParallelSkinning::~ParallelSkinning() = default;
+
+    void ParallelSkinning::operator()(osg::Node* node, osgUtil::CullVisitor* cv)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        ParallelSkinning* const previous = sCurrentParallelSkinning;
+        sCurrentParallelSkinning = this;
+        traverse(node, cv);
+        sCurrentParallelSkinning = previous;
+
+        // Nothing is drawn before the cull traversal returns, so the vertices are ready in time
+        if (mJobs.empty())
+            return;
+
+        mNextJob = 0;
+        const std::size_t numWorkItems = std::min(mWorkerThreads, mJobs.size() - 1);
+        for (std::size_t i = 0; i < numWorkItems; ++i)
+        {
+            osg::ref_ptr<WorkItem> item = new SkinningWorkItem(*this);
+            mWorkQueue->addWorkItem(item, true);
+            mWorkItems.push_back(std::move(item));
+        }
+
+        runRemainingJobs();
+
+        for (const osg::ref_ptr<WorkItem>& item : mWorkItems)
+            item->waitTillDone();
+        mWorkItems.clear();
+        mJobs.clear();
+    }
+
+    ParallelSkinning* ParallelSkinning::getCurrent()
+    {
+        return sCurrentParallelSkinning;
+    }
+
+    void ParallelSkinning::runRemainingJobs()
+    {
+        for (std::size_t i = mNextJob++; i < mJobs.size(); i = mNextJob++)
+            mJobs[i]->tryRun();
+    }
+}
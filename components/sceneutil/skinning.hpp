@@ -0,0 +1,129 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <osg/Matrixf>
+#include <osg/Referenced>
+#include <osg/Vec3f>
+#include <osg/Vec4f>
+#include <osg/ref_ptr>
+
+#include <components/sceneutil/nodecallback.hpp>
+
+namespace osgUtil
+{
+    class CullVisitor;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+    class WorkItem;
+
+    /// Skinning matrices of the bones of a mesh, every matrix stored as 4 aligned rows for the SIMD kernel.
+    class SkinningPalette
+    {
+    public:
+        void resize(std::size_t size) { mMatrices.resize(size); }
+
+        std::size_t size() const { return mMatrices.size(); }
+
+        void set(std::size_t index, const osg::Matrixf& matrix);
+
+        /// The vertices influenced by a missing bone ignore its weight
+        void setMissing(std::size_t index);
+
+        const float* get(std::size_t index) const { return mMatrices[index].mValues; }
+
+    private:
+        struct alignas(16) Matrix
+        {
+            float mValues[16];
+        };
+
+        std::vector<Matrix> mMatrices;
+    };
+
+    struct SkinningArrays
+    {
+        const osg::Vec3f* mPositionSrc = nullptr;
+        osg::Vec3f* mPositionDst = nullptr;
+        /// Optional
+        const osg::Vec3f* mNormalSrc = nullptr;
+        osg::Vec3f* mNormalDst = nullptr;
+        /// Optional, w is copied as is
+        const osg::Vec4f* mTangentSrc = nullptr;
+        osg::Vec4f* mTangentDst = nullptr;
+    };
+
+    /// Transforms the vertices by the weighted sum of the matrices of the bones, then by geomToSkel if there is one.
+    void skinVertices(const SkinningPalette& palette, const std::vector<std::pair<std::size_t, float>>& weights,
+        const osg::Matrixf* geomToSkel, const std::vector<unsigned short>& vertices, const SkinningArrays& arrays);
+
+    /// Bones influencing a vertex as passed to the skinning in the shaders, the unused ones have no weight.
+    struct PackedInfluences
+    {
+        osg::Vec4f mIndices;
+        osg::Vec4f mWeights;
+    };
+
+    /// Keeps the 4 heaviest influences, scaled to have the same total weight as all of them. The bones past
+    /// numBones are ignored.
+    PackedInfluences packInfluences(const std::vector<std::pair<std::size_t, float>>& weights, std::size_t numBones);
+
+    /// Skinning of a RigGeometry deferred by ParallelSkinning.
+    class SkinningJob : public osg::Referenced
+    {
+    public:
+        explicit SkinningJob(std::function<void()>&& function)
+            : mFunction(std::move(function))
+        {
+        }
+
+        /// @return false if another thread has started the job already
+        bool tryRun();
+
+        /// Runs the job unless another thread has started it already, in which case waits for it to be done.
+        void finish();
+
+    private:
+        std::function<void()> mFunction;
+        std::atomic<int> mState{ 0 };
+    };
+
+    /// Defers the skinning of the RigGeometries culled below the node to the end of its cull traversal, then skins
+    /// all of them at once on the cull thread and the worker threads.
+    class ParallelSkinning : public SceneUtil::NodeCallback<ParallelSkinning, osg::Node*, osgUtil::CullVisitor*>
+    {
+    public:
+        explicit ParallelSkinning(std::size_t workerThreads);
+
+        ~ParallelSkinning();
+
+        void operator()(osg::Node* node, osgUtil::CullVisitor* cv);
+
+        /// @return the ParallelSkinning whose node the calling thread is culling, nullptr if there is none
+        static ParallelSkinning* getCurrent();
+
+        void addJob(osg::ref_ptr<SkinningJob> job) { mJobs.push_back(std::move(job)); }
+
+        /// Used by the worker threads.
+        void runRemainingJobs();
+
+    private:
+        osg::ref_ptr<WorkQueue> mWorkQueue;
+        std::size_t mWorkerThreads;
+        std::mutex mMutex;
+        std::vector<osg::ref_ptr<SkinningJob>> mJobs;
+        std::atomic<std::size_t> mNextJob{ 0 };
+        std::vector<osg::ref_ptr<WorkItem>> mWorkItems;
+    };
+}
+
+#endif
@@ -27,12 +27,21 @@ namespace Settings
         SettingValue<bool> mPreloadInstances{ mIndex, "Cells", "preload instances" };
         SettingValue<int> mPreloadCellCacheMin{ mIndex, "Cells", "preload cell cache min", makeMaxSanitizerInt(1) };
         SettingValue<int> mPreloadCellCacheMax{ mIndex, "Cells", "preload cell cache max", makeMaxSanitizerInt(1) };
+        SettingValue<int> mPreloadCellCacheMaxMemory{ mIndex, "Cells", "preload cell cache max memory",
+            makeMaxSanitizerInt(0) };
         SettingValue<float> mPreloadCellExpiryDelay{ mIndex, "Cells", "preload cell expiry delay",
             makeMaxSanitizerFloat(0) };
         SettingValue<float> mPredictionTime{ mIndex, "Cells", "prediction time", makeMaxSanitizerFloat(0) };
         SettingValue<float> mCacheExpiryDelay{ mIndex, "Cells", "cache expiry delay", makeMaxSanitizerFloat(0) };
+        SettingValue<int> mCacheMaxMemory{ mIndex, "Cells", "cache max memory", makeMaxSanitizerInt(0) };
         SettingValue<float> mTargetFramerate{ mIndex, "Cells", "target framerate", makeMaxStrictSanitizerFloat(0) };
+        SettingValue<float> mCompileTimeBudget{ mIndex, "Cells", "compile time budget", makeMaxSanitizerFloat(0) };
+        SettingValue<int> mCompileMaxObjects{ mIndex, "Cells", "compile max objects", makeMaxSanitizerInt(1) };
         SettingValue<int> mPointersCacheSize{ mIndex, "Cells", "pointers cache size", makeClampSanitizerInt(40, 1000) };
+        SettingValue<float> mActivationTimeBudget{ mIndex, "Cells", "activation time budget",
+            makeMaxSanitizerFloat(0) };
+        SettingValue<float> mImmediateActivationDistance{ mIndex, "Cells", "immediate activation distance",
+            makeMaxSanitizerFloat(0) };
     };
 }
 
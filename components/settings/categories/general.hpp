@@ -32,6 +32,14 @@ namespace Settings
         SettingValue<bool> mGmstOverridesL10n{ mIndex, "General", "gmst overrides l10n" };
         SettingValue<std::size_t> mLogBufferSize{ mIndex, "General", "log buffer size" };
         SettingValue<std::size_t> mConsoleHistoryBufferSize{ mIndex, "General", "console history buffer size" };
+        SettingValue<bool> mCacheCompiledScripts{ mIndex, "General", "cache compiled scripts" };
+        SettingValue<int> mSkinningThreads{ mIndex, "General", "skinning threads", makeMaxSanitizerInt(0) };
+        SettingValue<float> mAnimationLodPixelSize{ mIndex, "General", "animation lod pixel size",
+            makeMaxSanitizerFloat(0) };
+        SettingValue<int> mAnimationLodMaxInterval{ mIndex, "General", "animation lod max interval",
+            makeClampSanitizerInt(1, 16) };
+        SettingValue<float> mMorphAnimationDistance{ mIndex, "General", "morph animation distance",
+            makeMaxSanitizerFloat(0) };
     };
 }
 
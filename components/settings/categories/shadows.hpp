@@ -42,6 +42,14 @@ namespace Settings
         SettingValue<bool> mTerrainShadows{ mIndex, "Shadows", "terrain shadows" };
         SettingValue<bool> mObjectShadows{ mIndex, "Shadows", "object shadows" };
         SettingValue<bool> mEnableIndoorShadows{ mIndex, "Shadows", "enable indoor shadows" };
+        SettingValue<bool> mCacheStaticShadowCasters{ mIndex, "Shadows", "cache static shadow casters" };
+        SettingValue<float> mStaticShadowCacheMargin{ mIndex, "Shadows", "static shadow cache margin",
+            makeClampSanitizerFloat(0, 1) };
+        SettingValue<float> mStaticShadowCacheSunAngle{ mIndex, "Shadows", "static shadow cache sun angle",
+            makeClampSanitizerFloat(0, 90) };
+        SettingValue<int> mMaximumShadowMapUpdateInterval{ mIndex, "Shadows", "maximum shadow map update interval",
+            makeClampSanitizerInt(1, 16) };
+        SettingValue<float> mShadowMapBudget{ mIndex, "Shadows", "shadow map budget", makeMaxSanitizerFloat(0) };
     };
 }
 
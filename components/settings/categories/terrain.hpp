@@ -27,6 +27,7 @@ namespace Settings
         SettingValue<float> mMaxCompositeGeometrySize{ mIndex, "Terrain", "max composite geometry size",
             makeMaxSanitizerFloat(1) };
         SettingValue<bool> mDebugChunks{ mIndex, "Terrain", "debug chunks" };
+        SettingValue<int> mViewUpdateThreads{ mIndex, "Terrain", "view update threads", makeMaxSanitizerInt(0) };
         SettingValue<bool> mObjectPaging{ mIndex, "Terrain", "object paging" };
         SettingValue<bool> mObjectPagingActiveGrid{ mIndex, "Terrain", "object paging active grid" };
         SettingValue<float> mObjectPagingMergeFactor{ mIndex, "Terrain", "object paging merge factor",
@@ -37,6 +38,7 @@ namespace Settings
             makeMaxStrictSanitizerFloat(0) };
         SettingValue<float> mObjectPagingMinSizeCostMultiplier{ mIndex, "Terrain",
             "object paging min size cost multiplier", makeMaxStrictSanitizerFloat(0) };
+        SettingValue<bool> mObjectPagingInstancing{ mIndex, "Terrain", "object paging instancing" };
     };
 }
 
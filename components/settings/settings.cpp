@@ -99,6 +99,8 @@ namespace Settings
                     return "shaders compatibility";
                 case SceneUtil::LightingMethod::SingleUBO:
                     return "shaders";
+                case SceneUtil::LightingMethod::Clustered:
+                    return "shaders clustered";
             }
 
             throw std::invalid_argument("Invalid LightingMethod value: " + std::to_string(static_cast<int>(value)));
@@ -554,6 +556,8 @@ namespace Settings
             return SceneUtil::LightingMethod::PerObjectUniform;
         if (value == "shaders")
             return SceneUtil::LightingMethod::SingleUBO;
+        if (value == "shaders clustered")
+            return SceneUtil::LightingMethod::Clustered;
 
         constexpr const char* fallback = "shaders compatibility";
         Log(Debug::Warning) << "Unknown lighting method '" << value << "', returning fallback '" << fallback << "'";
@@ -189,6 +189,8 @@ namespace Shader
         , mReconstructNormalZ(false)
         , mTexStageRequiringTangents(-1)
         , mSoftParticles(false)
+        , mInstancing(false)
+        , mSkinning(false)
         , mNode(nullptr)
     {
     }
@@ -308,6 +310,10 @@ namespace Shader
         if (node.getUserValue(Misc::OsgUserValues::sXSoftEffect, softEffect) && softEffect)
             mRequirements.back().mSoftParticles = true;
 
+        bool instancing = false;
+        if (node.getUserValue("instancing", instancing) && instancing)
+            mRequirements.back().mInstancing = true;
+
         // Make sure to disregard any state that came from a previous call to createProgram
         osg::ref_ptr<AddedState> addedState = getAddedState(*stateset);
 
@@ -754,13 +760,18 @@ namespace Shader
 
         defineMap["softParticles"] = reqs.mSoftParticles ? "1" : "0";
 
+        defineMap["instancing"] = reqs.mInstancing ? "1" : "0";
+
+        defineMap["skinning"] = reqs.mSkinning ? "1" : "0";
+
         Stereo::shaderStereoDefines(defineMap);
 
         std::string shaderPrefix;
         if (!node.getUserValue("shaderPrefix", shaderPrefix))
             shaderPrefix = mDefaultShaderPrefix;
 
-        auto program = mShaderManager.getProgram(shaderPrefix, defineMap, mProgramTemplate);
+        auto program = mShaderManager.getProgram(
+            shaderPrefix, defineMap, reqs.mSkinning ? mSkinningProgramTemplate : mProgramTemplate);
         writableStateSet->setAttributeAndModes(program, osg::StateAttribute::ON);
         addedState->setAttributeAndModes(std::move(program));
 
@@ -941,6 +952,11 @@ namespace Shader
         if (!needPop && dynamic_cast<osgParticle::ParticleSystem*>(&drawable))
             needPop = true;
 
+        // Rigged meshes skinned by the shaders need their own shader variant too.
+        auto rig = dynamic_cast<SceneUtil::RigGeometry*>(&drawable);
+        if (!needPop && rig && mSkinningProgramTemplate)
+            needPop = true;
+
         if (needPop)
         {
             pushRequirements(drawable);
@@ -949,10 +965,22 @@ namespace Shader
                 applyStateSet(drawable.getStateSet(), drawable);
         }
 
+        if (rig && mSkinningProgramTemplate)
+        {
+            // Only the objects shaders know how to skin
+            std::string shaderPrefix;
+            if (!drawable.getUserValue("shaderPrefix", shaderPrefix))
+                shaderPrefix = mDefaultShaderPrefix;
+            ShaderRequirements& rigReqs = mRequirements.back();
+            rigReqs.mSkinning = (rigReqs.mShaderRequired || mForceShaders) && !rigReqs.mInstancing
+                && shaderPrefix == "objects" && rig->supportsGpuSkinning();
+            rig->setGpuSkinning(rigReqs.mSkinning);
+        }
+
         const ShaderRequirements& reqs = mRequirements.back();
         createProgram(reqs);
 
-        if (auto rig = dynamic_cast<SceneUtil::RigGeometry*>(&drawable))
+        if (rig)
         {
             osg::ref_ptr<osg::Geometry> sourceGeometry = rig->getSourceGeometry();
             if (sourceGeometry && adjustGeometry(*sourceGeometry, reqs))
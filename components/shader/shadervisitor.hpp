@@ -53,6 +53,13 @@ namespace Shader
 
         void setWeatherParticleOcclusion(bool value) { mWeatherParticleOcclusion = value; }
 
+        /// Skin the rigged meshes rendered by the objects shaders in the shaders, which are created from the given
+        /// template. The CPU skinning is used when it's null (default).
+        void setSkinningProgramTemplate(const osg::Program* programTemplate)
+        {
+            mSkinningProgramTemplate = programTemplate;
+        }
+
         void apply(osg::Node& node) override;
 
         void apply(osg::Drawable& drawable) override;
@@ -117,6 +124,12 @@ namespace Shader
 
             bool mSoftParticles;
 
+            // vertices are transformed by per instance attributes
+            bool mInstancing;
+
+            // vertices are transformed by the bones influencing them
+            bool mSkinning;
+
             // the Node that requested these requirements
             osg::Node* mNode;
         };
@@ -129,6 +142,7 @@ namespace Shader
         bool adjustGeometry(osg::Geometry& sourceGeometry, const ShaderRequirements& reqs);
 
         osg::ref_ptr<const osg::Program> mProgramTemplate;
+        osg::ref_ptr<const osg::Program> mSkinningProgramTemplate;
     };
 
     class ReinstateRemovedStateVisitor : public osg::NodeVisitor
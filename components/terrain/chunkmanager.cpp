@@ -31,6 +31,7 @@ namespace Terrain
         , mCompositeMapSize(512)
         , mCompositeMapLevel(1.f)
         , mMaxCompGeometrySize(1.f)
+        , mCreateOccluders(false)
     {
         mMultiPassRoot = new osg::StateSet;
         mMultiPassRoot->setRenderingHint(osg::StateSet::OPAQUE_BIN);
@@ -290,6 +291,9 @@ namespace Terrain
 
         geometry->setupWaterBoundingBox(-1, chunkSize * mStorage->getCellWorldSize(mWorldspace) / numVerts);
 
+        if (mCreateOccluders)
+            geometry->setupOccluder(numVerts);
+
         if (!templateGeometry && compile && mSceneManager->getIncrementalCompileOperation())
         {
             mSceneManager->getIncrementalCompileOperation()->add(geometry);
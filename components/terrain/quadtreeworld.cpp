@@ -13,6 +13,7 @@
 #include <components/misc/mathutil.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "chunkmanager.hpp"
 #include "compositemaprenderer.hpp"
@@ -24,6 +25,9 @@
 
 namespace
 {
+    // How far from its view point, in reuse distances, a view can still be used while it's being updated
+    constexpr float maxOutdatedViewDistanceFactor = 4;
+
     unsigned int Log2(unsigned int n)
     {
         unsigned int targetlevel = 0;
@@ -278,6 +282,32 @@ namespace Terrain
         unsigned int mNodeMask;
     };
 
+    class ViewUpdateItem : public SceneUtil::WorkItem
+    {
+    public:
+        ViewUpdateItem(QuadTreeWorld& world, const ViewData& view, const osg::Vec3f& viewPoint,
+            const osg::Vec4i& activeGrid, const DefaultLodCallback& lodCallback)
+            : mWorld(world)
+            , mViewPoint(viewPoint)
+            , mActiveGrid(activeGrid)
+            , mLodCallback(lodCallback)
+        {
+            // Start from the current entries to reuse the rendering nodes of unchanged ones
+            mView.copyFrom(view);
+        }
+
+        void doWork() override { mWorld.updateView(mView, mViewPoint, mActiveGrid, mLodCallback, true); }
+
+        ViewData& getView() { return mView; }
+
+    private:
+        QuadTreeWorld& mWorld;
+        ViewData mView;
+        osg::Vec3f mViewPoint;
+        osg::Vec4i mActiveGrid;
+        DefaultLodCallback mLodCallback;
+    };
+
     QuadTreeWorld::QuadTreeWorld(osg::Group* parent, osg::Group* compileRoot, Resource::ResourceSystem* resourceSystem,
         Storage* storage, unsigned int nodeMask, unsigned int preCompileMask, unsigned int borderMask,
         int compMapResolution, float compMapLevel, float lodFactor, int vertexLodMod, float maxCompGeometrySize,
@@ -305,7 +335,12 @@ namespace Terrain
         }
     }
 
-    QuadTreeWorld::~QuadTreeWorld() {}
+    QuadTreeWorld::~QuadTreeWorld()
+    {
+        // Pending view updates use the quad tree and the chunk managers
+        if (mViewUpdateQueue != nullptr)
+            mViewUpdateQueue->stop();
+    }
 
     /// get the level of vertex detail to render this node at, expressed relative to the native resolution of the vertex
     /// data set, NOT relative to mMinSize as is the case with node LODs.
@@ -470,15 +505,27 @@ namespace Terrain
             return;
 
         osg::Object* viewer = isCullVisitor ? static_cast<osgUtil::CullVisitor*>(&nv)->getCurrentCamera() : nullptr;
-        bool needsUpdate = true;
+        ViewUpdate update = ViewUpdate::Required;
         osg::Vec3f viewPoint = viewer ? nv.getViewPoint() : nv.getEyePoint();
-        ViewData* vd = mViewDataMap->getViewData(viewer, viewPoint, mActiveGrid, needsUpdate);
-        if (needsUpdate)
+        ViewData* vd = mViewDataMap->getViewData(viewer, viewPoint, mActiveGrid, update);
+        const DefaultLodCallback lodCallback(
+            mLodFactor, mMinSize, mViewDistance, mActiveGrid, ESM::getCellSize(mWorldspace));
+        if (update == ViewUpdate::Outdated)
+        {
+            if (viewer != nullptr && updateViewAsync(*vd, viewPoint, lodCallback))
+                update = ViewUpdate::None;
+            else
+            {
+                vd->setPendingUpdate(nullptr);
+                mViewDataMap->resetView(*vd, viewPoint, mActiveGrid);
+                update = ViewUpdate::Required;
+            }
+        }
+        if (update == ViewUpdate::Required)
         {
             vd->reset();
-            DefaultLodCallback lodCallback(
-                mLodFactor, mMinSize, mViewDistance, mActiveGrid, ESM::getCellSize(mWorldspace));
-            mRootNode->traverseNodes(vd, viewPoint, &lodCallback);
+            DefaultLodCallback traversalLodCallback = lodCallback;
+            mRootNode->traverseNodes(vd, viewPoint, &traversalLodCallback);
         }
 
         const float cellWorldSize = ESM::getCellSize(mWorldspace);
@@ -504,6 +551,68 @@ namespace Terrain
         }
     }
 
+    bool QuadTreeWorld::updateViewAsync(
+        ViewData& vd, const osg::Vec3f& viewPoint, const DefaultLodCallback& lodCallback)
+    {
+        if (mViewUpdateQueue == nullptr)
+            return false;
+
+        const float reuseDistance = mViewDataMap->getReuseDistance();
+        // Don't keep using the view for too long if the update is slow, there would be visible LOD changes. A view
+        // further than that, for example after a teleport, is rebuilt right away instead.
+        const float maxDistance = reuseDistance * maxOutdatedViewDistanceFactor;
+
+        if (SceneUtil::WorkItem* pending = vd.getPendingUpdate())
+        {
+            if (pending->isDone())
+            {
+                const ViewData& updated = static_cast<ViewUpdateItem*>(pending)->getView();
+                // The camera could have moved further while the view was updated, use it anyway if it's closer
+                const bool valid = updated.suitableToUse(mActiveGrid)
+                    && updated.getWorldUpdateRevision() >= mViewDataMap->getWorldUpdateRevision()
+                    && (updated.getViewPoint() - viewPoint).length2() < (vd.getViewPoint() - viewPoint).length2();
+                if (valid)
+                    vd.copyFrom(updated);
+                vd.setPendingUpdate(nullptr);
+                if ((vd.getViewPoint() - viewPoint).length2() < reuseDistance * reuseDistance)
+                    return true;
+            }
+            else
+                return (vd.getViewPoint() - viewPoint).length2() < maxDistance * maxDistance;
+        }
+
+        if ((vd.getViewPoint() - viewPoint).length2() >= maxDistance * maxDistance)
+            return false;
+
+        osg::ref_ptr<ViewUpdateItem> item = new ViewUpdateItem(*this, vd, viewPoint, mActiveGrid, lodCallback);
+        vd.setPendingUpdate(item);
+        mViewUpdateQueue->addWorkItem(item);
+        return true;
+    }
+
+    void QuadTreeWorld::updateView(ViewData& vd, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid,
+        DefaultLodCallback lodCallback, bool compile)
+    {
+        const float cellWorldSize = ESM::getCellSize(mWorldspace);
+
+        vd.setViewPoint(viewPoint);
+        vd.setActiveGrid(activeGrid);
+        vd.reset();
+        mRootNode->traverseNodes(&vd, viewPoint, &lodCallback);
+
+        for (unsigned int i = 0; i < vd.getNumEntries(); ++i)
+            loadRenderingNode(vd.getEntry(i), &vd, cellWorldSize, activeGrid, compile);
+
+        vd.resetChanged();
+    }
+
+    void QuadTreeWorld::setViewUpdateThreads(std::size_t count)
+    {
+        if (mViewUpdateQueue != nullptr)
+            mViewUpdateQueue->stop();
+        mViewUpdateQueue = count == 0 ? nullptr : new SceneUtil::WorkQueue(count);
+    }
+
     void QuadTreeWorld::ensureQuadTreeBuilt()
     {
         std::lock_guard<std::mutex> lock(mQuadTreeMutex);
@@ -8,6 +8,7 @@
 #include <mutex>
 
 #include <components/esm/refid.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 namespace osg
 {
@@ -24,6 +25,8 @@ namespace Terrain
     struct ViewDataEntry;
 
     class DebugChunkManager;
+    class DefaultLodCallback;
+    class ViewUpdateItem;
 
     /// @brief Terrain implementation that loads cells into a Quad Tree, with geometry LOD and texture LOD.
     class QuadTreeWorld
@@ -56,6 +59,13 @@ namespace Terrain
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats) override;
 
+        /// Update the views of cameras in background threads when they move away from the view point they were
+        /// filled for, and keep using the old ones meanwhile. This moves quad tree traversal and chunk creation out of
+        /// the cull traversal and lets the views of several cameras be updated in parallel. 0 updates the views in the
+        /// cull traversal.
+        /// @note Not thread safe.
+        void setViewUpdateThreads(std::size_t count);
+
         class ChunkManager
         {
         public:
@@ -91,6 +101,9 @@ namespace Terrain
         void ensureQuadTreeBuilt();
         void loadRenderingNode(
             ViewDataEntry& entry, ViewData* vd, float cellWorldSize, const osg::Vec4i& gridbounds, bool compile);
+        bool updateViewAsync(ViewData& vd, const osg::Vec3f& viewPoint, const DefaultLodCallback& lodCallback);
+        void updateView(ViewData& vd, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid,
+            DefaultLodCallback lodCallback, bool compile);
 
         osg::ref_ptr<RootNode> mRootNode;
 
@@ -106,6 +119,9 @@ namespace Terrain
         float mMinSize;
         bool mDebugTerrainChunks;
         std::unique_ptr<DebugChunkManager> mDebugChunkManager;
+        osg::ref_ptr<SceneUtil::WorkQueue> mViewUpdateQueue;
+
+        friend class ViewUpdateItem;
     };
 
 }
@@ -1,9 +1,13 @@
 #include "terraindrawable.hpp"
 
+#include <algorithm>
+#include <limits>
+
 #include <osg/ClusterCullingCallback>
 #include <osgUtil/CullVisitor>
 
 #include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/occlusionculling.hpp>
 
 #include "compositemaprenderer.hpp"
 
@@ -18,6 +22,7 @@ namespace Terrain
         : osg::Geometry(copy, copyop)
         , mPasses(copy.mPasses)
         , mLightListCallback(copy.mLightListCallback)
+        , mOccluder(copy.mOccluder)
     {
     }
 
@@ -92,6 +97,12 @@ namespace Terrain
             return;
         }
 
+        if (mOccluder)
+        {
+            if (SceneUtil::OcclusionView* occlusionView = SceneUtil::OcclusionView::get(*cv))
+                occlusionView->addOccluder(*mOccluder, matrix);
+        }
+
         if (mCompositeMap && mCompositeMapRenderer)
         {
             mCompositeMapRenderer->setImmediate(mCompositeMap);
@@ -151,6 +162,49 @@ namespace Terrain
         }
     }
 
+    void TerrainDrawable::setupOccluder(unsigned int numVerts)
+    {
+        const osg::Vec3Array* vertices = static_cast<const osg::Vec3Array*>(getVertexArray());
+        if (numVerts < 2 || vertices->size() != numVerts * numVerts)
+            return;
+
+        const unsigned int numCells = std::min(8u, numVerts - 1);
+        const auto toVertex = [&](unsigned int coarse) { return coarse * (numVerts - 1) / numCells; };
+
+        // Each vertex of the coarse grid takes the lowest height of the coarse cells around it, so the coarse surface
+        // never rises above the actual one
+        osg::ref_ptr<SceneUtil::OccluderMesh> occluder = new SceneUtil::OccluderMesh;
+        for (unsigned int x = 0; x <= numCells; ++x)
+        {
+            for (unsigned int y = 0; y <= numCells; ++y)
+            {
+                float height = std::numeric_limits<float>::max();
+                for (unsigned int vertX = toVertex(std::max(x, 1u) - 1); vertX <= toVertex(std::min(x + 1, numCells));
+                     ++vertX)
+                    for (unsigned int vertY = toVertex(std::max(y, 1u) - 1);
+                         vertY <= toVertex(std::min(y + 1, numCells)); ++vertY)
+                        height = std::min(height, (*vertices)[vertX * numVerts + vertY].z());
+
+                osg::Vec3f vertex = (*vertices)[toVertex(x) * numVerts + toVertex(y)];
+                vertex.z() = height;
+                occluder->mVertices.push_back(vertex);
+                occluder->mBound.expandBy(vertex);
+            }
+        }
+
+        for (unsigned int x = 0; x < numCells; ++x)
+        {
+            for (unsigned int y = 0; y < numCells; ++y)
+            {
+                const unsigned int i = x * (numCells + 1) + y;
+                occluder->mIndices.insert(
+                    occluder->mIndices.end(), { i, i + numCells + 1, i + numCells + 2, i, i + numCells + 2, i + 1 });
+            }
+        }
+
+        mOccluder = occluder;
+    }
+
     void TerrainDrawable::compileGLObjects(osg::RenderInfo& renderInfo) const
     {
         for (PassVector::const_iterator it = mPasses.begin(); it != mPasses.end(); ++it)
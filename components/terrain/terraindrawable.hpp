@@ -16,6 +16,7 @@ namespace osgUtil
 namespace SceneUtil
 {
     class LightListCallback;
+    struct OccluderMesh;
 }
 
 namespace Terrain
@@ -59,6 +60,9 @@ namespace Terrain
         void setupWaterBoundingBox(float waterheight, float margin);
         const osg::BoundingBox& getWaterBoundingBox() const { return mWaterBoundingBox; }
 
+        /// Creates a coarse mesh staying below the surface to hide what is behind the terrain from the scene camera.
+        void setupOccluder(unsigned int numVerts);
+
         void setCompositeMap(CompositeMap* map) { mCompositeMap = map; }
         CompositeMap* getCompositeMap() const { return mCompositeMap; }
         void setCompositeMapRenderer(CompositeMapRenderer* renderer) { mCompositeMapRenderer = renderer; }
@@ -70,6 +74,7 @@ namespace Terrain
         osg::ref_ptr<osg::ClusterCullingCallback> mClusterCullingCallback;
 
         osg::ref_ptr<SceneUtil::LightListCallback> mLightListCallback;
+        osg::ref_ptr<const SceneUtil::OccluderMesh> mOccluder;
         osg::ref_ptr<CompositeMap> mCompositeMap;
         osg::ref_ptr<CompositeMapRenderer> mCompositeMapRenderer;
     };
@@ -74,6 +74,7 @@ namespace Terrain
         mChanged = false;
         mHasViewPoint = false;
         mNodes.clear();
+        mPendingUpdate = nullptr;
     }
 
     bool ViewData::suitableToUse(const osg::Vec4i& activeGrid) const
@@ -127,7 +128,7 @@ namespace Terrain
     }
 
     ViewData* ViewDataMap::getViewData(
-        osg::Object* viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, bool& needsUpdate)
+        osg::Object* viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, ViewUpdate& update)
     {
         ViewerMap::const_iterator found = mViewers.find(viewer);
         ViewData* vd = nullptr;
@@ -138,7 +139,7 @@ namespace Terrain
         }
         else
             vd = found->second;
-        needsUpdate = false;
+        update = ViewUpdate::None;
 
         if (!(vd->suitableToUse(activeGrid)
                 && (vd->getViewPoint() - viewPoint).length2() < mReuseDistance * mReuseDistance
@@ -165,19 +166,29 @@ namespace Terrain
             }
             else if (!mostSuitableView)
             {
-                if (vd->getWorldUpdateRevision() != mWorldUpdateRevision)
+                if (vd->suitableToUse(activeGrid) && vd->getWorldUpdateRevision() >= mWorldUpdateRevision)
                 {
-                    vd->setWorldUpdateRevision(mWorldUpdateRevision);
-                    vd->clear();
+                    update = ViewUpdate::Outdated;
+                    return vd;
                 }
-                vd->setViewPoint(viewPoint);
-                vd->setActiveGrid(activeGrid);
-                needsUpdate = true;
+                resetView(*vd, viewPoint, activeGrid);
+                update = ViewUpdate::Required;
             }
         }
         return vd;
     }
 
+    void ViewDataMap::resetView(ViewData& vd, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid) const
+    {
+        if (vd.getWorldUpdateRevision() != mWorldUpdateRevision)
+        {
+            vd.setWorldUpdateRevision(mWorldUpdateRevision);
+            vd.clear();
+        }
+        vd.setViewPoint(viewPoint);
+        vd.setActiveGrid(activeGrid);
+    }
+
     ViewData* ViewDataMap::createOrReuseView()
     {
         ViewData* vd = nullptr;
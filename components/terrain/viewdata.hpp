@@ -6,6 +6,8 @@
 
 #include <osg/Node>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "view.hpp"
 
 namespace Terrain
@@ -78,6 +80,10 @@ namespace Terrain
 
         void removeNodeFromIndex(const QuadTreeNode* node);
 
+        /// Background update of this view for a new view point, the view stays in use until it's done.
+        SceneUtil::WorkItem* getPendingUpdate() const { return mPendingUpdate.get(); }
+        void setPendingUpdate(osg::ref_ptr<SceneUtil::WorkItem> update) { mPendingUpdate = std::move(update); }
+
     private:
         std::vector<ViewDataEntry> mEntries;
         std::vector<const QuadTreeNode*> mNodes;
@@ -88,6 +94,18 @@ namespace Terrain
         bool mHasViewPoint;
         osg::Vec4i mActiveGrid;
         unsigned int mWorldUpdateRevision;
+        osg::ref_ptr<SceneUtil::WorkItem> mPendingUpdate;
+    };
+
+    enum class ViewUpdate
+    {
+        // The view can be used as is
+        None,
+        // The view was reset for the new view point and has to be filled before use
+        Required,
+        // The view is valid for the active grid and the world state but was filled for a distant view point. It can be
+        // used until updated, or reset with ViewDataMap::resetView to be filled right away.
+        Outdated,
     };
 
     class ViewDataMap : public osg::Referenced
@@ -105,7 +123,11 @@ namespace Terrain
         }
 
         ViewData* getViewData(
-            osg::Object* viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, bool& needsUpdate);
+            osg::Object* viewer, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid, ViewUpdate& update);
+
+        void resetView(ViewData& vd, const osg::Vec3f& viewPoint, const osg::Vec4i& activeGrid) const;
+
+        unsigned int getWorldUpdateRevision() const { return mWorldUpdateRevision; }
 
         ViewData* createOrReuseView();
         ViewData* createIndependentView() const;
@@ -126,6 +126,12 @@ namespace Terrain
         mCompositeMapRenderer->setTargetFrameRate(rate);
     }
 
+    void World::setCreateOccluders(bool create)
+    {
+        if (mChunkManager)
+            mChunkManager->setCreateOccluders(create);
+    }
+
     float World::getHeightAt(const osg::Vec3f& worldPos)
     {
         return mStorage->getHeightAt(worldPos, mWorldspace);
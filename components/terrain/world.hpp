@@ -58,6 +58,10 @@ namespace Terrain
         /// See CompositeMapRenderer::setTargetFrameRate
         void setTargetFrameRate(float rate);
 
+        /// Create coarse meshes of the terrain chunks hiding what is behind them, see SceneUtil::OcclusionCulling.
+        /// @note Has to be called before chunks are created.
+        void setCreateOccluders(bool create);
+
         /// Apply the scene manager's texture filtering settings to all cached textures.
         /// @note Thread safe.
         void updateTextureFiltering();
@@ -6,11 +6,23 @@ varying float alphaPassthrough;
 #include "lib/core/vertex.h.glsl"
 #include "vertexcolors.glsl"
 
+#if @skinning
+attribute vec4 aBoneIndices;
+attribute vec4 aBoneWeights;
+
+#include "lib/util/skinning.glsl"
+#endif
+
 void main()
 {
-    gl_Position = modelToClip(gl_Vertex);
+#if @skinning
+    vec4 vertex = vec4(gl_Vertex.xyz, 1.0) * getSkinningMatrix(aBoneIndices, aBoneWeights);
+#else
+    vec4 vertex = gl_Vertex;
+#endif
+    gl_Position = modelToClip(vertex);
 
-    vec4 viewPos = modelToView(gl_Vertex);
+    vec4 viewPos = modelToView(vertex);
     gl_ClipVertex = viewPos;
 
     if (colorMode == 2)
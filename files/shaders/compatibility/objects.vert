@@ -72,6 +72,20 @@ varying vec4 passTangent;
 #include "lib/light/lighting.glsl"
 #include "lib/view/depth.glsl"
 
+#if @instancing
+attribute vec4 aInstanceOffset;
+attribute vec4 aInstanceRotation;
+
+#include "lib/util/instancing.glsl"
+#endif
+
+#if @skinning
+attribute vec4 aBoneIndices;
+attribute vec4 aBoneWeights;
+
+#include "lib/util/skinning.glsl"
+#endif
+
 #if @particleOcclusion
 varying vec3 orthoDepthMapCoord;
 
@@ -81,22 +95,40 @@ uniform mat4 osg_ViewMatrixInverse;
 
 void main(void)
 {
+#if @instancing
+    vec4 vertex = instanceToModel(aInstanceOffset, aInstanceRotation, gl_Vertex);
+    vec3 normal = rotateByQuat(aInstanceRotation, gl_Normal.xyz);
+#elif @skinning
+    mat4 skinningMatrix = getSkinningMatrix(aBoneIndices, aBoneWeights);
+    vec4 vertex = vec4(gl_Vertex.xyz, 1.0) * skinningMatrix;
+    vec3 normal = (vec4(gl_Normal.xyz, 0.0) * skinningMatrix).xyz;
+#else
+    vec4 vertex = gl_Vertex;
+    vec3 normal = gl_Normal.xyz;
+#endif
+
 #if @particleOcclusion
     mat4 model = osg_ViewMatrixInverse * gl_ModelViewMatrix;
-    orthoDepthMapCoord = ((depthSpaceMatrix * model) * vec4(gl_Vertex.xyz, 1.0)).xyz;
+    orthoDepthMapCoord = ((depthSpaceMatrix * model) * vec4(vertex.xyz, 1.0)).xyz;
 #endif
 
-    gl_Position = modelToClip(gl_Vertex);
+    gl_Position = modelToClip(vertex);
 
-    vec4 viewPos = modelToView(gl_Vertex);
+    vec4 viewPos = modelToView(vertex);
     gl_ClipVertex = viewPos;
     passColor = gl_Color;
     passViewPos = viewPos.xyz;
-    passNormal = gl_Normal.xyz;
+    passNormal = normal;
     normalToViewMatrix = gl_NormalMatrix;
 
 #if @normalMap || @diffuseParallax
+#if @instancing
+    passTangent = vec4(rotateByQuat(aInstanceRotation, gl_MultiTexCoord7.xyz), gl_MultiTexCoord7.w);
+#elif @skinning
+    passTangent = vec4((vec4(gl_MultiTexCoord7.xyz, 0.0) * skinningMatrix).xyz, gl_MultiTexCoord7.w);
+#else
     passTangent = gl_MultiTexCoord7.xyzw;
+#endif
     normalToViewMatrix *= generateTangentSpace(passTangent, passNormal);
 #endif
 
@@ -8,12 +8,33 @@ uniform int colorMode;
 uniform bool useTreeAnim;
 uniform bool useDiffuseMapForShadowAlpha = true;
 uniform bool alphaTestShadows = true;
+uniform bool useInstancing = false;
+
+attribute vec4 aInstanceOffset;
+attribute vec4 aInstanceRotation;
+
+#include "lib/util/instancing.glsl"
+
+#if @skinning
+attribute vec4 aBoneIndices;
+attribute vec4 aBoneWeights;
+
+#include "lib/util/skinning.glsl"
+#endif
 
 void main(void)
 {
-    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+#if @skinning
+    vec4 vertex = vec4(gl_Vertex.xyz, 1.0) * getSkinningMatrix(aBoneIndices, aBoneWeights);
+#else
+    vec4 vertex = gl_Vertex;
+    if (useInstancing)
+        vertex = instanceToModel(aInstanceOffset, aInstanceRotation, gl_Vertex);
+#endif
+
+    gl_Position = gl_ModelViewProjectionMatrix * vertex;
 
-    vec4 viewPos = (gl_ModelViewMatrix * gl_Vertex);
+    vec4 viewPos = (gl_ModelViewMatrix * vertex);
     gl_ClipVertex = viewPos;
 
     if (useDiffuseMapForShadowAlpha)
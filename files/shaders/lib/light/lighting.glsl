@@ -55,9 +55,17 @@ void doLighting(vec3 viewPos, vec3 viewNormal, float shininess, out vec3 diffuse
     specularLight = vec3(0.0);
 #endif
 
+#if @lightingMethodClustered
+    int clusterData = lcalcClusterData(viewPos);
+    int clusterStart = clusterData & int(0xffff);
+    int clusterEnd = clusterStart + (clusterData >> 16);
+#endif
+
     for (int i = @startLight; i < @endLight; ++i)
     {
-#if @lightingMethodUBO
+#if @lightingMethodClustered
+        int lightIndex = lcalcClusterLight(i);
+#elif @lightingMethodUBO
         int lightIndex = PointLightIndex[i];
 #else
         int lightIndex = i;
@@ -44,6 +44,43 @@ uniform LightBufferBinding
     LightData LightBuffer[@maxLightsInScene];
 };
 
+#if @lightingMethodClustered
+
+/* Layout:
+LightClusterGrid: one int per cluster, offset into LightClusterIndices | light count << 16
+LightClusterIndices: 16-bit indices into LightBuffer, two per int
+*/
+uniform LightClusterGridBinding
+{
+    ivec4 LightClusterGrid[@lightClusterGridSize];
+};
+
+uniform LightClusterIndexBinding
+{
+    ivec4 LightClusterIndices[@lightClusterIndexSize];
+};
+
+// The depth slice of a view position is log2(depth) * x + y
+uniform vec2 LightClusterDepth;
+
+int lcalcClusterData(vec3 viewPos)
+{
+    vec4 clipPos = gl_ProjectionMatrix * vec4(viewPos, 1.0);
+    vec2 tiles = vec2(@lightClusterTilesX, @lightClusterTilesY);
+    ivec2 tile = ivec2(clamp((clipPos.xy / clipPos.w * 0.5 + 0.5) * tiles, vec2(0.0), tiles - 1.0));
+    int slice = int(clamp(log2(max(-viewPos.z, 1.0)) * LightClusterDepth.x + LightClusterDepth.y, 0.0, float(@lightClusterSlices - 1)));
+    int cluster = (slice * @lightClusterTilesY + tile.y) * @lightClusterTilesX + tile.x;
+    return LightClusterGrid[cluster >> 2][cluster & 3];
+}
+
+int lcalcClusterLight(int i)
+{
+    int data = LightClusterIndices[i >> 3][(i >> 1) & 3];
+    return (data >> ((i & 1) * 16)) & int(0xffff);
+}
+
+#endif
+
 #elif @lightingMethodPerObjectUniform
 
 /* Layout:
@@ -0,0 +1,19 @@
+#ifndef LIB_UTIL_INSTANCING
+#define LIB_UTIL_INSTANCING
+
+// Per instance transformation of a mesh drawn with instancing:
+// offset.xyz is the translation, offset.w is the uniform scale and rotation is a quaternion.
+
+vec3 rotateByQuat(vec4 q, vec3 v)
+{
+    vec3 uv = cross(q.xyz, v);
+    vec3 uuv = cross(q.xyz, uv);
+    return v + 2.0 * (q.w * uv + uuv);
+}
+
+vec4 instanceToModel(vec4 offset, vec4 rotation, vec4 pos)
+{
+    return vec4(rotateByQuat(rotation, pos.xyz * offset.w) + offset.xyz * pos.w, pos.w);
+}
+
+#endif
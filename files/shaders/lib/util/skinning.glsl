@@ -0,0 +1,36 @@
+#ifndef LIB_UTIL_SKINNING
+#define LIB_UTIL_SKINNING
+
+// Skinning of a mesh by up to 4 bones per vertex, see SceneUtil::RigGeometry.
+// Every bone has the first three columns of its matrix in boneMatrices, as the last one is always (0, 0, 0, 1).
+// skinningOffset is the translation applied once after blending the matrices.
+
+#define MAX_SKINNING_BONES 64
+
+uniform vec4 boneMatrices[MAX_SKINNING_BONES * 3];
+uniform vec3 skinningOffset;
+
+vec4 blendBoneColumns(int column, vec4 indices, vec4 weights)
+{
+    return boneMatrices[int(indices.x) * 3 + column] * weights.x
+        + boneMatrices[int(indices.y) * 3 + column] * weights.y
+        + boneMatrices[int(indices.z) * 3 + column] * weights.z
+        + boneMatrices[int(indices.w) * 3 + column] * weights.w;
+}
+
+// Transforms row vectors, like vec4(pos, 1.0) * m
+mat4 getSkinningMatrix(vec4 indices, vec4 weights)
+{
+    // Vertices without influences are left as is
+    if (dot(weights, vec4(1.0)) == 0.0)
+        return mat4(1.0);
+
+    mat4 m;
+    m[0] = blendBoneColumns(0, indices, weights) + vec4(0.0, 0.0, 0.0, skinningOffset.x);
+    m[1] = blendBoneColumns(1, indices, weights) + vec4(0.0, 0.0, 0.0, skinningOffset.y);
+    m[2] = blendBoneColumns(2, indices, weights) + vec4(0.0, 0.0, 0.0, skinningOffset.z);
+    m[3] = vec4(0.0, 0.0, 0.0, 1.0);
+    return m;
+}
+
+#endif